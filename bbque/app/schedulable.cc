@@ -15,6 +15,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <fstream>
 
 #include "bbque/app/schedulable.h"
@@ -349,6 +350,58 @@ uint64_t Schedulable::ScheduleCount() const noexcept
 	return schedule.count;
 }
 
+#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+
+void Schedulable::UpdateIOUsage(
+		std::string const & dev,
+		IOUsage_t const & sample,
+		float weight)
+{
+	std::unique_lock<std::mutex> io_ul(io_usage_mtx);
+	IOUsage_t & usage(io_usage[dev]);
+
+	// The first sample initializes the moving average
+	if (usage.samples == 0)
+		weight = 1.0;
+
+	usage.read_bps   = weight * sample.read_bps   + (1 - weight) * usage.read_bps;
+	usage.write_bps  = weight * sample.write_bps  + (1 - weight) * usage.write_bps;
+	usage.read_iops  = weight * sample.read_iops  + (1 - weight) * usage.read_iops;
+	usage.write_iops = weight * sample.write_iops + (1 - weight) * usage.write_iops;
+	++usage.samples;
+}
+
+Schedulable::IOUsage_t Schedulable::GetIOUsage(std::string const & dev) const
+{
+	std::unique_lock<std::mutex> io_ul(io_usage_mtx);
+	auto it = io_usage.find(dev);
+	if (it == io_usage.end())
+		return IOUsage_t();
+	return it->second;
+}
+
+Schedulable::IOUsage_t Schedulable::GetIOUsage() const
+{
+	std::unique_lock<std::mutex> io_ul(io_usage_mtx);
+	IOUsage_t total;
+	for (auto const & entry : io_usage) {
+		total.read_bps   += entry.second.read_bps;
+		total.write_bps  += entry.second.write_bps;
+		total.read_iops  += entry.second.read_iops;
+		total.write_iops += entry.second.write_iops;
+		total.samples = std::max(total.samples, entry.second.samples);
+	}
+	return total;
+}
+
+void Schedulable::ClearIOUsage()
+{
+	std::unique_lock<std::mutex> io_ul(io_usage_mtx);
+	io_usage.clear();
+}
+
+#endif // CONFIG_BBQUE_LINUX_CG_BLKIO
+
 
 } // namespace app
 
@@ -257,40 +257,17 @@ int32_t WorkingMode::BindResource(br::ResourceType r_type,
 	logger->Debug("BindResource: <%s> from %d to %d",
 		br::GetResourceTypeString(r_type), source_id, out_id);
 
-	br::ResourceAssignmentMapPtr_t bindings_map = nullptr;
-	br::ResourceAssignmentMap_t * requests_map =
-		GetSourceAndOutBindingMaps(bindings_map, prev_refn);
-	if (!requests_map || !bindings_map) {
-		logger->Error("BindingResource: source map = @%p", requests_map);
-		logger->Error("BindingResource: out map = @%p", bindings_map.get());
-		return -1;
-	}
-
-	// Check that the source map contains all the requests. This check is
-	// necessary since a policy may have added further requests after
-	// performing some bindings
-	if (!bindings_map->empty() && (bindings_map->size() != resources.requested.size())) {
-		uint32_t miss_count = AddMissingResourceRequests(bindings_map, r_type);
-		logger->Debug("BindResource: added %d missing request(s)", miss_count);
+	br::BindingStep_t step;
+	step.r_type    = r_type;
+	step.source_id = source_id;
+	step.out_id    = out_id;
+	if ((filter_rtype != br::ResourceType::UNDEFINED) && (filter_mask != nullptr)) {
+		step.filter_rtype = filter_rtype;
+		step.filtered     = true;
+		step.filter_mask  = *filter_mask;
 	}
 
-	// Do the binding
-	br::ResourceBinder::Bind(*requests_map, r_type, source_id, out_id, bindings_map,
-				filter_rtype, filter_mask);
-	if (bindings_map->empty()) {
-		logger->Warn("BindResource: %s nothing to bind", str_id);
-		return -1;
-	}
-
-	// Save the result of the binding
-	int32_t refn = StoreBinding(bindings_map, prev_refn);
-	logger->Debug("BindResource: %s R{%-3s} map size = %d [refn = %d]",
-		str_id, br::GetResourceTypeString(r_type),
-		bindings_map->size(), refn);
-
-	PrintBindingMap(bindings_map);
-
-	return refn;
+	return AddBindingStep(step, prev_refn);
 }
 
 int32_t WorkingMode::BindResource(br::ResourcePathPtr_t resource_path,
@@ -300,40 +277,70 @@ int32_t WorkingMode::BindResource(br::ResourcePathPtr_t resource_path,
 	logger->Debug("BindResource: %s <%s> binding according to mask=%s",
 		str_id, resource_path->ToString().c_str(), filter_mask.ToString().c_str());
 
-	br::ResourceAssignmentMapPtr_t bindings_map = nullptr;
-	br::ResourceAssignmentMap_t * requests_map =
-		GetSourceAndOutBindingMaps(bindings_map, prev_refn);
+	br::BindingStep_t step;
+	step.resource_path = resource_path;
+	step.filter_mask   = filter_mask;
 
-	if (!requests_map || !bindings_map) {
-		logger->Error("BindingResource: source map = @%p", requests_map);
-		logger->Error("BindingResource: out map = @%p", bindings_map.get());
-		return -1;
+	return AddBindingStep(step, prev_refn);
+}
+
+int32_t WorkingMode::AddBindingStep(br::BindingStep_t const & step,
+				    int32_t prev_refn)
+{
+	// First binding: start a new candidate, if there is something to bind
+	if (prev_refn < 0) {
+		if (!br::ResourceBinder::Bindable(resources.requested, step)) {
+			logger->Warn("BindResource: %s nothing to bind", str_id);
+			return -1;
+		}
+		resources.sched_bindings.emplace_back();
+		resources.sched_bindings.back().steps.push_back(step);
+		int32_t refn = resources.sched_bindings.size() - 1;
+		logger->Debug("BindResource: %s first binding [refn=%d]",
+			str_id, refn);
+		return refn;
 	}
 
-	// Check that the source map contains all the requests. This check is
-	// necessary since a policy may have added further requests after
-	// performing some bindings
-	if (!bindings_map->empty() && (bindings_map->size() != resources.requested.size())) {
-		uint32_t miss_count = AddMissingResourceRequests(bindings_map, resource_path->Type());
-		logger->Debug("BindResource: %s added %d missing request(s)", str_id, miss_count);
+	// Resuming already performed bindings...
+	if (prev_refn >= (int32_t) resources.sched_bindings.size()) {
+		logger->Error("BindResource: %s wrong reference number [%d]",
+			str_id, prev_refn);
+		return -1;
 	}
 
-	br::ResourceBinder::Bind(*requests_map, resource_path, filter_mask, bindings_map);
+	SchedBinding_t & candidate(resources.sched_bindings[prev_refn]);
+	candidate.steps.push_back(step);
+	logger->Debug("BindResource: %s binding [refn=%d] steps=%d",
+		str_id, prev_refn, candidate.steps.size());
+
+	// Keep the map updated if already built
+	if (candidate.bound_map)
+		ApplyBindingStep(candidate.bound_map, step);
+
+	return prev_refn;
+}
+
+void WorkingMode::ApplyBindingStep(br::ResourceAssignmentMapPtr_t bindings_map,
+				   br::BindingStep_t const & step) const
+{
+	// The first binding starts from the resource requests
 	if (bindings_map->empty()) {
-		logger->Warn("BindResource: %s nothing to bind for <%s>",
-			str_id, resource_path->ToString().c_str());
-		return -1;
+		br::ResourceBinder::Bind(resources.requested, step, bindings_map);
+		return;
 	}
-	logger->Debug("BindResource: %s binding performed for <%s>",
-		str_id, resource_path->ToString().c_str());
 
-	// Save the result of the binding
-	int32_t refn = StoreBinding(bindings_map, prev_refn);
-	logger->Debug("BindResource: %s bindings_map size=%d [prev_refn=%d]",
-		str_id, bindings_map->size(), refn);
+	// Check that the source map contains all the requests. This check is
+	// necessary since a policy may have added further requests after
+	// performing some bindings
+	if (bindings_map->size() != resources.requested.size()) {
+		br::ResourceType r_type = step.resource_path ?
+			step.resource_path->Type() : step.r_type;
+		uint32_t miss_count = AddMissingResourceRequests(bindings_map, r_type);
+		logger->Debug("BindResource: %s added %d missing request(s)",
+			str_id, miss_count);
+	}
 
-	PrintBindingMap(bindings_map);
-	return refn;
+	br::ResourceBinder::Bind(*bindings_map, step, bindings_map);
 }
 
 void WorkingMode::PrintBindingMap(br::ResourceAssignmentMapPtr_t bind_map) const
@@ -353,7 +360,7 @@ void WorkingMode::PrintBindingMap(br::ResourceAssignmentMapPtr_t bind_map) const
 
 uint32_t
 WorkingMode::AddMissingResourceRequests(br::ResourceAssignmentMapPtr_t bound_map,
-					br::ResourceType r_type)
+					br::ResourceType r_type) const
 {
 	uint32_t diff_size = resources.requested.size() - bound_map->size();
 	logger->Debug("AddMissingResourceRequests: bound_map size=%d ", bound_map->size());
@@ -406,49 +413,6 @@ WorkingMode::AddMissingResourceRequests(br::ResourceAssignmentMapPtr_t bound_map
 	return nr_added;
 }
 
-br::ResourceAssignmentMap_t *
-WorkingMode::GetSourceAndOutBindingMaps(br::ResourceAssignmentMapPtr_t & bindings_map,
-					int32_t prev_refn)
-{
-	// First binding?
-	if (prev_refn < 0) {
-		logger->Debug("BindResource: first binding");
-		bindings_map = std::make_shared<br::ResourceAssignmentMap_t>();
-		return &resources.requested;
-	}
-
-	// Resuming already performed bindings...
-	logger->Debug("BindResource: resuming binding @[%d]", prev_refn);
-	bindings_map = GetSchedResourceBinding(prev_refn);
-	if (!bindings_map) {
-		logger->Error("BindingResource: wrong reference number [%d]",
-			prev_refn);
-		return nullptr;
-	}
-
-	return bindings_map.get();
-}
-
-int32_t WorkingMode::StoreBinding(br::ResourceAssignmentMapPtr_t bindings_map,
-				  int32_t prev_refn)
-{
-	int32_t refn = -1;
-	if (prev_refn < 0) {
-		refn = 0;
-		resources.sched_bindings.push_back(bindings_map);
-		logger->Debug("StoreBinding: first binding stored [refn=%d]", refn);
-	}
-	else if (prev_refn < (int32_t) resources.sched_bindings.size()) {
-		refn = prev_refn;
-		resources.sched_bindings[refn] = bindings_map;
-		logger->Debug("StoreBinding: updated binding stored [refn=%d]", refn);
-	}
-	else
-		logger->Error("StoreBinding: out of range reference number [%d]",
-			prev_refn);
-	return refn;
-}
-
 br::ResourceAssignmentMapPtr_t WorkingMode::GetSchedResourceBinding(uint32_t b_refn) const
 {
 	if (b_refn >= resources.sched_bindings.size()) {
@@ -456,8 +420,23 @@ br::ResourceAssignmentMapPtr_t WorkingMode::GetSchedResourceBinding(uint32_t b_r
 			str_id, b_refn);
 		return nullptr;
 	}
+
+	// Build the map of resource assignments, replaying the binding actions.
+	// The map is published only once complete.
+	SchedBinding_t & candidate(resources.sched_bindings[b_refn]);
+	std::call_once(*candidate.build_flag, [&]() {
+		auto bound_map = std::make_shared<br::ResourceAssignmentMap_t>();
+		for (auto const & step : candidate.steps)
+			ApplyBindingStep(bound_map, step);
+		logger->Debug("SchedResourceBinding: %s binding @[%ld] built: "
+			"steps=%d map size=%d", str_id, b_refn,
+			candidate.steps.size(), bound_map->size());
+		PrintBindingMap(bound_map);
+		candidate.bound_map = bound_map;
+	});
+
 	logger->Debug("SchedResourceBinding: found binding @[%ld]", b_refn);
-	return resources.sched_bindings[b_refn];
+	return candidate.bound_map;
 }
 
 WorkingMode::ExitCode_t WorkingMode::SetResourceBinding(br::RViewToken_t status_view,
@@ -488,6 +467,10 @@ void WorkingMode::UpdateBindingInfo(br::RViewToken_t status_view,
 	br::ResourceBitset new_mask;
 	logger->Debug("UpdateBinding: mask update required (%s)",
 		update_changed ? "Y" : "N");
+	if (!resources.sync_bindings) {
+		logger->Debug("UpdateBinding: %s no binding to synchronize", str_id);
+		return;
+	}
 
 	// Update the resource binding bitmask (for each type)
 	for (int r_type_index = 0; r_type_index < R_TYPE_COUNT; ++r_type_index) {
@@ -498,14 +481,14 @@ void WorkingMode::UpdateBindingInfo(br::RViewToken_t status_view,
 				str_id, br::GetResourceTypeString(r_type));
 			// 'Deep' get bit-mask in this case
 			new_mask = br::ResourceBinder::GetMask(
-							resources.sched_bindings[resources.sync_refn],
+							resources.sync_bindings,
 							static_cast<br::ResourceType>(r_type),
 							br::ResourceType::CPU,
 							R_ID_ANY, owner, status_view);
 		}
 		else {
 			new_mask = br::ResourceBinder::GetMask(
-							resources.sched_bindings[resources.sync_refn],
+							resources.sync_bindings,
 							static_cast<br::ResourceType>(r_type));
 		}
 		logger->Debug("UpdateBinding: %s R{%-3s}: %s",
@@ -35,6 +35,7 @@
 #include "bbque/resource_partition_validator.h"
 #include "bbque/utils/assert.h"
 #include "bbque/utils/schedlog.h"
+#include "bbque/utils/tracer.h"
 
 #include <boost/program_options/options_description.hpp>
 #include <boost/program_options/variables_map.hpp>
@@ -1586,6 +1587,7 @@ ApplicationManager::ScheduleRequest(ba::AppCPtr_t papp,
 				    br::RViewToken_t status_view,
 				    size_t b_refn)
 {
+	BBQUE_TRACE_SPAN_LABEL("am.schedule_request", papp->StrId());
 
 	ResourceAccounter & ra(ResourceAccounter::GetInstance());
 	ResourceAccounter::ExitCode_t ra_result;
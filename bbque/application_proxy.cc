@@ -41,7 +41,11 @@ namespace br = bbque::res;
 namespace bbque {
 
 ApplicationProxy::ApplicationProxy() :
-    Worker()
+    Worker(),
+    requests_pool(BBQUE_MODULE_NAME("ap.rq"), BBQUE_AP_WORKERS),
+    stop_pool(BBQUE_MODULE_NAME("ap.st"), BBQUE_AP_WORKERS),
+    commands_pool(BBQUE_MODULE_NAME("ap.cs"), BBQUE_AP_WORKERS),
+    cmd_token(0)
 {
 	//---------- Setup Worker
 	Worker::Setup(BBQUE_MODULE_NAME("ap"), APPLICATION_PROXY_NAMESPACE);
@@ -85,11 +89,18 @@ ApplicationProxy & ApplicationProxy::GetInstance()
 	return instance;
 }
 
-bl::rpc_msg_type_t ApplicationProxy::GetNextMessage(pchMsg_t & pChMsg)
+bl::rpc_msg_type_t ApplicationProxy::GetNextMessage(pchMsg_t & pChMsg,
+						     size_t & msg_size)
 {
-	rpc->RecvMessage(pChMsg);
-	logger->Debug("GetNextMessage: RX [typ: %d, pid: %d]",
-		pChMsg->typ, pChMsg->app_pid);
+	pChMsg = NULL;
+	ssize_t bytes = rpc->RecvMessage(pChMsg);
+	msg_size = (bytes > 0) ? bytes : 0;
+	if (!pChMsg) {
+		logger->Debug("GetNextMessage: no message [err: %d]", (int)bytes);
+		return bl::RPC_BBQ_MSGS_COUNT;
+	}
+	logger->Debug("GetNextMessage: RX [typ: %d, pid: %d, sze: %d]",
+		pChMsg->typ, pChMsg->app_pid, (int)msg_size);
 
 	return (bl::rpc_msg_type_t)pChMsg->typ;
 }
@@ -118,7 +129,7 @@ void ApplicationProxy::EnqueueHandler(pcmdSn_t pcs)
 
 	assert(pcs);
 
-	pcs->pid = gettid();
+	pcs->pid = ++cmd_token;
 
 	if (cmdSnMap.find(pcs->pid) != cmdSnMap.end()) {
 		logger->Crit("EnqueueHandler: handler enqueuing FAILED "
@@ -220,10 +231,9 @@ ApplicationProxy::StopExecution(AppPtr_t papp)
 	psn = SetupCmdSession(papp);
 	logger->Info("StopExecution: [%s] closing communication...",
 		papp->StrId());
-	// Spawn a new Command Executor (passing the future)
-	psn->exe = std::thread(&ApplicationProxy::StopExecutionTrd, this, psn);
-	psn->exe.detach();
-
+	// Submit a new Command Executor (passing the future)
+	commands_pool.Submit(papp->Pid(),
+		std::bind(&ApplicationProxy::StopExecutionTrd, this, psn));
 
 	// Return the promise (thus unlocking the executor)
 	psn->resp_prm.get_future();
@@ -245,9 +255,8 @@ ApplicationProxy::Prof_GetRuntimeData(ba::AppPtr_t papp)
 	assert(pcs);
 
 	// Command executor (passing the future)
-	pcs->exe = std::thread(
-			&ApplicationProxy::Prof_GetRuntimeDataTrd, this, pcs);
-	pcs->exe.detach();
+	commands_pool.Submit(papp->Pid(),
+		std::bind(&ApplicationProxy::Prof_GetRuntimeDataTrd, this, pcs));
 
 	// Setup the promise (thus unlocking the executor)
 	pcs->resp_ftr = (pcs->resp_prm).get_future();
@@ -264,14 +273,16 @@ ApplicationProxy::Prof_GetRuntimeDataTrd(pcmdSn_t pcs)
 	EnqueueHandler(pcs);
 
 	// Send get runtime profile request
-	result = Prof_GetRuntimeDataSend(pcs->papp);
+	result = Prof_GetRuntimeDataSend(pcs);
 	if (result != RTLIB_OK) {
 		logger->Error("Prof_GetRuntimeDataTrd: profile data request failed");
+		ReleaseCommandSession(pcs);
 		return RTLIB_ERROR;
 	}
 
 	// Receive runtime profiling data
 	result = Prof_GetRuntimeDataRecv(pcs);
+	ReleaseCommandSession(pcs);
 	if (result != RTLIB_OK) {
 		logger->Error("Prof_GetRuntimeDataTrd: profile data receiving failed");
 		return RTLIB_ERROR;
@@ -282,8 +293,9 @@ ApplicationProxy::Prof_GetRuntimeDataTrd(pcmdSn_t pcs)
 }
 
 RTLIB_ExitCode_t
-ApplicationProxy::Prof_GetRuntimeDataSend(ba::AppPtr_t papp)
+ApplicationProxy::Prof_GetRuntimeDataSend(pcmdSn_t pcs)
 {
+	AppPtr_t papp = pcs->papp;
 	std::unique_lock<std::mutex> conCtxMap_ul(conCtxMap_mtx,
 						std::defer_lock);
 	conCtxMap_t::iterator it;
@@ -293,7 +305,7 @@ ApplicationProxy::Prof_GetRuntimeDataSend(ba::AppPtr_t papp)
 	bl::rpc_msg_BBQ_GET_PROFILE_t stop_msg = {
 		{
 			bl::RPC_BBQ_GET_PROFILE,
-			static_cast<unsigned int> (gettid()),
+			static_cast<bl::rpc_msg_token_t> (pcs->pid),
 			static_cast<int> (papp->Pid()),
 			papp->ExcId()
 		},
@@ -365,6 +377,9 @@ ApplicationProxy::Prof_GetRuntimeDataRecv(pcmdSn_t pcs)
 	logger->Info("Prof_GetRuntimeDataRecv: [%s %s] runtime profile set",
 		pcs->papp->StrId(), pcs->papp->CurrentAWM()->StrId());
 
+	rpc->FreeMessage(pcs->pmsg);
+	pcs->pmsg = NULL;
+
 	return RTLIB_OK;
 }
 
@@ -585,6 +600,9 @@ ApplicationProxy::SyncP_PreChangeRecv(pcmdSn_t pcs,
 		pcs->papp->CurrentAWM()->SetRuntimeProfSyncTime(
 								presp->syncLatency);
 
+	rpc->FreeMessage(pcs->pmsg);
+	pcs->pmsg = NULL;
+
 	return RTLIB_OK;
 }
 
@@ -650,10 +668,9 @@ ApplicationProxy::SyncP_PreChange(AppPtr_t papp, pPreChangeRsp_t presp)
 	assert(presp->pcs);
 
 #ifdef CONFIG_BBQUE_YP_SASB_ASYNC
-	// Spawn a new Command Executor (passing the future)
-	presp->pcs->exe = std::thread(&ApplicationProxy::SyncP_PreChangeTrd,
-				this, presp);
-	presp->pcs->exe.detach();
+	// Submit a new Command Executor (passing the future)
+	commands_pool.Submit(papp->Pid(),
+		std::bind(&ApplicationProxy::SyncP_PreChangeTrd, this, presp));
 
 	// Setup the promise (thus unlocking the executor)
 	presp->pcs->resp_ftr = (presp->pcs->resp_prm).get_future();
@@ -780,6 +797,9 @@ ApplicationProxy::SyncP_SyncChangeRecv(pcmdSn_t pcs,
 	// Processing response (nothing to process right now)
 	(void) presp;
 
+	rpc->FreeMessage(pcs->pmsg);
+	pcs->pmsg = NULL;
+
 	return RTLIB_OK;
 }
 
@@ -836,10 +856,9 @@ ApplicationProxy::SyncP_SyncChange(AppPtr_t papp, pSyncChangeRsp_t presp)
 	assert(presp->pcs);
 
 #ifdef CONFIG_BBQUE_YP_SASB_ASYNC
-	// Spawn a new Command Executor (passing the future)
-	presp->pcs->exe = std::thread(&ApplicationProxy::SyncP_SyncChangeTrd,
-				this, presp);
-	presp->pcs->exe.detach();
+	// Submit a new Command Executor (passing the future)
+	commands_pool.Submit(papp->Pid(),
+		std::bind(&ApplicationProxy::SyncP_SyncChangeTrd, this, presp));
 
 	// Setup the promise (thus unlocking the executor)
 	presp->pcs->resp_ftr = (presp->pcs->resp_prm).get_future();
@@ -1047,6 +1066,9 @@ ApplicationProxy::SyncP_PostChangeRecv(pcmdSn_t pcs,
 	// Processing response (nothing to process right now)
 	(void) presp;
 
+	rpc->FreeMessage(pcs->pmsg);
+	pcs->pmsg = NULL;
+
 	return RTLIB_OK;
 }
 
@@ -1154,6 +1176,7 @@ void ApplicationProxy::CompleteTransaction(pchMsg_t & pmsg)
 			"(Error: cmd session not found for token [%d])",
 			pmsg_hdr->token);
 		assert(pcs);
+		rpc->FreeMessage(pmsg);
 		return;
 	}
 
@@ -1419,6 +1442,67 @@ void ApplicationProxy::RpcExcRuntimeProfileNotify(prqsSn_t prqs)
 	//RpcACK(pcon, pmsg_hdr, bl::RPC_EXC_RESP);
 }
 
+void ApplicationProxy::RpcExcRuntimeProfileNotifyBatch(prqsSn_t prqs)
+{
+	ApplicationManager & am(ApplicationManager::GetInstance());
+	ResourceManager & rm(ResourceManager::GetInstance());
+	pchMsg_t pchMsg = prqs->pmsg;
+	rpc_msg_header_t * pmsg_hdr = pchMsg;
+	bl::rpc_msg_EXC_RTNOTIFY_BATCH_t * pmsg_pyl =
+		(bl::rpc_msg_EXC_RTNOTIFY_BATCH_t*)pmsg_hdr;
+	bl::rpc_msg_EXC_RTNOTIFY_sample_t * samples = &(pmsg_pyl->samples);
+	pconCtx_t pcon;
+	ApplicationManager::ExitCode_t result;
+	bool resched_required = false;
+	assert(pchMsg);
+	// Looking for a valid connection context
+	pcon = GetConnectionContext(pmsg_hdr);
+	if (!pcon) {
+		logger->Error("RpcExcRuntimeProfileNotifyBatch: No connection context");
+		return;
+	}
+
+	// The message must hold all the profiles it counts
+	if ((prqs->msg_size < offsetof(bl::rpc_msg_EXC_RTNOTIFY_BATCH_t, count) +
+				sizeof(pmsg_pyl->count)) ||
+		(pmsg_pyl->count == 0) ||
+		(pmsg_pyl->count > RPC_EXC_RTNOTIFY_BATCH_MAX) ||
+		(prqs->msg_size < offsetof(bl::rpc_msg_EXC_RTNOTIFY_BATCH_t, samples) +
+			pmsg_pyl->count * sizeof(bl::rpc_msg_EXC_RTNOTIFY_sample_t))) {
+		logger->Error("RpcExcRuntimeProfileNotifyBatch: [app: %s, pid: %d] "
+			"malformed message [sze: %d]",
+			pcon->app_name, pcon->app_pid, (int)prqs->msg_size);
+		return;
+	}
+
+	logger->Debug("RpcExcRuntimeProfileNotifyBatch: [%d] profiles received "
+		"[app: %s, pid: %d]",
+		pmsg_pyl->count, pcon->app_name, pcon->app_pid);
+
+	// Update all the profiles, then reschedule (once) if required
+	for (uint8_t i = 0; i < pmsg_pyl->count; ++i) {
+		logger->Debug("RpcExcRuntimeProfileNotifyBatch: EXC [pid: %d, exc: %d]"
+			" ggap=%d cpu_usage=%d cycle_time=%dms cycle_count=%d",
+			pcon->app_pid, samples[i].exc_id,
+			samples[i].cps_goal_gap,
+			samples[i].cpu_usage,
+			samples[i].cycle_time_ms,
+			samples[i].cycle_count);
+		result = am.SetRuntimeProfile(pcon->app_pid, samples[i].exc_id,
+					samples[i].cps_goal_gap,
+					samples[i].cpu_usage,
+					samples[i].cycle_time_ms,
+					samples[i].cycle_count);
+		if (result == ApplicationManager::AM_RESCHED_REQUIRED)
+			resched_required = true;
+	}
+
+	if (resched_required) {
+		logger->Debug("RpcExcRuntimeProfileNotifyBatch: Notifying ResourceManager");
+		rm.NotifyEvent(ResourceManager::BBQ_OPTS);
+	}
+}
+
 void ApplicationProxy::RpcExcStart(prqsSn_t prqs)
 {
 	ApplicationManager & am(ApplicationManager::GetInstance());
@@ -1542,7 +1626,7 @@ void ApplicationProxy::RpcAppPair(prqsSn_t prqs)
 
 	// Checking API versioning
 	if (pmsg_pyl->mjr_version != RTLIB_VERSION_MAJOR ||
-	pmsg_pyl->mnr_version > RTLIB_VERSION_MINOR) {
+	pmsg_pyl->mnr_version != RTLIB_VERSION_MINOR) {
 		logger->Error("RpcAppPair: Setup RPC channel [pid: %d, name: %s] "
 			"FAILED (Error: version mismatch, "
 			"app_v%d.%d != rtlib_v%d.%d)",
@@ -1618,19 +1702,9 @@ void ApplicationProxy::RpcAppExit(prqsSn_t prqs)
 
 void ApplicationProxy::RequestExecutor(prqsSn_t prqs)
 {
-	std::unique_lock<std::mutex> snCtxMap_ul(snCtxMap_mtx);
-	snCtxMap_t::iterator it;
-	psnCtx_t psc;
-
 	// Set the thread PID
 	prqs->pid = gettid();
 
-	// This look could be acquiren only when the ProcessCommand has returned
-	// Thus we use this lock to synchronize the CommandExecutr starting with
-	// the completion of the ProcessCommand, which also setup thread
-	// tracking data structures.
-	snCtxMap_ul.unlock();
-
 	logger->Debug("RequestExecutor: [%d:%d]: Executor starting...",
 		prqs->pid, prqs->pmsg->typ);
 
@@ -1663,6 +1737,11 @@ void ApplicationProxy::RequestExecutor(prqsSn_t prqs)
 		RpcExcRuntimeProfileNotify(prqs);
 		break;
 
+	case bl::RPC_EXC_RTNOTIFY_BATCH:
+		logger->Debug("EXC_RTNOTIFY_BATCH");
+		RpcExcRuntimeProfileNotifyBatch(prqs);
+		break;
+
 	case bl::RPC_EXC_START:
 		logger->Debug("EXC_START");
 		RpcExcStart(prqs);
@@ -1694,49 +1773,53 @@ void ApplicationProxy::RequestExecutor(prqsSn_t prqs)
 		break;
 	}
 
-	// Releasing the thread tracking data before exiting
-	snCtxMap_ul.lock();
-	it = snCtxMap.lower_bound(prqs->pmsg->typ);
-	for ( ; it != snCtxMap.end() ; it++) {
-		psc = it->second;
-		if (psc->pid == prqs->pid) {
-			snCtxMap.erase(it);
-			break;
-		}
-	}
-	snCtxMap_ul.unlock();
-
 	logger->Debug("RequestExecutor: [%d:%d] Executor terminated",
 		prqs->pid, prqs->pmsg->typ);
 
+	// Release the request message
+	rpc->FreeMessage(prqs->pmsg);
+
 }
 
-void ApplicationProxy::ProcessRequest(pchMsg_t & pmsg)
+bool ApplicationProxy::IsBlockingRequest(uint8_t typ)
+{
+	// The stop waits for the scheduler into ApplicationManager::DisableEXC().
+	// The unregister and exit requests could disable the EXCs left
+	// running, and must not overtake a previous stop.
+	switch (typ) {
+	case bl::RPC_EXC_STOP:
+	case bl::RPC_EXC_UNREGISTER:
+	case bl::RPC_APP_EXIT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void ApplicationProxy::ProcessRequest(pchMsg_t & pmsg, size_t msg_size)
 {
-	std::unique_lock<std::mutex> snCtxMap_ul(snCtxMap_mtx);
 	prqsSn_t prqsSn = std::make_shared<rqsSn_t>();
 	assert(prqsSn);
 
 	prqsSn->pmsg = pmsg;
-	// Create a new executor thread, this will start locked since it needs
-	// the execMap_mtx we already hold. This is used to ensure that the
-	// executor thread start only alfter the playground has been properly
-	// prepared
-	prqsSn->exe = std::thread(
-				&ApplicationProxy::RequestExecutor,
-				this, prqsSn);
-	prqsSn->exe.detach();
-
-	logger->Debug("ProcessRequest: enqueuing new request...");
-
-	// Add a new threaded command executor
-	snCtxMap.emplace(pmsg->typ, prqsSn);
+	prqsSn->msg_size = msg_size;
+	logger->Debug("ProcessRequest: enqueuing new request [typ: %d, pid: %d]...",
+		pmsg->typ, pmsg->app_pid);
+
+	// The requests of the same application are served in order. The
+	// requests disabling EXCs could wait for an optimization: keep them
+	// apart.
+	bu::WorkerPool & pool(IsBlockingRequest(pmsg->typ) ?
+		stop_pool : requests_pool);
+	pool.Submit(pmsg->app_pid,
+		std::bind(&ApplicationProxy::RequestExecutor, this, prqsSn));
 }
 
 void ApplicationProxy::Task()
 {
 	bl::rpc_msg_type_t msgType;
 	pchMsg_t pmsg;
+	size_t msg_size;
 	logger->Info("Task: Messages dispatcher STARTED");
 
 	while (!done) {
@@ -1744,7 +1827,9 @@ void ApplicationProxy::Task()
 			continue;
 		logger->Debug("Task: new incoming message from RTLIB");
 
-		msgType = GetNextMessage(pmsg);
+		msgType = GetNextMessage(pmsg, msg_size);
+		if (!pmsg)
+			continue;
 		logger->Debug("Task: incoming message type: %d", msgType);
 
 		if (msgType > bl::RPC_EXC_MSGS_COUNT) {
@@ -1752,7 +1837,7 @@ void ApplicationProxy::Task()
 			CompleteTransaction(pmsg);
 			continue;
 		}
-		ProcessRequest(pmsg);
+		ProcessRequest(pmsg, msg_size);
 	}
 
 	logger->Info("Task: Messages dispatcher ENDED");
@@ -465,6 +465,22 @@ PlatformManager::MapResources(SchedPtr_t papp, ResourceAssignmentMapPtr_t pres,
 	return PLATFORM_OK;
 }
 
+PlatformManager::ExitCode_t PlatformManager::BeginMappings()
+{
+	return lpp->BeginMappings();
+}
+
+PlatformManager::ExitCode_t
+PlatformManager::CommitMappings(std::vector<SchedPtr_t> & failed)
+{
+	ExitCode_t ec = lpp->CommitMappings(failed);
+	if (BBQUE_UNLIKELY(ec != PLATFORM_OK)) {
+		logger->Error("CommitMappings: %d local mapping(s) failed "
+			"(error code: %i)", failed.size(), ec);
+	}
+	return ec;
+}
+
 PlatformManager::ExitCode_t PlatformManager::ActuatePowerManagement()
 {
 
@@ -10,6 +10,18 @@ bool PlatformProxy::IsHighPerformance(bbque::res::ResourcePathPtr_t const & path
 	return false;
 }
 
+PlatformProxy::ExitCode_t PlatformProxy::BeginMappings()
+{
+	return ExitCode_t::PLATFORM_OK;
+}
+
+PlatformProxy::ExitCode_t
+PlatformProxy::CommitMappings(std::vector<SchedPtr_t> & failed)
+{
+	(void) failed;
+	return ExitCode_t::PLATFORM_OK;
+}
+
 PlatformProxy::ExitCode_t PlatformProxy::ActuatePowerManagement()
 {
 	return ExitCode_t::PLATFORM_OK;
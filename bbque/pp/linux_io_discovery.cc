@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2017  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bbque/pp/linux_io_discovery.h"
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <unistd.h>
+
+#define MODULE_NAMESPACE "bq.pp.linux_io"
+
+#define BBQUE_PP_LINUX_SYS_BLOCK      "/sys/block"
+#define BBQUE_PP_LINUX_DEV            "/dev"
+
+// Size of the reads for the sequential bandwidth measurement
+#define BBQUE_PP_LINUX_IO_SEQ_SIZE    (1 << 20)
+// Size of the reads for the random IOPS measurement
+#define BBQUE_PP_LINUX_IO_RAND_SIZE   (4 << 10)
+// Alignment of the O_DIRECT buffer
+#define BBQUE_PP_LINUX_IO_ALIGN       4096
+
+// Header of the calibration cache file. A cache with a different header
+// (e.g., bandwidth in MB/s) is discarded.
+#define BBQUE_PP_LINUX_IO_CACHE_HEADER \
+	"# name dev rotational size[B] read_bandwidth[B/s] read_iops"
+
+namespace bfs = boost::filesystem;
+
+namespace bbque {
+namespace pp {
+
+LinuxIODiscovery::LinuxIODiscovery(
+		std::string const & _cache_file,
+		uint32_t _calibration_ms) :
+    cache_file(_cache_file),
+    calibration_ms(_calibration_ms)
+{
+	logger = bu::Logger::GetLogger(MODULE_NAMESPACE);
+	assert(logger);
+}
+
+std::vector<LinuxIODiscovery::DeviceInfo_t> LinuxIODiscovery::Discover()
+{
+	std::vector<DeviceInfo_t> devices;
+	bool cache_updated = false;
+
+	LoadCache();
+
+	boost::system::error_code ec;
+	bfs::directory_iterator dir_it(BBQUE_PP_LINUX_SYS_BLOCK, ec);
+	if (ec) {
+		logger->Error("Discover: cannot access %s [%s]",
+			BBQUE_PP_LINUX_SYS_BLOCK, ec.message().c_str());
+		return devices;
+	}
+
+	for (; dir_it != bfs::directory_iterator(); ++dir_it) {
+		DeviceInfo_t info;
+		info.name = dir_it->path().filename().string();
+		if (!ReadDeviceAttributes(info.name, info))
+			continue;
+
+		// Calibration results still valid?
+		auto cache_it = cache.find(info.name);
+		if ((cache_it != cache.end())
+				&& (cache_it->second.dev == info.dev)
+				&& (cache_it->second.size == info.size)) {
+			info.bandwidth = cache_it->second.bandwidth;
+			info.iops = cache_it->second.iops;
+			logger->Debug("Discover: [%s] calibration cached", info.name.c_str());
+		}
+		else if (Calibrate(info)) {
+			cache_updated = true;
+		}
+		else {
+			logger->Warn("Discover: [%s] calibration failed: skipping",
+				info.name.c_str());
+			continue;
+		}
+
+		logger->Info("Discover: [%s] dev=%s %s size=%lu MB read=%lu MB/s %lu IOPS",
+			info.name.c_str(), info.dev.c_str(),
+			info.rotational ? "HDD" : "SSD",
+			info.size >> 20, info.bandwidth >> 20, info.iops);
+		devices.push_back(info);
+	}
+
+	if (cache_updated)
+		SaveCache(devices);
+
+	return devices;
+}
+
+bool LinuxIODiscovery::ReadDeviceAttributes(
+		std::string const & name,
+		DeviceInfo_t & info) const
+{
+	std::string sys_path(BBQUE_PP_LINUX_SYS_BLOCK "/" + name);
+
+	// Virtual devices (loop, ram, zram, device-mapper...) have not a
+	// backing "device"
+	if (!bfs::exists(sys_path + "/device")) {
+		logger->Debug("ReadDeviceAttributes: [%s] virtual device: skipping",
+			name.c_str());
+		return false;
+	}
+
+	std::ifstream dev_ifs(sys_path + "/dev");
+	if (!(dev_ifs >> info.dev))
+		return false;
+
+	// Size is always expressed in 512 bytes sectors
+	uint64_t sectors = 0;
+	std::ifstream size_ifs(sys_path + "/size");
+	if (!(size_ifs >> sectors) || (sectors == 0)) {
+		logger->Debug("ReadDeviceAttributes: [%s] empty device: skipping",
+			name.c_str());
+		return false;
+	}
+	info.size = sectors << 9;
+
+	int rotational = 0;
+	std::ifstream rot_ifs(sys_path + "/queue/rotational");
+	rot_ifs >> rotational;
+	info.rotational = (rotational != 0);
+
+	return true;
+}
+
+bool LinuxIODiscovery::Calibrate(DeviceInfo_t & info) const
+{
+	std::string dev_path(BBQUE_PP_LINUX_DEV "/" + info.name);
+	logger->Info("Calibrate: [%s] measuring read performance (%d ms)...",
+		info.name.c_str(), calibration_ms);
+
+	if (info.size < BBQUE_PP_LINUX_IO_SEQ_SIZE)
+		return false;
+
+	int fd = ::open(dev_path.c_str(), O_RDONLY | O_DIRECT);
+	if (fd < 0) {
+		logger->Error("Calibrate: [%s] open failed [%d: %s]",
+			dev_path.c_str(), errno, strerror(errno));
+		return false;
+	}
+
+	void * buffer = nullptr;
+	if (posix_memalign(&buffer, BBQUE_PP_LINUX_IO_ALIGN, BBQUE_PP_LINUX_IO_SEQ_SIZE) != 0) {
+		logger->Error("Calibrate: [%s] buffer allocation failed",
+			info.name.c_str());
+		::close(fd);
+		return false;
+	}
+
+	using clock = std::chrono::steady_clock;
+	auto budget = std::chrono::milliseconds(calibration_ms / 2);
+	bool result = true;
+
+	// Sequential read bandwidth
+	uint64_t bytes = 0;
+	auto start = clock::now();
+	while ((clock::now() - start < budget)
+			&& (bytes + BBQUE_PP_LINUX_IO_SEQ_SIZE <= info.size)) {
+		ssize_t nr = ::pread(fd, buffer, BBQUE_PP_LINUX_IO_SEQ_SIZE, bytes);
+		if (nr <= 0) {
+			result = (bytes > 0);
+			break;
+		}
+		bytes += nr;
+	}
+	double elapsed_s = std::chrono::duration<double>(clock::now() - start).count();
+	if (result && (elapsed_s > 0))
+		info.bandwidth = bytes / elapsed_s;
+
+	// Random read IOPS, on aligned offsets spread over the whole device
+	std::mt19937_64 rand_gen(info.size);
+	std::uniform_int_distribution<uint64_t> rand_block(
+		0, info.size / BBQUE_PP_LINUX_IO_RAND_SIZE - 1);
+	uint64_t ops = 0;
+	start = clock::now();
+	while (result && (clock::now() - start < budget)) {
+		off_t offset = rand_block(rand_gen) * BBQUE_PP_LINUX_IO_RAND_SIZE;
+		if (::pread(fd, buffer, BBQUE_PP_LINUX_IO_RAND_SIZE, offset) <= 0) {
+			result = (ops > 0);
+			break;
+		}
+		++ops;
+	}
+	elapsed_s = std::chrono::duration<double>(clock::now() - start).count();
+	if (result && (elapsed_s > 0))
+		info.iops = ops / elapsed_s;
+
+	free(buffer);
+	::close(fd);
+
+	return result && (info.bandwidth > 0) && (info.iops > 0);
+}
+
+void LinuxIODiscovery::LoadCache()
+{
+	std::ifstream ifs(cache_file);
+	if (!ifs.is_open()) {
+		logger->Debug("LoadCache: no calibration cache [%s]",
+			cache_file.c_str());
+		return;
+	}
+
+	std::string line;
+	if (!std::getline(ifs, line) || (line != BBQUE_PP_LINUX_IO_CACHE_HEADER)) {
+		logger->Warn("LoadCache: unknown calibration cache format [%s]",
+			cache_file.c_str());
+		return;
+	}
+
+	while (std::getline(ifs, line)) {
+		if (line.empty() || (line[0] == '#'))
+			continue;
+		DeviceInfo_t info;
+		std::istringstream iss(line);
+		if (!(iss >> info.name >> info.dev >> info.rotational >> info.size
+				>> info.bandwidth >> info.iops))
+			continue;
+		cache[info.name] = info;
+	}
+	logger->Info("LoadCache: %d device(s) in the calibration cache",
+		cache.size());
+}
+
+void LinuxIODiscovery::SaveCache(std::vector<DeviceInfo_t> const & devices) const
+{
+	std::ofstream ofs(cache_file, std::ofstream::out | std::ofstream::trunc);
+	if (!ofs.is_open()) {
+		logger->Warn("SaveCache: cannot write the calibration cache [%s]",
+			cache_file.c_str());
+		return;
+	}
+
+	ofs << BBQUE_PP_LINUX_IO_CACHE_HEADER << std::endl;
+	for (auto const & info : devices) {
+		ofs << info.name << " " << info.dev << " " << info.rotational << " "
+			<< info.size << " " << info.bandwidth << " " << info.iops
+			<< std::endl;
+	}
+	logger->Info("SaveCache: calibration cache [%s] updated", cache_file.c_str());
+}
+
+} // namespace pp
+
+} // namespace bbque
@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2017  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bbque/pp/linux_io_monitor.h"
+
+#include "bbque/configuration_manager.h"
+#include "bbque/utils/utility.h"
+
+#include <boost/program_options.hpp>
+
+#include <fstream>
+#include <sstream>
+
+#define MODULE_NAMESPACE "bq.pp.linux_io"
+#define MODULE_CONFIG    "LinuxPlatformProxy.io_monitor"
+
+#ifdef CONFIG_BBQUE_LINUX_CG_V2
+#define BBQUE_PP_LINUX_IOSTAT_PARAM   "io.stat"
+#else
+#define BBQUE_PP_LINUX_IOBYTES_PARAM  "blkio.throttle.io_service_bytes"
+#define BBQUE_PP_LINUX_IOSERV_PARAM   "blkio.throttle.io_serviced"
+#endif
+
+#define BBQUE_PP_LINUX_IO_PERIOD_MS_DEFAULT   1000
+#define BBQUE_PP_LINUX_IO_EMA_WEIGHT_DEFAULT  0.3
+
+namespace po = boost::program_options;
+
+namespace bbque {
+namespace pp {
+
+LinuxIOMonitor & LinuxIOMonitor::GetInstance()
+{
+	static LinuxIOMonitor instance;
+	return instance;
+}
+
+LinuxIOMonitor::LinuxIOMonitor() :
+    period_ms(BBQUE_PP_LINUX_IO_PERIOD_MS_DEFAULT),
+    ema_weight(BBQUE_PP_LINUX_IO_EMA_WEIGHT_DEFAULT)
+{
+	Worker::Setup(BBQUE_MODULE_NAME("pp.linux_io"), MODULE_NAMESPACE);
+
+	po::options_description opts_desc("Linux block I/O monitor options");
+	opts_desc.add_options()
+		(MODULE_CONFIG ".period_ms",
+		po::value<uint32_t> (&period_ms)->default_value(
+			BBQUE_PP_LINUX_IO_PERIOD_MS_DEFAULT),
+		"The block I/O sampling period [ms] (0 to disable)");
+	opts_desc.add_options()
+		(MODULE_CONFIG ".ema_weight",
+		po::value<float> (&ema_weight)->default_value(
+			BBQUE_PP_LINUX_IO_EMA_WEIGHT_DEFAULT),
+		"The weight of the newest sample in the moving average (0..1]");
+	po::variables_map opts_vm;
+	ConfigurationManager::GetInstance().
+		ParseConfigurationFile(opts_desc, opts_vm);
+
+	if ((ema_weight <= 0) || (ema_weight > 1)) {
+		logger->Warn("LinuxIOMonitor: invalid moving average weight %.2f, "
+			"using %.2f", ema_weight, BBQUE_PP_LINUX_IO_EMA_WEIGHT_DEFAULT);
+		ema_weight = BBQUE_PP_LINUX_IO_EMA_WEIGHT_DEFAULT;
+	}
+
+	if (period_ms == 0) {
+		logger->Info("LinuxIOMonitor: block I/O monitoring disabled");
+		return;
+	}
+
+	logger->Info("LinuxIOMonitor: sampling period %d ms, weight %.2f",
+		period_ms, ema_weight);
+	Worker::Start();
+}
+
+LinuxIOMonitor::~LinuxIOMonitor()
+{
+	std::unique_lock<std::mutex> apps_ul(apps_mtx);
+	apps.clear();
+}
+
+void LinuxIOMonitor::Register(app::SchedPtr_t papp, std::string const & cg_path)
+{
+	if (period_ms == 0)
+		return;
+
+	std::unique_lock<std::mutex> apps_ul(apps_mtx);
+	AppIOInfo_t & app_info(apps[papp->Uid()]);
+	app_info.papp = papp;
+	app_info.cg_path = cg_path;
+	app_info.last_counters.clear();
+	app_info.last_time = std::chrono::steady_clock::now();
+	papp->ClearIOUsage();
+
+	// Initial values of the cumulative counters
+	ReadCounters(cg_path, app_info.last_counters);
+	logger->Debug("Register: [%s] sampling [%s]", papp->StrId(), cg_path.c_str());
+}
+
+void LinuxIOMonitor::Unregister(app::SchedPtr_t papp)
+{
+	std::unique_lock<std::mutex> apps_ul(apps_mtx);
+	if (apps.erase(papp->Uid()) > 0)
+		logger->Debug("Unregister: [%s] sampling stopped", papp->StrId());
+}
+
+void LinuxIOMonitor::Task()
+{
+	logger->Info("Task: block I/O monitoring started");
+
+	std::unique_lock<std::mutex> worker_status_ul(worker_status_mtx);
+	while (!done) {
+		worker_status_cv.wait_for(worker_status_ul,
+			std::chrono::milliseconds(period_ms));
+		if (done)
+			break;
+		worker_status_ul.unlock();
+
+		std::unique_lock<std::mutex> apps_ul(apps_mtx);
+		for (auto it = apps.begin(); it != apps.end(); ) {
+			if (!SampleApplication(it->second))
+				it = apps.erase(it);
+			else
+				++it;
+		}
+		apps_ul.unlock();
+
+		worker_status_ul.lock();
+	}
+
+	logger->Info("Task: block I/O monitoring terminated");
+}
+
+bool LinuxIOMonitor::SampleApplication(AppIOInfo_t & app_info)
+{
+	auto papp = app_info.papp.lock();
+	if (!papp)
+		return false;
+
+	std::map<std::string, IOCounters_t> counters;
+	if (!ReadCounters(app_info.cg_path, counters)) {
+		logger->Debug("SampleApplication: [%s] statistics not available",
+			papp->StrId());
+		return true;
+	}
+
+	auto now = std::chrono::steady_clock::now();
+	double period_s = std::chrono::duration<double>(
+		now - app_info.last_time).count();
+	if (period_s <= 0)
+		return true;
+
+	for (auto const & dev_entry : counters) {
+		IOCounters_t const & curr(dev_entry.second);
+		IOCounters_t prev;
+		auto prev_it = app_info.last_counters.find(dev_entry.first);
+		if (prev_it != app_info.last_counters.end())
+			prev = prev_it->second;
+
+		// Counters are reset if the cgroup has been re-created
+		if ((curr.rbytes < prev.rbytes) || (curr.wbytes < prev.wbytes) ||
+			(curr.rios < prev.rios) || (curr.wios < prev.wios))
+			prev = IOCounters_t();
+
+		app::Schedulable::IOUsage_t sample;
+		sample.read_bps   = (curr.rbytes - prev.rbytes) / period_s;
+		sample.write_bps  = (curr.wbytes - prev.wbytes) / period_s;
+		sample.read_iops  = (curr.rios - prev.rios) / period_s;
+		sample.write_iops = (curr.wios - prev.wios) / period_s;
+		papp->UpdateIOUsage(dev_entry.first, sample, ema_weight);
+
+		logger->Debug("SampleApplication: [%s] dev=%s "
+			"r=%.0f B/s w=%.0f B/s r=%.0f IOPS w=%.0f IOPS",
+			papp->StrId(), dev_entry.first.c_str(),
+			sample.read_bps, sample.write_bps,
+			sample.read_iops, sample.write_iops);
+	}
+
+	app_info.last_counters = std::move(counters);
+	app_info.last_time = now;
+	return true;
+}
+
+#ifdef CONFIG_BBQUE_LINUX_CG_V2
+
+bool LinuxIOMonitor::ReadCounters(
+		std::string const & cg_path,
+		std::map<std::string, IOCounters_t> & counters) const
+{
+	// Format: "<major>:<minor> rbytes=N wbytes=N rios=N wios=N ..."
+	std::ifstream ifs(cg_path + "/" BBQUE_PP_LINUX_IOSTAT_PARAM);
+	if (!ifs.is_open())
+		return false;
+
+	std::string line;
+	while (std::getline(ifs, line)) {
+		std::istringstream iss(line);
+		std::string dev, field;
+		if (!(iss >> dev))
+			continue;
+		IOCounters_t & dev_counters(counters[dev]);
+		while (iss >> field) {
+			size_t eq_pos = field.find('=');
+			if (eq_pos == std::string::npos)
+				continue;
+			std::string key(field.substr(0, eq_pos));
+			uint64_t value = std::strtoull(
+				field.c_str() + eq_pos + 1, nullptr, 10);
+			if (key == "rbytes")
+				dev_counters.rbytes = value;
+			else if (key == "wbytes")
+				dev_counters.wbytes = value;
+			else if (key == "rios")
+				dev_counters.rios = value;
+			else if (key == "wios")
+				dev_counters.wios = value;
+		}
+	}
+	return true;
+}
+
+#else // CONFIG_BBQUE_LINUX_CG_V2
+
+/**
+ * @brief Parse a blkio throttling statistics file
+ *
+ * Format: "<major>:<minor> <Read|Write|Sync|Async|Discard|Total> N", with
+ * a final "Total N" summary line, which is skipped.
+ */
+static bool ParseBlkIOStat(
+		std::string const & stat_path,
+		std::map<std::string, std::pair<uint64_t, uint64_t>> & values)
+{
+	std::ifstream ifs(stat_path);
+	if (!ifs.is_open())
+		return false;
+
+	std::string dev, op;
+	uint64_t value;
+	while (ifs >> dev) {
+		if (dev == "Total") {
+			ifs >> value;
+			continue;
+		}
+		if (!(ifs >> op >> value))
+			break;
+		if (op == "Read")
+			values[dev].first = value;
+		else if (op == "Write")
+			values[dev].second = value;
+	}
+	return true;
+}
+
+bool LinuxIOMonitor::ReadCounters(
+		std::string const & cg_path,
+		std::map<std::string, IOCounters_t> & counters) const
+{
+	std::map<std::string, std::pair<uint64_t, uint64_t>> bytes, ios;
+	if (!ParseBlkIOStat(cg_path + "/" BBQUE_PP_LINUX_IOBYTES_PARAM, bytes))
+		return false;
+	if (!ParseBlkIOStat(cg_path + "/" BBQUE_PP_LINUX_IOSERV_PARAM, ios))
+		return false;
+
+	for (auto const & entry : bytes) {
+		counters[entry.first].rbytes = entry.second.first;
+		counters[entry.first].wbytes = entry.second.second;
+	}
+	for (auto const & entry : ios) {
+		counters[entry.first].rios = entry.second.first;
+		counters[entry.first].wios = entry.second.second;
+	}
+	return true;
+}
+
+#endif // CONFIG_BBQUE_LINUX_CG_V2
+
+} // namespace pp
+
+} // namespace bbque
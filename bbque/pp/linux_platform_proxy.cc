@@ -22,6 +22,7 @@
 #include "bbque/res/resource_path.h"
 #include "bbque/utils/assert.h"
 #include "bbque/utils/iofs.h"
+#include "bbque/utils/tracer.h"
 #include "bbque/utils/utility.h"
 
 #include <boost/program_options.hpp>
@@ -30,9 +31,14 @@
 #include <criu/criu.h>
 #endif
 
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
 #include <fstream>
+#include <mutex>
+#ifndef CONFIG_BBQUE_LINUX_CG_V2
 #include <libcgroup.h>
+#endif
 #include <linux/ethtool.h>
 #include <linux/sockios.h>
 #include <linux/version.h>
@@ -45,7 +51,9 @@
 #include <sys/wait.h>
 #include <string.h>
 #include <stdio.h>
+#include <set>
 #include <sstream>
+#include <thread>
 #include <unistd.h>
 
 #ifdef CONFIG_BBQUE_WM
@@ -56,6 +64,14 @@
 #include "bbque/energy_monitor.h"
 #endif
 
+#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+#include "bbque/pp/linux_io_monitor.h"
+#endif
+
+#ifdef CONFIG_BBQUE_LINUX_IO_DISCOVERY
+#include "bbque/pp/linux_io_discovery.h"
+#endif
+
 #ifdef CONFIG_BBQUE_LINUX_CG_NET_BANDWIDTH
 #include <asm/types.h>
 #include <linux/if_ether.h>
@@ -71,7 +87,6 @@
 
 #endif
 
-#define BBQUE_PP_LINUX_SILOS BBQUE_PP_LINUX_CGROUP"/silos"
 
 #define BBQUE_PP_LINUX_CPUS_PARAM           "cpuset.cpus"
 #define BBQUE_PP_LINUX_CPUP_PARAM           "cpu.cfs_period_us"
@@ -84,6 +99,8 @@
 #define BBQUE_PP_LINUX_NETCLS_PARAM         "net_cls.classid"
 #define BBQUE_PP_LINUX_R_IO_PARAM			"blkio.throttle.read_bps_device"
 #define BBQUE_PP_LINUX_W_IO_PARAM			"blkio.throttle.write_bps_device"
+#define BBQUE_PP_LINUX_R_IOPS_PARAM			"blkio.throttle.read_iops_device"
+#define BBQUE_PP_LINUX_W_IOPS_PARAM			"blkio.throttle.write_iops_device"
 
 #define BBQUE_PP_LINUX_SYS_MEMINFO "/proc/meminfo"
 
@@ -110,6 +127,25 @@ namespace po = boost::program_options;
 namespace bbque {
 namespace pp {
 
+#if defined(CONFIG_BBQUE_LINUX_CG_BLKIO) && !defined(CONFIG_BBQUE_LINUX_CG_V2)
+
+/**
+ * @brief Write a single "major:minor value" entry into a blkio attribute
+ *
+ * The kernel parses one device rule per write() call, thus each entry
+ * must be flushed on its own.
+ */
+static bool WriteBlkIOEntry(std::string const & attr_path, const char * entry)
+{
+	std::ofstream ofs(attr_path, std::ofstream::out);
+	if (!ofs.is_open())
+		return false;
+	ofs << entry << std::flush;
+	return ofs.good();
+}
+
+#endif
+
 LinuxPlatformProxy * LinuxPlatformProxy::GetInstance()
 {
 	static LinuxPlatformProxy * instance;
@@ -153,7 +189,11 @@ LinuxPlatformProxy::LinuxPlatformProxy() :
 #endif
 
 #ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+#ifdef CONFIG_BBQUE_LINUX_IO_DISCOVERY
+	DiscoverIODevices();
+#endif
 	InitIODevInfo();
+	LinuxIOMonitor::GetInstance();
 #endif
 
 }
@@ -434,7 +474,8 @@ void LinuxPlatformProxy::InitIODevInfo()
 		auto sys = sys_entry.second;
 
 		for(const auto storage : sys.GetStoragesAll()) {
-			if(storage -> GetId() == 0) MakeNewIODev(storage->GetDev());
+			if(storage->GetIOKind() == PlatformDescription::IO_READ_BANDWIDTH)
+				MakeNewIODev(storage->GetDev());
 		}
 	}
 
@@ -445,6 +486,84 @@ void LinuxPlatformProxy::InitIODevInfo()
 	}
 }
 
+#ifdef CONFIG_BBQUE_LINUX_IO_DISCOVERY
+
+void LinuxPlatformProxy::DiscoverIODevices()
+{
+	try {
+		this->GetPlatformDescription();
+	}
+	catch (const std::runtime_error& e) {
+		UNUSED(e);
+		logger->Fatal("DiscoverIODevices: PlatformDescription object missing");
+		return;
+	}
+
+	// Systems are iterated by copy elsewhere: update the entry in place
+	PlatformDescription::System * local_sys = nullptr;
+	for (auto & sys_entry : pli->getPlatformInfo().GetSystemsAll()) {
+		if (sys_entry.second.IsLocal()) {
+			local_sys = &sys_entry.second;
+			break;
+		}
+	}
+	if (local_sys == nullptr) {
+		logger->Warn("DiscoverIODevices: no local system description");
+		return;
+	}
+
+	// Devices already described and first free block identifier
+	std::set<std::string> known_devs;
+	uint16_t next_id = 0;
+	for (auto const & storage : local_sys->GetStoragesAll()) {
+		known_devs.insert(storage->GetDev());
+		br::ResourcePath storage_path(storage->GetPath());
+		int block_id = storage_path.GetID(br::ResourceType::BLOCK);
+		if (block_id >= next_id)
+			next_id = block_id + 1;
+	}
+
+	LinuxIODiscovery io_discovery(io_discovery_cache, io_calibration_ms);
+	for (auto const & dev_info : io_discovery.Discover()) {
+		if (known_devs.find(dev_info.dev) != known_devs.end()) {
+			logger->Debug("DiscoverIODevices: [%s] dev=%s already described",
+				dev_info.name.c_str(), dev_info.dev.c_str());
+			continue;
+		}
+
+		PlatformDescription::Block block_dev(next_id++);
+		block_dev.SetPrefix(local_sys->GetPath());
+
+		// The calibration is read-only: the write capacity is assumed to be
+		// the same of the read one
+		for (auto kind : { PlatformDescription::IO_READ_BANDWIDTH,
+				PlatformDescription::IO_WRITE_BANDWIDTH,
+				PlatformDescription::IO_READ_IOPS,
+				PlatformDescription::IO_WRITE_IOPS }) {
+			auto storage = std::make_shared<PlatformDescription::Storage>();
+			storage->SetPrefix(block_dev.GetPath());
+			storage->SetIOKind(kind);
+			storage->SetQuantity(dev_info.size);
+			storage->SetDev(dev_info.dev);
+			storage->SetStorageType(dev_info.rotational ?
+				PlatformDescription::HDD : PlatformDescription::SSD);
+			if (storage->IsIOPS())
+				storage->SetIOPS(dev_info.iops);
+			else
+				storage->SetBandwidth(dev_info.bandwidth);
+			local_sys->AddStorage(storage);
+		}
+
+		known_devs.insert(dev_info.dev);
+		logger->Info("DiscoverIODevices: <%s> [%s] added: %lu MB/s, %lu IOPS "
+			"(write capacity assumed equal to read)",
+			block_dev.GetPath().c_str(), dev_info.name.c_str(),
+			dev_info.bandwidth >> 20, dev_info.iops);
+	}
+}
+
+#endif // CONFIG_BBQUE_LINUX_IO_DISCOVERY
+
 LinuxPlatformProxy::ExitCode_t LinuxPlatformProxy::MakeNewIODev(std::string const & dev)
 {
 	// Creates a new element and adds it to the vector this -> dev_info.
@@ -454,37 +573,182 @@ LinuxPlatformProxy::ExitCode_t LinuxPlatformProxy::MakeNewIODev(std::string cons
 	return PLATFORM_OK;
 }
 
-LinuxPlatformProxy::ExitCode_t LinuxPlatformProxy::AddDevicePath(br::ResourcePathPtr_t resource_path)
+LinuxPlatformProxy::ExitCode_t LinuxPlatformProxy::AddDevicePath(
+		br::ResourcePathPtr_t resource_path,
+		std::string const & dev,
+		PlatformDescription::IOKind_t kind)
 {
-	// Search the first available bandwidth path and set it to resource_path.
-	for(auto & dev: this->dev_info) {
-		if(dev->r_bw_path == NULL){
-			dev->r_bw_path = resource_path;
-			logger->Debug("AddDevicePath: set %s as read bw path of %s", resource_path->ToString().c_str(), dev->dev.c_str());
-			return LinuxPlatformProxy::PLATFORM_OK;
-		}
+	// Set the resource path into the slot of the given kind
+	for(auto & dev_entry: this->dev_info) {
+		if (dev_entry->dev.compare(dev))
+			continue;
 
-		if(dev->w_bw_path == NULL){
-			dev->w_bw_path = resource_path;
-			logger->Debug("AddDevicePath: set %s as write bw path of %s", resource_path->ToString().c_str(), dev->dev.c_str());
-			return LinuxPlatformProxy::PLATFORM_OK;
+		switch (kind) {
+		case PlatformDescription::IO_READ_BANDWIDTH:
+			dev_entry->r_bw_path = resource_path;
+			break;
+		case PlatformDescription::IO_WRITE_BANDWIDTH:
+			dev_entry->w_bw_path = resource_path;
+			break;
+		case PlatformDescription::IO_READ_IOPS:
+			dev_entry->r_iops_path = resource_path;
+			break;
+		case PlatformDescription::IO_WRITE_IOPS:
+			dev_entry->w_iops_path = resource_path;
+			break;
+		default:
+			return LinuxPlatformProxy::PLATFORM_GENERIC_ERROR;
 		}
+
+		// Index the device for the lookups performed at mapping time
+		this->dev_by_path[IODevKey(*resource_path)] = dev_entry;
+
+		logger->Debug("AddDevicePath: set %s as I/O path [kind=%d] of %s",
+			resource_path->ToString().c_str(), kind, dev.c_str());
+		return LinuxPlatformProxy::PLATFORM_OK;
 	}
 
 	return LinuxPlatformProxy::PLATFORM_GENERIC_ERROR;
 }
 
-std::string LinuxPlatformProxy::GetDevFromPath(br::ResourcePathPtr_t const & resource_path)
+uint64_t LinuxPlatformProxy::IODevKey(br::ResourcePath const & resource_path)
+{
+	// Identifiers are 16 bits wide. Mixed or template paths (R_ID_ANY,
+	// R_ID_NONE) produce keys never indexed.
+	uint16_t ids[3] = { 0xFFFF, 0xFFFF, 0xFFFF };
+	for (auto const & rid : resource_path.GetIdentifiers()) {
+		switch (rid->Type()) {
+		case br::ResourceType::SYSTEM:
+			ids[0] = static_cast<uint16_t>(rid->ID());
+			break;
+		case br::ResourceType::BLOCK:
+			ids[1] = static_cast<uint16_t>(rid->ID());
+			break;
+		case br::ResourceType::IO:
+			if (rid->ID() >= 0)
+				ids[2] = PlatformDescription::IO_READ_BANDWIDTH + rid->ID();
+			break;
+		case br::ResourceType::IOPS:
+			if (rid->ID() >= 0)
+				ids[2] = PlatformDescription::IO_READ_IOPS + rid->ID();
+			break;
+		default:
+			break;
+		}
+	}
+	return (static_cast<uint64_t>(ids[0]) << 32)
+		| (static_cast<uint64_t>(ids[1]) << 16) | ids[2];
+}
+
+std::string const &
+LinuxPlatformProxy::GetDevFromPath(br::ResourcePathPtr_t const & resource_path) const
+{
+	static const std::string no_dev;
+	auto dev_it = this->dev_by_path.find(IODevKey(*resource_path));
+	if (dev_it == this->dev_by_path.end())
+		return no_dev;
+	return dev_it->second->dev;
+}
+
+#ifndef CONFIG_BBQUE_LINUX_CG_V2
+
+LinuxPlatformProxy::ExitCode_t
+LinuxPlatformProxy::SetupBlkIO(CGroupDataPtr_t & pcgd,
+			       RLinuxBindingsPtr_t prlb) noexcept
+{
+	BBQUE_TRACE_SPAN_LABEL("lpp.setup_blkio", pcgd->papp->StrId());
+	ExitCode_t result;
+
+	// The bandwidth is accounted in B/s, as the blkio parameter
+	result = UpdateBlkIOLimits(pcgd, BBQUE_PP_LINUX_R_IO_PARAM,
+				prlb->read_devs, pcgd->blkio_read_bps);
+	if (BBQUE_UNLIKELY(result != PLATFORM_OK))
+		return result;
+
+	result = UpdateBlkIOLimits(pcgd, BBQUE_PP_LINUX_W_IO_PARAM,
+				prlb->write_devs, pcgd->blkio_write_bps);
+	if (BBQUE_UNLIKELY(result != PLATFORM_OK))
+		return result;
+
+	result = UpdateBlkIOLimits(pcgd, BBQUE_PP_LINUX_R_IOPS_PARAM,
+				prlb->read_iops_devs, pcgd->blkio_read_iops);
+	if (BBQUE_UNLIKELY(result != PLATFORM_OK))
+		return result;
+
+	result = UpdateBlkIOLimits(pcgd, BBQUE_PP_LINUX_W_IOPS_PARAM,
+				prlb->write_iops_devs, pcgd->blkio_write_iops);
+	if (BBQUE_UNLIKELY(result != PLATFORM_OK))
+		return result;
+
+	return PLATFORM_OK;
+}
+
+LinuxPlatformProxy::ExitCode_t
+LinuxPlatformProxy::UpdateBlkIOLimits(
+		CGroupDataPtr_t & pcgd,
+		const char * attribute,
+		std::vector<std::pair<ResourcePathPtr_t, int_fast64_t>> const & devs,
+		std::map<std::string, uint64_t> & committed) noexcept
 {
-	for(auto dev : this->dev_info) {
-		if (!dev->r_bw_path->ToString().compare(resource_path->ToString()) 
-		 || !dev->w_bw_path->ToString().compare(resource_path->ToString())) {
-			return dev->dev;
+	std::string attr_path(blkio_mount_path + "/" + pcgd->cgpath + "/" + attribute);
+	std::map<std::string, uint64_t> requested;
+	char entry[64];
+
+	// Collect the required limits, indexed by major:minor
+	for (auto & dev_entry : devs) {
+		std::string const & dev(GetDevFromPath(dev_entry.first));
+		if (dev.empty()) {
+			logger->Warn("SetupBlkIO: dev not found for %s",
+				dev_entry.first->ToString().c_str());
+			return PLATFORM_MAPPING_FAILED;
+		}
+		requested[dev] = static_cast<uint64_t>(dev_entry.second);
+	}
+
+	// Remove the limits of devices no longer assigned
+	// NOTE: writing a zero value deletes the device throttling rule
+	for (auto it = committed.begin(); it != committed.end(); ) {
+		if (requested.find(it->first) != requested.end()) {
+			++it;
+			continue;
+		}
+		snprintf(entry, sizeof(entry), "%s 0", it->first.c_str());
+		if (!WriteBlkIOEntry(attr_path, entry)) {
+			logger->Error("SetupBlkIO: [%s] writing <%s> to %s FAILED",
+				pcgd->papp->StrId(), entry, attribute);
+			return PLATFORM_MAPPING_FAILED;
+		}
+		logger->Debug("SetupBlkIO: [%s] %s: {%s} removed",
+			pcgd->papp->StrId(), attribute, it->first.c_str());
+		it = committed.erase(it);
+	}
+
+	// Write only the limits changed since the last mapping
+	for (auto & req : requested) {
+		auto it = committed.find(req.first);
+		if ((it != committed.end()) && (it->second == req.second)) {
+			logger->Debug("SetupBlkIO: [%s] %s: {%s %lu} unchanged",
+				pcgd->papp->StrId(), attribute,
+				req.first.c_str(), req.second);
+			continue;
+		}
+		snprintf(entry, sizeof(entry), "%s %lu",
+			req.first.c_str(), req.second);
+		if (!WriteBlkIOEntry(attr_path, entry)) {
+			logger->Error("SetupBlkIO: [%s] writing <%s> to %s FAILED",
+				pcgd->papp->StrId(), entry, attribute);
+			return PLATFORM_MAPPING_FAILED;
 		}
+		committed[req.first] = req.second;
+		logger->Debug("SetupBlkIO: [%s] %s: {%s}",
+			pcgd->papp->StrId(), attribute, entry);
 	}
-	return "";
+
+	return PLATFORM_OK;
 }
 
+#endif // !CONFIG_BBQUE_LINUX_CG_V2
+
 #endif
 
 bool
@@ -534,6 +798,17 @@ LinuxPlatformProxy::ExitCode_t LinuxPlatformProxy::Setup(SchedPtr_t papp) noexce
 		return result;
 	}
 
+#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+	// Sample the block I/O actually performed by the application
+#ifdef CONFIG_BBQUE_LINUX_CG_V2
+	LinuxIOMonitor::GetInstance().Register(papp, pcgd->fs_path);
+#else
+	if (!blkio_mount_path.empty())
+		LinuxIOMonitor::GetInstance().Register(
+			papp, blkio_mount_path + "/" + pcgd->cgpath);
+#endif
+#endif
+
 	return result;
 }
 
@@ -548,6 +823,28 @@ void LinuxPlatformProxy::LoadConfiguration() noexcept
 		(MODULE_CONFIG ".cfs_bandwidth.threshold_pct",
 		po::value<int> (&cfs_threshold_pct)->default_value(100),
 		"The threshold [%] under which we enable CFS bandwidth enforcement");
+	opts_desc.add_options()
+		(MODULE_CONFIG ".sync_workers",
+		po::value<uint32_t> (&sync_workers)->default_value(4),
+		"The number of threads updating the control groups at each synchronization");
+#ifdef CONFIG_BBQUE_LINUX_CG_V2
+	opts_desc.add_options()
+		(MODULE_CONFIG ".cgroup_v2.mount_path",
+		po::value<std::string> (&cgroup_v2_mount)->default_value(
+			BBQUE_PP_LINUX_CGROUP_V2_MOUNT),
+		"The mount point of the unified (v2) control groups hierarchy");
+#endif
+#ifdef CONFIG_BBQUE_LINUX_IO_DISCOVERY
+	opts_desc.add_options()
+		(MODULE_CONFIG ".io_discovery.cache_file",
+		po::value<std::string> (&io_discovery_cache)->default_value(
+			BBQUE_PATH_VAR "/io_calibration.cache"),
+		"The calibration cache file of the discovered storage devices");
+	opts_desc.add_options()
+		(MODULE_CONFIG ".io_discovery.calibration_ms",
+		po::value<uint32_t> (&io_calibration_ms)->default_value(2000),
+		"The time budget [ms] for the calibration of a storage device");
+#endif
 	po::variables_map opts_vm;
 	ConfigurationManager::GetInstance().
 		ParseConfigurationFile(opts_desc, opts_vm);
@@ -562,6 +859,10 @@ void LinuxPlatformProxy::LoadConfiguration() noexcept
 
 	logger->Info("LoadConfiguration: CFS bandwidth control, margin %d, threshold: %d",
 		cfs_margin_pct, cfs_threshold_pct);
+
+	// The thread committing the mappings is a worker too
+	if (sync_workers > 1)
+		sync_pool.reset(new bu::WorkerPool("bq.lpp.sync", sync_workers - 1));
 }
 
 LinuxPlatformProxy::ExitCode_t
@@ -570,11 +871,16 @@ LinuxPlatformProxy::Release(SchedPtr_t papp)
 	// Release CGroup plugin data
 	// ... thus releasing the corresponding control group
 	logger->Debug("Release: releasing platform-specific data [%s]", papp->StrId());
+#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+	LinuxIOMonitor::GetInstance().Unregister(papp);
+#endif
 	papp->ClearPluginData(LINUX_PP_NAMESPACE);
 
 	return PLATFORM_OK;
 }
 
+#ifndef CONFIG_BBQUE_LINUX_CG_V2
+
 LinuxPlatformProxy::ExitCode_t
 LinuxPlatformProxy::ReclaimResources(SchedPtr_t papp) noexcept
 {
@@ -607,6 +913,8 @@ LinuxPlatformProxy::ReclaimResources(SchedPtr_t papp) noexcept
 	return PLATFORM_OK;
 }
 
+#endif // !CONFIG_BBQUE_LINUX_CG_V2
+
 void LinuxPlatformProxy::Exit()
 {
 
@@ -683,8 +991,16 @@ LinuxPlatformProxy::MapResources(SchedPtr_t papp,
 			logger->Error("MapResources: binding parsing FAILED");
 			return PLATFORM_MAPPING_FAILED;
 		}
+	}
 
-		// Configure the CGroup based on resource bindings
+	// Configure the CGroup based on resource bindings, or defer it to the
+	// commit of the current batch
+	if (batch_mappings) {
+		logger->Debug("MapResources: [%s] CGroup update deferred",
+			papp->StrId());
+		pending_mappings[papp.get()] = { pcgd, prlb, excl };
+	}
+	else {
 		result = SetupCGroup(pcgd, prlb, excl, true);
 		if (BBQUE_UNLIKELY(result != PLATFORM_OK)) {
 			logger->Error("MapResources: Set CGroups FAILED");
@@ -748,6 +1064,11 @@ LinuxPlatformProxy::MapResources(SchedPtr_t papp,
 		proc_elements.ToString().c_str(),
 		proc_elements_exclusive.ToString().c_str(),
 		mem_nodes.ToString().c_str());
+	if (!proc_elements.FitsULong() || !mem_nodes.FitsULong()) {
+		logger->Warn("MapResources: [%d] IDs beyond %d not included in the "
+			"distributed actuation masks", papp->Pid(),
+			static_cast<int>(8 * sizeof(unsigned long)) - 1);
+	}
 	papp->SetCGroupSetupData(
 				proc_elements.ToULong(),
 				mem_nodes.ToULong(),
@@ -758,6 +1079,74 @@ LinuxPlatformProxy::MapResources(SchedPtr_t papp,
 }
 
 
+LinuxPlatformProxy::ExitCode_t LinuxPlatformProxy::BeginMappings()
+{
+	logger->Debug("BeginMappings: collecting CGroup updates...");
+	pending_mappings.clear();
+	batch_mappings = true;
+	return PLATFORM_OK;
+}
+
+LinuxPlatformProxy::ExitCode_t
+LinuxPlatformProxy::CommitMappings(std::vector<SchedPtr_t> & failed)
+{
+	batch_mappings = false;
+	if (pending_mappings.empty())
+		return PLATFORM_OK;
+
+	std::vector<PendingMapping_t *> jobs;
+	jobs.reserve(pending_mappings.size());
+	for (auto & pending : pending_mappings)
+		jobs.push_back(&pending.second);
+
+	// Each worker picks the next CGroup to update, until none is left.
+	// CGroups are disjoint, thus the updates are independent.
+	std::vector<ExitCode_t> results(jobs.size(), PLATFORM_OK);
+	std::atomic<size_t> next_job(0);
+	auto update_cgroups = [&]() {
+		for (size_t i = next_job++; i < jobs.size(); i = next_job++) {
+			results[i] = SetupCGroup(
+				jobs[i]->pcgd, jobs[i]->prlb, jobs[i]->excl, true);
+		}
+	};
+
+	// The calling thread is a worker too
+	size_t nr_jobs = 0;
+	if (sync_pool)
+		nr_jobs = std::min<size_t>(sync_pool->Size(), jobs.size() - 1);
+	std::mutex jobs_mtx;
+	std::condition_variable jobs_cv;
+	size_t jobs_left = nr_jobs;
+	for (size_t i = 0; i < nr_jobs; ++i) {
+		sync_pool->Submit(i, [&]() {
+			update_cgroups();
+			std::unique_lock<std::mutex> jobs_ul(jobs_mtx);
+			if (--jobs_left == 0)
+				jobs_cv.notify_one();
+		});
+	}
+	update_cgroups();
+	std::unique_lock<std::mutex> jobs_ul(jobs_mtx);
+	jobs_cv.wait(jobs_ul, [&]() { return jobs_left == 0; });
+	jobs_ul.unlock();
+
+	ExitCode_t result = PLATFORM_OK;
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		if (results[i] == PLATFORM_OK)
+			continue;
+		logger->Error("CommitMappings: [%s] Set CGroups FAILED",
+			jobs[i]->pcgd->papp->StrId());
+		failed.push_back(jobs[i]->pcgd->papp);
+		result = PLATFORM_MAPPING_FAILED;
+	}
+
+	logger->Debug("CommitMappings: %d CGroup(s) updated by %d worker(s)",
+		jobs.size(), nr_jobs + 1);
+	pending_mappings.clear();
+
+	return result;
+}
+
 #ifdef CONFIG_BBQUE_LINUX_CG_NET_BANDWIDTH
 
 LinuxPlatformProxy::ExitCode_t
@@ -869,9 +1258,13 @@ LinuxPlatformProxy::GetResourceMapping(SchedPtr_t papp,
 							br::ResourceType::CPU,
 							node_id,
 							papp, rvt));
-	if (strlen(prlb->cpus) > 0)
+	size_t cpus_used = strlen(prlb->cpus);
+	if ((cpus_used > 0) && (cpus_used + 1 < prlb->cpus_len)) {
 		strcat(prlb->cpus, ",");
-	strncat(prlb->cpus, +core_ids.ToStringCG().c_str(), 3 * MaxCpusCount);
+		++cpus_used;
+	}
+	strncat(prlb->cpus, core_ids.ToStringCG().c_str(),
+		prlb->cpus_len - cpus_used - 1);
 	logger->Debug("GetResourceMapping: cpu[%d] cores: { %s }",
 		node_id, prlb->cpus);
 
@@ -886,7 +1279,7 @@ LinuxPlatformProxy::GetResourceMapping(SchedPtr_t papp,
 	if (mem_ids.Count() == 0)
 		strncpy(prlb->mems, memory_ids_all.c_str(), memory_ids_all.length());
 	else
-		strncpy(prlb->mems, mem_ids.ToStringCG().c_str(), 3 * MaxMemsCount);
+		strncpy(prlb->mems, mem_ids.ToStringCG().c_str(), prlb->mems_len - 1);
 	logger->Debug("GetResourceMapping: cpu[%d] mems : { %s }",
 		node_id, prlb->mems);
 
@@ -935,27 +1328,32 @@ LinuxPlatformProxy::GetResourceMapping(SchedPtr_t papp,
 		node_id, prlb->amount_net_bw);
 
 #ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+	// Block I/O assignments are not node-specific: refill them at each
+	// call to avoid duplicated entries
+	prlb->read_devs.clear();
+	prlb->write_devs.clear();
+	prlb->read_iops_devs.clear();
+	prlb->write_iops_devs.clear();
 	for (auto dev : dev_info) {
-		uint64_t r_bw = ra.GetAssignedAmount(
-						assign_map,
-						papp, rvt,
-						dev->r_bw_path);
-
-		uint64_t w_bw =  ra.GetAssignedAmount(
-						assign_map,
-						papp, rvt,
-						dev->w_bw_path);
-
-		if(r_bw > 0) {
-			prlb -> read_devs.push_back(std::make_pair(dev->r_bw_path, r_bw));
-			logger->Debug("GetResourceMapping: cpu[%d] read bandwidth for %s: { %lld }",
-				node_id, dev->r_bw_path->ToString().c_str(), r_bw);
-		}
-
-		if(w_bw > 0) {
-			prlb -> write_devs.push_back(std::make_pair(dev->w_bw_path, w_bw));
-			logger->Debug("GetResourceMapping: cpu[%d] write bandwidth for %s: { %lld }",
-				node_id, dev->w_bw_path->ToString().c_str(), w_bw);
+		std::pair<br::ResourcePathPtr_t, decltype(prlb->read_devs) *> dev_paths[] = {
+			{ dev->r_bw_path,   &prlb->read_devs },
+			{ dev->w_bw_path,   &prlb->write_devs },
+			{ dev->r_iops_path, &prlb->read_iops_devs },
+			{ dev->w_iops_path, &prlb->write_iops_devs }
+		};
+
+		for (auto & dev_path : dev_paths) {
+			if (!dev_path.first)
+				continue;
+			uint64_t amount = ra.GetAssignedAmount(
+							assign_map,
+							papp, rvt,
+							dev_path.first);
+			if (amount == 0)
+				continue;
+			dev_path.second->push_back(std::make_pair(dev_path.first, amount));
+			logger->Debug("GetResourceMapping: cpu[%d] I/O amount for %s: { %lld }",
+				node_id, dev_path.first->ToString().c_str(), amount);
 		}
 	}
 #endif
@@ -1206,26 +1604,32 @@ uint64_t LinuxPlatformProxy::GetNetIFBandwidth(const std::string &ifname) const
 }
 
 LinuxPlatformProxy::ExitCode_t
-LinuxPlatformProxy::RegisterIODev(const PlatformDescription::IO &io_dev,
+LinuxPlatformProxy::RegisterIODev(const PlatformDescription::Storage &io_dev,
 				  bool is_local) noexcept
 {
 
 	ResourceAccounter & ra(ResourceAccounter::GetInstance());
 	UNUSED(is_local);
 
+	// The I/O capacity is either a bandwidth or an IOPS amount
 	std::string resource_path = io_dev.GetPath();
-	const auto bps = io_dev.GetBandwidth();
-	logger->Debug("RegisterIODev: Registration of <%s>: %lu Kb",
-		resource_path.c_str(), bps);
+	const auto amount = io_dev.IsIOPS() ?
+		io_dev.GetIOPS() : io_dev.GetBandwidth();
+	logger->Debug("RegisterIODev: Registration of <%s>: %lu %s",
+		resource_path.c_str(), amount, io_dev.IsIOPS() ? "IO/s" : "B/s");
 
 	if (refreshMode) {
-		ra.UpdateResource(resource_path, "", bps);
+		ra.UpdateResource(resource_path, "", amount);
 	}
 	else {
 		// May save the returned resource path pointers to use them in MapResources
-		bbque::res::ResourcePtr_t res_ptr = ra.RegisterResource(resource_path, "", bps);
+		bbque::res::ResourcePtr_t res_ptr = ra.RegisterResource(resource_path, "", amount);
 #ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
-		AddDevicePath(res_ptr->Path());
+		if (AddDevicePath(res_ptr->Path(), io_dev.GetDev(), io_dev.GetIOKind())
+				!= PLATFORM_OK) {
+			logger->Warn("RegisterIODev: <%s> device %s not found",
+				resource_path.c_str(), io_dev.GetDev().c_str());
+		}
 #endif
 	}
 	logger->Debug("RegisterIODev: Registration of <%s> successfully performed",
@@ -1284,6 +1688,8 @@ void LinuxPlatformProxy::RegisterForEnergyMonitoring(std::string const & resourc
  * cgroup manipulation
  ******************************************************************************/
 
+#ifndef CONFIG_BBQUE_LINUX_CG_V2
+
 LinuxPlatformProxy::ExitCode_t LinuxPlatformProxy::InitCGroups() noexcept
 {
 	ExitCode_t pp_result;
@@ -1307,6 +1713,21 @@ LinuxPlatformProxy::ExitCode_t LinuxPlatformProxy::InitCGroups() noexcept
 	logger->Info("InitCGroups: controller [%s] mounted at [%s]",
 		controller, mount_path);
 
+#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+	char *blkio_mount = NULL;
+	cg_result = cgroup_get_subsys_mount_point("blkio", &blkio_mount);
+	if (BBQUE_UNLIKELY(cg_result)) {
+		logger->Error("InitCGroups: [blkio] mountpoint lookup FAILED! "
+			"(Error: %d - %s)", cg_result, cgroup_strerror(cg_result));
+		free(mount_path);
+		return PLATFORM_GENERIC_ERROR;
+	}
+	blkio_mount_path = blkio_mount;
+	free(blkio_mount);
+	logger->Info("InitCGroups: controller [blkio] mounted at [%s]",
+		blkio_mount_path.c_str());
+#endif
+
 
 	// TODO: check that the "bbq" cgroup already existis
 	// TODO: check that the "bbq" cgroup has CPUS and MEMS
@@ -1484,6 +1905,8 @@ LinuxPlatformProxy::BuildCGroup(CGroupDataPtr_t &pcgd) noexcept
 	return PLATFORM_OK;
 }
 
+#endif // !CONFIG_BBQUE_LINUX_CG_V2
+
 LinuxPlatformProxy::ExitCode_t
 LinuxPlatformProxy::GetCGroupData(SchedPtr_t papp, CGroupDataPtr_t &pcgd) noexcept
 {
@@ -1513,6 +1936,8 @@ LinuxPlatformProxy::GetCGroupData(SchedPtr_t papp, CGroupDataPtr_t &pcgd) noexce
 	return PLATFORM_OK;
 }
 
+#ifndef CONFIG_BBQUE_LINUX_CG_V2
+
 LinuxPlatformProxy::ExitCode_t
 LinuxPlatformProxy::SetupCGroup(CGroupDataPtr_t & pcgd,
 				RLinuxBindingsPtr_t prlb,
@@ -1524,10 +1949,11 @@ LinuxPlatformProxy::SetupCGroup(CGroupDataPtr_t & pcgd,
 		"the EXC itself.");
 	return PLATFORM_OK;
 #endif
+	BBQUE_TRACE_SPAN_LABEL("lpp.setup_cgroup", pcgd->papp->StrId());
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(3,2,0)
 	int64_t cpus_quota = -1; // NOTE: use "-1" for no quota assignement
 #endif
-	int result;
+	std::vector<CGroupAttr_t> attrs;
 
 	/**********************************************************************
 	 *    CPUSET Controller
@@ -1535,23 +1961,19 @@ LinuxPlatformProxy::SetupCGroup(CGroupDataPtr_t & pcgd,
 #if 0
 	// Setting CPUs as EXCLUSIVE if required
 	if (excl) {
-		cgroup_set_value_string(pcgd->pc_cpuset,
-					BBQUE_PP_LINUX_CPU_EXCLUSIVE_PARAM, "1");
+		attrs.push_back({ "cpuset", BBQUE_PP_LINUX_CPU_EXCLUSIVE_PARAM, "1" });
 	}
 #else
 	excl = false;
 #endif
 
 	// Set the assigned CPUs
-	cgroup_set_value_string(pcgd->pc_cpuset,
-				BBQUE_PP_LINUX_CPUS_PARAM,
-				prlb->cpus ? prlb->cpus : "");
+	attrs.push_back({ "cpuset", BBQUE_PP_LINUX_CPUS_PARAM,
+				prlb->cpus ? prlb->cpus : "" });
 
 	// Set the assigned memory NODE (only if we have at least one CPUS)
 	if (prlb->cpus[0]) {
-		cgroup_set_value_string(pcgd->pc_cpuset,
-					BBQUE_PP_LINUX_MEMN_PARAM,
-					prlb->mems);
+		attrs.push_back({ "cpuset", BBQUE_PP_LINUX_MEMN_PARAM, prlb->mems });
 
 		logger->Debug("SetupCGroup: CPUSET for [%s]: {cpus [%c: %s], mems[%s]}",
 			pcgd->papp->StrId(),
@@ -1571,17 +1993,15 @@ LinuxPlatformProxy::SetupCGroup(CGroupDataPtr_t & pcgd,
 #ifdef CONFIG_BBQUE_LINUX_CG_MEMORY
 	assert(prlb->amount_memb >= -1);
 
-	char quota[] = "9223372036854775807";
 	// Set the assigned MEMORY amount
+	std::string quota("-1");
 	if (prlb->amount_memb > 0)
-		sprintf(quota, "%lu", prlb->amount_memb);
-	else
-		sprintf(quota, "-1");
+		quota = std::to_string(prlb->amount_memb);
 
-	cgroup_set_value_string(pcgd->pc_memory, BBQUE_PP_LINUX_MEMB_PARAM, quota);
+	attrs.push_back({ "memory", BBQUE_PP_LINUX_MEMB_PARAM, quota });
 
 	logger->Debug("SetupCGroup: MEMORY for [%s]: {bytes_limit [%s]}",
-		pcgd->papp->StrId(), quota);
+		pcgd->papp->StrId(), quota.c_str());
 #endif
 
 	/**********************************************************************
@@ -1591,12 +2011,12 @@ LinuxPlatformProxy::SetupCGroup(CGroupDataPtr_t & pcgd,
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(3,2,0)
 
 	uint32_t cfs_period_us = BBQUE_PP_LINUX_CPUP_MAX;
-	char const *cfs_c = std::to_string(cfs_period_us).c_str();
+	std::string cfs_c(std::to_string(cfs_period_us));
 
 	if (BBQUE_LIKELY(pcgd->cfs_quota_available)) {
 		bool quota_enforcing = true;
 		// Set the default CPU bandwidth period
-		cgroup_set_value_string(pcgd->pc_cpu, BBQUE_PP_LINUX_CPUP_PARAM, cfs_c);
+		attrs.push_back({ "cpu", BBQUE_PP_LINUX_CPUP_PARAM, cfs_c });
 
 		// Set the assigned CPU bandwidth amount
 		// NOTE: if a quota is NOT assigned we have amount_cpus="0", but this
@@ -1620,21 +2040,19 @@ LinuxPlatformProxy::SetupCGroup(CGroupDataPtr_t & pcgd,
 
 		if (quota_enforcing) {
 			cpus_quota = (cfs_period_us / 100) * prlb->amount_cpus;
-			cgroup_set_value_int64(
-					pcgd->pc_cpu,
-					BBQUE_PP_LINUX_CPUQ_PARAM,
-					cpus_quota);
-
 			logger->Debug("SetupCGroup: CPU for [%s]: {period [%s], quota [%lu]}",
 				pcgd->papp->StrId(),
-				cfs_c,
+				cfs_c.c_str(),
 				cpus_quota);
 		}
 		else {
+			cpus_quota = -1;
 			logger->Debug("SetupCGroup: CPU for [%s]: {period [%s], quota [-]}",
 				pcgd->papp->StrId(),
-				cfs_c);
+				cfs_c.c_str());
 		}
+		attrs.push_back({ "cpu", BBQUE_PP_LINUX_CPUQ_PARAM,
+					std::to_string(cpus_quota) });
 	}
 	else {
 		logger->Warn("SetupCGroup: CFS quota enforcement not supported by the kernel");
@@ -1642,65 +2060,23 @@ LinuxPlatformProxy::SetupCGroup(CGroupDataPtr_t & pcgd,
 #endif
 
 	/**********************************************************************
-	 *    Block I/O Controller
+	 *    CGroup Configuration
 	 **********************************************************************/
-#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
-
-	char quota[30];
-	for (auto r_dev : prlb->read_devs) {
-		br::ResourcePathPtr_t dev_path = r_dev.first;
-		int_fast64_t amount = r_dev.second;
-
-		std::string dev = GetDevFromPath(dev_path);
-
-		// Set the assigned READ BANDWIDTH amount
-		if (dev.compare(""))
-			sprintf(quota, "%s %lu", dev.c_str(), amount << 20); // The bandwidth is stored in MB/s, the blkio parameter is in Bps.
-		else {
-			logger->Warn("SetupCGroup: dev not found for %s, search returned %s", dev_path->ToString().c_str(), dev.c_str());
-			return PLATFORM_MAPPING_FAILED;
-		}
-
-		cgroup_set_value_string(pcgd->pc_blkio, BBQUE_PP_LINUX_R_IO_PARAM, quota);
-
-		logger->Debug("SetupCGroup: READ BANDWIDTH for [%s]: {maj:min bytes_limit [%s] bps}",
-			pcgd->papp->StrId(), quota);
-	}
-
-	for (auto w_dev : prlb->write_devs) {
-		br::ResourcePathPtr_t dev_path = w_dev.first;
-		int_fast64_t amount = w_dev.second;
-
-		std::string dev = GetDevFromPath(dev_path);
 
-		// Set the assigned WRITE BANDWIDTH amount
-		if (dev.compare(""))
-			sprintf(quota, "%s %lu", dev.c_str(), amount << 20); // The bandwidth is stored in MB/s, the blkio parameter is in Bps.
-		else {
-			logger->Warn("SetupCGroup: dev not found for %s, search returned %s", dev_path->ToString().c_str(), dev.c_str());
-			return PLATFORM_MAPPING_FAILED;
-		}
-
-		cgroup_set_value_string(pcgd->pc_blkio, BBQUE_PP_LINUX_W_IO_PARAM, quota);
-
-		logger->Debug("SetupCGroup: WRITE BANDWIDTH for [%s]: {maj:min bytes_limit [%s] bps}",
-			pcgd->papp->StrId(), quota);
-	}
-#endif
+	logger->Debug("SetupCGroup: Updating cgroup [%s]", pcgd->cgpath);
+	if (BBQUE_UNLIKELY(ModifyCGroup(pcgd, attrs) != PLATFORM_OK))
+		return PLATFORM_MAPPING_FAILED;
 
 	/**********************************************************************
-	 *    CGroup Configuration
+	 *    Block I/O Controller
 	 **********************************************************************/
-
-	logger->Debug("SetupCGroup: Updating cgroup [%s]", pcgd->cgpath);
-	bbque_assert(pcgd->pcg);
-	result = cgroup_modify_cgroup(pcgd->pcg);
-	if (BBQUE_UNLIKELY(result)) {
-		logger->Error("SetupCGroup: cgroup resource mapping FAILED "
-			"(Error: libcgroup, kernel cgroup update "
-			"[%d: %s])", errno, strerror(errno));
+#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+	if (BBQUE_UNLIKELY(SetupBlkIO(pcgd, prlb) != PLATFORM_OK)) {
+		logger->Error("SetupCGroup: [%s] block I/O limits setting FAILED",
+			pcgd->papp->StrId());
 		return PLATFORM_MAPPING_FAILED;
 	}
+#endif
 
 	/* If a task has not been assigned, we are done */
 	if (!move)
@@ -1733,22 +2109,99 @@ LinuxPlatformProxy::SetupCGroup(CGroupDataPtr_t & pcgd,
 			w_dev.first->ToString().c_str(),
 			w_dev.second);
 	}
-	
-	cgroup_set_value_uint64(
-				pcgd->pc_cpuset, BBQUE_PP_LINUX_PROCS_PARAM, pcgd->papp->Pid());
 
+	for (auto r_dev : prlb->read_iops_devs){
+		logger->Info("SetupCGroup: [%s] => {read_iops [%s: %ld IO/s]}",
+			pcgd->papp->StrId(),
+			r_dev.first->ToString().c_str(),
+			r_dev.second);
+	}
+
+	for (auto w_dev : prlb->write_iops_devs){
+		logger->Info("SetupCGroup: [%s] => {write_iops [%s: %ld IO/s]}",
+			pcgd->papp->StrId(),
+			w_dev.first->ToString().c_str(),
+			w_dev.second);
+	}
+	
+	// The task could have been moved into the silos in the meantime: the
+	// assignment is always written
 	logger->Debug("SetupCGroup: Updating cgroup [%s]", pcgd->cgpath);
-	result = cgroup_modify_cgroup(pcgd->pcg);
+	std::vector<CGroupAttr_t> procs_attr = {
+		{ "cpuset", BBQUE_PP_LINUX_PROCS_PARAM,
+			std::to_string(pcgd->papp->Pid()) }
+	};
+	if (BBQUE_UNLIKELY(ModifyCGroup(pcgd, procs_attr, false) != PLATFORM_OK))
+		return PLATFORM_MAPPING_FAILED;
+
+	return PLATFORM_OK;
+}
+
+LinuxPlatformProxy::ExitCode_t
+LinuxPlatformProxy::ModifyCGroup(CGroupDataPtr_t & pcgd,
+				 std::vector<CGroupAttr_t> const & attrs,
+				 bool track) noexcept
+{
+	// Skip the attributes whose value has not changed
+	std::vector<CGroupAttr_t const *> changed;
+	for (auto const & attr : attrs) {
+		auto it = pcgd->attrs.find(attr.name);
+		if (track && (it != pcgd->attrs.end()) && (it->second == attr.value))
+			continue;
+		changed.push_back(&attr);
+	}
+
+	if (changed.empty()) {
+		logger->Debug("ModifyCGroup: [%s] unchanged", pcgd->cgpath);
+		return PLATFORM_OK;
+	}
+
+	struct cgroup * pcg = cgroup_new_cgroup(pcgd->cgpath);
+	if (BBQUE_UNLIKELY(!pcg)) {
+		logger->Error("ModifyCGroup: [%s] cgroup resource mapping FAILED "
+			"(Error: libcgroup, \"cgroup\" creation)", pcgd->cgpath);
+		return PLATFORM_MAPPING_FAILED;
+	}
+
+	for (auto attr : changed) {
+		struct cgroup_controller * pctrl =
+			cgroup_get_controller(pcg, attr->controller);
+		if (!pctrl)
+			pctrl = cgroup_add_controller(pcg, attr->controller);
+		if (BBQUE_UNLIKELY(!pctrl
+			|| cgroup_set_value_string(pctrl, attr->name, attr->value.c_str()))) {
+			logger->Error("ModifyCGroup: [%s] cgroup resource mapping FAILED "
+				"(Error: libcgroup, [%s] value setting)",
+				pcgd->cgpath, attr->name);
+			cgroup_free(&pcg);
+			return PLATFORM_MAPPING_FAILED;
+		}
+	}
+
+	int result = cgroup_modify_cgroup(pcg);
+	cgroup_free(&pcg);
 	if (BBQUE_UNLIKELY(result)) {
-		logger->Error("SetupCGroup: cgroup resource mapping FAILED "
+		logger->Error("ModifyCGroup: [%s] cgroup resource mapping FAILED "
 			"(Error: libcgroup, kernel cgroup update "
-			"[%d: %s])", errno, strerror(errno));
+			"[%d: %s])", pcgd->cgpath, errno, strerror(errno));
+		// Values partially written: write all of them the next time
+		for (auto attr : changed)
+			pcgd->attrs.erase(attr->name);
 		return PLATFORM_MAPPING_FAILED;
 	}
 
+	if (track) {
+		for (auto attr : changed)
+			pcgd->attrs[attr->name] = attr->value;
+	}
+
+	logger->Debug("ModifyCGroup: [%s] %d/%d attribute(s) written",
+		pcgd->cgpath, changed.size(), attrs.size());
 	return PLATFORM_OK;
 }
 
+#endif // !CONFIG_BBQUE_LINUX_CG_V2
+
 LinuxPlatformProxy::ExitCode_t
 LinuxPlatformProxy::BuildAppCG(SchedPtr_t papp, CGroupDataPtr_t &pcgd) noexcept
 {
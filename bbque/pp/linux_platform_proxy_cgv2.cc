@@ -0,0 +1,477 @@
+/*
+ * Copyright (C) 2017  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Control groups management through the unified (v2) hierarchy.
+ *
+ * The cgroupfs attributes are written directly, without going through
+ * libcgroup. Since the hierarchy is just a set of directories and files,
+ * the mount point can be redirected to a fake hierarchy (e.g., a mounted
+ * tmpfs) to test the enforcement without a cgroup2 filesystem, by setting
+ * "LinuxPlatformProxy.cgroup_v2.mount_path" in the configuration file. In
+ * a fake hierarchy the attribute files (e.g., "io.max" and "io.weight") are
+ * created by the writes themselves, so that the limits set by a mapping can
+ * be read back, e.g., by the "bbque-cgv2-iocheck" tool.
+ */
+
+#include "bbque/config.h"
+
+#include "bbque/pp/linux_platform_proxy.h"
+#include "bbque/utils/assert.h"
+#include "bbque/utils/tracer.h"
+
+#include <algorithm>
+#include <array>
+#include <boost/filesystem.hpp>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <linux/version.h>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#define BBQUE_PP_LINUX_CGV2_CPUS_PARAM      "cpuset.cpus"
+#define BBQUE_PP_LINUX_CGV2_MEMN_PARAM      "cpuset.mems"
+#define BBQUE_PP_LINUX_CGV2_CPUMAX_PARAM    "cpu.max"
+#define BBQUE_PP_LINUX_CGV2_MEMMAX_PARAM    "memory.max"
+#define BBQUE_PP_LINUX_CGV2_IOMAX_PARAM     "io.max"
+#define BBQUE_PP_LINUX_CGV2_IOWEIGHT_PARAM  "io.weight"
+#define BBQUE_PP_LINUX_CGV2_PROCS_PARAM     "cgroup.procs"
+#define BBQUE_PP_LINUX_CGV2_SUBTREE_PARAM   "cgroup.subtree_control"
+
+// The CFS bandwidth period [us]
+#define BBQUE_PP_LINUX_CGV2_CPUP_MAX        1000000
+
+// The "io.weight" range is [1, 10000], with 100 as default
+#define BBQUE_PP_LINUX_CGV2_IOWEIGHT_DEFAULT 100
+#define BBQUE_PP_LINUX_CGV2_IOWEIGHT_MAX     10000
+
+namespace bfs = boost::filesystem;
+
+namespace bbque {
+namespace pp {
+
+/**
+ * @brief Controllers to enable for the managed control groups
+ */
+static const char * cgv2_controllers[] = {
+	"cpuset",
+	"cpu",
+#ifdef CONFIG_BBQUE_LINUX_CG_MEMORY
+	"memory",
+#endif
+#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+	"io",
+#endif
+};
+
+/**
+ * @brief Write a value into a cgroupfs attribute file
+ *
+ * The kernel parses each write() call on its own, thus the value is
+ * flushed at once.
+ */
+static bool WriteAttributeFile(std::string const & attr_path, std::string const & value)
+{
+	std::ofstream ofs(attr_path, std::ofstream::out);
+	if (!ofs.is_open())
+		return false;
+	ofs << value << std::flush;
+	return ofs.good();
+}
+
+/**
+ * @brief Check if a controller is listed into a "cgroup.subtree_control"
+ */
+static bool IsControllerEnabled(std::string const & subtree_path, const char * name)
+{
+	std::ifstream ifs(subtree_path);
+	std::string enabled;
+	while (ifs >> enabled) {
+		if (enabled.compare(name) == 0)
+			return true;
+	}
+	return false;
+}
+
+
+LinuxPlatformProxy::ExitCode_t LinuxPlatformProxy::InitCGroups() noexcept
+{
+	ExitCode_t pp_result;
+
+	if (BBQUE_UNLIKELY(!bfs::is_directory(cgroup_v2_mount))) {
+		logger->Error("InitCGroups: unified hierarchy mount point [%s] "
+			"not found", cgroup_v2_mount.c_str());
+		return PLATFORM_INIT_FAILED;
+	}
+	logger->Info("InitCGroups: unified hierarchy mounted at [%s]",
+		cgroup_v2_mount.c_str());
+
+	// Resources CGroup, parent of all the application ones
+	pp_result = MakeCGroupV2(BBQUE_PP_LINUX_RESOURCES);
+	if (BBQUE_UNLIKELY(pp_result != PLATFORM_OK)) {
+		logger->Error("InitCGroups: resources CGroup [%s] setup FAILED!",
+			BBQUE_PP_LINUX_RESOURCES);
+		return PLATFORM_INIT_FAILED;
+	}
+
+	// Build "silos" CGroup to host blocked applications
+	pp_result = BuildSilosCG(psilos);
+	if (BBQUE_UNLIKELY(pp_result)) {
+		logger->Error("InitCGroups: Silos CGroup setup FAILED!");
+		return PLATFORM_GENERIC_ERROR;
+	}
+
+	return PLATFORM_OK;
+}
+
+LinuxPlatformProxy::ExitCode_t
+LinuxPlatformProxy::MakeCGroupV2(std::string const & cgpath) noexcept
+{
+	std::stringstream ss(cgpath);
+	std::string level;
+	bfs::path fs_path(cgroup_v2_mount);
+	boost::system::error_code ec;
+	bool last = false;
+
+	logger->Debug("MakeCGroupV2: building cgroup [%s]...", cgpath.c_str());
+
+	while (!last) {
+		last = !std::getline(ss, level, '/');
+
+		// Controllers must be enabled by the parent for the children to
+		// get the attribute files
+		std::string subtree_path((fs_path / BBQUE_PP_LINUX_CGV2_SUBTREE_PARAM).string());
+		for (auto name : cgv2_controllers) {
+			if (IsControllerEnabled(subtree_path, name))
+				continue;
+			if (!WriteAttributeFile(subtree_path, std::string("+") + name)) {
+				logger->Error("MakeCGroupV2: enabling [%s] into [%s] FAILED",
+					name, subtree_path.c_str());
+				return PLATFORM_INIT_FAILED;
+			}
+			logger->Debug("MakeCGroupV2: enabled [%s] into [%s]",
+				name, subtree_path.c_str());
+		}
+
+		if (last)
+			break;
+		if (level.empty())
+			continue;
+
+		fs_path /= level;
+		if (bfs::is_directory(fs_path))
+			continue;
+		if (!bfs::create_directory(fs_path, ec)) {
+			logger->Error("MakeCGroupV2: cgroup [%s] creation FAILED (%s)",
+				fs_path.string().c_str(), ec.message().c_str());
+			return PLATFORM_INIT_FAILED;
+		}
+	}
+
+	return PLATFORM_OK;
+}
+
+bool LinuxPlatformProxy::WriteCGroupAttribute(
+		CGroupDataPtr_t & pcgd,
+		const char * attr,
+		std::string const & value) noexcept
+{
+	// Skip the write if the value has not changed
+	auto it = pcgd->attrs.find(attr);
+	if ((it != pcgd->attrs.end()) && (it->second == value))
+		return true;
+
+	if (!WriteAttributeFile(pcgd->fs_path + "/" + attr, value)) {
+		logger->Error("WriteCGroupAttribute: [%s] %s <= [%s] FAILED",
+			pcgd->cgpath, attr, value.c_str());
+		pcgd->attrs.erase(attr);
+		return false;
+	}
+
+	pcgd->attrs[attr] = value;
+	return true;
+}
+
+LinuxPlatformProxy::ExitCode_t
+LinuxPlatformProxy::BuildSilosCG(CGroupDataPtr_t &pcgd) noexcept
+{
+	ExitCode_t result;
+
+	logger->Debug("BuildSilosCG: Building SILOS CGroup...");
+
+	// Build new CGroup data
+	pcgd = CGroupDataPtr_t(new CGroupData_t(BBQUE_PP_LINUX_SILOS));
+	result = BuildCGroup(pcgd);
+	if (BBQUE_UNLIKELY(result != PLATFORM_OK))
+		return result;
+
+	// Setting up silos (limited) resources, just to run the RTLib
+	logger->Info("BuildSilosCG: Updating kernel CGroup [%s]", pcgd->cgpath);
+	if (!WriteCGroupAttribute(pcgd, BBQUE_PP_LINUX_CGV2_CPUS_PARAM, "0")
+	 || !WriteCGroupAttribute(pcgd, BBQUE_PP_LINUX_CGV2_MEMN_PARAM, "0")) {
+		logger->Error("BuildSilosCG: CGroup resource mapping FAILED");
+		return PLATFORM_MAPPING_FAILED;
+	}
+
+	return PLATFORM_OK;
+}
+
+LinuxPlatformProxy::ExitCode_t
+LinuxPlatformProxy::BuildCGroup(CGroupDataPtr_t &pcgd) noexcept
+{
+	logger->Debug("BuildCGroup: building cgroup [%s]...", pcgd->cgpath);
+
+	// The parent has the required controllers already enabled
+	std::string fs_path(cgroup_v2_mount + "/" + pcgd->cgpath);
+	if ((mkdir(fs_path.c_str(), 0755) != 0) && (errno != EEXIST)) {
+		logger->Error("BuildCGroup: cgroup [%s] creation FAILED "
+			"[%d: %s]", fs_path.c_str(), errno, strerror(errno));
+		return PLATFORM_MAPPING_FAILED;
+	}
+
+	pcgd->fs_path = fs_path;
+	pcgd->cfs_quota_available = true;
+	logger->Debug("BuildCGroup: cgroup [%s] created", pcgd->cgpath);
+
+	return PLATFORM_OK;
+}
+
+LinuxPlatformProxy::ExitCode_t
+LinuxPlatformProxy::ReclaimResources(SchedPtr_t papp) noexcept
+{
+	logger->Debug("ReclaimResources: CGroup resource claiming START");
+
+	// Move this app into "silos" CGroup
+	logger->Info("ReclaimResources: [%s] => SILOS[%s]",
+		papp->StrId(), psilos->cgpath);
+	std::string procs_path(psilos->fs_path + "/" BBQUE_PP_LINUX_CGV2_PROCS_PARAM);
+	if (!WriteAttributeFile(procs_path, std::to_string(papp->Pid()))) {
+		logger->Error("ReclaimResources: CGroup resource reclaiming FAILED "
+			"(Error: kernel cgroup update [%d: %s]",
+			errno, strerror(errno));
+		return PLATFORM_MAPPING_FAILED;
+	}
+
+	logger->Debug("ReclaimResources: CGroup resource claiming DONE!");
+
+	return PLATFORM_OK;
+}
+
+LinuxPlatformProxy::ExitCode_t
+LinuxPlatformProxy::SetupCGroup(CGroupDataPtr_t & pcgd,
+				RLinuxBindingsPtr_t prlb,
+				bool excl,
+				bool move) noexcept
+{
+	BBQUE_TRACE_SPAN_LABEL("lpp.setup_cgroup", pcgd->papp->StrId());
+	UNUSED(excl);
+
+	/**********************************************************************
+	 *    CPUSET Controller
+	 **********************************************************************/
+
+	// Set the assigned CPUs
+	if (!WriteCGroupAttribute(pcgd, BBQUE_PP_LINUX_CGV2_CPUS_PARAM,
+				prlb->cpus ? prlb->cpus : ""))
+		return PLATFORM_MAPPING_FAILED;
+
+	// Set the assigned memory NODE (only if we have at least one CPUS)
+	if (prlb->cpus[0]) {
+		if (!WriteCGroupAttribute(pcgd, BBQUE_PP_LINUX_CGV2_MEMN_PARAM,
+					prlb->mems))
+			return PLATFORM_MAPPING_FAILED;
+
+		logger->Debug("SetupCGroup: CPUSET for [%s]: {cpus [%s], mems[%s]}",
+			pcgd->papp->StrId(), prlb->cpus, prlb->mems);
+	}
+	else {
+		logger->Debug("SetupCGroup: CPUSET for [%s]: {cpus [NONE], mems[NONE]}",
+			pcgd->papp->StrId());
+	}
+
+	/**********************************************************************
+	 *    MEMORY Controller
+	 **********************************************************************/
+
+#ifdef CONFIG_BBQUE_LINUX_CG_MEMORY
+	assert(prlb->amount_memb >= -1);
+
+	// Set the assigned MEMORY amount
+	std::string memory_max("max");
+	if (prlb->amount_memb > 0)
+		memory_max = std::to_string(prlb->amount_memb);
+
+	if (!WriteCGroupAttribute(pcgd, BBQUE_PP_LINUX_CGV2_MEMMAX_PARAM, memory_max))
+		return PLATFORM_MAPPING_FAILED;
+
+	logger->Debug("SetupCGroup: MEMORY for [%s]: {max [%s]}",
+		pcgd->papp->StrId(), memory_max.c_str());
+#endif
+
+	/**********************************************************************
+	 *    CPU Quota Controller
+	 **********************************************************************/
+
+	// CFS quota to enforce is assigned + (margin * #PEs)
+	// NOTE: "max" removes any constraint
+	int64_t cfs_period_us = BBQUE_PP_LINUX_CGV2_CPUP_MAX;
+	int64_t cpus_quota = prlb->amount_cpus;
+	bool quota_enforcing = (prlb->amount_cpus != 0);
+	cpus_quota += ((cpus_quota / 100) + 1) * cfs_margin_pct;
+	if ((cpus_quota % 100) > cfs_threshold_pct) {
+		logger->Warn("SetupCGroup: CFS (quota+margin) %d > %d "
+			"threshold, enforcing disabled",
+			cpus_quota, cfs_threshold_pct);
+		quota_enforcing = false;
+	}
+
+	std::string cpu_max("max " + std::to_string(cfs_period_us));
+	if (quota_enforcing && pcgd->cfs_quota_available) {
+		cpus_quota = (cfs_period_us / 100) * prlb->amount_cpus;
+		cpu_max = std::to_string(cpus_quota) + " " + std::to_string(cfs_period_us);
+	}
+
+	if (!WriteCGroupAttribute(pcgd, BBQUE_PP_LINUX_CGV2_CPUMAX_PARAM, cpu_max))
+		return PLATFORM_MAPPING_FAILED;
+
+	logger->Debug("SetupCGroup: CPU for [%s]: {max [%s]}",
+		pcgd->papp->StrId(), cpu_max.c_str());
+
+	/**********************************************************************
+	 *    Block I/O Controller
+	 **********************************************************************/
+
+#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+	if (BBQUE_UNLIKELY(SetupBlkIO(pcgd, prlb) != PLATFORM_OK)) {
+		logger->Error("SetupCGroup: [%s] block I/O limits setting FAILED",
+			pcgd->papp->StrId());
+		return PLATFORM_MAPPING_FAILED;
+	}
+#endif
+
+	/* If a task has not been assigned, we are done */
+	if (!move)
+		return PLATFORM_OK;
+
+	/**********************************************************************
+	 *    CGroup Task Assignment
+	 **********************************************************************/
+	// NOTE: task assignement must be done AFTER CGroup configuration, to
+	// ensure all the controller have been properly setup to manage the
+	// task.
+
+	logger->Info("SetupCGroup: [%s] => {cpus [%s: %ld], mems[%s: %ld B]}",
+		pcgd->papp->StrId(),
+		prlb->cpus,
+		prlb->amount_cpus,
+		prlb->mems,
+		prlb->amount_memb);
+
+	std::string procs_path(pcgd->fs_path + "/" BBQUE_PP_LINUX_CGV2_PROCS_PARAM);
+	if (!WriteAttributeFile(procs_path, std::to_string(pcgd->papp->Pid()))) {
+		logger->Error("SetupCGroup: [%s] task assignment FAILED "
+			"[%d: %s]", pcgd->papp->StrId(), errno, strerror(errno));
+		return PLATFORM_MAPPING_FAILED;
+	}
+
+	return PLATFORM_OK;
+}
+
+
+#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+
+LinuxPlatformProxy::ExitCode_t
+LinuxPlatformProxy::SetupBlkIO(CGroupDataPtr_t & pcgd,
+			       RLinuxBindingsPtr_t prlb) noexcept
+{
+	BBQUE_TRACE_SPAN_LABEL("lpp.setup_blkio", pcgd->papp->StrId());
+
+	// Limits to set, per device: "rbps", "wbps", "riops", "wiops"
+	std::map<std::string, std::array<std::string, 4>> limits;
+	static const char * keys[] = { "rbps", "wbps", "riops", "wiops" };
+
+	// The bandwidth is accounted in B/s, as the io.max parameter
+	decltype(prlb->read_devs) * dev_limits[] = {
+		&prlb->read_devs,
+		&prlb->write_devs,
+		&prlb->read_iops_devs,
+		&prlb->write_iops_devs
+	};
+
+	for (auto & dev : dev_info)
+		limits[dev->dev].fill("max");
+
+	for (size_t i = 0; i < 4; ++i) {
+		for (auto & dev_entry : *(dev_limits[i])) {
+			std::string const & dev(GetDevFromPath(dev_entry.first));
+			if (dev.empty()) {
+				logger->Warn("SetupBlkIO: dev not found for %s",
+					dev_entry.first->ToString().c_str());
+				return PLATFORM_MAPPING_FAILED;
+			}
+			limits[dev][i] = std::to_string(
+				static_cast<uint64_t>(dev_entry.second));
+		}
+	}
+
+	// One io.max line per device, written only if changed. Devices never
+	// limited are skipped, since a new cgroup has no limits set.
+	for (auto & dev_limit : limits) {
+		std::string line(dev_limit.first);
+		bool unlimited = true;
+		for (size_t i = 0; i < 4; ++i) {
+			line += std::string(" ") + keys[i] + "=" + dev_limit.second[i];
+			unlimited &= (dev_limit.second[i] == "max");
+		}
+
+		std::string cache_key(BBQUE_PP_LINUX_CGV2_IOMAX_PARAM ":" + dev_limit.first);
+		auto it = pcgd->attrs.find(cache_key);
+		if (it == pcgd->attrs.end() ? unlimited : (it->second == line))
+			continue;
+
+		std::string attr_path(pcgd->fs_path + "/" BBQUE_PP_LINUX_CGV2_IOMAX_PARAM);
+		if (!WriteAttributeFile(attr_path, line)) {
+			logger->Error("SetupBlkIO: [%s] writing <%s> to %s FAILED",
+				pcgd->papp->StrId(), line.c_str(),
+				BBQUE_PP_LINUX_CGV2_IOMAX_PARAM);
+			pcgd->attrs.erase(cache_key);
+			return PLATFORM_MAPPING_FAILED;
+		}
+		pcgd->attrs[cache_key] = line;
+		logger->Debug("SetupBlkIO: [%s] %s: {%s}",
+			pcgd->papp->StrId(), BBQUE_PP_LINUX_CGV2_IOMAX_PARAM,
+			line.c_str());
+	}
+
+	// Proportional share of the devices, according to the priority
+	// (0 is the highest one)
+	int weight = BBQUE_PP_LINUX_CGV2_IOWEIGHT_DEFAULT *
+		(BBQUE_APP_PRIO_LEVELS - pcgd->papp->Priority());
+	weight = std::min(std::max(weight, 1), BBQUE_PP_LINUX_CGV2_IOWEIGHT_MAX);
+	if (!WriteCGroupAttribute(pcgd, BBQUE_PP_LINUX_CGV2_IOWEIGHT_PARAM,
+				"default " + std::to_string(weight)))
+		return PLATFORM_MAPPING_FAILED;
+
+	return PLATFORM_OK;
+}
+
+#endif // CONFIG_BBQUE_LINUX_CG_BLKIO
+
+} // namespace pp
+} // namespace bbque
@@ -233,6 +233,30 @@ LocalPlatformProxy::MapResources(SchedPtr_t papp,
 	return PLATFORM_OK;
 }
 
+LocalPlatformProxy::ExitCode_t LocalPlatformProxy::BeginMappings()
+{
+	ExitCode_t ec = this->host->BeginMappings();
+	for (auto it = this->accl.begin() ; it < this->accl.end(); it++) {
+		if ((*it)->BeginMappings() != PLATFORM_OK)
+			ec = PLATFORM_MAPPING_FAILED;
+	}
+	return ec;
+}
+
+LocalPlatformProxy::ExitCode_t
+LocalPlatformProxy::CommitMappings(std::vector<SchedPtr_t> & failed)
+{
+	ExitCode_t ec = this->host->CommitMappings(failed);
+	for (auto it = this->accl.begin() ; it < this->accl.end(); it++) {
+		if ((*it)->CommitMappings(failed) != PLATFORM_OK)
+			ec = PLATFORM_MAPPING_FAILED;
+	}
+
+	if (ec != PLATFORM_OK)
+		logger->Error("CommitMappings: failed");
+	return ec;
+}
+
 LocalPlatformProxy::ExitCode_t LocalPlatformProxy::ActuatePowerManagement()
 {
 	// Platform-specific power settings (system-level configurations)
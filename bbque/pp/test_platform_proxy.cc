@@ -150,13 +150,14 @@ TestPlatformProxy::RegisterIODev(const PlatformDescription::IO &io_dev)
 	ResourceAccounter & ra(ResourceAccounter::GetInstance());
 
 	std::string resource_path(io_dev.GetPath());
-	const auto q_bytes = io_dev.GetBandwidth();
+	const auto amount = io_dev.IsIOPS() ?
+		io_dev.GetIOPS() : io_dev.GetBandwidth();
 
-	if (ra.RegisterResource(resource_path, "", q_bytes)  == nullptr)
+	if (ra.RegisterResource(resource_path, "", amount)  == nullptr)
 		return PLATFORM_DATA_PARSING_ERROR;
 
-	logger->Debug("RegisterIODev: <%s> [size=%dB] done",
-		resource_path.c_str(), q_bytes);
+	logger->Debug("RegisterIODev: <%s> [amount=%lu] done",
+		resource_path.c_str(), amount);
 
 	return PLATFORM_OK;
 }
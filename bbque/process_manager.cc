@@ -25,6 +25,7 @@
 #include "bbque/process_manager.h"
 #include "bbque/resource_manager.h"
 #include "bbque/utils/schedlog.h"
+#include "bbque/utils/tracer.h"
 
 #define MODULE_NAMESPACE "bq.prm"
 #define MODULE_CONFIG    "ProcessManager"
@@ -471,6 +472,7 @@ ProcessManager::ScheduleRequest(ProcPtr_t proc,
 				res::RViewToken_t status_view,
 				size_t b_refn)
 {
+	BBQUE_TRACE_SPAN_LABEL("prm.schedule_request", proc->StrId());
 	ResourceAccounter & ra(ResourceAccounter::GetInstance());
 	logger->Info("ScheduleRequest: [%s] schedule request for binding @[%d] view=%ld",
 		proc->StrId(), b_refn, status_view);
@@ -19,6 +19,7 @@
 #include "bbque/app/working_mode.h"
 #include "bbque/app/application.h"
 
+#include "bbque/utils/tracer.h"
 #include "bbque/utils/utility.h"
 
 #define PROFILE_MANAGER_NAMESPACE "bq.om"
@@ -164,6 +165,7 @@ ProfileManager::ProfileScheduleClass(uint16_t prio) {
 ProfileManager::ExitCode_t
 ProfileManager::ProfileSchedule() {
 	uint16_t prio;
+	BBQUE_TRACE_SPAN("om.profile");
 
 	logger->Notice(
 		"====================================================================");
@@ -36,7 +36,7 @@ void ResourceBinder::Bind(
 			  BBQUE_RID_TYPE out_id,
 			  ResourceAssignmentMapPtr_t out_map,
 			  br::ResourceType filter_rtype,
-			  ResourceBitset * filter_mask)
+			  ResourceBitset const * filter_mask)
 {
 	ResourceAccounter & ra(ResourceAccounter::GetInstance());
 	ResourcePath::ExitCode_t rp_result;
@@ -158,6 +158,36 @@ void ResourceBinder::Bind(
 		(*out_map)[resource_path]->GetResourcesList().size());
 }
 
+void ResourceBinder::Bind(
+			  br::ResourceAssignmentMap_t const & source_map,
+			  BindingStep_t const & step,
+			  br::ResourceAssignmentMapPtr_t out_map)
+{
+	if (step.resource_path) {
+		Bind(source_map, step.resource_path, step.filter_mask, out_map);
+		return;
+	}
+
+	Bind(source_map, step.r_type, step.source_id, step.out_id, out_map,
+		step.filter_rtype, step.filtered ? &step.filter_mask : nullptr);
+}
+
+bool ResourceBinder::Bindable(
+			      br::ResourceAssignmentMap_t const & source_map,
+			      BindingStep_t const & step)
+{
+	if (step.resource_path)
+		return source_map.find(step.resource_path) != source_map.end();
+
+	for (auto const & ru_entry : source_map) {
+		br::ResourcePathPtr_t const & source_path(ru_entry.first);
+		if ((source_path->NumLevels() > 0)
+				&& source_path->IncludesType(step.r_type))
+			return true;
+	}
+	return false;
+}
+
 void ResourceBinder::RemoveCompatibleAssignments(
 						 br::ResourceAssignmentMapPtr_t out_map,
 						 br::ResourcePathPtr_t out_path)
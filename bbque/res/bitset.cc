@@ -15,20 +15,16 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <cstring>
+#include <algorithm>
+#include <cstdio>
 
 #include "bbque/res/bitset.h"
-#include "bbque/utils/utility.h"
 
 #define MODULE_NAMESPACE "bq.bs"
 
 namespace bbque { namespace res {
 
-ResourceBitset::ResourceBitset():
-	first_set(R_ID_NONE),
-	last_set(R_ID_NONE),
-	count(0),
-	none(true) {
+ResourceBitset::ResourceBitset() {
 }
 
 ResourceBitset::~ResourceBitset() {}
@@ -37,62 +33,152 @@ ResourceBitset::~ResourceBitset() {}
  *         Operators          *
  ******************************/
 
-ResourceBitset ResourceBitset::operator|= (const ResourceBitset & rbs) {
-	int _bit = rbs.FirstSet();
-	while ((_bit >= 0) && (_bit <= rbs.LastSet())) {
-		if (rbs.Test(_bit)) Set(_bit);
-		_bit++;
-	}
+bool ResourceBitset::operator== (ResourceBitset const & rbs) const {
+	size_t common = std::min(words.size(), rbs.words.size());
+	if (!std::equal(words.begin(), words.begin() + common, rbs.words.begin()))
+		return false;
+
+	// The exceeding words of the wider bitset must be empty
+	auto const & wider(words.size() > common ? words : rbs.words);
+	return std::all_of(wider.begin() + common, wider.end(),
+		[](Word_t w) { return w == 0; });
+}
+
+ResourceBitset & ResourceBitset::operator|= (const ResourceBitset & rbs) {
+	if (words.size() < rbs.words.size())
+		words.resize(rbs.words.size(), 0);
+	for (size_t i = 0; i < rbs.words.size(); ++i)
+		words[i] |= rbs.words[i];
 	return *this;
 }
 
-ResourceBitset ResourceBitset::operator&= (const ResourceBitset & rbs) {
-	Reset();
-	return (*this |= rbs);
+ResourceBitset & ResourceBitset::operator&= (const ResourceBitset & rbs) {
+	if (words.size() > rbs.words.size())
+		words.resize(rbs.words.size());
+	for (size_t i = 0; i < words.size(); ++i)
+		words[i] &= rbs.words[i];
+	return *this;
+}
+
+ResourceBitset & ResourceBitset::operator-= (const ResourceBitset & rbs) {
+	size_t common = std::min(words.size(), rbs.words.size());
+	for (size_t i = 0; i < common; ++i)
+		words[i] &= ~rbs.words[i];
+	return *this;
 }
 
 /**/
 
 ResourceBitset::ExitCode_t ResourceBitset::Set(BBQUE_RID_TYPE pos) {
-	char buff[4] = "";
-
 	// Boundary check
-	if (pos > BBQUE_MAX_R_ID_NUM)
+	if (pos < 0)
 		return OUT_OF_RANGE;
-	// Set bit
-	if (bit_set.test(pos))
-		return OK;
-	bit_set.set(pos);
-
-	// Track set boundaries
-	if (pos > last_set)
-		last_set  = pos;
-	if ((pos < first_set) || (first_set < 0))
-		first_set = pos;
-
-	// Update CG string
-	if (count > 0)
-		snprintf(buff, 4, ",%d", pos);
-	else
-		snprintf(buff, 4, "%d", pos);
-	cg_str.append(buff);
-
-	++count;
-	if (none) none = false;
+
+	// Grow to include the position
+	size_t word_idx = WordIndex(pos);
+	if (word_idx >= words.size())
+		words.resize(word_idx + 1, 0);
+	words[word_idx] |= BitMask(pos);
 	return OK;
 }
 
 ResourceBitset::ExitCode_t ResourceBitset::Reset() {
-	bit_set.reset();
-	first_set = last_set = R_ID_NONE;
-	none  = true;
-	count = 0;
+	words.clear();
 	return OK;
 }
 
+ResourceBitset::ExitCode_t ResourceBitset::Reset(BBQUE_RID_TYPE pos) {
+	if (pos < 0)
+		return OUT_OF_RANGE;
+	if (WordIndex(pos) < words.size())
+		words[WordIndex(pos)] &= ~BitMask(pos);
+	return OK;
+}
 
+BBQUE_RID_TYPE ResourceBitset::Count() const {
+	BBQUE_RID_TYPE count = 0;
+	for (Word_t w : words)
+		count += __builtin_popcountll(w);
+	return count;
+}
+
+BBQUE_RID_TYPE ResourceBitset::FirstSet() const {
+	for (size_t i = 0; i < words.size(); ++i) {
+		if (words[i] != 0)
+			return i * BitsPerWord + __builtin_ctzll(words[i]);
+	}
+	return R_ID_NONE;
+}
+
+BBQUE_RID_TYPE ResourceBitset::LastSet() const {
+	for (size_t i = words.size(); i > 0; --i) {
+		if (words[i-1] != 0)
+			return (i - 1) * BitsPerWord
+				+ (BitsPerWord - 1 - __builtin_clzll(words[i-1]));
+	}
+	return R_ID_NONE;
+}
+
+bool ResourceBitset::Intersects(ResourceBitset const & rbs) const {
+	size_t common = std::min(words.size(), rbs.words.size());
+	for (size_t i = 0; i < common; ++i) {
+		if (words[i] & rbs.words[i])
+			return true;
+	}
+	return false;
+}
+
+std::string ResourceBitset::ToString() const {
+	BBQUE_RID_TYPE last = LastSet();
+	if (last < 0)
+		return "0";
+
+	std::string str(last + 1, '0');
+	for (BBQUE_RID_TYPE pos = 0; pos <= last; ++pos) {
+		if (Test(pos))
+			str[last - pos] = '1';
+	}
+	return str;
+}
+
+std::string ResourceBitset::ToStringCG() const {
+	std::string cg_str;
+	char buff[16];
+
+	// Scan the words for runs of consecutive set bits
+	BBQUE_RID_TYPE range_begin = R_ID_NONE;
+	BBQUE_RID_TYPE pos = 0;
+	size_t nr_words = words.size();
+	for (size_t i = 0; i <= nr_words; ++i) {
+		Word_t w = (i < nr_words) ? words[i] : 0;
+
+		// Fast path: word entirely inside or outside a range
+		if (((w == ~Word_t(0)) && (range_begin >= 0))
+				|| ((w == 0) && (range_begin < 0))) {
+			pos += BitsPerWord;
+			continue;
+		}
+
+		for (size_t b = 0; b < BitsPerWord; ++b, ++pos) {
+			bool bit = (w >> b) & 1;
+			if (bit && (range_begin < 0)) {
+				range_begin = pos;
+			}
+			else if (!bit && (range_begin >= 0)) {
+				if (range_begin == pos - 1)
+					snprintf(buff, sizeof(buff), "%s%d",
+						cg_str.empty() ? "" : ",", range_begin);
+				else
+					snprintf(buff, sizeof(buff), "%s%d-%d",
+						cg_str.empty() ? "" : ",", range_begin, pos - 1);
+				cg_str.append(buff);
+				range_begin = R_ID_NONE;
+			}
+		}
+	}
+	return cg_str;
+}
 
 } // namespace res
 
 } // namespace bbque
-
@@ -46,7 +46,7 @@ void ResourceAssignment::SetResourcesList(ResourcePtrList_t & r_list)
 
 void ResourceAssignment::SetResourcesList(ResourcePtrList_t & r_list,
 					  br::ResourceType filter_rtype,
-					  ResourceBitset & filter_mask)
+					  ResourceBitset const & filter_mask)
 {
 	if (r_list.empty())
 		return;
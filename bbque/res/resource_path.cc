@@ -50,6 +50,8 @@ ResourcePath::ResourcePath(ResourcePath const & r_path):
 	types_bits  = r_path.types_bits;
 	global_type = r_path.global_type;
 	level_count = r_path.level_count;
+	key         = r_path.key;
+	str_path    = r_path.str_path;
 }
 
 ResourcePath::~ResourcePath() {
@@ -62,42 +64,13 @@ ResourcePath::~ResourcePath() {
  ******************************************************************/
 
 bool ResourcePath::operator< (ResourcePath const & comp_path) const {
-	// Manage the case of different length
-	if (identifiers.size() < comp_path.NumLevels())
-		return true;
-	else if (identifiers.size() > comp_path.NumLevels())
-		return false;
-
-	// Per-level comparison of resource identifiers (equal length)
-	auto curr_it = identifiers.begin();
-	auto comp_it = comp_path.Begin();
-	for (; curr_it != identifiers.end(), comp_it != comp_path.End(); ++curr_it, ++comp_it) {
-		ResourceIdentifier & curr_resource_ident(*(*curr_it));
-		ResourceIdentifier & comp_resource_ident(*(*comp_it));
-
-		if (curr_resource_ident < comp_resource_ident)
-			return true;
-	}
-	return false;
+	// Shorter paths first, then per-level comparison of type and ID
+	return key < comp_path.key;
 }
 
 
 bool ResourcePath::operator== (ResourcePath const & comp_path) const {
-	// Manage the case of different length
-	if (identifiers.size() != comp_path.NumLevels())
-		return false;
-
-	// Per-level comparison of resource identifiers (equal length)
-	auto curr_it = identifiers.begin();
-	auto comp_it = comp_path.Begin();
-	for (; curr_it != identifiers.end(), comp_it != comp_path.End(); ++curr_it, ++comp_it) {
-		ResourceIdentifier & curr_resource_ident(*(*curr_it));
-		ResourceIdentifier & comp_resource_ident(*(*comp_it));
-
-		if (curr_resource_ident != comp_resource_ident)
-			return false;
-	}
-	return true;
+	return key == comp_path.key;
 }
 
 
@@ -162,6 +135,8 @@ void ResourcePath::Clear() {
 	types_bits.reset();
 	global_type = ResourceType::UNDEFINED;
 	level_count = 0;
+	key.Clear();
+	str_path.clear();
 }
 
 ResourcePath::ExitCode_t ResourcePath::Append(
@@ -182,12 +157,21 @@ ResourcePath::ExitCode_t ResourcePath::Append(
 		logger->Debug("Append: resource type [%d] already in the path", r_type);
 		return ERR_USED_TYPE;
 	}
+	if (level_count == MAX_NUM_LEVELS) {
+		logger->Error("Append: maximum number of levels (%d) reached",
+			MAX_NUM_LEVELS);
+		return ERR_MAX_LEVELS;
+	}
 	types_bits.set(r_type_index);
 	types_idx.emplace(r_type_index, level_count);
 
 	// Append the new resource identifier (sp) to the list
 	auto curr_resource_ident = std::make_shared<ResourceIdentifier>(r_type, r_id);
 	identifiers.push_back(curr_resource_ident);
+	key.Append(r_type, curr_resource_ident->ID());
+	if (!str_path.empty())
+		str_path.append(".");
+	str_path.append(curr_resource_ident->Name());
 	global_type = r_type;
 	logger->Debug("Append: updating global type = <%s>",
 		br::GetResourceTypeString(global_type));
@@ -198,7 +182,7 @@ ResourcePath::ExitCode_t ResourcePath::Append(
 			curr_resource_ident->Name().c_str(), types_idx[r_type_index],
 			types_bits.to_string().c_str());
 	logger->Debug("Append: SP:'%s', count: %d",
-			this->ToString().c_str(), level_count);
+			str_path.c_str(), level_count);
 	return OK;
 }
 
@@ -315,16 +299,23 @@ ResourcePath::ExitCode_t ResourcePath::ReplaceID(
 		ResourceType r_type,
 		BBQUE_RID_TYPE source_id,
 		BBQUE_RID_TYPE out_id) {
-	ResourceIdentifierPtr_t curr_resource_ident(GetIdentifier(r_type));
-	if (!curr_resource_ident)
+	int8_t level = GetLevel(r_type);
+	if (level < 0)
 		return ERR_MISS_TYPE;
+	ResourceIdentifierPtr_t curr_resource_ident(identifiers.at(level));
 	logger->Debug("ReplaceID: replace %s to ID[%d]",
 			curr_resource_ident->Name().c_str(), out_id);
 
 	if ((source_id != R_ID_ANY) && (curr_resource_ident->ID() != source_id))
 		return WRN_MISS_ID;
 
+	// Identifiers are shared among copies of the path: replace, do not
+	// modify in place
+	curr_resource_ident = std::make_shared<ResourceIdentifier>(*curr_resource_ident);
 	curr_resource_ident->SetID(out_id);
+	identifiers[level] = curr_resource_ident;
+	key.Set(level, r_type, curr_resource_ident->ID());
+	UpdateString();
 	logger->Debug("ReplaceID: from %d to %d, DONE",
 			source_id, curr_resource_ident->ID());
 
@@ -352,9 +343,9 @@ ResourceType ResourcePath::ParentType(ResourceType r_type) const {
 }
 
 
-std::string ResourcePath::ToString() const {
+void ResourcePath::UpdateString() {
 	ResourcePath::ConstIterator it;
-	std::string str_path;
+	str_path.clear();
 
 	// The resource identifiers
 	for (it = identifiers.begin(); it != identifiers.end(); ++it) {
@@ -362,8 +353,6 @@ std::string ResourcePath::ToString() const {
 			str_path.append(".");
 		str_path.append((*it)->Name());
 	}
-	// Update the string
-	return str_path;
 }
 
 } // namespace res
@@ -50,6 +50,14 @@ ResourceTree::ResourceTree():
 ResourcePtrList_t
 ResourceTree::find_list(ResourcePath & rsrc_path, uint16_t match_flags) const
 {
+	// Precomputed matchings
+	auto indexed = find_indexed(rsrc_path, match_flags & ~RT_MATCH_FIRST);
+	if (indexed) {
+		if ((match_flags & RT_MATCH_FIRST) && !indexed->empty())
+			return ResourcePtrList_t(1, indexed->front());
+		return *indexed;
+	}
+
 	ResourcePtrList_t matchings;
 	auto head_path(rsrc_path.Begin());
 	auto const & end_path(rsrc_path.End());
@@ -62,8 +70,151 @@ ResourceTree::find_list(ResourcePath & rsrc_path, uint16_t match_flags) const
 	return matchings;
 }
 
+ResourcePtrList_t const *
+ResourceTree::find_indexed(ResourcePath const & rsrc_path, uint16_t match_flags) const
+{
+	auto entry = find_entry(rsrc_path, match_flags);
+	if (!entry)
+		return nullptr;
+	return &(entry->resources);
+}
+
+ResourceTree::IndexEntry_t const *
+ResourceTree::find_entry(ResourcePath const & rsrc_path, uint16_t match_flags) const
+{
+	static IndexEntry_t const no_matchings;
+	if (!index_ready)
+		return nullptr;
+
+	// First matching only: not a sub-list of the index
+	if (match_flags & RT_MATCH_FIRST)
+		return nullptr;
+
+	ResourcePathKey key;
+	for (auto const & path_node : rsrc_path.GetIdentifiers()) {
+		// Undefined types match any level: not indexed
+		if (path_node->Type() == ResourceType::UNDEFINED)
+			return nullptr;
+
+		int32_t id = path_node->ID();
+		if (match_flags & RT_MATCH_MIXED) {
+			if (id < 0)
+				id = R_ID_ANY;
+		}
+		else if (match_flags & RT_MATCH_TYPE) {
+			id = R_ID_ANY;
+		}
+		else if (id < 0) {
+			// Exact matching of a missing ID
+			return &no_matchings;
+		}
+		if (!ResourcePathKey::Encodable(id))
+			return nullptr;
+		key.Append(path_node->Type(), id);
+	}
+
+	auto index_it = index.find(key);
+	if (index_it == index.end())
+		return &no_matchings;
+	return &(index_it->second);
+}
+
+void ResourceTree::build_index()
+{
+	std::vector<std::pair<ResourceType, int32_t>> levels;
+	index.clear();
+	index_entries.clear();
+	++index_gen;
+	for (auto & child_node : root->children) {
+		if (index_node(child_node, levels))
+			continue;
+		// Keep on visiting the tree at each lookup
+		logger->Error("build_index: resource IDs out of range, "
+		              "index not available");
+		index.clear();
+		return;
+	}
+
+	// Dense ids of the entries and aggregated amounts
+	for (auto & index_entry : index) {
+		IndexEntry_t & entry(index_entry.second);
+		entry.id = index_entries.size();
+		index_entries.push_back(&entry);
+		aggregate_entry(entry);
+		for (auto & resource_ptr : entry.resources) {
+			if (resource_ptr->index_gen != index_gen) {
+				resource_ptr->index_entries.clear();
+				resource_ptr->index_gen = index_gen;
+			}
+			resource_ptr->index_entries.push_back(entry.id);
+		}
+	}
+
+	index_ready = true;
+	logger->Debug("build_index: %d path matchings indexed [gen=%d]",
+	              index.size(), index_gen);
+}
+
+void ResourceTree::aggregate_entry(IndexEntry_t & entry)
+{
+	entry.total = 0;
+	entry.unreserved = 0;
+	entry.offline_count = 0;
+	for (auto & resource_ptr : entry.resources) {
+		entry.total += resource_ptr->Total();
+		if (resource_ptr->IsOffline()) {
+			++entry.offline_count;
+			continue;
+		}
+		entry.unreserved += resource_ptr->Unreserved();
+	}
+}
+
+void ResourceTree::refresh_index(Resource const & resource)
+{
+	if (!index_ready || (resource.index_gen != index_gen))
+		return;
+	for (auto entry_id : resource.index_entries)
+		aggregate_entry(*index_entries[entry_id]);
+}
+
+bool ResourceTree::index_node(
+        ResourceNodePtr_t node,
+        std::vector<std::pair<ResourceType, int32_t>> & levels)
+{
+	auto const & resource_ptr(node->data);
+	if (!ResourcePathKey::Encodable(resource_ptr->ID())) {
+		logger->Error("index_node: <%s> ID out of range",
+		              resource_ptr->Name().c_str());
+		return false;
+	}
+	levels.emplace_back(resource_ptr->Type(), resource_ptr->ID());
+
+	// All the combinations of matching by type+ID or by type only, the
+	// nodes are visited in the same order of find_node()
+	size_t nr_levels = levels.size();
+	for (uint32_t mask = 0; mask < (1U << nr_levels); ++mask) {
+		ResourcePathKey key;
+		for (size_t i = 0; i < nr_levels; ++i) {
+			int32_t id = (mask & (1U << i)) ? R_ID_ANY : levels[i].second;
+			key.Append(levels[i].first, id);
+		}
+		index[key].resources.push_back(resource_ptr);
+	}
+
+	for (auto & child_node : node->children) {
+		if (!index_node(child_node, levels))
+			return false;
+	}
+	levels.pop_back();
+	return true;
+}
+
 ResourcePtr_t & ResourceTree::insert(ResourcePath const & rsrc_path)
 {
+	// The index must be rebuilt
+	index_ready = false;
+
 	// Seeking on the last matching resource path level (tree node)
 	ResourceNodePtr_t curr_node = root;
 	for (auto path_it = rsrc_path.Begin();
@@ -16,6 +16,7 @@ static const char * r_type_str[] = {
 	"icn" ,
 	"blk" ,
 	"io"  ,
+	"iops",
 	"cst"
 };
 
@@ -18,6 +18,8 @@
 #include "bbque/res/resources.h"
 #include "bbque/resource_accounter.h"
 
+#include <atomic>
+
 #define MODULE_NAMESPACE "bq.re"
 
 namespace bu = bbque::utils;
@@ -25,14 +27,61 @@ namespace bu = bbque::utils;
 namespace bbque {
 namespace res {
 
+/*****************************************************************************
+ * class ResourceStateView
+ *****************************************************************************/
+
+ResourceStateView::ResourceStateView(ResourceStateView const & other,
+				     RViewToken_t _token) :
+    token(_token),
+    index_gen(other.index_gen),
+    used_sums(other.used_sums),
+    index(other.index.size(), nullptr)
+{
+	// Copy the states one by one, to index the new ones
+	for (size_t idx = 0; idx < other.index.size(); ++idx) {
+		if (!other.index[idx])
+			continue;
+		states.push_back(*other.index[idx]);
+		index[idx] = &states.back();
+	}
+}
+
+ResourceState * ResourceStateView::GetOrCreate(uint32_t idx)
+{
+	if (idx >= index.size())
+		index.resize(idx + 1, nullptr);
+	if (!index[idx]) {
+		states.emplace_back();
+		index[idx] = &states.back();
+	}
+	return index[idx];
+}
+
+void ResourceStateView::AddUsed(std::vector<uint32_t> const & entries,
+				uint32_t gen, int64_t amount)
+{
+	if (gen != index_gen)
+		return;
+	for (auto entry_id : entries) {
+		if (entry_id >= used_sums.size())
+			used_sums.resize(entry_id + 1, 0);
+		used_sums[entry_id] += amount;
+	}
+}
+
 /*****************************************************************************
  * class Resource
  *****************************************************************************/
 
+/** Next free index of the resource states in the views */
+static std::atomic<uint32_t> next_state_idx(0);
+
 Resource::Resource(br::ResourceType type, BBQUE_RID_TYPE id, uint64_t tot) :
     br::ResourceIdentifier(type, id),
     total(tot),
-    reserved(0)
+    reserved(0),
+    state_idx(next_state_idx++)
 {
 	name = std::string(GetResourceTypeString(type)) + std::to_string(id);
 
@@ -141,11 +190,14 @@ uint64_t Resource::UsedBy(SchedPtr_t const & papp, RViewToken_t view_id) const
 uint64_t Resource::Acquire(SchedPtr_t const & papp, uint64_t amount,
 			   RViewToken_t view_id)
 {
-	ResourceStatePtr_t view(GetStateView(view_id));
-	if (!view) {
-		view = std::make_shared<ResourceState>();
-		state_views[view_id] = view;
+	ResourceAccounter & ra(ResourceAccounter::GetInstance());
+	ResourceStateViewPtr_t state_view(ra.GetStateView(view_id));
+	if (!state_view) {
+		DB(fprintf(stderr, FD("Resource {%s}: cannot find view %" PRIu64 "\n"),
+			name.c_str(), view_id));
+		return 0;
 	}
+	ResourceState * view = state_view->GetOrCreate(state_idx);
 
 	// Try to set the new "used" value
 	uint64_t fut_used = view->used + amount;
@@ -155,31 +207,30 @@ uint64_t Resource::Acquire(SchedPtr_t const & papp, uint64_t amount,
 	// Set new used value and application that requested the resource
 	view->used = fut_used;
 	view->apps[papp->Uid()] = amount;
+	state_view->AddUsed(index_entries, index_gen, amount);
 	return amount;
 }
 
 uint64_t Resource::Release(SchedPtr_t const & papp, RViewToken_t view_id)
 {
-	ResourceStatePtr_t view(GetStateView(view_id));
-	if (!view) {
-		DB(fprintf(stderr,
-			FD("Resource {%s}: cannot find view %" PRIu64 "\n"),
-			name.c_str(), view_id));
-		return 0;
-	}
-	return Release(papp->Uid(), view);
+	return Release(papp->Uid(), view_id);
 }
 
 uint64_t Resource::Release(AppUid_t app_uid, RViewToken_t view_id)
 {
-	ResourceStatePtr_t view(GetStateView(view_id));
+	ResourceAccounter & ra(ResourceAccounter::GetInstance());
+	ResourceStateViewPtr_t state_view(ra.GetStateView(view_id));
+	ResourceState * view = state_view ? state_view->Get(state_idx) : nullptr;
 	if (!view) {
 		DB(fprintf(stderr,
 			FD("Resource {%s}: cannot find view %" PRIu64 "\n"),
 			name.c_str(), view_id));
 		return 0;
 	}
-	return Release(app_uid, view);
+
+	uint64_t released = Release(app_uid, ResourceStatePtr_t(state_view, view));
+	state_view->AddUsed(index_entries, index_gen, -static_cast<int64_t>(released));
+	return released;
 }
 
 uint64_t Resource::Release(AppUid_t app_uid, ResourceStatePtr_t view)
@@ -201,15 +252,6 @@ uint64_t Resource::Release(AppUid_t app_uid, ResourceStatePtr_t view)
 	return used_by_app;
 }
 
-void Resource::DeleteView(RViewToken_t view_id)
-{
-	ResourceAccounter & ra(ResourceAccounter::GetInstance());
-	// Avoid to delete the default view
-	if (view_id == ra.GetSystemView())
-		return;
-	state_views.erase(view_id);
-}
-
 uint16_t Resource::ApplicationsCount(AppUsageQtyMap_t & apps_map, RViewToken_t view_id) const
 {
 	ResourceStatePtr_t view(GetStateView(view_id));
@@ -243,16 +285,17 @@ uint64_t Resource::UsedBy(SchedPtr_t const & papp, AppUsageQtyMap_t & apps_map)
 ResourceStatePtr_t Resource::GetStateView(RViewToken_t view_id) const
 {
 	ResourceAccounter & ra(ResourceAccounter::GetInstance());
-	// Default view if token = 0
-	if (view_id == 0)
-		view_id = ra.GetSystemView();
+	// Default view if token = 0 (resolved by the accounter)
+	ResourceStateViewPtr_t state_view(ra.GetStateView(view_id));
+	if (!state_view)
+		return nullptr;
 
-	// Retrieve the view from hash map otherwise
-	auto it = state_views.find(view_id);
-	if (it != state_views.end())
-		return it->second;
+	ResourceState * state = state_view->Get(state_idx);
+	if (!state)
+		return nullptr;
 
-	return nullptr;
+	// The returned pointer shares the ownership of the whole view
+	return ResourceStatePtr_t(state_view, state);
 }
 
 #ifdef CONFIG_BBQUE_PM
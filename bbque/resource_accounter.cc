@@ -35,6 +35,7 @@
 #include "bbque/process_manager.h"
 #include "bbque/res/resource_path.h"
 #include "bbque/utils/schedlog.h"
+#include "bbque/utils/tracer.h"
 
 #undef  MODULE_CONFIG
 #define MODULE_CONFIG "ResourceAccounter"
@@ -62,17 +63,21 @@ ResourceAccounter::ResourceAccounter() :
     am(ApplicationManager::GetInstance()),
     cm(CommandManager::GetInstance()),
     fm(ConfigurationManager::GetInstance()),
-    status(State::NOT_READY)
+    status(State::NOT_READY),
+    sys_view_gen(0)
 {
 	// Get a logger
 	logger = bu::Logger::GetLogger(RESOURCE_ACCOUNTER_NAMESPACE);
 	assert(logger);
 
 	// Init the system resources state view
-	sys_assign_view = std::make_shared<AppAssignmentsMap_t>();
-	sys_view_token  = 0;
-	assign_per_views[sys_view_token] = sys_assign_view;
-	rsrc_per_views[sys_view_token]   = std::make_shared<ResourceSet_t>();
+	sys_view_token = 0;
+	assign_per_views[sys_view_token] = std::make_shared<AppAssignmentsMap_t>();
+	state_per_views[sys_view_token]  =
+		std::make_shared<br::ResourceStateView>(sys_view_token);
+	PublishSystemView(sys_view_token,
+		state_per_views[sys_view_token],
+		assign_per_views[sys_view_token]);
 
 	// Init sync session info
 	sync_ssn.count = 0;
@@ -92,7 +97,7 @@ ResourceAccounter::~ResourceAccounter()
 	resources.clear();
 	resource_set.clear();
 	assign_per_views.clear();
-	rsrc_per_views.clear();
+	state_per_views.clear();
 	per_type_resource_ids.clear();
 }
 
@@ -106,6 +111,8 @@ void ResourceAccounter::SetPlatformReady()
 	while (status == State::SYNC) {
 		status_cv.wait(status_ul);
 	}
+	// Precompute the resource paths matchings
+	resources.build_index();
 	status = State::READY;
 	status_cv.notify_all();
 	PrintCountPerType();
@@ -123,6 +130,10 @@ void ResourceAccounter::SetPlatformNotReady()
 
 void ResourceAccounter::WaitForPlatformReady()
 {
+	// Fast path: no locking if already ready
+	if (status.load() == State::READY)
+		return;
+
 	std::unique_lock<std::mutex> status_ul(status_mtx);
 	while (status != State::READY) {
 		status_cv.wait(status_ul);
@@ -353,6 +364,7 @@ bool ResourceAccounter::ExistResource(ResourcePathPtr_t resource_path_ptr) const
 
 ResourcePathPtr_t const ResourceAccounter::GetPath(std::string const & strpath)
 {
+	std::unique_lock<std::mutex> paths_ul(paths_mtx);
 	auto rp_it = resource_paths.find(strpath);
 	if (rp_it == resource_paths.end()) {
 		// Create a new resource path object
@@ -423,8 +435,7 @@ uint64_t ResourceAccounter::Total(br::ResourcePtrList_t & resources_list) const
 uint64_t ResourceAccounter::Total(ResourcePathPtr_t resource_path_ptr,
 				  PathClass_t rpc) const
 {
-	br::ResourcePtrList_t matchings(GetList(resource_path_ptr, rpc));
-	return QueryStatus(matchings, RA_TOTAL, 0);
+	return QueryStatus(resource_path_ptr, rpc, RA_TOTAL, 0);
 }
 
 uint64_t ResourceAccounter::Used(std::string const & path,
@@ -446,8 +457,7 @@ uint64_t ResourceAccounter::Used(ResourcePathPtr_t resource_path_ptr,
 				 PathClass_t rpc,
 				 br::RViewToken_t status_view) const
 {
-	br::ResourcePtrList_t matchings(GetList(resource_path_ptr, rpc));
-	return QueryStatus(matchings, RA_USED, status_view);
+	return QueryStatus(resource_path_ptr, rpc, RA_USED, status_view);
 }
 
 uint64_t ResourceAccounter::UsedBy(std::string const & path,
@@ -472,8 +482,7 @@ uint64_t ResourceAccounter::UsedBy(ResourcePathPtr_t resource_path_ptr,
 				   PathClass_t rpc,
 				   br::RViewToken_t status_view) const
 {
-	br::ResourcePtrList_t matchings(GetList(resource_path_ptr, rpc));
-	return QueryStatus(matchings, RA_USED_BY, status_view, papp);
+	return QueryStatus(resource_path_ptr, rpc, RA_USED_BY, status_view, papp);
 }
 
 uint64_t ResourceAccounter::Available(std::string const & path,
@@ -498,8 +507,7 @@ uint64_t ResourceAccounter::Available(ResourcePathPtr_t resource_path_ptr,
 				      br::RViewToken_t status_view,
 				      ba::SchedPtr_t papp) const
 {
-	br::ResourcePtrList_t matchings(GetList(resource_path_ptr, rpc));
-	return QueryStatus(matchings, RA_AVAIL, status_view, papp);
+	return QueryStatus(resource_path_ptr, rpc, RA_AVAIL, status_view, papp);
 }
 
 uint64_t ResourceAccounter::Unreserved(std::string const & path)
@@ -519,8 +527,7 @@ ResourceAccounter::Unreserved(br::ResourcePtrList_t & resources_list) const
 uint64_t
 ResourceAccounter::Unreserved(ResourcePathPtr_t resource_path_ptr) const
 {
-	br::ResourcePtrList_t matchings(GetList(resource_path_ptr, MIXED));
-	return QueryStatus(matchings, RA_UNRESERVED, 0);
+	return QueryStatus(resource_path_ptr, MIXED, RA_UNRESERVED, 0);
 }
 
 uint16_t ResourceAccounter::Count(ResourcePathPtr_t resource_path_ptr) const
@@ -546,6 +553,63 @@ ResourceAccounter::GetList(ResourcePathPtr_t resource_path_ptr,
 	return resources.find_list(*resource_path_ptr, RTFlags(rpc));
 }
 
+uint64_t
+ResourceAccounter::QueryStatus(ResourcePathPtr_t resource_path_ptr,
+			       PathClass_t rpc,
+			       QueryOption_t _att,
+			       br::RViewToken_t status_view,
+			       ba::SchedPtr_t papp) const
+{
+	if (!resource_path_ptr)
+		return 0;
+
+	// Precomputed matchings: no list to build. Tree nodes have unique
+	// paths, thus an exact matching returns the first one only
+	uint16_t match_flags = RTFlags(rpc) & ~RT_MATCH_FIRST;
+	if (rpc == UNDEFINED)
+		match_flags = resource_path_ptr->IsTemplate() ?
+			RT_MATCH_TYPE : RT_MATCH_MIXED;
+	auto entry = resources.find_entry(*resource_path_ptr, match_flags);
+	if (entry) {
+		// Aggregated amounts, if not application specific
+		uint64_t used;
+		switch (_att) {
+		case RA_TOTAL:
+			return entry->total;
+		case RA_UNRESERVED:
+			if (entry->offline_count == 0)
+				return entry->unreserved;
+			break;
+		case RA_USED:
+			if (GetAggregatedUsed(entry, status_view, used))
+				return used;
+			break;
+		case RA_AVAIL:
+			if (!papp && (entry->offline_count == 0)
+					&& GetAggregatedUsed(entry, status_view, used))
+				return entry->unreserved - used;
+			break;
+		default:
+			break;
+		}
+		return QueryStatus(entry->resources, _att, status_view, papp);
+	}
+
+	br::ResourcePtrList_t matchings(GetList(resource_path_ptr, rpc));
+	return QueryStatus(matchings, _att, status_view, papp);
+}
+
+bool ResourceAccounter::GetAggregatedUsed(
+		br::ResourceTree::IndexEntry_t const * entry,
+		br::RViewToken_t status_view,
+		uint64_t & used) const
+{
+	auto state_view = GetStateView(status_view);
+	if (!state_view)
+		return false;
+	return state_view->GetUsed(entry->id, resources.index_generation(), used);
+}
+
 uint64_t
 ResourceAccounter::QueryStatus(br::ResourcePtrList_t const & resources_list,
 			       QueryOption_t _att,
@@ -714,12 +778,13 @@ ResourceAccounter::GetAppAssignmentsByView(br::RViewToken_t status_view,
 	// Get the map of all the Apps/EXCs resource assignments
 	// (default system resource state view)
 	if (status_view == 0) {
-		assert(sys_assign_view);
-		apps_assign = sys_assign_view;
+		apps_assign = LoadSystemView()->assignments;
+		assert(apps_assign);
 		return RA_SUCCESS;
 	}
 
 	// "Alternate" state view
+	std::unique_lock<std::mutex> views_ul(views_mtx);
 	auto view_it = assign_per_views.find(status_view);
 	if (view_it == assign_per_views.end()) {
 		logger->Error("GetAppAssignmentsByView:"
@@ -775,7 +840,9 @@ ResourceAccounter::RegisterResource(std::string const & strpath,
 
 	// Insert the path in the overall resource path set
 	resource_set.emplace(resource_ptr);
+	std::unique_lock<std::mutex> paths_ul(paths_mtx);
 	resource_paths.emplace(strpath, resource_path_ptr);
+	paths_ul.unlock();
 	per_arch_resource_path_list[GetArchTypeFromString(model)].push_back(resource_path_ptr);
 	path_max_len = std::max((int) path_max_len, (int) strpath.length());
 
@@ -823,8 +890,10 @@ ResourceAccounter::UpdateResource(std::string const & _path,
 	SetState(State::NOT_READY);
 
 	// If the required amount is <= 1, the resource is off-lined
-	if (_amount == 0)
+	if (_amount == 0) {
 		resource_ptr->SetOffline();
+		resources.refresh_index(*resource_ptr);
+	}
 
 	// Check if the required amount is compliant with the total defined at
 	// registration time
@@ -841,6 +910,7 @@ ResourceAccounter::UpdateResource(std::string const & _path,
 	reserved = resource_ptr->Total() - availability;
 	ReserveResources(resource_path_ptr, reserved);
 	resource_ptr->SetOnline();
+	resources.refresh_index(*resource_ptr);
 
 	// Back to READY
 	SetState(State::READY);
@@ -866,6 +936,7 @@ ResourceAccounter::ReserveResources(ResourcePathPtr_t resource_path_ptr,
 
 	for (auto & r : resources_list) {
 		rresult = r->Reserve(amount);
+		resources.refresh_index(*r);
 		if (rresult != br::Resource::RS_SUCCESS) {
 			logger->Warn("Reservation: Exceeding value [%" PRIu64 "] for [%s]",
 				amount, resource_path_ptr->ToString().c_str());
@@ -915,6 +986,7 @@ ResourceAccounter::SetOffline(br::ResourcePathPtr_t path)
 
 	for (auto & resource_ptr : resources_list) {
 		resource_ptr->SetOffline();
+		resources.refresh_index(*resource_ptr);
 		logger->Debug("SetOffline: <%s> -> (virtual) offline",
 			resource_ptr->Path()->ToString().c_str());
 #ifdef CONFIG_BBQUE_PM
@@ -946,6 +1018,7 @@ ResourceAccounter::SetOnline(br::ResourcePathPtr_t path)
 
 	for (auto & resource_ptr : resources_list) {
 		resource_ptr->SetOnline();
+		resources.refresh_index(*resource_ptr);
 		logger->Debug("SetOnline: <%s> -> online",
 			resource_ptr->Path()->ToString().c_str());
 #ifdef CONFIG_BBQUE_PM
@@ -1050,15 +1123,18 @@ ResourceAccounter::_GetView(std::string const & req_path, br::RViewToken_t & tok
 		logger->Error("GetView: Missing a valid string");
 		return RA_ERR_MISS_PATH;
 	}
+	BBQUE_TRACE_SPAN_LABEL("ra.get_view", req_path.c_str());
 
 	// Token
 	token = std::hash<std::string>()(req_path);
 	logger->Debug("GetView: new resource state view token = %ld", token);
 
 	// Allocate a new view for the applications resource assignments
+	std::unique_lock<std::mutex> views_ul(views_mtx);
 	assign_per_views.emplace(token, std::make_shared<AppAssignmentsMap_t>());
-	//Allocate a new view for the set of resources allocated
-	rsrc_per_views.emplace(token, std::make_shared<ResourceSet_t>());
+	// Allocate a new (empty) view for the state of the resources
+	state_per_views.emplace(token, std::make_shared<br::ResourceStateView>(
+		token, resources.index_generation()));
 
 	return RA_SUCCESS;
 }
@@ -1079,27 +1155,26 @@ ResourceAccounter::_PutView(br::RViewToken_t status_view)
 		return RA_ERR_UNAUTH_VIEW;
 	}
 
-	// Get the resource set using the referenced view
-	ResourceViewsMap_t::iterator rviews_it(rsrc_per_views.find(status_view));
-	if (rviews_it == rsrc_per_views.end()) {
+	// Get the resource states of the referenced view
+	std::unique_lock<std::mutex> views_ul(views_mtx);
+	ResourceViewsMap_t::iterator rviews_it(state_per_views.find(status_view));
+	if (rviews_it == state_per_views.end()) {
 		logger->Warn("PutView: cannot find resource view token %ld", status_view);
 		return RA_ERR_MISS_VIEW;
 	}
+	logger->Debug("PutView: [%ld] releasing %d resource states",
+		status_view, rviews_it->second->TouchedCount());
 
-	// For each resource delete the view
-	for (auto & resource_set : * (rviews_it->second))
-		resource_set->DeleteView(status_view);
-
-	// Remove the map of Apps/EXCs resource assignments and the resource reference
-	// set of this view
+	// Remove the map of Apps/EXCs resource assignments and the resource states
+	// of this view
 	assign_per_views.erase(status_view);
-	rsrc_per_views.erase(status_view);
+	state_per_views.erase(rviews_it);
 
 	logger->Debug("PutView: [%ld] cleared view", status_view);
-	logger->Debug("PutView: [%ld] currently managed {resource sets = %ld, "
+	logger->Debug("PutView: [%ld] currently managed {state views = %ld, "
 		" assign_map = %d}",
 		status_view,
-		rsrc_per_views.size(),
+		state_per_views.size(),
 		assign_per_views.erase(status_view));
 
 	return RA_SUCCESS;
@@ -1113,6 +1188,7 @@ br::RViewToken_t ResourceAccounter::SetView(br::RViewToken_t status_view)
 
 br::RViewToken_t ResourceAccounter::_SetView(br::RViewToken_t status_view)
 {
+	std::unique_lock<std::mutex> sys_view_ul(sys_view_mtx);
 	br::RViewToken_t old_sys_status_view;
 
 	// Do nothing if the token references the system state view
@@ -1124,30 +1200,119 @@ br::RViewToken_t ResourceAccounter::_SetView(br::RViewToken_t status_view)
 
 	// Set the system state view pointer to the map of applications resource
 	// usages of this view and point to
+	std::unique_lock<std::mutex> views_ul(views_mtx);
 	AppAssignmentsViewsMap_t::iterator assign_view_it(assign_per_views.find(status_view));
 	if (assign_view_it == assign_per_views.end()) {
 		logger->Fatal("SetView: [%ld] unknown view", status_view);
 		return sys_view_token;
 	}
 
-	// Save the old view token, update the system state view token and the map
-	// of Apps/EXCs resource assignments
+	ResourceViewsMap_t::iterator state_view_it(state_per_views.find(status_view));
+	if (state_view_it == state_per_views.end()) {
+		logger->Fatal("SetView: [%ld] missing resource states", status_view);
+		return sys_view_token;
+	}
+
+	// Save the old view token, update the system state view token, the
+	// resource states and the map of Apps/EXCs resource assignments
 	old_sys_status_view = sys_view_token;
 	sys_view_token      = status_view;
-	sys_assign_view     = assign_view_it->second;
+	PublishSystemView(status_view,
+		state_view_it->second, assign_view_it->second);
+	views_ul.unlock();
 
 	// Put the old view
 	_PutView(old_sys_status_view);
 
 	logger->Info("SetView: [%ld] is the new system state view.", sys_view_token);
-	logger->Debug("SetView: [%ld] currently managed {resource sets = %ld,"
+	views_ul.lock();
+	logger->Debug("SetView: [%ld] currently managed {state views = %ld,"
 		" assign_map = %d}",
 		sys_view_token,
-		rsrc_per_views.size(),
+		state_per_views.size(),
 		assign_per_views.erase(status_view));
 	return sys_view_token;
 }
 
+void ResourceAccounter::PublishSystemView(br::RViewToken_t tok,
+					  br::ResourceStateViewPtr_t states,
+					  AppAssignmentsMapPtr_t assignments)
+{
+	auto snapshot = std::make_shared<SystemView_t>();
+	snapshot->token       = tok;
+	snapshot->states      = states;
+	snapshot->assignments = assignments;
+
+	// The previous snapshot (and its views) is reclaimed as soon as the
+	// last reader holding it is done
+	std::atomic_store(&sys_view,
+		std::shared_ptr<SystemView_t const>(std::move(snapshot)));
+	sys_view_gen.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<ResourceAccounter::SystemView_t const>
+ResourceAccounter::LoadSystemView() const
+{
+	static thread_local std::shared_ptr<SystemView_t const> snapshot;
+	static thread_local uint64_t snapshot_gen = 0;
+
+	// Load the snapshot again only if a new one has been published. A
+	// reader racing with the publication gets the previous one, which is
+	// still consistent.
+	uint64_t gen = sys_view_gen.load(std::memory_order_acquire);
+	if (!snapshot || (gen != snapshot_gen)) {
+		snapshot     = std::atomic_load(&sys_view);
+		snapshot_gen = gen;
+	}
+	return snapshot;
+}
+
+br::RViewToken_t ResourceAccounter::_CopySystemView()
+{
+	br::RViewToken_t copy_view =
+		std::hash<std::string>()(RESOURCE_ACCOUNTER_NAMESPACE ".sys_copy");
+	auto snapshot = LoadSystemView();
+
+	std::unique_lock<std::mutex> views_ul(views_mtx);
+	state_per_views[copy_view] = std::make_shared<br::ResourceStateView>(
+		*snapshot->states, snapshot->token);
+	assign_per_views[copy_view] = std::make_shared<AppAssignmentsMap_t>(
+		*snapshot->assignments);
+	logger->Debug("CopySystemView: [%ld] copied into [%ld]",
+		snapshot->token, copy_view);
+	return copy_view;
+}
+
+void ResourceAccounter::_PublishSystemViewCopy(br::RViewToken_t copy_view)
+{
+	std::unique_lock<std::mutex> views_ul(views_mtx);
+	br::ResourceStateViewPtr_t states(state_per_views[copy_view]);
+	AppAssignmentsMapPtr_t assignments(assign_per_views[copy_view]);
+	state_per_views.erase(copy_view);
+	assign_per_views.erase(copy_view);
+
+	// Replace the system view, keeping its token
+	state_per_views[sys_view_token]  = states;
+	assign_per_views[sys_view_token] = assignments;
+	PublishSystemView(sys_view_token, states, assignments);
+	logger->Debug("PublishSystemViewCopy: [%ld] updated", sys_view_token);
+}
+
+br::ResourceStateViewPtr_t
+ResourceAccounter::GetStateView(br::RViewToken_t view_id) const
+{
+	// System view: read the published snapshot
+	auto snapshot = LoadSystemView();
+	if ((view_id == 0) || (view_id == snapshot->token))
+		return snapshot->states;
+
+	std::unique_lock<std::mutex> views_ul(views_mtx);
+	auto view_it = state_per_views.find(view_id);
+	if (view_it == state_per_views.end())
+		return nullptr;
+	return view_it->second;
+}
+
 void ResourceAccounter::SetScheduledView(br::RViewToken_t svt)
 {
 	// Update the new scheduled view
@@ -1346,6 +1511,7 @@ ResourceAccounter::BookResources(ba::SchedPtr_t papp,
 		logger->Fatal("Booking: application descriptor null pointer");
 		return RA_ERR_MISS_APP;
 	}
+	BBQUE_TRACE_SPAN_LABEL("ra.book", papp->StrId());
 
 	// Check that the set of resource assignments is not null
 	if ((!assign_map) || (assign_map->empty())) {
@@ -1364,6 +1530,21 @@ ResourceAccounter::BookResources(ba::SchedPtr_t papp,
 		}
 	}
 
+	// Booking on the system view: the published snapshot is not modified,
+	// a copy of it is updated and then published
+	if ((status_view == 0) || (status_view == GetSystemView())) {
+		std::unique_lock<std::mutex> sys_view_ul(sys_view_mtx);
+		if ((status_view == 0) || (status_view == sys_view_token)) {
+			br::RViewToken_t copy_view = _CopySystemView();
+			ExitCode_t result = IncBookingCounts(assign_map, papp, copy_view);
+			if (result == RA_SUCCESS)
+				_PublishSystemViewCopy(copy_view);
+			else
+				_PutView(copy_view);
+			return result;
+		}
+	}
+
 	// Increment the booking counts and save the reference to the resource set
 	// used by the application
 	return IncBookingCounts(assign_map, papp, status_view);
@@ -1378,7 +1559,7 @@ void ResourceAccounter::ReleaseResources(ba::SchedPtr_t papp,
 		return;
 	}
 
-	if (rsrc_per_views.find(status_view) == rsrc_per_views.end()) {
+	if (!ExistView(status_view)) {
 		logger->Debug("Release: resource state view already cleared");
 		return;
 	}
@@ -1388,8 +1569,20 @@ void ResourceAccounter::ReleaseResources(ba::SchedPtr_t papp,
 		_ReleaseResources(papp, sync_ssn.view);
 
 	// Decrease resources in the required view
-	if (status_view != sync_ssn.view)
-		_ReleaseResources(papp, status_view);
+	if (status_view == sync_ssn.view)
+		return;
+
+	// System view: release from a copy of it, and then publish the copy
+	std::unique_lock<std::mutex> sys_view_ul(sys_view_mtx);
+	if ((status_view == 0) || (status_view == sys_view_token)) {
+		br::RViewToken_t copy_view = _CopySystemView();
+		_ReleaseResources(papp, copy_view);
+		_PublishSystemViewCopy(copy_view);
+		return;
+	}
+	sys_view_ul.unlock();
+
+	_ReleaseResources(papp, status_view);
 }
 
 void ResourceAccounter::_ReleaseResources(ba::SchedPtr_t papp,
@@ -1425,15 +1618,13 @@ ResourceAccounter::IncBookingCounts(br::ResourceAssignmentMapPtr_t const & assig
 	logger->Debug("IncBooking: getting the assigned amount from view [%ld]...",
 		status_view);
 
-	// Get the set of resources referenced in the view
-	auto rsrc_view(rsrc_per_views.find(status_view));
-	assert(rsrc_view != rsrc_per_views.end());
-	if (rsrc_view == rsrc_per_views.end()) {
+	// Check the resource state view
+	assert(ExistView(status_view));
+	if (!ExistView(status_view)) {
 		logger->Fatal("IncBooking: invalid resource state view token [%ld]",
 			status_view);
 		return RA_ERR_MISS_VIEW;
 	}
-	auto & rsrc_set(rsrc_view->second);
 
 	// Get the map of resources used by the application (from the state view
 	// referenced by 'status_view').
@@ -1461,7 +1652,7 @@ ResourceAccounter::IncBookingCounts(br::ResourceAssignmentMapPtr_t const & assig
 			rsrc_path->ToString().c_str(), r_assign->GetAmount());
 
 		// Do booking for the current resource request
-		result = DoResourceBooking(papp, r_assign, status_view, rsrc_set);
+		result = DoResourceBooking(papp, r_assign, status_view);
 		if (result != RA_SUCCESS)  {
 			logger->Crit("IncBooking: [%s] unexpected fail! <%s> "
 				"[USG:%" PRIu64 " | AV:%" PRIu64 " | TOT:%" PRIu64 "]",
@@ -1492,8 +1683,7 @@ ResourceAccounter::IncBookingCounts(br::ResourceAssignmentMapPtr_t const & assig
 ResourceAccounter::ExitCode_t
 ResourceAccounter::DoResourceBooking(ba::SchedPtr_t const & papp,
 				     br::ResourceAssignmentPtr_t & r_assign,
-				     br::RViewToken_t status_view,
-				     ResourceSetPtr_t & rsrc_set)
+				     br::RViewToken_t status_view)
 {
 	// Amount of resource to book and list of resource descriptors
 	auto requested = r_assign->GetAmount();
@@ -1509,10 +1699,6 @@ ResourceAccounter::DoResourceBooking(ba::SchedPtr_t const & papp,
 		// Break if the required resource has been completely allocated
 		if (requested == 0)
 			break;
-		// Add the current resource binding to the set of resources used in
-		// the view referenced by 'status_view'
-		rsrc_set->insert(resource);
-
 		// Synchronization: booking according to scheduling decisions
 		if (Synching()) {
 			SyncResourceBooking(papp, resource, requested);
@@ -1606,20 +1792,18 @@ void ResourceAccounter::DecBookingCounts(br::ResourceAssignmentMapPtr_t const &
 	logger->Debug("DecCount: [%s] holds %d resources in view=[%ld]",
 		papp->StrId(), assign_map->size(), status_view);
 
-	// Get the set of resources referenced in the view
-	ResourceViewsMap_t::iterator rsrc_view(rsrc_per_views.find(status_view));
-	if (rsrc_view == rsrc_per_views.end()) {
+	// Check the resource state view
+	if (!ExistView(status_view)) {
 		logger->Fatal("DecCount: invalid resource state view: [%ld]", status_view);
 		return;
 	}
-	auto & rsrc_set(rsrc_view->second);
 
 	// Release the all the resources hold by the Application/EXC
 	for (auto & ru_entry : * (assign_map.get())) {
 		br::ResourcePathPtr_t const & rsrc_path(ru_entry.first);
 		br::ResourceAssignmentPtr_t & r_assign(ru_entry.second);
 		// Release the resources bound to the current request
-		ra_result = UndoResourceBooking(papp, r_assign, status_view, rsrc_set);
+		ra_result = UndoResourceBooking(papp, r_assign, status_view);
 		if (ra_result == RA_ERR_MISS_VIEW)
 			return;
 		logger->Debug("DecCount: [%s] has freed {%s} of %" PRIu64 "",
@@ -1631,8 +1815,7 @@ void ResourceAccounter::DecBookingCounts(br::ResourceAssignmentMapPtr_t const &
 ResourceAccounter::ExitCode_t
 ResourceAccounter::UndoResourceBooking(ba::SchedPtr_t const & papp,
 				       br::ResourceAssignmentPtr_t & r_assign,
-				       br::RViewToken_t status_view,
-				       ResourceSetPtr_t & rsrc_set)
+				       br::RViewToken_t status_view)
 {
 	// Keep track of the amount of resource freed
 	uint64_t usage_freed = 0;
@@ -1645,11 +1828,6 @@ ResourceAccounter::UndoResourceBooking(ba::SchedPtr_t const & papp,
 
 		// Release the quantity hold by the Application/EXC
 		usage_freed += rsrc->Release(papp, status_view);
-
-		// If no more applications are using this resource, remove it from
-		// the set of resources referenced in the resource state view
-		if ((rsrc_set) && (rsrc->ApplicationsCount() == 0))
-			rsrc_set->erase(rsrc);
 	}
 	assert(usage_freed == r_assign->GetAmount());
 	return RA_SUCCESS;
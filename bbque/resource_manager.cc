@@ -20,6 +20,7 @@
 
 #include "bbque/configuration_manager.h"
 #include "bbque/signals_manager.h"
+#include "bbque/utils/tracer.h"
 #include "bbque/utils/utility.h"
 
 #ifdef CONFIG_BBQUE_WM
@@ -90,6 +91,7 @@ ResourceManager::metrics[RM_METRICS_COUNT] = {
 	RM_COUNTER_METRIC("sch.failed",	"  FAILED  schedules"),
 	RM_COUNTER_METRIC("sch.delayed", "  DELAYED schedules"),
 	RM_COUNTER_METRIC("sch.empty",	"  EMPTY   schedules"),
+	RM_COUNTER_METRIC("sch.coalesced", "  COALESCED schedules"),
 
 	RM_COUNTER_METRIC("syn.tot",	"Total Synchronization activations"),
 	RM_COUNTER_METRIC("syn.failed",	"  FAILED synchronizations"),
@@ -197,6 +199,11 @@ ResourceManager::Setup()
 	po::variables_map opts_vm;
 	cm.ParseConfigurationFile(opts_desc, opts_vm);
 
+#ifdef CONFIG_BBQUE_TRACING
+	//---------- Register the tracing commands
+	bu::Tracer::GetInstance();
+#endif
+
 	//---------- Dump list of registered plugins
 	const bp::PluginManager::RegistrationMap & rm = um.GetRegistrationMap();
 	logger->Info("RM: Registered plugins:");
@@ -328,14 +335,81 @@ void ResourceManager::TerminateWorkers()
 		workers_map.empty() ? "Yes" : "No");
 }
 
-void ResourceManager::Optimize()
+void ResourceManager::ScheduleOptimization(milliseconds timeout)
 {
-	static bu::Timer optimization_tmr;
-	double period;
+#ifdef CONFIG_BBQUE_RM_COALESCED
+	std::unique_lock<std::mutex> status_ul(status_mtx);
+	if (!is_ready) {
+		logger->Debug("ScheduleOptimization: optimization in progress, "
+			"new run coalesced");
+		resched_pending = true;
+		return;
+	}
+	status_ul.unlock();
+#endif
+	optimize_dfr.Schedule(timeout);
+}
+
+#ifdef CONFIG_BBQUE_RM_COALESCED
+
+bool ResourceManager::CoalesceNextRun(uint16_t runs)
+{
+	bool overrun = false;
+	std::unique_lock<std::mutex> status_ul(status_mtx);
+
+	if (resched_pending) {
+		resched_pending = false;
+		if (runs < BBQUE_RM_OPT_COALESCE_MAX_RUNS) {
+			logger->Info("CoalesceNextRun: new run [%d] requested",
+				runs + 1);
+			RM_COUNT_EVENT(metrics, RM_SCHED_COALESCED);
+			return true;
+		}
+		overrun = true;
+	}
+
+	// Ready again for processing next events
+	is_ready = true;
+	status_cv.notify_all();
+	status_ul.unlock();
+	logger->Debug("CoalesceNextRun: optimization terminated");
+
+	// Do not starve the threads waiting for the end of the optimization
+	if (overrun) {
+		logger->Warn("CoalesceNextRun: %d runs limit reached, "
+			"deferring the pending request", runs);
+		NotifyEvent(BBQ_OPTS);
+	}
 
+	return false;
+}
+
+#endif // CONFIG_BBQUE_RM_COALESCED
+
+void ResourceManager::Optimize()
+{
 	// Locking mechanism
 	SetReady(false);
 
+#ifdef CONFIG_BBQUE_RM_COALESCED
+	uint16_t runs = 0;
+	do {
+		OptimizeRun();
+	} while (CoalesceNextRun(++runs));
+#else
+	OptimizeRun();
+
+	// Ready again for processing next events
+	SetReady(true);
+#endif
+}
+
+void ResourceManager::OptimizeRun()
+{
+	static bu::Timer optimization_tmr;
+	double period;
+	BBQUE_TRACE_SPAN("rm.optimize");
+
 	if (this->plat_event) {
 		logger->Debug("Optimize: execution triggered by a platform event");
 		this->plat_event = false;
@@ -370,12 +444,10 @@ void ResourceManager::Optimize()
 			logger->Warn("Optimize: scheduling FAILED "
 				"(Error: scheduling policy failed)");
 			RM_COUNT_EVENT(metrics, RM_SCHED_FAILED);
-			SetReady(true);
 			return;
 		case SchedulerManager::DELAYED:
 			logger->Error("Optimize: scheduling DELAYED");
 			RM_COUNT_EVENT(metrics, RM_SCHED_DELAYED);
-			SetReady(true);
 			return;
 		default:
 			assert(sched_result == SchedulerManager::DONE);
@@ -452,9 +524,6 @@ void ResourceManager::Optimize()
 	eym.StartSamplingResourceConsumption();
 #endif
 
-	// Ready again for processing next events
-	SetReady(true);
-
 #ifdef CONFIG_BBQUE_DM
 	dm.NotifyUpdate(stat::EVT_SCHEDULING);
 #endif
@@ -606,7 +675,7 @@ void ResourceManager::EvtExcStart()
 	}
 
 	unsigned int timeout = BBQUE_RM_OPT_EXC_START_DEFER_MS;
-	optimize_dfr.Schedule(milliseconds(timeout));
+	ScheduleOptimization(milliseconds(timeout));
 
 	RM_GET_TIMING(metrics, RM_EVT_TIME_START, rm_tmr);
 }
@@ -618,7 +687,7 @@ void ResourceManager::EvtExcStop()
 
 	// This is a simple optimization triggering policy
 	unsigned int timeout = BBQUE_RM_OPT_EXC_STOP_DEFER_MS;
-	optimize_dfr.Schedule(milliseconds(timeout));
+	ScheduleOptimization(milliseconds(timeout));
 
 	RM_GET_TIMING(metrics, RM_EVT_TIME_STOP, rm_tmr);
 }
@@ -633,7 +702,7 @@ void ResourceManager::EvtBbqPlat()
 	// TODO add a better policy which triggers immediate rescheduling only
 	// on resources reduction. Perhaps such a policy could be plugged into
 	// the PlatformProxy module.
-	optimize_dfr.Schedule();
+	ScheduleOptimization();
 
 	// Collecing execution metrics
 	RM_GET_TIMING(metrics, RM_EVT_TIME_PLAT, rm_tmr);
@@ -648,7 +717,7 @@ void ResourceManager::EvtBbqOpts()
 	// default just to increase the chance for aggregation of multiple
 	// requests
 	unsigned int timeout = BBQUE_RM_OPT_REQUEST_DEFER_MS;
-	optimize_dfr.Schedule(milliseconds(timeout));
+	ScheduleOptimization(milliseconds(timeout));
 
 	RM_GET_TIMING(metrics, RM_EVT_TIME_OPTS, rm_tmr);
 }
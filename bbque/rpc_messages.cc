@@ -53,6 +53,8 @@ const char *RPC_messageStr[] = {
 	"ERunt",
 	//RPC_EXC_UNREGISTER
 	"EUnreg",
+	//RPC_EXC_RTNOTIFY_BATCH
+	"ERuntB",
 	//RPC_EXC_RESP
 	"EResp",
 	//RPC_EXC_MSGS_COUNT
@@ -237,6 +237,12 @@ void RPCProxy::Task() {
 			SignalPoll();
 			continue;
 		}
+		// Messages not valid are discarded by the channel
+		if (size < 0) {
+			logger->Warn("Task: message receive FAILED (Error %d: %s)",
+				(int)-size, strerror(-size));
+			continue;
+		}
 		assert(msg);
 		logger->Debug("Task: RX [typ: %2d, sze: %3d]",
 				msg->typ, size);
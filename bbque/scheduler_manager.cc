@@ -22,6 +22,7 @@
 #include "bbque/modules_factory.h"
 #include "bbque/system.h"
 
+#include "bbque/utils/tracer.h"
 #include "bbque/utils/utility.h"
 
 // The prefix for configuration file attributes
@@ -159,6 +160,7 @@ SchedulerManager::CollectStats()
 SchedulerManager::ExitCode_t
 SchedulerManager::Schedule()
 {
+	BBQUE_TRACE_SPAN("sm.schedule");
 
 	if (!policy) {
 		logger->Crit("Resource scheduling FAILED (Error: missing policy)");
@@ -196,7 +198,11 @@ SchedulerManager::Schedule()
 
 	logger->Notice("Scheduling [%d] START, policy [%s]",
 		sched_count, policy->Name());
-	SchedulerPolicyIF::ExitCode result = policy->Schedule(sv, sched_view_id);
+	SchedulerPolicyIF::ExitCode result;
+	{
+		BBQUE_TRACE_SPAN("sm.policy");
+		result = policy->Schedule(sv, sched_view_id);
+	}
 	if (result != SchedulerPolicyIF::SCHED_DONE) {
 		logger->Error("Scheduling [%d] FAILED: error=%d",
 			sched_count, result);
@@ -231,6 +237,8 @@ SchedulerManager::Schedule()
 
 void SchedulerManager::CommitRunningApplications()
 {
+	BBQUE_TRACE_SPAN("sm.commit");
+
 	// Running (AEM) applications
 	AppsUidMapIt apps_it;
 	AppPtr_t papp = am.GetFirst(Schedulable::RUNNING, apps_it);
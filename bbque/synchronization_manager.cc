@@ -27,6 +27,7 @@
 #include "bbque/app/application.h"
 #include "bbque/app/working_mode.h"
 
+#include "bbque/utils/tracer.h"
 #include "bbque/utils/utility.h"
 
 // The prefix for configuration file attributes
@@ -178,6 +179,7 @@ SynchronizationManager::Sync_PreChange(Schedulable::SyncState_t syncState)
 	RspMap_t rsp_map;
 	AppPtr_t papp;
 
+	BBQUE_TRACE_SPAN("ym.prechange");
 	logger->Debug("Sync_PreChange: STEP 1 => START");
 	SM_RESET_TIMING(sm_tmr);
 
@@ -194,6 +196,7 @@ SynchronizationManager::Sync_PreChange(Schedulable::SyncState_t syncState)
 		}
 
 		logger->Debug("Sync_PreChange: STEP 1 => [%s]", papp->StrId());
+		BBQUE_TRACE_SPAN_LABEL("ym.prechange.exc", papp->StrId());
 
 		// Do the minimum for disabled applications
 		if (papp->Disabled()) {
@@ -323,6 +326,7 @@ SynchronizationManager::Sync_SyncChange(Schedulable::SyncState_t syncState)
 	RspMap_t rsp_map;
 	AppPtr_t papp;
 
+	BBQUE_TRACE_SPAN("ym.syncchange");
 	logger->Debug("Sync_SyncChange: STEP 2 => START");
 	SM_RESET_TIMING(sm_tmr);
 
@@ -337,6 +341,7 @@ SynchronizationManager::Sync_SyncChange(Schedulable::SyncState_t syncState)
 			continue;
 
 		logger->Debug("Sync_SyncChange: STEP 2 => [%s]", papp->StrId());
+		BBQUE_TRACE_SPAN_LABEL("ym.syncchange.exc", papp->StrId());
 
 		// Jumping meanwhile disabled applications
 		if (papp->Disabled()) {
@@ -446,6 +451,7 @@ SynchronizationManager::Sync_DoChange(Schedulable::SyncState_t syncState)
 
 	RTLIB_ExitCode_t result;
 
+	BBQUE_TRACE_SPAN("ym.dochange");
 	logger->Debug("Sync_DoChange: STEP 3 => START");
 	SM_RESET_TIMING(sm_tmr);
 
@@ -460,6 +466,7 @@ SynchronizationManager::Sync_DoChange(Schedulable::SyncState_t syncState)
 			continue;
 
 		logger->Debug("Sync_DoChange: STEP 3 => [%s]", papp->StrId());
+		BBQUE_TRACE_SPAN_LABEL("ym.dochange.exc", papp->StrId());
 
 		// Jumping meanwhile disabled applications
 		if (papp->Disabled()) {
@@ -491,6 +498,7 @@ SynchronizationManager::Sync_PostChange(Schedulable::SyncState_t syncState)
 	AppPtr_t papp;
 	uint8_t excs = 0;
 
+	BBQUE_TRACE_SPAN("ym.postchange");
 	logger->Debug("Sync_PostChange: STEP 4 => START");
 	SM_RESET_TIMING(sm_tmr);
 
@@ -529,6 +537,7 @@ SynchronizationManager::Sync_PostChange(Schedulable::SyncState_t syncState)
 
 void SynchronizationManager::SyncCommit(AppPtr_t papp)
 {
+	BBQUE_TRACE_SPAN_LABEL("ym.commit", papp->StrId());
 	logger->Debug("SyncCommit: [%s] is in %s/%s", papp->StrId(),
 		papp->StateStr(papp->State()),
 		papp->SyncStateStr(papp->SyncState()));
@@ -552,13 +561,16 @@ SynchronizationManager::ExitCode_t
 SynchronizationManager::Sync_Platform(Schedulable::SyncState_t syncState)
 {
 	ExitCode_t result;
-	bool at_least_one_success = false;
+	uint32_t nr_synced = 0;
 
+	BBQUE_TRACE_SPAN("ym.platform");
 	logger->Debug("Sync_Platform <%s>: START adaptive applications",
 		Schedulable::SyncStateStr(syncState));
 	SM_RESET_TIMING(sm_tmr);
 
-	// Enforce resource assignments to applications
+	// Enforce resource assignments to applications, all together at the
+	// end of the loop
+	plm.BeginMappings();
 	AppsUidMapIt apps_it;
 	AppPtr_t papp;
 	papp = am.GetFirst(syncState, apps_it);
@@ -579,28 +591,55 @@ SynchronizationManager::Sync_Platform(Schedulable::SyncState_t syncState)
 			sync_fails_apps.insert(papp);
 			continue;
 		}
-		else if (!at_least_one_success)
-			at_least_one_success = true;
+		++nr_synced;
 
 		logger->Debug("Sync_Platform <%s>: [%s] => OK",
 			papp->SyncStateStr(syncState),
 			papp->StrId());
 	}
 
+	for (auto & psched : CommitMappings()) {
+		logger->Error("Sync_Platform <%s>: [%s] failed [commit]",
+			Schedulable::SyncStateStr(syncState), psched->StrId());
+		sync_fails_apps.insert(std::static_pointer_cast<app::Application>(psched));
+		--nr_synced;
+	}
+
 	// Collecting execution metrics
 	SM_GET_TIMING_SYNCSTATE(metrics, SM_SYNCP_TIME_SYNCPLAT, sm_tmr, syncState);
 	logger->Debug("Sync_Platform <%s>: DONE with adaptive applications",
 		papp->SyncStateStr(syncState));
 
-	if (at_least_one_success)
+	if (nr_synced > 0)
 		return OK;
 	return PLATFORM_SYNC_FAILED;
 }
 
+std::vector<SchedPtr_t> SynchronizationManager::CommitMappings()
+{
+	std::vector<SchedPtr_t> failed;
+	std::vector<SchedPtr_t> sync_failed;
+	BBQUE_TRACE_SPAN("ym.commit_mappings");
+
+	plm.CommitMappings(failed);
+	for (auto & psched : failed) {
+		// Terminated in the meanwhile: not a synchronization failure
+		if (kill(psched->Pid(), 0) != 0) {
+			logger->Debug("CommitMappings: [%s] mapping failed, "
+				"but no longer running", psched->StrId());
+			continue;
+		}
+		sync_failed.push_back(psched);
+	}
+
+	return sync_failed;
+}
+
 SynchronizationManager::ExitCode_t
 SynchronizationManager::MapResources(SchedPtr_t papp)
 {
 	PlatformManager::ExitCode_t result = PlatformManager::PLATFORM_OK;
+	BBQUE_TRACE_SPAN_LABEL("ym.map", papp->StrId());
 	logger->Debug("MapResources <%s>: [%s] resource mapping...",
 		papp->SyncStateStr(papp->SyncState()),
 		papp->StrId());
@@ -755,8 +794,7 @@ SynchronizationManager::SyncSchedule()
 	ResourceAccounter::ExitCode_t raResult;
 	bu::Timer syncp_tmr;
 	ExitCode_t result;
-	// TODO add here proper tracing/monitoring events for statistics
-	// collection
+	BBQUE_TRACE_SPAN("ym.session");
 
 	// Update session count
 	++sync_count;
@@ -884,6 +922,7 @@ SynchronizationManager::SyncProcesses()
 SynchronizationManager::ExitCode_t
 SynchronizationManager::Sync_PostChangeForProcesses()
 {
+	BBQUE_TRACE_SPAN("ym.postchange");
 	logger->Debug("STEP 4.2: postChange() START: processes");
 
 	// Commit SYNC -> RUNNING
@@ -909,8 +948,9 @@ SynchronizationManager::ExitCode_t
 SynchronizationManager::Sync_PlatformForProcesses()
 {
 	ExitCode_t result;
-	bool at_least_one_success = false;
+	uint32_t nr_synced = 0;
 
+	BBQUE_TRACE_SPAN("ym.platform");
 	logger->Debug("STEP M.2: SyncPlatform() START: processes");
 	SM_RESET_TIMING(sm_tmr);
 
@@ -919,6 +959,7 @@ SynchronizationManager::Sync_PlatformForProcesses()
 		return NOTHING_TO_SYNC;
 	}
 
+	plm.BeginMappings();
 	ProcessMapIterator procs_it;
 	ProcPtr_t proc = prm.GetFirst(Schedulable::SYNC, procs_it);
 	for ( ; proc; proc = prm.GetNext(Schedulable::SYNC, procs_it)) {
@@ -928,20 +969,27 @@ SynchronizationManager::Sync_PlatformForProcesses()
 			sync_fails_procs.insert(proc);
 			continue;
 		}
-		else if (!at_least_one_success)
-			at_least_one_success = true;
+		++nr_synced;
 		logger->Info("STEP M.2: <--------- OK -- [%s]", proc->StrId());
 	}
 
+	for (auto & psched : CommitMappings()) {
+		logger->Error("STEP M.2: cannot synchronize application [%s] (commit)",
+			psched->StrId());
+		sync_fails_procs.insert(std::static_pointer_cast<app::Process>(psched));
+		--nr_synced;
+	}
+
 	// Collecting execution metrics
 	logger->Debug("STEP M.2: SyncPlatform() DONE: processes");
-	if (at_least_one_success)
+	if (nr_synced > 0)
 		return OK;
 	return PLATFORM_SYNC_FAILED;
 }
 
 void SynchronizationManager::SyncCommit(ProcPtr_t proc)
 {
+	BBQUE_TRACE_SPAN_LABEL("ym.commit", proc->StrId());
 	logger->Debug("SyncCommit: [%s] is in %s/%s", proc->StrId(),
 		proc->StateStr(proc->State()),
 		proc->SyncStateStr(proc->SyncState()));
@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bbque/utils/tracer.h"
+
+#include <cstdio>
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define TRACER_NAMESPACE "bq.tr"
+#define MODULE_NAMESPACE TRACER_NAMESPACE
+
+#define TRACER_DEFAULT_DUMP_FILE BBQUE_PATH_VAR "/bbque_trace.json"
+
+namespace bbque { namespace utils {
+
+/**
+ * @class TraceRing
+ * @brief The spans buffer of a thread
+ *
+ * Single producer (the owner thread) and single consumer (the dump). The
+ * producer never waits: the consumer copies the buffer and then drops the
+ * events which could have been overwritten meanwhile.
+ */
+class TraceRing {
+
+public:
+
+	explicit TraceRing(size_t capacity) :
+		events(capacity), mask(capacity - 1), head(0), in_use(true) {
+	}
+
+	/** Fixed size storage, a power of two */
+	std::vector<Tracer::Event_t> events;
+
+	size_t const mask;
+
+	/** The number of events recorded so far */
+	std::atomic<uint64_t> head;
+
+	/** True while owned by a running thread */
+	std::atomic<bool> in_use;
+
+	inline void Push(Tracer::Event_t const & event) {
+		uint64_t idx = head.load(std::memory_order_relaxed);
+		events[idx & mask] = event;
+		head.store(idx + 1, std::memory_order_release);
+	}
+
+	void Snapshot(std::vector<Tracer::Event_t> & out) const {
+		uint64_t capacity = events.size();
+		uint64_t last = head.load(std::memory_order_acquire);
+		uint64_t first = (last > capacity) ? last - capacity : 0;
+
+		std::vector<Tracer::Event_t> copy;
+		copy.reserve(last - first);
+		for (uint64_t i = first; i < last; ++i)
+			copy.push_back(events[i & mask]);
+
+		// Drop the events overwritten during the copy. The producer
+		// could be writing the slot of the next event too (of index
+		// "now"), which is the one of the event "now - capacity".
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t now = head.load(std::memory_order_relaxed);
+		uint64_t valid = (now + 1 > capacity) ? now + 1 - capacity : 0;
+		size_t skip = (valid > first) ? std::min(valid - first, last - first) : 0;
+		out.insert(out.end(), copy.begin() + skip, copy.end());
+	}
+};
+
+/**
+ * @brief Release the buffer of a thread at its termination
+ */
+struct TraceRingOwner {
+	std::shared_ptr<TraceRing> ring;
+
+	~TraceRingOwner() {
+		if (ring)
+			ring->in_use.store(false, std::memory_order_release);
+	}
+};
+
+static size_t RingCapacity() {
+	size_t capacity = 1;
+	while (capacity < BBQUE_TRACE_BUFFER_EVENTS)
+		capacity <<= 1;
+	return capacity;
+}
+
+Tracer & Tracer::GetInstance() {
+	static Tracer tr;
+	return tr;
+}
+
+Tracer::Tracer() :
+	epoch(std::chrono::steady_clock::now()),
+	enabled(true) {
+
+	//---------- Get a logger module
+	logger = Logger::GetLogger(TRACER_NAMESPACE);
+	assert(logger);
+
+	//---------- Register commands
+	CommandManager &cm = CommandManager::GetInstance();
+#define CMD_TRACE_ENABLE ".enable"
+	cm.RegisterCommand(MODULE_NAMESPACE CMD_TRACE_ENABLE,
+			static_cast<CommandHandler*>(this),
+			"Start recording the optimization spans");
+#define CMD_TRACE_DISABLE ".disable"
+	cm.RegisterCommand(MODULE_NAMESPACE CMD_TRACE_DISABLE,
+			static_cast<CommandHandler*>(this),
+			"Stop recording the optimization spans");
+#define CMD_TRACE_DUMP ".dump"
+	cm.RegisterCommand(MODULE_NAMESPACE CMD_TRACE_DUMP,
+			static_cast<CommandHandler*>(this),
+			"Export the recorded spans in Chrome trace format [file]");
+
+	logger->Debug("Tracer: %lu spans buffered per thread", RingCapacity());
+}
+
+Tracer::~Tracer() {
+
+}
+
+void Tracer::Enable(bool enable) {
+	enabled.store(enable, std::memory_order_relaxed);
+	logger->Info("Tracing %s", enable ? "ENABLED" : "DISABLED");
+}
+
+std::shared_ptr<TraceRing> Tracer::AcquireRing(pid_t tid) {
+	std::unique_lock<std::mutex> rings_ul(rings_mtx);
+
+	char name[16] = "";
+	pthread_getname_np(pthread_self(), name, sizeof(name));
+	thread_names[tid] = name;
+
+	for (auto & ring : rings) {
+		bool free = false;
+		if (ring->in_use.compare_exchange_strong(free, true))
+			return ring;
+	}
+
+	rings.push_back(std::make_shared<TraceRing>(RingCapacity()));
+	return rings.back();
+}
+
+TraceRing * Tracer::GetThreadRing() {
+	static thread_local TraceRingOwner owner;
+	if (!owner.ring)
+		owner.ring = AcquireRing(syscall(SYS_gettid));
+	return owner.ring.get();
+}
+
+void Tracer::Record(char const * name, char const * label,
+		uint64_t begin_ns, uint64_t end_ns) {
+	static thread_local pid_t tid = syscall(SYS_gettid);
+	Event_t event;
+	event.name = name;
+	memcpy(event.label, label, BBQUE_TRACE_LABEL_LEN);
+	event.begin_ns = begin_ns;
+	event.duration_ns = end_ns - begin_ns;
+	event.tid = tid;
+	GetThreadRing()->Push(event);
+}
+
+/**
+ * @brief Write a string into a JSON document, escaping the special chars
+ */
+static void WriteJSONString(FILE * out, char const * str) {
+	fputc('"', out);
+	for (; *str; ++str) {
+		if (*str == '"' || *str == '\\')
+			fputc('\\', out);
+		if (static_cast<unsigned char>(*str) < 0x20)
+			continue;
+		fputc(*str, out);
+	}
+	fputc('"', out);
+}
+
+int Tracer::Dump(std::string const & file_path) {
+	std::vector<Event_t> events;
+	std::map<pid_t, std::string> names;
+	{
+		std::unique_lock<std::mutex> rings_ul(rings_mtx);
+		for (auto & ring : rings)
+			ring->Snapshot(events);
+		names = thread_names;
+	}
+
+	FILE * out = fopen(file_path.c_str(), "w");
+	if (!out) {
+		logger->Error("Dump: cannot open <%s>", file_path.c_str());
+		return -1;
+	}
+
+	pid_t pid = getpid();
+	fprintf(out, "{\"traceEvents\":[\n");
+	fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+		"\"args\":{\"name\":\"%s\"}}", pid, BBQUE_DAEMON_NAME);
+	for (auto const & thread : names) {
+		fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+			"\"tid\":%d,\"args\":{\"name\":", pid, thread.first);
+		WriteJSONString(out, thread.second.c_str());
+		fprintf(out, "}}");
+	}
+
+	// Timestamps and durations are in microseconds
+	for (auto const & event : events) {
+		fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"bbque\",\"ph\":\"X\","
+			"\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d",
+			event.name, event.begin_ns / 1e3, event.duration_ns / 1e3,
+			pid, event.tid);
+		if (event.label[0] != '\0') {
+			fprintf(out, ",\"args\":{\"label\":");
+			WriteJSONString(out, event.label);
+			fprintf(out, "}");
+		}
+		fprintf(out, "}");
+	}
+	fprintf(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+	fclose(out);
+
+	logger->Notice("Dump: %lu spans from %lu threads written to <%s>",
+		events.size(), names.size(), file_path.c_str());
+	return 0;
+}
+
+int Tracer::CommandsCb(int argc, char *argv[]) {
+	std::string command_name(argv[0]);
+
+	if (command_name.compare(MODULE_NAMESPACE CMD_TRACE_ENABLE) == 0) {
+		Enable(true);
+		return 0;
+	}
+
+	if (command_name.compare(MODULE_NAMESPACE CMD_TRACE_DISABLE) == 0) {
+		Enable(false);
+		return 0;
+	}
+
+	if (command_name.compare(MODULE_NAMESPACE CMD_TRACE_DUMP) == 0) {
+		std::string file_path(TRACER_DEFAULT_DUMP_FILE);
+		if (argc > 1)
+			file_path.assign(argv[1]);
+		return Dump(file_path);
+	}
+
+	logger->Error("CommandsCb: <%s> not supported by this module",
+		command_name.c_str());
+	return -1;
+}
+
+} // namespace utils
+
+} // namespace bbque
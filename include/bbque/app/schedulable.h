@@ -19,9 +19,11 @@
 #define BBQUE_SCHEDULABLE_H_
 
 #include <cassert>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <string>
 
 #include "bbque/config.h"
 #include "bbque/utils/extra_data_container.h"
@@ -168,6 +170,25 @@ public:
 		};
 	};
 
+#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+
+	/**
+	 * @struct IOUsage_t
+	 *
+	 * Block I/O usage measured at run-time, as exponential moving
+	 * averages of the per-period transfer rates.
+	 */
+	struct IOUsage_t
+	{
+		double read_bps   = 0; /** Read bandwidth [bytes/s] */
+		double write_bps  = 0; /** Write bandwidth [bytes/s] */
+		double read_iops  = 0; /** Read operations per second */
+		double write_iops = 0; /** Write operations per second */
+		uint64_t samples  = 0; /** Number of samples accounted */
+	};
+
+#endif
+
 #ifdef CONFIG_BBQUE_CGROUPS_DISTRIBUTED_ACTUATION
 
 	struct CGroupSetupData_t
@@ -452,6 +473,39 @@ public:
 		return max(checkpoint_latencies);
 	}
 
+#endif
+
+#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+
+	/**
+	 * @brief Update the measured block I/O usage on a device
+	 *
+	 * @param dev The device identifier ("major:minor")
+	 * @param sample The transfer rates observed in the last period
+	 * @param weight The weight of the new sample in the moving average
+	 */
+	void UpdateIOUsage(std::string const & dev, IOUsage_t const & sample,
+			float weight);
+
+	/**
+	 * @brief The measured block I/O usage on a device
+	 *
+	 * @param dev The device identifier ("major:minor")
+	 * @return The moving averages of the transfer rates (all zeros if
+	 * no I/O has been observed on the device)
+	 */
+	IOUsage_t GetIOUsage(std::string const & dev) const;
+
+	/**
+	 * @brief The measured block I/O usage, summed over all the devices
+	 */
+	IOUsage_t GetIOUsage() const;
+
+	/**
+	 * @brief Drop the block I/O usage statistics collected so far
+	 */
+	void ClearIOUsage();
+
 #endif
 
 	/** States for which may require the launch of a scheduling policy */
@@ -491,6 +545,14 @@ protected:
 	std::string checkpoint_info_dir;
 #endif
 
+#ifdef CONFIG_BBQUE_LINUX_CG_BLKIO
+	/** The mutex to serialize access to block I/O usage statistics */
+	mutable std::mutex io_usage_mtx;
+
+	/** Measured block I/O usage, per device ("major:minor") */
+	std::map<std::string, IOUsage_t> io_usage;
+#endif
+
 	/** A string id with information for logging */
 	std::string str_id;
 
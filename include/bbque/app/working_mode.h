@@ -19,8 +19,11 @@
 #define BBQUE_WORKING_MODE_H_
 
 #include <map>
+#include <memory>
+#include <mutex>
 
 #include "bbque/app/working_mode_status.h"
+#include "bbque/res/binder.h"
 #include "bbque/res/bitset.h"
 #include "bbque/res/resource_assignment.h"
 #include "bbque/utils/logging/logger.h"
@@ -419,34 +422,36 @@ public:
 	 */
 	uint32_t AddMissingResourceRequests(
 					br::ResourceAssignmentMapPtr_t bound_map,
-					br::ResourceType r_type);
+					br::ResourceType r_type) const;
 
 	/**
-	 * @brief Retrieve the source and the destination map of resource
-	 * assignments
+	 * @brief Add a binding action to a binding candidate
 	 *
-	 * @param out_map The map to fill with bound resource assignments
-	 * @param prev_refn The reference number to retrieve later this binding
+	 * @param step The binding action
+	 * @param prev_refn The reference number of the candidate to extend, or
+	 * a negative value to start a new candidate
 	 *
-	 * @return A pointer to a source map for resource requests or
-	 * previously bound resource requests
+	 * @return The reference number of the binding candidate, or -1 if
+	 * there is nothing to bind
 	 */
-	br::ResourceAssignmentMap_t * GetSourceAndOutBindingMaps(
-								br::ResourceAssignmentMapPtr_t & out_map,
-								int32_t prev_refn);
+	int32_t AddBindingStep(br::BindingStep_t const & step, int32_t prev_refn);
 
 	/**
-	 * @brief Save a resource assignment map aming the bindings
+	 * @brief Apply a binding action to a map of resource assignments
 	 *
-	 * @param bound_map The resource assignment map
-	 * @param prev_refn The reference number to retrieve later this binding
-	 *
-	 * @return The reference number of the binding
+	 * @param bindings_map The map to update. If empty the binding starts
+	 * from the resource requests.
+	 * @param step The binding action
 	 */
-	int32_t StoreBinding(br::ResourceAssignmentMapPtr_t, int32_t prev_refn);
+	void ApplyBindingStep(br::ResourceAssignmentMapPtr_t bindings_map,
+			br::BindingStep_t const & step) const;
 
 	/**
 	 * @see WorkingModeStatusIF
+	 *
+	 * The map of the resource assignments is built (once) at the first
+	 * call, by applying the binding actions of the candidate. Concurrent
+	 * calls are safe, while BindResource() must not run concurrently.
 	 */
 	br::ResourceAssignmentMapPtr_t GetSchedResourceBinding(uint32_t b_refn) const;
 
@@ -779,6 +784,22 @@ private:
 	 */
 	uint32_t sched_count = 0;
 
+	/**
+	 * @struct SchedBinding_t
+	 *
+	 * A binding candidate built by the scheduling policy
+	 */
+	struct SchedBinding_t
+	{
+		/** The binding actions performed by the policy */
+		std::vector<br::BindingStep_t> steps;
+		/** The resulting map of resource assignments (null until built) */
+		br::ResourceAssignmentMapPtr_t bound_map;
+		/** The map is built once, even if requested concurrently */
+		std::shared_ptr<std::once_flag> build_flag =
+			std::make_shared<std::once_flag>();
+	};
+
 	/**
 	 * @struct ResourceUsagesInfo
 	 *
@@ -792,10 +813,11 @@ private:
 		 */
 		br::ResourceAssignmentMap_t requested;
 		/**
-		 * The temporary map of resource bindings. This is built by the
-		 * BindResource calls
+		 * The binding candidates built by the BindResource calls. Each
+		 * one is kept as the sequence of binding actions, while the map of
+		 * the bound resource assignments is built only if required
 		 */
-		std::vector<br::ResourceAssignmentMapPtr_t> sched_bindings;
+		mutable std::vector<SchedBinding_t> sched_bindings;
 		/**
 		 * The map of the resource bindings allocated for the working mode.
 		 * This is set by SetResourceBinding() as a commit of the
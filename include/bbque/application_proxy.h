@@ -18,14 +18,15 @@
 #ifndef BBQUE_APPLICATION_PROXY_H_
 #define BBQUE_APPLICATION_PROXY_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <future>
-#include <thread>
 
 #include "bbque/app/application.h"
 #include "bbque/command_manager.h"
 #include "bbque/utils/worker.h"
+#include "bbque/utils/worker_pool.h"
 #include "bbque/utils/logging/logger.h"
 #include "bbque/plugins/rpc_channel.h"
 #include "bbque/rtlib/rpc/rpc_messages.h"
@@ -55,7 +56,6 @@ private:
 
 	typedef struct snCtx
 	{
-		std::thread exe;
 		ba::AppPid_t pid;
 	} snCtx_t;
 
@@ -187,13 +187,37 @@ private:
 
 	// Sessions
 
-	typedef std::shared_ptr<snCtx_t> psnCtx_t;
+	/**
+	 * @brief The threads serving the requests received from applications
+	 *
+	 * The requests are dispatched by application PID, thus the requests of
+	 * an application are served in order of reception.
+	 */
+	bu::WorkerPool requests_pool;
 
-	typedef std::map<uint8_t, psnCtx_t> snCtxMap_t;
+	/**
+	 * @brief The threads serving the requests disabling EXCs
+	 *
+	 * A stop, an unregister or an exit request waits for the end of the
+	 * optimization in progress: it is served apart, not to block the
+	 * requests of other applications sharing the same thread of
+	 * requests_pool. These requests are dispatched by application PID
+	 * too, thus they are served in order of reception.
+	 */
+	bu::WorkerPool stop_pool;
 
-	snCtxMap_t snCtxMap;
+	/**
+	 * @brief The threads running the asynchronous command sessions
+	 */
+	bu::WorkerPool commands_pool;
 
-	std::mutex snCtxMap_mtx;
+	/**
+	 * @brief The token of the last command session
+	 *
+	 * Command sessions are not bound to a thread, thus each one gets its
+	 * own token, to match the application responses.
+	 */
+	std::atomic<bl::rpc_msg_token_t> cmd_token;
 
 
 	// Connections
@@ -222,6 +246,8 @@ private:
 	typedef struct rqsSn : public snCtx_t
 	{
 		pchMsg_t pmsg;
+		/** The bytes of the received message */
+		size_t msg_size;
 	} rqsSn_t;
 
 	typedef std::shared_ptr<rqsSn_t> prqsSn_t;
@@ -246,7 +272,7 @@ private:
 
 	ApplicationProxy();
 
-	bl::rpc_msg_type_t GetNextMessage(pchMsg_t & pmsg);
+	bl::rpc_msg_type_t GetNextMessage(pchMsg_t & pmsg, size_t & msg_size);
 
 
 	/*******************************************************************************
@@ -260,14 +286,11 @@ private:
 	 *
 	 * Since Barbeque has a single input RPC channel for each application,
 	 * each response received from an applications should be dispatched to the
-	 * thread which generated the command. Thus, the execution context which
-	 * has generated a command must save a reference to itself for the proper
-	 * dispatching of resposes.
+	 * session which generated the command. Thus, each session gets a unique
+	 * token, which is sent with the command, and it is registered for the
+	 * proper dispatching of resposes.
 	 *
 	 * @param pcs command session handler which is waiting for a response
-	 *
-	 * @note This method must be called from within the session execution
-	 * context, i.e. the command processing thread for asynchronous commands.
 	 */
 	inline void EnqueueHandler(pcmdSn_t pcs);
 
@@ -288,7 +311,7 @@ private:
 	 */
 	RTLIB_ExitCode_t Prof_GetRuntimeDataTrd(pcmdSn_t pcs);
 
-	RTLIB_ExitCode_t Prof_GetRuntimeDataSend(ba::AppPtr_t papp);
+	RTLIB_ExitCode_t Prof_GetRuntimeDataSend(pcmdSn_t pcs);
 
 	RTLIB_ExitCode_t Prof_GetRuntimeDataRecv(pcmdSn_t pcs);
 
@@ -355,6 +378,12 @@ private:
 
 	void RpcExcRuntimeProfileNotify(prqsSn_t prqs);
 
+	/**
+	 * @brief Set the runtime profiles of a batch of EXCs, triggering
+	 * at most one optimization
+	 */
+	void RpcExcRuntimeProfileNotifyBatch(prqsSn_t prqs);
+
 	void RpcExcStart(prqsSn_t prqs);
 
 	void RpcExcStop(prqsSn_t prqs);
@@ -381,7 +410,12 @@ private:
 
 	void RequestExecutor(prqsSn_t prqs);
 
-	void ProcessRequest(pchMsg_t & pmsg);
+	void ProcessRequest(pchMsg_t & pmsg, size_t msg_size);
+
+	/**
+	 * @brief Check if serving a request could wait for an optimization
+	 */
+	static bool IsBlockingRequest(uint8_t typ);
 
 
 	/**
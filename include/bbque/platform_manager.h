@@ -85,6 +85,19 @@ public:
 				ResourceAssignmentMapPtr_t pres,
 				bool excl = true) override;
 
+	/**
+	 * @brief Start a batch of resource mappings
+	 *
+	 * Only the local mappings are batched, the remote ones are still
+	 * enforced immediately.
+	 */
+	ExitCode_t BeginMappings() override;
+
+	/**
+	 * @brief Enforce the local resource mappings of the current batch
+	 */
+	ExitCode_t CommitMappings(std::vector<SchedPtr_t> & failed) override;
+
 	/**
 	 * @brief Set the power management configuration set by the scheduling
 	 * policy
@@ -26,6 +26,7 @@
 #include "bbque/pp/cr/reliability_actions_if.h"
 
 #include <cstdint>
+#include <vector>
 
 #define PLATFORM_PROXY_NAMESPACE "bq.pp"
 
@@ -133,6 +134,25 @@ public:
 	virtual ExitCode_t MapResources(
 					SchedPtr_t papp, ResourceAssignmentMapPtr_t pres, bool excl = true) = 0;
 
+	/**
+	 * @brief Start a batch of resource mappings
+	 *
+	 * The platform proxy can defer the enforcement of the mappings
+	 * requested by the following MapResources() calls, until the
+	 * CommitMappings() call. The default implementation enforces each
+	 * mapping immediately.
+	 */
+	virtual ExitCode_t BeginMappings();
+
+	/**
+	 * @brief Enforce the resource mappings collected since the last call
+	 * of BeginMappings()
+	 *
+	 * @param failed Filled with the applications whose mapping failed
+	 * @return PLATFORM_OK if all the mappings have been enforced
+	 */
+	virtual ExitCode_t CommitMappings(std::vector<SchedPtr_t> & failed);
+
 	/**
 	 * @brief Set the power management configuration if set by the policy
 	 * @return PLATFORM_OK for success
@@ -18,11 +18,21 @@
 #ifndef BBQUE_SCHEDULER_POLICY_H_
 #define BBQUE_SCHEDULER_POLICY_H_
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "bbque/config.h"
 #include "bbque/system.h"
 #include "bbque/app/application_conf.h"
 #include "bbque/app/working_mode.h"
 #include "bbque/res/resources.h"
+#include "bbque/utils/worker_pool.h"
 
 // The prefix for logging statements category
 #define SCHEDULER_POLICY_NAMESPACE "bq.sp"
@@ -223,6 +233,59 @@ public:
 	/** Shared pointer to a scheduling entity */
 	typedef std::shared_ptr<SchedEntity_t> SchedEntityPtr_t;
 
+	/**
+	 * @struct SchedDecision_t
+	 * @brief A scheduling decision taken in a resource partition
+	 */
+	struct SchedDecision_t
+	{
+		/** The application (null in case of process) */
+		ba::AppCPtr_t papp;
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+		/** The process (null in case of application) */
+		ProcPtr_t proc;
+#endif
+		/** The working mode assigned */
+		ba::AwmPtr_t pawm;
+		/** Reference number of the resource binding */
+		int32_t bind_refn;
+
+		/** The schedulable entity */
+		ba::SchedPtr_t Sched() const
+		{
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+			if (proc)
+				return proc;
+#endif
+			return papp;
+		}
+	};
+
+	/**
+	 * @struct SchedPartition_t
+	 * @brief An independent partition of the resources to schedule
+	 *
+	 * The partitions (e.g., the CPU sockets or the accelerators) are
+	 * scheduled concurrently, each one in its own resource state view. The
+	 * decisions taken are then merged into the scheduling view.
+	 */
+	struct SchedPartition_t
+	{
+		/** Partition name, used to build the resource view token */
+		std::string name;
+		/** The resource state view of the partition */
+		br::RViewToken_t view = 0;
+		/** The scheduling decisions taken (in order) */
+		std::vector<SchedDecision_t> decisions;
+		/** The decisions conflicting with the scheduling view at merge */
+		std::vector<SchedDecision_t> conflicts;
+		/** Result of the partition scheduling */
+		ExitCode_t result = SCHED_OK;
+	};
+
+	/** The scheduling function of a partition */
+	using PartitionScheduleFunc_t = std::function<ExitCode_t(SchedPartition_t &)>;
+
 	/** List of scheduling entities */
 	typedef std::list<SchedEntityPtr_t> SchedEntityList_t;
 
@@ -263,6 +326,13 @@ protected:
 	/** A counter used for getting always a new clean resources view */
 	uint32_t status_view_count = 0;
 
+#ifdef CONFIG_BBQUE_SCHED_PARALLEL
+	/** The threads scheduling the resource partitions */
+	std::unique_ptr<bbque::utils::WorkerPool> partitions_pool {
+		new bbque::utils::WorkerPool(SCHEDULER_POLICY_NAMESPACE ".pt",
+			std::thread::hardware_concurrency()) };
+#endif
+
 
 	/** List of scheduling entities  */
 	SchedEntityList_t entities;
@@ -411,6 +481,124 @@ protected:
 
 #endif
 
+	/**
+	 * @brief Schedule a set of resource partitions in parallel
+	 *
+	 * Each partition gets a new resource state view, then the scheduling
+	 * function is called for each partition, concurrently (on the threads
+	 * pool of the policy) if CONFIG_BBQUE_SCHED_PARALLEL is set. The
+	 * function must take its decisions through ScheduleInPartition().
+	 *
+	 * Eventually, the decisions are merged (serially, in the order of the
+	 * partitions) into the scheduling view. A decision is in conflict if
+	 * any of the resources booked in the partition view is not available
+	 * in the scheduling view, e.g., because the partitions were not
+	 * disjoint. Conflicting decisions are not applied and are returned in
+	 * the "conflicts" list of the partition, to let the policy handle them
+	 * serially.
+	 *
+	 * @note The partition views start empty, thus this should be called
+	 * before booking any resource of the partitions in the scheduling view.
+	 * The scheduling function must not access any schedulable entity
+	 * assigned to another partition.
+	 *
+	 * @param partitions The partitions to schedule
+	 * @param sched_func The scheduling function of a partition
+	 *
+	 * @return The number of conflicting decisions
+	 */
+	uint32_t ForEachPartitionParallelDo(
+				std::vector<SchedPartition_t> & partitions,
+				PartitionScheduleFunc_t sched_func)
+	{
+		ResourceAccounter & ra(ResourceAccounter::GetInstance());
+
+		// Resource state views of the partitions
+		for (auto & part : partitions) {
+			std::string token_path(SCHEDULER_POLICY_NAMESPACE);
+			token_path += std::to_string(status_view_count) + "." + part.name;
+			part.decisions.clear();
+			part.conflicts.clear();
+			if (ra.GetView(token_path, part.view) != ResourceAccounterStatusIF::RA_SUCCESS)
+				part.result = SCHED_ERROR_VIEW;
+			else
+				part.result = SCHED_OK;
+		}
+
+		// Schedule the partitions
+		std::atomic<size_t> next_part(0);
+		auto worker = [&]() {
+			size_t i;
+			while ((i = next_part++) < partitions.size()) {
+				if (partitions[i].result == SCHED_OK)
+					partitions[i].result = sched_func(partitions[i]);
+			}
+		};
+#ifdef CONFIG_BBQUE_SCHED_PARALLEL
+		// The calling thread takes part too, up to a job per partition
+		size_t nr_jobs = std::min<size_t>(
+			partitions.size(), partitions_pool->Size() + 1);
+		nr_jobs = (nr_jobs > 0) ? nr_jobs - 1 : 0;
+		std::mutex jobs_mtx;
+		std::condition_variable jobs_cv;
+		size_t jobs_left = nr_jobs;
+		for (size_t j = 0; j < nr_jobs; ++j) {
+			partitions_pool->Submit(j, [&]() {
+				worker();
+				std::unique_lock<std::mutex> jobs_ul(jobs_mtx);
+				if (--jobs_left == 0)
+					jobs_cv.notify_one();
+			});
+		}
+		worker();
+		std::unique_lock<std::mutex> jobs_ul(jobs_mtx);
+		jobs_cv.wait(jobs_ul, [&]() { return jobs_left == 0; });
+		jobs_ul.unlock();
+#else
+		worker();
+#endif
+
+		// Merge the decisions into the scheduling view
+		uint32_t nr_conflicts = 0;
+		for (auto & part : partitions) {
+			for (auto & decision : part.decisions) {
+				if (!MergeDecision(decision, part.view)) {
+					part.conflicts.push_back(decision);
+					++nr_conflicts;
+				}
+			}
+			if (part.view != 0)
+				ra.PutView(part.view);
+		}
+
+		return nr_conflicts;
+	}
+
+	/**
+	 * @brief Take a scheduling decision in a resource partition
+	 *
+	 * The resources are booked in the partition view, so that the further
+	 * decisions on the same partition account for them.
+	 *
+	 * @param part The partition
+	 * @param decision The scheduling decision
+	 *
+	 * @return SCHED_OK for success, SCHED_R_UNAVAILABLE if the resources
+	 * are not available in the partition
+	 */
+	ExitCode_t ScheduleInPartition(SchedPartition_t & part,
+				SchedDecision_t const & decision)
+	{
+		ResourceAccounter & ra(ResourceAccounter::GetInstance());
+		auto ra_result = ra.BookResources(decision.Sched(),
+			decision.pawm->GetSchedResourceBinding(decision.bind_refn),
+			part.view);
+		if (ra_result != ResourceAccounterStatusIF::RA_SUCCESS)
+			return SCHED_R_UNAVAILABLE;
+		part.decisions.push_back(decision);
+		return SCHED_OK;
+	}
+
 	/**
 	 * Compute a priority-proportional amount of quota for a given resource
 	 *
@@ -442,6 +630,44 @@ protected:
 		return (sys->ApplicationLowestPriority() - priority + 1)
 			* resource_slot_size;
 	}
+
+private:
+
+	/**
+	 * @brief Apply a decision taken in a partition to the scheduling view
+	 *
+	 * @return false in case of conflict
+	 */
+	bool MergeDecision(SchedDecision_t const & decision, br::RViewToken_t part_view)
+	{
+		auto psched = decision.Sched();
+		auto assign_map = decision.pawm->GetSchedResourceBinding(decision.bind_refn);
+		if (!assign_map)
+			return false;
+
+		// Conflict detection: every resource booked in the partition must
+		// be available in the scheduling view
+		for (auto const & ru_entry : *assign_map) {
+			for (auto const & rsrc : ru_entry.second->GetResourcesList()) {
+				uint64_t booked = rsrc->UsedBy(psched, part_view);
+				if (booked > rsrc->Available(psched, sched_status_view))
+					return false;
+			}
+		}
+
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+		if (decision.proc) {
+			ProcessManager & prm(ProcessManager::GetInstance());
+			return prm.ScheduleRequest(decision.proc, decision.pawm,
+				sched_status_view, decision.bind_refn)
+				== ProcessManager::SUCCESS;
+		}
+#endif
+		ApplicationManager & am(ApplicationManager::GetInstance());
+		return am.ScheduleRequest(decision.papp, decision.pawm,
+			sched_status_view, decision.bind_refn)
+			== ApplicationManager::AM_SUCCESS;
+	}
 };
 
 } // namespace plugins
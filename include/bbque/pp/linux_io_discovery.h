@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2017  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_LINUX_IO_DISCOVERY_H_
+#define BBQUE_LINUX_IO_DISCOVERY_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bbque/config.h"
+#include "bbque/utils/logging/logger.h"
+
+namespace bu = bbque::utils;
+
+namespace bbque {
+namespace pp {
+
+/**
+ * @class LinuxIODiscovery
+ * @brief Discovery and calibration of the local block devices
+ *
+ * The block devices are enumerated from sysfs (/sys/block). Virtual
+ * devices (loop, ram, device-mapper...) and empty ones are skipped. For
+ * each device, the sequential read bandwidth and the random read IOPS are
+ * measured by reading the raw device in O_DIRECT mode, for a bounded
+ * amount of time. The calibration is read-only, thus it never alters the
+ * content of the device.
+ *
+ * The results are cached into a file, to skip the calibration of the
+ * devices already known at the next start-up. A cache entry is valid as
+ * long as the device number and size are unchanged.
+ */
+class LinuxIODiscovery
+{
+public:
+
+	/**
+	 * @struct DeviceInfo_t
+	 * @brief The characterization of a block device
+	 */
+	struct DeviceInfo_t
+	{
+		/** Kernel name (e.g., "sda") */
+		std::string name;
+		/** Device number ("major:minor") */
+		std::string dev;
+		/** True for rotational devices (HDD) */
+		bool rotational = false;
+		/** Capacity [bytes] */
+		uint64_t size = 0;
+		/** Sequential read bandwidth [B/s] */
+		uint64_t bandwidth = 0;
+		/** Random (4KB) read operations per second */
+		uint64_t iops = 0;
+	};
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param cache_file The path of the calibration cache file
+	 * @param calibration_ms Time budget [ms] of the calibration of each
+	 * device (half for the bandwidth and half for the IOPS measurement)
+	 */
+	LinuxIODiscovery(std::string const & cache_file, uint32_t calibration_ms);
+
+	virtual ~LinuxIODiscovery() { };
+
+	/**
+	 * @brief Enumerate and characterize the block devices
+	 *
+	 * @return The list of the devices found. Devices which could not be
+	 * calibrated are not included.
+	 */
+	std::vector<DeviceInfo_t> Discover();
+
+private:
+
+	std::unique_ptr<bu::Logger> logger;
+
+	/** Calibration cache file */
+	std::string cache_file;
+
+	/** Time budget for the calibration of a device [ms] */
+	uint32_t calibration_ms;
+
+	/** Calibration results loaded from the cache, by device name */
+	std::map<std::string, DeviceInfo_t> cache;
+
+	/**
+	 * @brief Read the attributes of a block device from sysfs
+	 *
+	 * @return false if the device must be skipped
+	 */
+	bool ReadDeviceAttributes(std::string const & name, DeviceInfo_t & info) const;
+
+	/**
+	 * @brief Measure the read bandwidth and IOPS of a block device
+	 *
+	 * @return true on success, false otherwise
+	 */
+	bool Calibrate(DeviceInfo_t & info) const;
+
+	void LoadCache();
+
+	void SaveCache(std::vector<DeviceInfo_t> const & devices) const;
+
+};
+
+} // namespace pp
+
+} // namespace bbque
+
+#endif // BBQUE_LINUX_IO_DISCOVERY_H_
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2017  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_LINUX_IO_MONITOR_H_
+#define BBQUE_LINUX_IO_MONITOR_H_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "bbque/config.h"
+#include "bbque/app/schedulable.h"
+#include "bbque/utils/worker.h"
+
+namespace bu = bbque::utils;
+
+namespace bbque {
+namespace pp {
+
+/**
+ * @class LinuxIOMonitor
+ * @brief Sampler of the block I/O actually performed by the applications
+ *
+ * The block I/O resources are accounted by the ResourceAccounter only in
+ * terms of the amount booked by the scheduling policy. This worker
+ * periodically reads back the statistics exported by the control group of
+ * each managed application (blkio.throttle.io_service_bytes and
+ * blkio.throttle.io_serviced, or io.stat on the unified hierarchy) and
+ * updates the measured usage of the application (@see
+ * Schedulable::UpdateIOUsage).
+ */
+class LinuxIOMonitor : public bu::Worker
+{
+public:
+
+	static LinuxIOMonitor & GetInstance();
+
+	virtual ~LinuxIOMonitor();
+
+	LinuxIOMonitor & operator=(LinuxIOMonitor &) = delete;
+
+	/**
+	 * @brief Start sampling the block I/O of an application
+	 *
+	 * @param papp The application to monitor
+	 * @param cg_path The absolute path of the control group directory
+	 * hosting the application
+	 */
+	void Register(app::SchedPtr_t papp, std::string const & cg_path);
+
+	/**
+	 * @brief Stop sampling the block I/O of an application
+	 */
+	void Unregister(app::SchedPtr_t papp);
+
+	/**
+	 * @brief Sampling period [ms] (0 if the monitoring is disabled)
+	 */
+	uint32_t GetPeriodMs() const
+	{
+		return period_ms;
+	}
+
+private:
+
+	/**
+	 * @struct IOCounters_t
+	 * @brief Cumulative counters read from the control group statistics
+	 */
+	struct IOCounters_t
+	{
+		uint64_t rbytes = 0;
+		uint64_t wbytes = 0;
+		uint64_t rios = 0;
+		uint64_t wios = 0;
+	};
+
+	/**
+	 * @struct AppIOInfo_t
+	 * @brief Sampling status of a monitored application
+	 */
+	struct AppIOInfo_t
+	{
+		/** The application (not owned) */
+		std::weak_ptr<app::Schedulable> papp;
+		/** The control group directory */
+		std::string cg_path;
+		/** Time of the last sample */
+		std::chrono::steady_clock::time_point last_time;
+		/** Counters of the last sample, per device ("major:minor") */
+		std::map<std::string, IOCounters_t> last_counters;
+	};
+
+	/** Sampling period [ms] */
+	uint32_t period_ms;
+
+	/** Weight of the newest sample in the moving averages */
+	float ema_weight;
+
+	/** Mutex protecting the set of monitored applications */
+	std::mutex apps_mtx;
+
+	/** The monitored applications, by application UID */
+	std::map<uint32_t, AppIOInfo_t> apps;
+
+	LinuxIOMonitor();
+
+	/**
+	 * @brief Periodic task
+	 */
+	void Task() override;
+
+	/**
+	 * @brief Sample the block I/O of a single application
+	 *
+	 * @return false if the application is no longer valid
+	 */
+	bool SampleApplication(AppIOInfo_t & app_info);
+
+	/**
+	 * @brief Read the cumulative I/O counters of a control group
+	 *
+	 * @param cg_path The control group directory
+	 * @param counters The counters, per device ("major:minor")
+	 *
+	 * @return true on success, false otherwise
+	 */
+	bool ReadCounters(std::string const & cg_path,
+			std::map<std::string, IOCounters_t> & counters) const;
+
+};
+
+} // namespace pp
+
+} // namespace bbque
+
+#endif // BBQUE_LINUX_IO_MONITOR_H_
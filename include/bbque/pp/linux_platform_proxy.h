@@ -21,6 +21,7 @@
 #include "bbque/config.h"
 #include "bbque/platform_proxy.h"
 #include "bbque/utils/logging/logger.h"
+#include "bbque/utils/worker_pool.h"
 
 #define LINUX_PP_NAMESPACE "bq.pp.linux"
 
@@ -28,7 +29,10 @@
 // constants define
 #include "bbque/pp/linux_platform_proxy_types.h"
 
+#include <atomic>
 #include <bitset>
+#include <memory>
+#include <unordered_map>
 
 #define BBQUE_PP_LINUX_PLATFORM_ID "bq.linux"
 
@@ -78,6 +82,25 @@ public:
 				ResourceAssignmentMapPtr_t pres,
 				bool excl) noexcept override final;
 
+	/**
+	 * @brief Start collecting the control group updates
+	 *
+	 * The MapResources() calls following this one only compute the
+	 * resource bindings, while the control groups are updated by
+	 * CommitMappings().
+	 */
+	ExitCode_t BeginMappings() override final;
+
+	/**
+	 * @brief Update the control groups of all the applications mapped
+	 * since BeginMappings()
+	 *
+	 * The updates are spread over a small pool of worker threads (@see
+	 * sync_workers), since each of them consists of several independent
+	 * sysfs writes.
+	 */
+	ExitCode_t CommitMappings(std::vector<SchedPtr_t> & failed) override final;
+
 	/**
 	 * @brief Linux platform specific termination.
 	 */
@@ -127,6 +150,29 @@ private:
 	int cfs_margin_pct = 0; /**< CFS bandwidth enforcement safety margin (default: 0%) */
 	int cfs_threshold_pct = 100; /**< CFS bandwidth enforcement threshold (default: 100%)   */
 
+	/**
+	 * @struct PendingMapping_t
+	 * @brief A control group update deferred to the batch commit
+	 */
+	struct PendingMapping_t
+	{
+		CGroupDataPtr_t pcgd;
+		RLinuxBindingsPtr_t prlb;
+		bool excl;
+	};
+
+	/** True while collecting a batch of resource mappings */
+	std::atomic<bool> batch_mappings { false };
+
+	/** Control group updates of the current batch, by application */
+	std::unordered_map<app::Schedulable const *, PendingMapping_t> pending_mappings;
+
+	/** Number of threads updating the control groups of a batch */
+	uint32_t sync_workers = 4;
+
+	/** The threads updating the control groups, besides the calling one */
+	std::unique_ptr<bu::WorkerPool> sync_pool;
+
 	std::unique_ptr<bu::Logger> logger;
 
 	/**
@@ -206,6 +252,19 @@ private:
 	 */
 	std::vector<IODevInfoPtr_t> dev_info;
 
+	/**
+	 * @brief Index of the IO devices, keyed by the identifiers of the
+	 * resource paths registered for them (@see IODevKey)
+	 */
+	std::unordered_map<uint64_t, IODevInfoPtr_t> dev_by_path;
+
+#ifndef CONFIG_BBQUE_LINUX_CG_V2
+	/**
+	 * @brief Mount point of the blkio controller hierarchy
+	 */
+	std::string blkio_mount_path;
+#endif
+
 	/**
 	 * @brief Adds a new IO device to the vector dev_info.
 	 * @param dev The major:minor string to be stored.
@@ -213,24 +272,87 @@ private:
 	ExitCode_t MakeNewIODev(std::string const & dev);
 	
 	/**
-	 * @brief Adds the device path to the first available slot.
+	 * @brief Adds the resource path to the slot of the given device.
 	 * @param resource_path The resource path.
+	 * @param dev The major:minor string of the device.
+	 * @param kind The kind of I/O resource (bandwidth or IOPS).
 	 */
-	ExitCode_t AddDevicePath(br::ResourcePathPtr_t resource_path);
+	ExitCode_t AddDevicePath(br::ResourcePathPtr_t resource_path,
+				std::string const & dev,
+				PlatformDescription::IOKind_t kind);
 
 	/**
 	 * @brief Gets the dev attribute for a given resource path.
 	 * @param resource_path The resource path.
 	 * 
-	 * @return The string with major:minor numbers for the given path.
+	 * @return The string with major:minor numbers for the given path, or
+	 * an empty string if the path does not refer to an IO device.
 	 */
-	std::string GetDevFromPath(br::ResourcePathPtr_t const & resource_path);
+	std::string const & GetDevFromPath(br::ResourcePathPtr_t const & resource_path) const;
+
+	/**
+	 * @brief Pack the system, block and IO identifiers of a resource path
+	 * into a key of the IO devices index.
+	 *
+	 * The "io" and "iops" identifiers are packed as the corresponding
+	 * PlatformDescription::IOKind_t value.
+	 */
+	static uint64_t IODevKey(br::ResourcePath const & resource_path);
 
 	/**
 	 * @brief Read the platform description and initialize the IO device information.
 	*/
 	void InitIODevInfo();
 
+#ifdef CONFIG_BBQUE_LINUX_IO_DISCOVERY
+	/**
+	 * @brief Calibration cache file of the discovered storage devices
+	 */
+	std::string io_discovery_cache;
+
+	/**
+	 * @brief Time budget [ms] for the calibration of a storage device
+	 */
+	uint32_t io_calibration_ms;
+
+	/**
+	 * @brief Add the storage devices found in sysfs, and not listed in the
+	 * platform description, to the local system
+	 */
+	void DiscoverIODevices();
+#endif
+
+	/**
+	 * @brief Enforce the block I/O limits of all the devices
+	 *
+	 * The blkio throttling attributes accept a single "major:minor value"
+	 * entry per write, therefore each device limit is written on its own.
+	 * Both bandwidth (Bps) and IOPS limits are managed. Only the entries
+	 * changed since the last mapping are written, while devices no longer
+	 * assigned get their limit removed.
+	 *
+	 * @param pcgd The control group data of the application
+	 * @param prlb The resource bindings to enforce
+	 */
+	ExitCode_t SetupBlkIO(CGroupDataPtr_t & pcgd, RLinuxBindingsPtr_t prlb) noexcept;
+
+#ifndef CONFIG_BBQUE_LINUX_CG_V2
+
+	/**
+	 * @brief Update a blkio throttling attribute for a set of devices
+	 *
+	 * @param pcgd The control group data of the application
+	 * @param attribute The blkio attribute (e.g., read_bps_device)
+	 * @param devs The vector of pairs <device path, amount>
+	 * @param committed The limits currently set into the control group
+	 */
+	ExitCode_t UpdateBlkIOLimits(
+		CGroupDataPtr_t & pcgd,
+		const char * attribute,
+		std::vector<std::pair<ResourcePathPtr_t, int_fast64_t>> const & devs,
+		std::map<std::string, uint64_t> & committed) noexcept;
+#endif
+
 #endif
 	/**
 	 * @brief Load values from the configuration file
@@ -253,7 +375,7 @@ private:
 	ExitCode_t RegisterCPU(const PlatformDescription::CPU &cpu, bool is_local = true) noexcept;
 	ExitCode_t RegisterMEM(const PlatformDescription::Memory &mem, bool is_local = true) noexcept;
 	ExitCode_t RegisterNET(const PlatformDescription::NetworkIF &net, bool is_local = true) noexcept;
-	ExitCode_t RegisterIODev(const PlatformDescription::IO &io_dev, bool is_local = true) noexcept;
+	ExitCode_t RegisterIODev(const PlatformDescription::Storage &io_dev, bool is_local = true) noexcept;
 
 	// --- CGroup-related methods
 
@@ -272,6 +394,63 @@ private:
 	ExitCode_t SetupCGroup(CGroupDataPtr_t &pcgd, RLinuxBindingsPtr_t prlb,
 			bool excl = false, bool move = true) noexcept;
 	ExitCode_t BuildAppCG(SchedPtr_t papp, CGroupDataPtr_t &pcgd) noexcept;
+
+#ifndef CONFIG_BBQUE_LINUX_CG_V2
+
+	/**
+	 * @brief Write the attributes of a cgroup changed since their last
+	 * write
+	 *
+	 * The values are written through a temporary libcgroup descriptor
+	 * holding only the changed attributes, since cgroup_modify_cgroup()
+	 * writes all the values set into a descriptor.
+	 *
+	 * @param pcgd The control group data
+	 * @param attrs The attribute values
+	 * @param track If false, the attributes are written unconditionally
+	 * and their value is not recorded (e.g., for task assignment)
+	 */
+	ExitCode_t ModifyCGroup(CGroupDataPtr_t & pcgd,
+			std::vector<CGroupAttr_t> const & attrs,
+			bool track = true) noexcept;
+
+#endif
+
+#ifdef CONFIG_BBQUE_LINUX_CG_V2
+
+	// --- cgroup v2 (unified hierarchy) specific
+
+	/**
+	 * @brief Mount point of the unified control groups hierarchy
+	 *
+	 * It can be set to a different directory (e.g., a tmpfs mounted fake
+	 * hierarchy) for testing purposes.
+	 */
+	std::string cgroup_v2_mount;
+
+	/**
+	 * @brief Create a cgroup directory, enabling the required controllers
+	 * into the "cgroup.subtree_control" of all its ancestors
+	 *
+	 * @param cgpath The cgroup path, relative to the hierarchy mount point
+	 */
+	ExitCode_t MakeCGroupV2(std::string const & cgpath) noexcept;
+
+	/**
+	 * @brief Write an attribute of a cgroup, if the value has changed
+	 * since the last write
+	 *
+	 * @param pcgd The control group data
+	 * @param attr The attribute file name (e.g., "cpu.max")
+	 * @param value The value to write
+	 *
+	 * @return true if the value is set, false in case of write errors
+	 */
+	bool WriteCGroupAttribute(CGroupDataPtr_t & pcgd,
+				const char * attr,
+				std::string const & value) noexcept;
+
+#endif
 };
 
 } // namespace pp
@@ -17,8 +17,15 @@ include linux_platform_proxy.h!
 #endif
 
 #include <cstdint>
+#include <map>
 #include <memory>
+
+#ifdef CONFIG_BBQUE_LINUX_CG_V2
+#include <string>
+#include <unistd.h>
+#else
 #include <libcgroup.h>
+#endif
 
 /**
  * @brief The cgroup expected to assign resources to the BarbequeRTRM
@@ -50,18 +57,31 @@ include linux_platform_proxy.h!
 
 #define BBQUE_PP_LINUX_FREEZER_STATE "/freezer.state"
 
+/**
+ * @brief The cgroup hosting the applications not (yet) scheduled
+ */
+#define BBQUE_PP_LINUX_SILOS BBQUE_PP_LINUX_CGROUP"/silos"
+
+/**
+ * @brief The default mount point of the unified (v2) cgroup hierarchy
+ */
+#define BBQUE_PP_LINUX_CGROUP_V2_MOUNT "/sys/fs/cgroup"
+
 
 namespace bbque {
 namespace pp {
 
 /**
- * @brief Stores major and minor numbers of the device, and resource path pointers for both bandwidth attributes
+ * @brief Stores major and minor numbers of the device, and resource path
+ * pointers for both bandwidth and IOPS attributes
  */
 struct IODevInfo_t
 {
 	std::string dev = "";
 	br::ResourcePathPtr_t r_bw_path = NULL;
 	br::ResourcePathPtr_t w_bw_path = NULL;
+	br::ResourcePathPtr_t r_iops_path = NULL;
+	br::ResourcePathPtr_t w_iops_path = NULL;
 
 	IODevInfo_t(std::string const & dev)
 	{
@@ -71,6 +91,23 @@ struct IODevInfo_t
 
 using IODevInfoPtr_t = std::shared_ptr<IODevInfo_t>;
 
+#ifndef CONFIG_BBQUE_LINUX_CG_V2
+
+/**
+ * @brief The value of a cgroup attribute to write
+ */
+struct CGroupAttr_t
+{
+	const char * controller; /** Controller name, e.g. "cpuset" */
+	const char * name;       /** Attribute name, e.g. "cpuset.cpus" */
+	std::string value;
+};
+
+#endif
+
+/** Max length of a resource ID in a cpuset string, separator included */
+#define BBQUE_LINUX_ID_STR_LEN 6
+
 /**
  * @brief Resource assignment bindings on a Linux machine
  */
@@ -79,25 +116,30 @@ struct RLinuxBindings_t
 	unsigned short node_id = 0; /** Computing node, e.g. processor */
 	char *cpus = NULL; /** Processing elements / CPU cores assigned */
 	char *mems = NULL; /** Memory nodes assigned */
+	size_t cpus_len = 0; /** Size of the cpus buffer */
+	size_t mems_len = 0; /** Size of the mems buffer */
 	char *memb = NULL; /** Memory limits in bytes */
 	uint_fast32_t amount_cpus = 0; /** Percentage of CPUs time assigned */
 	int_fast64_t amount_memb = 0; /** Amount of socket MEMORY assigned (byte) */
 	int_fast64_t amount_net_bw = 0; /** Amount of network bandwidth assigned (bps) */
-	std::vector<std::pair<ResourcePathPtr_t, int_fast64_t>> read_devs; /** Vector of pairs <read_device, amount> (MB/s)*/
-	std::vector<std::pair<ResourcePathPtr_t, int_fast64_t>> write_devs; /** Vector of pairs <write_device, amount> (MB/s)*/
+	std::vector<std::pair<ResourcePathPtr_t, int_fast64_t>> read_devs; /** Vector of pairs <read_device, amount> (B/s)*/
+	std::vector<std::pair<ResourcePathPtr_t, int_fast64_t>> write_devs; /** Vector of pairs <write_device, amount> (B/s)*/
+	std::vector<std::pair<ResourcePathPtr_t, int_fast64_t>> read_iops_devs; /** Vector of pairs <read_device, amount> (IO/s)*/
+	std::vector<std::pair<ResourcePathPtr_t, int_fast64_t>> write_iops_devs; /** Vector of pairs <write_device, amount> (IO/s)*/
 
-	RLinuxBindings_t(const uint_fast8_t MaxCpusCount,
-			const uint_fast8_t MaxMemsCount)
+	RLinuxBindings_t(const uint_fast16_t MaxCpusCount,
+			const uint_fast16_t MaxMemsCount)
 	{
-		// 3 chars are required for each CPU/MEM resource if formatted
-		// with syntax: "nn,". This allows for up-to 99 resources per
-		// cluster
+		// In the worst case (no consecutive IDs) each CPU/MEM resource
+		// requires the chars of the ID plus the separator: "nnnnn,"
 		if (MaxCpusCount) {
-			cpus = new char[3 * MaxCpusCount]();
+			cpus_len = BBQUE_LINUX_ID_STR_LEN * MaxCpusCount;
+			cpus = new char[cpus_len]();
 			cpus[0] = 0;
 		}
 		if (MaxMemsCount) {
-			mems = new char[3 * MaxMemsCount]();
+			mems_len = BBQUE_LINUX_ID_STR_LEN * MaxMemsCount;
+			mems = new char[mems_len]();
 			mems[0] = 0;
 		}
 	}
@@ -118,15 +160,54 @@ struct CGroupData_t : public bbque::utils::PluginDataKey
 	bbque::app::SchedPtr_t papp; /** The controlled application */
 #define BBQUE_PP_LINUX_CGROUP_PATH_MAX 128 // "user.slice/res/12345:ABCDEF:00";
 	char cgpath[BBQUE_PP_LINUX_CGROUP_PATH_MAX];
+	std::map<std::string, std::string> attrs; /** Committed attribute values */
+#ifdef CONFIG_BBQUE_LINUX_CG_V2
+	std::string fs_path; /** Absolute path of the cgroup directory */
+#else
 	struct cgroup *pcg;
 	struct cgroup_controller *pc_cpu;
 	struct cgroup_controller *pc_cpuset;
 	struct cgroup_controller *pc_memory;
 	struct cgroup_controller *pc_net_cls;
 	struct cgroup_controller *pc_blkio;
+#endif
 
 	bool cfs_quota_available = false; /** Target system supports CFS quota management? */
 
+#if defined(CONFIG_BBQUE_LINUX_CG_BLKIO) && !defined(CONFIG_BBQUE_LINUX_CG_V2)
+	std::map<std::string, uint64_t> blkio_read_bps;  /** Committed READ limits (Bps) per major:minor */
+	std::map<std::string, uint64_t> blkio_write_bps; /** Committed WRITE limits (Bps) per major:minor */
+	std::map<std::string, uint64_t> blkio_read_iops;  /** Committed READ limits (IO/s) per major:minor */
+	std::map<std::string, uint64_t> blkio_write_iops; /** Committed WRITE limits (IO/s) per major:minor */
+#endif
+
+#ifdef CONFIG_BBQUE_LINUX_CG_V2
+
+	CGroupData_t(bbque::app::SchedPtr_t sched_app) :
+	    bu::PluginDataKey(LINUX_PP_NAMESPACE, "cgroup"),
+	    papp(sched_app)
+	{
+		snprintf(cgpath, BBQUE_PP_LINUX_CGROUP_PATH_MAX,
+			BBQUE_PP_LINUX_RESOURCES"/%s",
+			papp->StrId());
+	}
+
+	CGroupData_t(const char *cgp) :
+	    bu::PluginDataKey(LINUX_PP_NAMESPACE, "cgroup")
+	{
+		snprintf(cgpath, BBQUE_PP_LINUX_CGROUP_PATH_MAX,
+			"%s", cgp);
+	}
+
+	~CGroupData_t()
+	{
+		// Removing kernel cgroup (it fails if tasks are still attached)
+		if (!fs_path.empty())
+			rmdir(fs_path.c_str());
+	}
+
+#else
+
 	CGroupData_t(bbque::app::SchedPtr_t sched_app) :
 	    bu::PluginDataKey(LINUX_PP_NAMESPACE, "cgroup"),
 	    papp(sched_app), pcg(NULL), pc_cpu(NULL),
@@ -156,6 +237,8 @@ struct CGroupData_t : public bbque::utils::PluginDataKey
 		}
 	}
 
+#endif
+
 };
 
 using CGroupDataPtr_t = std::shared_ptr<CGroupData_t>;
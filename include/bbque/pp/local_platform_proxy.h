@@ -73,6 +73,16 @@ public:
 				ResourceAssignmentMapPtr_t pres,
 				bool excl = true);
 
+	/**
+	 * @brief Start a batch of local resource mappings.
+	 */
+	ExitCode_t BeginMappings() override;
+
+	/**
+	 * @brief Enforce the local resource mappings of the current batch.
+	 */
+	ExitCode_t CommitMappings(std::vector<SchedPtr_t> & failed) override;
+
 	/**
 	 * @brief Actuate power management actions for to (local) not managed
 	 * resources
@@ -351,6 +351,23 @@ public:
 
 	typedef std::shared_ptr<InterConnect> InterConnect_t;
 
+	/**
+	 * @brief The kind of block I/O resource
+	 *
+	 * The bandwidth capacities [B/s] are "io" resources under the "blk" one
+	 * (sys0.blk0.io0 is the read bandwidth of the block device 0), while the
+	 * IOPS capacities are "iops" resources (sys0.blk0.iops1 is the write
+	 * IOPS capacity of the block device 0), so that the two are never summed.
+	 */
+	typedef enum IOKind
+	{
+		IO_READ_BANDWIDTH = 0,
+		IO_WRITE_BANDWIDTH,
+		IO_READ_IOPS,
+		IO_WRITE_IOPS,
+		IO_KIND_COUNT
+	} IOKind_t;
+
 	class IO : public Resource
 	{
 	public:
@@ -368,11 +385,53 @@ public:
 			return this->bandwidth;
 		}
 
+		void SetIOPS(uint64_t iops)
+		{
+			this->iops = iops;
+		}
+
+		uint64_t GetIOPS() const
+		{
+			return this->iops;
+		}
+
+		/**
+		 * @brief Set the kind of I/O resource, and then its type and ID
+		 */
+		void SetIOKind(IOKind_t kind)
+		{
+			this->io_kind = kind;
+			if (IsIOPS()) {
+				this->type = res::ResourceType::IOPS;
+				this->id = kind - IO_READ_IOPS;
+			}
+			else {
+				this->type = res::ResourceType::IO;
+				this->id = kind - IO_READ_BANDWIDTH;
+			}
+		}
+
+		IOKind_t GetIOKind() const
+		{
+			return this->io_kind;
+		}
+
+		bool IsIOPS() const
+		{
+			return (this->io_kind == IO_READ_IOPS)
+				|| (this->io_kind == IO_WRITE_IOPS);
+		}
+
 		void SetType(res::ResourceType type) = delete;
 
 	private:
 
-		uint64_t bandwidth;
+		/** Bandwidth capacity [B/s] */
+		uint64_t bandwidth = 0;
+
+		uint64_t iops = 0;
+
+		IOKind_t io_kind = IO_READ_BANDWIDTH;
 
 	};
 
@@ -20,12 +20,38 @@
 
 #include <cstdint>
 
+#include "bbque/res/bitset.h"
 #include "bbque/res/resource_assignment.h"
 #include "bbque/utils/logging/logger.h"
 
 namespace bbque { namespace res {
 
-class ResourceBitset;
+/**
+ * @struct BindingStep_t
+ * @brief A binding action requested by a scheduling policy
+ *
+ * A binding candidate is described by the sequence of binding actions to
+ * apply to the resource requests of a working mode. This allows the policy
+ * to try many candidates, building the resource assignments map only for
+ * the one actually selected.
+ */
+struct BindingStep_t
+{
+	/** Path to bind according to the filter mask (path-based binding) */
+	ResourcePathPtr_t resource_path;
+	/** The type of resource to bind (type-based binding) */
+	ResourceType r_type = ResourceType::UNDEFINED;
+	/** Recipe resource ID (type-based binding) */
+	BBQUE_RID_TYPE source_id = R_ID_NONE;
+	/** System resource ID (type-based binding) */
+	BBQUE_RID_TYPE out_id = R_ID_NONE;
+	/** Second level resource type to filter (type-based binding) */
+	ResourceType filter_rtype = ResourceType::UNDEFINED;
+	/** True if filter_mask must be applied (type-based binding) */
+	bool filtered = false;
+	/** IDs of the resources to include */
+	ResourceBitset filter_mask;
+};
 
 /**
  * @class ResourceBinder
@@ -70,7 +96,7 @@ public:
 			BBQUE_RID_TYPE out_id,
 			ResourceAssignmentMapPtr_t out_map,
 			ResourceType filter_rtype = ResourceType::UNDEFINED,
-			ResourceBitset * filter_mask = nullptr);
+			ResourceBitset const * filter_mask = nullptr);
 
 	/**
 	 * @brief Bind resource assignments to system resources
@@ -88,6 +114,33 @@ public:
 			ResourceBitset const & filter_mask,
 			ResourceAssignmentMapPtr_t out_map);
 
+	/**
+	 * @brief Apply a binding action to resource assignments
+	 *
+	 * @param source_map The map of resource assignments to bind
+	 * @param step The binding action
+	 * @param out_map A shared pointer to the map of bound resources to fill
+	 */
+	static void Bind(
+			ResourceAssignmentMap_t const & source_map,
+			BindingStep_t const & step,
+			ResourceAssignmentMapPtr_t out_map);
+
+	/**
+	 * @brief Check if a binding action would produce any assignment
+	 *
+	 * This allows to validate a binding action without building the map of
+	 * bound resource assignments.
+	 *
+	 * @param source_map The map of resource assignments to bind
+	 * @param step The binding action
+	 *
+	 * @return true if at least an assignment would be bound
+	 */
+	static bool Bindable(
+			ResourceAssignmentMap_t const & source_map,
+			BindingStep_t const & step);
+
 	/**
 	 * @brief Remove partially bound resource assignments
 	 *
@@ -18,7 +18,9 @@
 #ifndef BBQUE_RESOURCE_BITSET_H_
 #define BBQUE_RESOURCE_BITSET_H_
 
-#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 #include "bbque/res/identifier.h"
 
@@ -32,6 +34,10 @@ namespace bbque { namespace res {
  * the information.
  * This is commonly exploited to keep track of the IDs of a specific resource
  * type, from a set of resource assignments or resource descriptors.
+ *
+ * The bitset is sized at run-time, i.e., it grows to include the highest
+ * ID set. The bits are stored into 64-bit words, so that counting, searching
+ * and the set operations are performed a word at time.
  */
 class ResourceBitset {
 
@@ -53,66 +59,126 @@ public:
 	ExitCode_t Reset(BBQUE_RID_TYPE pos);
 
 	inline bool Test(BBQUE_RID_TYPE pos) const {
-		return bit_set.test(pos);
+		if ((pos < 0) || (WordIndex(pos) >= words.size()))
+			return false;
+		return (words[WordIndex(pos)] & BitMask(pos)) != 0;
 	}
 
-	inline BBQUE_RID_TYPE Count() const {
-		return count;
-	}
+	/**
+	 * @brief The number of bits set
+	 */
+	BBQUE_RID_TYPE Count() const;
 
-	inline BBQUE_RID_TYPE FirstSet() const {
-		return first_set;
-	}
+	/**
+	 * @brief The lowest ID set, or R_ID_NONE if the bitset is empty
+	 */
+	BBQUE_RID_TYPE FirstSet() const;
 
-	inline BBQUE_RID_TYPE LastSet() const {
-		return last_set;
-	}
+	/**
+	 * @brief The highest ID set, or R_ID_NONE if the bitset is empty
+	 */
+	BBQUE_RID_TYPE LastSet() const;
 
-	inline std::string ToString() const {
-		return bit_set.to_string();
+	inline bool None() const {
+		return FirstSet() == R_ID_NONE;
 	}
 
-	inline std::string const & ToStringCG() const {
-		return cg_str;
+	/**
+	 * @brief The current width (number of bits) of the bitset
+	 */
+	inline size_t Size() const {
+		return words.size() * BitsPerWord;
 	}
 
+	/**
+	 * @brief Binary string, from the highest ID set down to ID 0
+	 */
+	std::string ToString() const;
+
+	/**
+	 * @brief List of IDs in the format of the cpuset control group
+	 * attributes, where consecutive IDs are compressed into ranges
+	 * (e.g., "0-3,8,10-11")
+	 */
+	std::string ToStringCG() const;
+
+	/**
+	 * @brief The IDs from 0 to 63 as a bitmask
+	 *
+	 * @note Higher IDs are not included. Check FitsULong() first whenever
+	 * the bitset could be wider.
+	 */
 	inline unsigned long ToULong() const {
-		return bit_set.to_ulong();
+		return words.empty() ? 0 : static_cast<unsigned long>(words[0]);
 	}
 
+	/**
+	 * @brief True if ToULong() returns all the IDs set
+	 */
+	inline bool FitsULong() const {
+		return LastSet() < static_cast<BBQUE_RID_TYPE>(8 * sizeof(unsigned long));
+	}
+
+	/**
+	 * @brief True if at least one ID is set in both the bitsets
+	 */
+	bool Intersects(ResourceBitset const & rbs) const;
+
 	/*****************************************************************
 	 *                        Operators                              *
 	 *****************************************************************/
 
-	bool operator== (ResourceBitset const & rbs) {
-		return bit_set == rbs.bit_set;
+	bool operator== (ResourceBitset const & rbs) const;
+
+	bool operator!= (ResourceBitset const & rbs) const {
+		return !(*this == rbs);
 	}
 
-	bool operator!= (ResourceBitset const & rbs) {
-		return bit_set != rbs.bit_set;
+	bool operator[] (BBQUE_RID_TYPE pos) const {
+		return Test(pos);
 	}
 
-	bool operator[] (BBQUE_RID_TYPE pos) {
-		return bit_set[pos];
+	ResourceBitset & operator|= (const ResourceBitset & rbs);
+
+	ResourceBitset & operator&= (const ResourceBitset & rbs);
+
+	/**
+	 * @brief Remove the IDs set in another bitset (set difference)
+	 */
+	ResourceBitset & operator-= (const ResourceBitset & rbs);
+
+	ResourceBitset operator| (const ResourceBitset & rbs) const {
+		ResourceBitset result(*this);
+		return (result |= rbs);
 	}
 
-	ResourceBitset operator|= (const ResourceBitset & rbs);
+	ResourceBitset operator& (const ResourceBitset & rbs) const {
+		ResourceBitset result(*this);
+		return (result &= rbs);
+	}
 
-	ResourceBitset operator&= (const ResourceBitset & rbs);
+	ResourceBitset operator- (const ResourceBitset & rbs) const {
+		ResourceBitset result(*this);
+		return (result -= rbs);
+	}
 
 private:
 
-	std::bitset<BBQUE_MAX_R_ID_NUM+1> bit_set;
+	using Word_t = uint64_t;
 
-	BBQUE_RID_TYPE first_set;
+	static constexpr size_t BitsPerWord = 64;
 
-	BBQUE_RID_TYPE last_set;
+	/** The bits, from ID 0 upward. Trailing words may be zero */
+	std::vector<Word_t> words;
 
-	BBQUE_RID_TYPE count;
+	static inline size_t WordIndex(BBQUE_RID_TYPE pos) {
+		return static_cast<size_t>(pos) / BitsPerWord;
+	}
 
-	bool none;
+	static inline Word_t BitMask(BBQUE_RID_TYPE pos) {
+		return Word_t(1) << (static_cast<size_t>(pos) % BitsPerWord);
+	}
 
-	std::string cg_str;
 };
 
 } // namespace res
@@ -120,4 +186,3 @@ private:
 } // namespace bbque
 
 #endif // BBQUE_RESOURCE_BITSET_H_
-
@@ -187,7 +187,7 @@ public:
 	void SetResourcesList(
 	        ResourcePtrList_t & r_list,
 	        ResourceType filter_rtype,
-	        ResourceBitset & filter_mask);
+	        ResourceBitset const & filter_mask);
 
 	void SetResourcesList(
 	        ResourcePtrList_t & r_list,
@@ -18,7 +18,11 @@
 #ifndef BBQUE_RESOURCE_PATH_H_
 #define BBQUE_RESOURCE_PATH_H_
 
+#include <array>
 #include <bitset>
+#include <cassert>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -36,6 +40,104 @@ namespace bu = bbque::utils;
 namespace bbque { namespace res {
 
 
+/**
+ * @class ResourcePathKey
+ *
+ * Compact encoding of a resource path: a fixed-size array of integers, one
+ * for each level of the path, packing the resource type and ID. Equality,
+ * ordering and hashing are integer operations, not requiring to access the
+ * resource identifier objects.
+ */
+class ResourcePathKey {
+
+public:
+
+	ResourcePathKey():
+		num_levels(0) {
+		levels.fill(0);
+	}
+
+	/**
+	 * @brief Check if a resource ID can be encoded
+	 *
+	 * The IDs are encoded on 16 bits: the ones out of the int16_t range
+	 * would be truncated, thus aliasing other IDs.
+	 */
+	static bool Encodable(int32_t r_id) {
+		return (r_id >= INT16_MIN) && (r_id <= INT16_MAX);
+	}
+
+	/**
+	 * @brief Append a level (the caller checks MAX_NUM_LEVELS and the ID
+	 * through Encodable())
+	 */
+	void Append(ResourceType r_type, int32_t r_id) {
+		levels[num_levels++] = Encode(r_type, r_id);
+	}
+
+	/**
+	 * @brief Update the encoding of an existing level
+	 */
+	void Set(uint8_t level, ResourceType r_type, int32_t r_id) {
+		levels[level] = Encode(r_type, r_id);
+	}
+
+	void Clear() {
+		levels.fill(0);
+		num_levels = 0;
+	}
+
+	uint8_t NumLevels() const {
+		return num_levels;
+	}
+
+	/**
+	 * @brief Hash value of the key
+	 */
+	size_t Hash() const {
+		size_t h = num_levels;
+		for (uint8_t i = 0; i < num_levels; ++i)
+			h = h * 31 + levels[i];
+		return h;
+	}
+
+	bool operator== (ResourcePathKey const & key) const {
+		return (num_levels == key.num_levels) && (levels == key.levels);
+	}
+
+	bool operator!= (ResourcePathKey const & key) const {
+		return !(*this == key);
+	}
+
+	/**
+	 * Shorter paths come first. Paths of the same length are compared
+	 * level by level, by type and then by ID.
+	 */
+	bool operator< (ResourcePathKey const & key) const {
+		if (num_levels != key.num_levels)
+			return num_levels < key.num_levels;
+		return levels < key.levels;
+	}
+
+private:
+
+	/** Number of valid levels */
+	uint8_t num_levels;
+
+	/** Encoded levels (unused ones are zero) */
+	std::array<uint32_t, MAX_NUM_LEVELS> levels;
+
+	static_assert(sizeof(BBQUE_RID_TYPE) <= sizeof(int16_t),
+		"Resource IDs wider than 16 bits cannot be encoded");
+
+	/** Type in the upper half, (biased) ID in the lower one */
+	static uint32_t Encode(ResourceType r_type, int32_t r_id) {
+		assert(Encodable(r_id));
+		return (static_cast<uint32_t>(r_type) << 16) |
+			static_cast<uint16_t>(r_id + 0x8000);
+	}
+};
+
 
 /**
  * @class ResourcePath
@@ -69,7 +171,8 @@ public:
 		OK        = 0 ,
 		WRN_MISS_ID   ,
 		ERR_MISS_TYPE ,
-		ERR_USED_TYPE
+		ERR_USED_TYPE ,
+		ERR_MAX_LEVELS
 	};
 
 	/**
@@ -147,7 +250,8 @@ public:
 	 * @param r_id   The integer ID
 	 *
 	 * @return OK for success, ERR_UNKN_TYPE for unknown resource type,
-	 * ERR_USED_TYPE if the type has been already included in the path
+	 * ERR_USED_TYPE if the type has been already included in the path,
+	 * ERR_MAX_LEVELS if the path has already MAX_NUM_LEVELS levels
 	 */
 	ExitCode_t Append(ResourceType r_type, BBQUE_RID_TYPE r_id);
 
@@ -353,7 +457,23 @@ public:
 	/**
 	 * @brief Return the resource path in text string format
 	 */
-	std::string ToString() const;
+	std::string ToString() const {
+		return str_path;
+	}
+
+	/**
+	 * @brief The compact (integer) encoding of the path
+	 */
+	ResourcePathKey const & Key() const {
+		return key;
+	}
+
+	/**
+	 * @brief Hash value of the path
+	 */
+	size_t Hash() const {
+		return key.Hash();
+	}
 
 
 	/***********************************************************
@@ -405,12 +525,42 @@ private:
 
 	/** Number of levels counter */
 	uint8_t level_count;
+
+	/** Compact encoding of the levels, for comparisons */
+	ResourcePathKey key;
+
+	/** The path in text string format (kept updated) */
+	std::string str_path;
+
+	/**
+	 * @brief Rebuild the text string format of the path
+	 */
+	void UpdateString();
 };
 
 } // namespace bbque
 
 } // namespace res
 
+
+namespace std {
+
+template<>
+struct hash<bbque::res::ResourcePathKey> {
+	size_t operator()(bbque::res::ResourcePathKey const & key) const {
+		return key.Hash();
+	}
+};
+
+template<>
+struct hash<bbque::res::ResourcePath> {
+	size_t operator()(bbque::res::ResourcePath const & r_path) const {
+		return r_path.Hash();
+	}
+};
+
+} // namespace std
+
 #endif // BBQUE_RESOURCE_PATH_H_
 
 
@@ -22,10 +22,12 @@
 #include <list>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "bbque/utils/logging/logger.h"
 #include "bbque/res/resources.h"
+#include "bbque/res/resource_path.h"
 #include "bbque/res/resource_utils.h"
 
 #define RESOURCE_TREE_NAMESPACE "bq.rt"
@@ -111,6 +113,28 @@ public:
 	};
 
 
+	/**
+	 * @struct IndexEntry_t
+	 *
+	 * An entry of the resource path index: the resources matching a
+	 * combination of path levels, and their aggregated amounts not
+	 * depending on the state view.
+	 */
+	struct IndexEntry_t
+	{
+		/** Dense id of the entry */
+		uint32_t id = UINT32_MAX;
+		/** The matching resources */
+		ResourcePtrList_t resources;
+		/** Sum of the total amounts */
+		uint64_t total = 0;
+		/** Sum of the unreserved amounts of the online resources */
+		uint64_t unreserved = 0;
+		/** Number of offline resources */
+		uint32_t offline_count = 0;
+	};
+
+
 	/**
 	 * @brief Constructor
 	 */
@@ -179,6 +203,64 @@ public:
 	        ResourcePath & rsrc_path,
 	        uint16_t match_flags = 0) const;
 
+	/**
+	 * @brief Find a set of resources in the index
+	 *
+	 * Same matching rules of @ref find_list, but the result is the list
+	 * precomputed by @ref build_index, thus no list is built at each call.
+	 *
+	 * @param rsrc_path   A resource path object to match
+	 * @param match_flags The matching flags
+	 *
+	 * @return A pointer to the (immutable) list of resource descriptors, or
+	 * nullptr if the index is not available for this query. In that case
+	 * @ref find_list must be used.
+	 */
+	ResourcePtrList_t const * find_indexed(
+	        ResourcePath const & rsrc_path,
+	        uint16_t match_flags = 0) const;
+
+	/**
+	 * @brief Find the index entry of a set of resources
+	 *
+	 * @see find_indexed
+	 *
+	 * @return A pointer to the index entry, or nullptr if the index is not
+	 * available for this query
+	 */
+	IndexEntry_t const * find_entry(
+	        ResourcePath const & rsrc_path,
+	        uint16_t match_flags = 0) const;
+
+	/**
+	 * @brief Update the aggregated amounts of the index entries including
+	 * a resource
+	 *
+	 * To call whenever the total, the reserved amount or the online status
+	 * of the resource changes.
+	 */
+	void refresh_index(Resource const & resource);
+
+	/**
+	 * @brief The generation of the index
+	 *
+	 * Incremented at each @ref build_index. Zero if the index has never
+	 * been built.
+	 */
+	uint32_t index_generation() const {
+		return index_gen;
+	}
+
+	/**
+	 * @brief Build the index of the resource paths
+	 *
+	 * For each node of the tree, the node is added to the lists matching all
+	 * the combinations of the path levels, each one given by type and ID
+	 * or by the type only. The index must be rebuilt after inserting new
+	 * resources, and it is invalidated by @ref insert.
+	 */
+	void build_index();
+
 	/**
 	 * @brief Maximum depth of the tree
 	 * @return The maxim depth value
@@ -200,6 +282,9 @@ public:
 	 */
 	inline void clear() {
 		clear_node(root);
+		index.clear();
+		index_entries.clear();
+		index_ready = false;
 	}
 
 private:
@@ -216,6 +301,37 @@ private:
 	/** Counter of resources */
 	uint16_t count;
 
+	/**
+	 * Index of the resource path matchings. The key is the sequence of
+	 * type and ID (R_ID_ANY if matching the type only) of the path levels.
+	 */
+	std::unordered_map<ResourcePathKey, IndexEntry_t> index;
+
+	/** The index entries, by id */
+	std::vector<IndexEntry_t *> index_entries;
+
+	/** True if the index is consistent with the tree content */
+	bool index_ready = false;
+
+	/** Generation of the index */
+	uint32_t index_gen = 0;
+
+	/**
+	 * @brief Compute the aggregated amounts of an index entry
+	 */
+	static void aggregate_entry(IndexEntry_t & entry);
+
+	/**
+	 * @brief Add a node, and recursively its children, to the index
+	 *
+	 * @param node The tree node
+	 * @param levels Type and ID of the path levels down to the node
+	 *
+	 * @return false if a resource ID cannot be indexed
+	 */
+	bool index_node(ResourceNodePtr_t node,
+	                std::vector<std::pair<ResourceType, int32_t>> & levels);
+
 	/**
 	 * @brief Find a node
 	 *
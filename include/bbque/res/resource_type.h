@@ -21,7 +21,7 @@
 #define R_ID_ANY            -1
 #define R_ID_NONE           -2
 
-#define R_TYPE_COUNT        12
+#define R_TYPE_COUNT        13
 
 /** Data-type for the Resource IDs */
 typedef int16_t BBQUE_RID_TYPE;
@@ -50,6 +50,7 @@ enum class ResourceType
 	INTERCONNECT ,
 	BLOCK 		 ,
 	IO           ,
+	IOPS         ,
 	CUSTOM       ,
 };
 
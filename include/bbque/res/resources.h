@@ -20,17 +20,18 @@
 
 #include <cstdint>
 #include <cstring>
+#include <deque>
 #include <list>
 #include <map>
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "bbque/config.h"
 #include "bbque/app/application_status.h"
 #include "bbque/pm/power_manager.h"
 #include "bbque/res/resource_path.h"
+#include "bbque/utils/flat_map.h"
 #include "bbque/utils/utility.h"
 #include "bbque/utils/timer.h"
 #include "bbque/utils/stats.h"
@@ -52,6 +53,7 @@ namespace res {
 
 // Forward declarations
 class Resource;
+class ResourceTree;
 struct ResourceState;
 
 /** Resource state view token data type */
@@ -69,11 +71,17 @@ using ResourcePtrListIterator_t = ResourcePtrList_t::iterator;
 /** Shared pointer to ResourceState object */
 using ResourceStatePtr_t = std::shared_ptr<ResourceState>;
 
-/** Map of amounts of resource used by applications. Key: Application UID */
-using AppUsageQtyMap_t = std::map<AppUid_t, uint64_t>;
+/** Number of resource holders stored without memory allocations */
+#define BBQUE_RES_INLINE_HOLDERS 4
+
+/**
+ * Map of amounts of resource used by applications. Key: Application UID.
+ * Most of the resources are held by a few applications at a time, thus a
+ * sorted flat container is used in place of a tree
+ */
+using AppUsageQtyMap_t =
+	bbque::utils::SmallFlatMap<AppUid_t, uint64_t, BBQUE_RES_INLINE_HOLDERS>;
 
-/** Hash map collecting the state views of a resource */
-using RSHashMap_t = std::unordered_map<RViewToken_t, ResourceStatePtr_t>;
 
 
 using ResourcePathPtr_t = std::shared_ptr<ResourcePath>;
@@ -118,6 +126,133 @@ struct ResourceState
 
 };
 
+/**
+ * @class ResourceStateView
+ *
+ * @brief The usage state of all the resources, according to a given view
+ *
+ * A view collects the states of the resources touched since its creation,
+ * indexed by the dense index of the resource (@see Resource::StateIndex).
+ * A resource which has not been touched is not allocated at all in the
+ * view. The states are stored contiguously and released all together
+ * with the view, so that creating and discarding a view, or committing it
+ * as the system one, does not require to visit every resource.
+ *
+ * The life-cycle of the views is managed by the ResourceAccounter.
+ */
+class ResourceStateView
+{
+public:
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param token The token referencing the view
+	 * @param index_gen The generation of the resource tree index the
+	 * aggregated amounts refer to (@see ResourceTree::build_index)
+	 */
+	ResourceStateView(RViewToken_t _token, uint32_t _index_gen = 0) :
+	    token(_token), index_gen(_index_gen) { }
+
+	/**
+	 * @brief Copy constructor
+	 *
+	 * @param other The view to copy
+	 * @param token The token referencing the copy
+	 */
+	ResourceStateView(ResourceStateView const & other, RViewToken_t _token);
+
+	ResourceStateView(ResourceStateView const &) = delete;
+	ResourceStateView & operator=(ResourceStateView const &) = delete;
+
+	/**
+	 * @brief The token referencing the view
+	 */
+	RViewToken_t Token() const
+	{
+		return token;
+	}
+
+	/**
+	 * @brief The state of a resource
+	 *
+	 * @param idx The state index of the resource
+	 * @return The state, or nullptr if the resource has not been touched
+	 */
+	ResourceState * Get(uint32_t idx) const
+	{
+		if (idx >= index.size())
+			return nullptr;
+		return index[idx];
+	}
+
+	/**
+	 * @brief The state of a resource, allocated if missing
+	 *
+	 * @param idx The state index of the resource
+	 * @return The state of the resource in the view
+	 */
+	ResourceState * GetOrCreate(uint32_t idx);
+
+	/**
+	 * @brief The number of resources touched in the view
+	 */
+	size_t TouchedCount() const
+	{
+		return states.size();
+	}
+
+	/**
+	 * @brief Update the amount used, aggregated per resource tree index
+	 * entry
+	 *
+	 * @param entries The index entries including the resource
+	 * @param gen The index generation the entries refer to. If it does not
+	 * match the one of the view, the aggregates are not valid anymore.
+	 * @param amount The amount acquired (positive) or released (negative)
+	 */
+	void AddUsed(std::vector<uint32_t> const & entries, uint32_t gen,
+		int64_t amount);
+
+	/**
+	 * @brief The amount used, aggregated for an index entry
+	 *
+	 * @param entry_id The id of the resource tree index entry
+	 * @param gen The current index generation
+	 * @param used The aggregated amount
+	 *
+	 * @return false if the aggregates are not valid for this generation
+	 */
+	bool GetUsed(uint32_t entry_id, uint32_t gen, uint64_t & used) const
+	{
+		if ((gen == 0) || (gen != index_gen))
+			return false;
+		used = (entry_id < used_sums.size()) ? used_sums[entry_id] : 0;
+		return true;
+	}
+
+private:
+
+	/** The token referencing the view */
+	RViewToken_t token;
+
+	/** Generation of the resource tree index of the aggregates */
+	uint32_t index_gen;
+
+	/** Amount used, by resource tree index entry */
+	std::vector<uint64_t> used_sums;
+
+	/** Pointers to the states, by resource state index */
+	std::vector<ResourceState *> index;
+
+	/** The states of the touched resources (stable addresses) */
+	std::deque<ResourceState> states;
+
+};
+
+/** Shared pointer to ResourceStateView object */
+using ResourceStateViewPtr_t = std::shared_ptr<ResourceStateView>;
+
 /**
  * @class Resource
  * @brief A generic resource descriptor
@@ -138,6 +273,8 @@ class Resource : public ResourceIdentifier, public ExtraDataContainer
 {
 	// This makes method SetTotal() accessible to RA
 	friend class bbque::ResourceAccounter;
+	// This makes the index entries accessible to the resource tree
+	friend class ResourceTree;
 
 public:
 
@@ -327,7 +464,6 @@ public:
 	 */
 	~Resource()
 	{
-		state_views.clear();
 #ifdef CONFIG_BBQUE_PM
 		pw_profile.values.clear();
 #endif
@@ -448,12 +584,14 @@ public:
 	}
 
 	/**
-	 * @brief The number of state views of the resource
-	 * @return The size of the map
+	 * @brief The index of the resource in the state views
+	 *
+	 * Each resource descriptor is assigned a unique index at construction
+	 * time, used to address its state in a ResourceStateView.
 	 */
-	size_t ViewCount() const
+	uint32_t StateIndex() const
 	{
-		return state_views.size();
+		return state_idx;
 	}
 
 
@@ -700,20 +838,23 @@ private:
 	ReliabilityProfile_t rb_profile;
 
 	/**
-	 * Hash map with all the views of the resource.
-	 * A "view" is a resource state. We can think at the hash map as a map
-	 * containing the "real" state of resource, plus other "temporary" states.
-	 * Such temporary states allows the Scheduler/Optimizer, i.e., to make
-	 * intermediate evaluations, before commit the ultimate scheduling.
-	 *
-	 * Each view is identified by a "token" which is hashed in order to
-	 * retrieve the ResourceState descriptor.
+	 * Index of the resource state in the views.
+	 * A "view" is a resource state. The ResourceAccounter keeps the "real"
+	 * state of the resources, plus other "temporary" states. Such temporary
+	 * states allows the Scheduler/Optimizer, i.e., to make intermediate
+	 * evaluations, before commit the ultimate scheduling.
 	 *
-	 * It's up to the Resource Accounter to maintain a consistent view of the
-	 * system state. Thus ResourceAccounter will manage tokens and the state
-	 * views life-cycle.
+	 * Each view is identified by a "token", used to retrieve the
+	 * ResourceStateView from the ResourceAccounter. The state of this
+	 * resource is then found at this index of the view.
 	 */
-	RSHashMap_t state_views;
+	uint32_t state_idx;
+
+	/** The resource tree index entries including this resource */
+	std::vector<uint32_t> index_entries;
+
+	/** The generation of the resource tree index of index_entries */
+	uint32_t index_gen = 0;
 
 	/**
 	 * @brief Availability information initialization
@@ -801,23 +942,11 @@ private:
 	 * @brief Get the view referenced by the token
 	 *
 	 * @param view_id The resource state view token
-	 * @return The ResourceState fo the referenced view
+	 * @return The ResourceState fo the referenced view, or nullptr if the
+	 * resource has not been touched in the view. The pointer keeps the whole
+	 * view alive.
 	 */
 	ResourceStatePtr_t GetStateView(RViewToken_t view_id) const;
-
-	/**
-	 * @brief Delete a state view
-	 *
-	 * If the token refers to the default view, the method returns doing
-	 * nothing. This control is ahead of safety and consistency purposes.
-	 * Indeed if the default view was removed, what state should be picked as
-	 * the new default one?
-	 * Thus, this constraint force the caller to set a new default view, before
-	 * delete the current one.
-	 *
-	 * @param view_id The token of the view to delete
-	 */
-	void DeleteView(RViewToken_t view_id);
 };
 
 
@@ -18,10 +18,12 @@
 #ifndef BBQUE_RESOURCE_ACCOUNTER_H_
 #define BBQUE_RESOURCE_ACCOUNTER_H_
 
+#include <atomic>
 #include <condition_variable>
 #include <map>
 #include <set>
 #include <thread>
+#include <unordered_map>
 
 #include "bbque/resource_accounter_conf.h"
 #include "bbque/config.h"
@@ -47,8 +49,7 @@ using AppAssignmentsMap_t = std::map<AppUid_t, br::ResourceAssignmentMapPtr_t>;
 using AppAssignmentsMapPtr_t = std::shared_ptr<AppAssignmentsMap_t>;
 using AppAssignmentsViewsMap_t = std::map<br::RViewToken_t, AppAssignmentsMapPtr_t>;
 using ResourceSet_t = std::set<br::ResourcePtr_t>;
-using ResourceSetPtr_t = std::shared_ptr<ResourceSet_t>;
-using ResourceViewsMap_t = std::map<br::RViewToken_t, ResourceSetPtr_t>;
+using ResourceViewsMap_t = std::unordered_map<br::RViewToken_t, br::ResourceStateViewPtr_t>;
 
 class ApplicationManager;
 
@@ -508,9 +509,24 @@ public:
 	 */
 	br::RViewToken_t GetSystemView() const
 	{
-		return sys_view_token;
+		return LoadSystemView()->token;
 	}
 
+	/**
+	 * @brief Get the resource state view referenced by a token
+	 *
+	 * The system view is read from the published snapshot, without
+	 * locking. The returned pointer keeps the view alive, even if it is
+	 * replaced or released in the meanwhile. The system view must not be
+	 * modified through it: the accounter updates a copy of the system
+	 * view, and then publishes it.
+	 *
+	 * @param view_id The token of the view (0 for the system view)
+	 *
+	 * @return The view, or nullptr if the token is unknown
+	 */
+	br::ResourceStateViewPtr_t GetStateView(br::RViewToken_t view_id) const;
+
 	/**
 	 * @brief Get the synchronization resource state view
 	 *
@@ -701,15 +717,24 @@ private:
 	/** Conditional variable for status synchronization */
 	std::condition_variable status_cv;
 
-	/** This contain the status of the Resource Accounter */
-	State status;
+	/**
+	 * This contain the status of the Resource Accounter. Updated while
+	 * holding status_mtx, it can be checked without locking.
+	 */
+	std::atomic<State> status;
 
 
 	/** The tree of all the resources in the system.*/
 	br::ResourceTree resources;
 
 	/** The resource paths registered (strings and objects) */
-	std::map<std::string, br::ResourcePathPtr_t> resource_paths;
+	std::unordered_map<std::string, br::ResourcePathPtr_t> resource_paths;
+
+	/**
+	 * Mutex protecting the resource paths map, which is updated by
+	 * GetPath() even from concurrent scheduling partitions
+	 */
+	std::mutex paths_mtx;
 
 	/** The resource paths grouped in lists per architecture type (derived from the model string) */
 	std::map<ArchType, std::list<br::ResourcePathPtr_t>> per_arch_resource_path_list;
@@ -745,20 +770,60 @@ private:
 	AppAssignmentsViewsMap_t assign_per_views;
 
 	/**
-	 * Keep track of the resources allocated for each view. This data
-	 * structure is needed to supports easily a view deletion or to set a view
-	 * as the new system state.
+	 * Mutex protecting the maps of the views (assign_per_views and
+	 * state_per_views), which are looked up even from the scheduling
+	 * partitions and the policies threads
+	 */
+	mutable std::mutex views_mtx;
+
+	/**
+	 * The resource state views, by token. Each view owns the states of the
+	 * resources touched in it, thus deleting a view or setting it as the
+	 * new system state does not require to visit the resources.
+	 */
+	ResourceViewsMap_t state_per_views;
+
+	/**
+	 * @struct SystemView_t
+	 * @brief The resources system state (default view)
+	 *
+	 * An immutable snapshot, published by SetView or after a copy of the
+	 * system view has been updated (@see _CopySystemView). Readers get a
+	 * reference to the current snapshot, so that the state views it points
+	 * to are reclaimed only when the last reader drops it.
+	 */
+	struct SystemView_t
+	{
+		/** The token of the view */
+		br::RViewToken_t token;
+		/** The state of the resources */
+		br::ResourceStateViewPtr_t states;
+		/** The map of applications resource assignments */
+		AppAssignmentsMapPtr_t assignments;
+	};
+
+	/**
+	 * The current system view snapshot. It must be accessed only through
+	 * std::atomic_load/std::atomic_store, which are not lock-free: readers
+	 * use LoadSystemView().
 	 */
-	ResourceViewsMap_t rsrc_per_views;
+	std::shared_ptr<SystemView_t const> sys_view;
 
 	/**
-	 * Pointer (shared) to the map of applications resource assignments, currently
-	 * describing the resources system state (default view).
+	 * The generation of the published snapshot, increased after each
+	 * publication. It tells the readers when to load the snapshot again.
 	 */
-	AppAssignmentsMapPtr_t sys_assign_view;
+	std::atomic<uint64_t> sys_view_gen;
+
+	/**
+	 * Mutex serializing the updates of the system view: copy, update and
+	 * publication of a copy, or publication of a new view by SetView
+	 */
+	std::mutex sys_view_mtx;
 
 	/**
 	 * The token referencing the system resources state (default view).
+	 * Writers side copy of sys_view->token.
 	 */
 	br::RViewToken_t sys_view_token;
 
@@ -824,6 +889,54 @@ private:
 	 */
 	ExitCode_t _PutView(br::RViewToken_t tok);
 
+	/**
+	 * @brief Publish a new snapshot of the system view
+	 *
+	 * @param tok The token of the view
+	 * @param states The state of the resources in the view
+	 * @param assignments The applications resource assignments in the view
+	 */
+	void PublishSystemView(br::RViewToken_t tok,
+			br::ResourceStateViewPtr_t states,
+			AppAssignmentsMapPtr_t assignments);
+
+	/**
+	 * @brief The current snapshot of the system view
+	 *
+	 * Each thread keeps a reference to the last snapshot it has read, and
+	 * loads the published one again only after a new publication. Thus,
+	 * the (locked) std::atomic_load is not on the readers path.
+	 */
+	std::shared_ptr<SystemView_t const> LoadSystemView() const;
+
+	/**
+	 * @brief Copy the system view into a new (private) view
+	 *
+	 * The published snapshot is never modified: bookings and releases on
+	 * the system view are performed on the copy, which is then published
+	 * by _PublishSystemViewCopy, or dropped by _PutView.
+	 * The caller must hold sys_view_mtx until then.
+	 *
+	 * @return The token of the copy
+	 */
+	br::RViewToken_t _CopySystemView();
+
+	/**
+	 * @brief Publish an updated copy of the system view
+	 *
+	 * @param copy_view The token returned by _CopySystemView
+	 */
+	void _PublishSystemViewCopy(br::RViewToken_t copy_view);
+
+	/**
+	 * @brief Check if a view exists
+	 */
+	bool ExistView(br::RViewToken_t tok) const
+	{
+		std::unique_lock<std::mutex> views_ul(views_mtx);
+		return (state_per_views.find(tok) != state_per_views.end());
+	}
+
 
 	/**
 	 * @brief Get a list of resource descriptor
@@ -859,6 +972,38 @@ private:
 			QueryOption_t q_opt, br::RViewToken_t status_view = 0,
 			ba::SchedPtr_t papp = ba::SchedPtr_t()) const;
 
+	/**
+	 * @brief The amount used in a view, aggregated over the resources of a
+	 * resource tree index entry
+	 *
+	 * @return false if the aggregated amount is not available
+	 */
+	bool GetAggregatedUsed(
+			br::ResourceTree::IndexEntry_t const * entry,
+			br::RViewToken_t status_view,
+			uint64_t & used) const;
+
+	/**
+	 * @brief Return a state parameter (availability, resources used, total
+	 * amount) for the resources referenced by a path.
+	 *
+	 * The precomputed list of matching resources is used, if available
+	 * (@see ResourceTree::find_indexed).
+	 *
+	 * @param resource_path_ptr The resource path
+	 * @param rpc The class of resource path
+	 * @param q_opt Resource state attribute requested (@see QueryOption_t)
+	 * @param status_view The token referencing the resource state view
+	 * @param papp The application interested in the query
+	 *
+	 * @return The value of the attribute request
+	 */
+	uint64_t QueryStatus(
+			br::ResourcePathPtr_t resource_path_ptr,
+			PathClass_t rpc,
+			QueryOption_t q_opt, br::RViewToken_t status_view = 0,
+			ba::SchedPtr_t papp = ba::SchedPtr_t()) const;
+
 	/**
 	 * @brief Check the resource availability for a whole set
 	 *
@@ -944,7 +1089,6 @@ private:
 	 * @param papp The Application/ExC using the resource
 	 * @param r_assign Usage object
 	 * @param status_view The token referencing the resource state view
-	 * @param rsrc_set The set of systems resources in use
 	 *
 	 * @return RA_ERR_USAGE_EXC if the usage required overcome the
 	 * availability. RA_SUCCESS otherwise.
@@ -952,8 +1096,7 @@ private:
 	ExitCode_t DoResourceBooking(
 				ba::SchedPtr_t const & papp,
 				br::ResourceAssignmentPtr_t & r_assign,
-				br::RViewToken_t status_view,
-				ResourceSetPtr_t & rsrc_set);
+				br::RViewToken_t status_view);
 
 	/**
 	 * @brief Release the resources
@@ -1023,7 +1166,6 @@ private:
 	 * @param papp The Application/ExC using the resource
 	 * @param r_assign Usage object
 	 * @param status_view The token referencing the resource state view
-	 * @param rsrc_set The set of systems resources in use
 	 *
 	 * @return RA_SUCCESS for successful return.
 	 * RA_ERR_MISS_VIEW if the resource state view provided is missing.
@@ -1033,8 +1175,7 @@ private:
 	ExitCode_t UndoResourceBooking(
 				ba::SchedPtr_t const & papp,
 				br::ResourceAssignmentPtr_t & r_assign,
-				br::RViewToken_t status_view,
-				ResourceSetPtr_t & rsrc_set);
+				br::RViewToken_t status_view);
 
 	/**
 	 * @brief Init the synchronized mode session
@@ -1061,8 +1202,7 @@ private:
 	 */
 	bool Synching()
 	{
-		std::unique_lock<std::mutex> status_ul(status_mtx);
-		return (status == State::SYNC);
+		return (status.load() == State::SYNC);
 	}
 
 	/**
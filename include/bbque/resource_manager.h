@@ -249,6 +249,14 @@ private:
 	 */
 	bool is_ready = true;
 
+#ifdef CONFIG_BBQUE_RM_COALESCED
+	/**
+	 * @brief An optimization has been requested while another one was in
+	 * progress
+	 */
+	bool resched_pending = false;
+#endif
+
 	std::mutex status_mtx;
 
 	std::condition_variable status_cv;
@@ -286,6 +294,7 @@ private:
 		RM_SCHED_FAILED,
 		RM_SCHED_DELAYED,
 		RM_SCHED_EMPTY,
+		RM_SCHED_COALESCED,
 
 		RM_SYNCH_TOTAL,
 		RM_SYNCH_FAILED,
@@ -364,6 +373,33 @@ private:
 	 */
 	void SetReady(bool value);
 
+	/**
+	 * @brief Request an optimization run after the given timeout
+	 *
+	 * With the coalesced re-optimization enabled, the requests received
+	 * while an optimization is in progress are merged into a single new
+	 * run, started right after the current synchronization is over (i.e.,
+	 * on the just committed resource assignment), without waiting for the
+	 * activation time.
+	 */
+	void ScheduleOptimization(milliseconds timeout = milliseconds(0));
+
+#ifdef CONFIG_BBQUE_RM_COALESCED
+	/**
+	 * @brief Check for optimization requests received during the last run
+	 *
+	 * If no further run is required, or the maximum number of back-to-back
+	 * runs has been reached, the optimization is terminated and the ready
+	 * state restored. In the latter case, the pending request is served by
+	 * a deferred optimization.
+	 *
+	 * @param runs The number of runs already performed
+	 *
+	 * @return true if a new run must be started, false otherwise
+	 */
+	bool CoalesceNextRun(uint16_t runs);
+#endif
+
 	/**
 	 * @brief Run on optimization cycle (i.e. Schedule and Synchronization)
 	 * Once an event happens which impacts on resources usage or availability
@@ -374,6 +410,11 @@ private:
 	 */
 	void Optimize();
 
+	/**
+	 * @brief A single scheduling and synchronization run
+	 */
+	void OptimizeRun();
+
 #ifdef CONFIG_BBQUE_ENERGY_MONITOR
 
 	/**
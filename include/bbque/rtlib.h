@@ -39,8 +39,11 @@ extern "C" {
 /**
  * @brief The RTLib revision version
  * @ingroup rtlib_sec03_plain_services
+ *
+ * It must match against the BarbequeRTRM revision too: a new revision
+ * could renumber the RPC messages (@see rpc_msg_type_t)
  */
-#define RTLIB_VERSION_MINOR 4
+#define RTLIB_VERSION_MINOR 5
 
 /**
  * @brief The maximum length for a recipe name
@@ -1064,6 +1067,8 @@ typedef struct RTLIB_Config
 			BBQUE_DEFAULT_RTLIB_RTPROF_REARM_TIME_MS;
 		uint16_t rt_profile_wait_for_sync_ms =
 			BBQUE_DEFAULT_RTLIB_RTPROF_WAIT_FOR_SYNC_MS;
+		uint16_t rt_profile_batch_window_ms =
+			BBQUE_DEFAULT_RTLIB_RTPROF_BATCH_WINDOW_MS;
 	} runtime_profiling;
 
 	// Unmanaged execution
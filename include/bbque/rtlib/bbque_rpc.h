@@ -21,6 +21,7 @@
 #include "bbque/rtlib.h"
 #include "bbque/config.h"
 #include "bbque/rtlib/rpc/rpc_messages.h"
+#include "bbque/utils/buffer_pool.h"
 #include "bbque/utils/stats.h"
 #include "bbque/utils/utility.h"
 #include "bbque/utils/timer.h"
@@ -189,6 +190,35 @@ public:
 	 */
 	RTLIB_ExitCode_t ForwardRuntimeProfile(const RTLIB_EXCHandler_t exc_handler);
 
+	/**
+	 * @brief Queue a runtime profile, to be forwarded with the next batch
+	 *
+	 * A profile still pending for the same EXC is replaced.
+	 */
+	void QueueRuntimeProfile(rpc_msg_EXC_RTNOTIFY_sample_t const & sample);
+
+	/**
+	 * @brief Forward the pending runtime profiles in a single batch, if
+	 * the batch window has elapsed
+	 *
+	 * @param force forward the pending profiles in any case
+	 */
+	RTLIB_ExitCode_t FlushRuntimeProfiles(bool force = false);
+
+	/**
+	 * @brief Forward the pending runtime profiles at the end of their batch
+	 * window, even if no EXC is cycling (thread body)
+	 */
+	void RuntimeProfilesFlusher();
+
+	/**
+	 * @brief Stop the runtime profiles flusher, forwarding the profiles
+	 * still pending
+	 *
+	 * This must be called before releasing the communication channel.
+	 */
+	void StopRuntimeProfilesFlusher();
+
 	/**
 	 * @brief
 	 * @param exc_handler
@@ -988,6 +1018,15 @@ protected:
 					int cycle_time_ms,
 					int cycle_time) = 0;
 
+	/**
+	 * @brief Notify the runtime profiles of a set of EXCs
+	 *
+	 * By default, the profiles are notified one by one, by _RTNotify.
+	 * Channels supporting batch messages should override this.
+	 */
+	virtual RTLIB_ExitCode_t _RTNotifyBatch(
+			std::vector<rpc_msg_EXC_RTNOTIFY_sample_t> const & samples);
+
 	virtual RTLIB_ExitCode_t _ScheduleRequest(pRegisteredEXC_t exc) = 0;
 
 	virtual void _Exit() = 0;
@@ -1125,6 +1164,15 @@ protected:
 	 */
 	pid_t restore_pid = 0;
 
+	/**
+	 * @brief The buffers of the variable size messages
+	 *
+	 * Size classes from 64 Bytes up to PIPE_BUF, with a few buffers cached
+	 * per class, since just the command threads and the channel thread
+	 * exchange messages.
+	 */
+	bu::BufferPool msg_pool{64, 7, 4};
+
 private:
 
 	/**
@@ -1150,6 +1198,31 @@ private:
 	 */
 	typedef std::pair<uint8_t, pRegisteredEXC_t> excMapEntry_t;
 
+	/**
+	 * @brief The runtime profiles waiting to be forwarded, by EXC ID
+	 */
+	std::map<uint8_t, rpc_msg_EXC_RTNOTIFY_sample_t> rtp_batch;
+
+	/**
+	 * @brief Started when the oldest pending runtime profile is queued
+	 */
+	bu::Timer rtp_batch_timer;
+
+	std::mutex rtp_batch_mtx;
+
+	/**
+	 * @brief Notified on the first pending runtime profile, and on the
+	 * flusher termination
+	 */
+	std::condition_variable rtp_batch_cv;
+
+	/**
+	 * @brief The thread forwarding the runtime profiles batches
+	 */
+	std::thread rtp_flusher;
+
+	bool rtp_flusher_done = false;
+
 	/**
 	 * @brief The path of the application CGroup
 	 */
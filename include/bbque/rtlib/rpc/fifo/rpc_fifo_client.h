@@ -77,6 +77,9 @@ protected:
 				int cycle_time_ms,
 				int cycle_count);
 
+	RTLIB_ExitCode_t _RTNotifyBatch(
+			std::vector<rpc_msg_EXC_RTNOTIFY_sample_t> const & samples);
+
 	void _Exit();
 
 	inline uint32_t RpcMsgToken()
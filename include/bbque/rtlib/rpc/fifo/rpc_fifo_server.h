@@ -109,6 +109,7 @@ RPC_FIFO_DEFINE_MESSAGE(EXC_UNREGISTER);
 RPC_FIFO_DEFINE_MESSAGE(EXC_SET);
 RPC_FIFO_DEFINE_MESSAGE(EXC_CLEAR);
 RPC_FIFO_DEFINE_MESSAGE(EXC_RTNOTIFY);
+RPC_FIFO_DEFINE_MESSAGE(EXC_RTNOTIFY_BATCH);
 RPC_FIFO_DEFINE_MESSAGE(EXC_START);
 RPC_FIFO_DEFINE_MESSAGE(EXC_STOP);
 RPC_FIFO_DEFINE_MESSAGE(EXC_SCHEDULE);
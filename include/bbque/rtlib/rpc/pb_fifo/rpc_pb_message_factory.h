@@ -4,6 +4,8 @@
 #define AOS_PROJECT_MESSAGE_FACTORY_H
 
 //#include <memory>
+#include <cstddef>
+#include <google/protobuf/arena.h>
 #include "rpc_messages.pb.h"
 #include "bbque/rtlib/rpc/rpc_messages.h"
 
@@ -27,6 +29,45 @@ public:
 
 };
 
+
+/**
+ * @brief A protobuf arena backed by an inline memory block
+ *
+ * The messages created on the arena (e.g., the ones built or parsed for a
+ * single RPC message) are allocated from the inline block: a stack
+ * instance does not use the heap, unless the messages grow bigger than the
+ * block.
+ */
+template <size_t BLOCK_SIZE = 2048>
+class PBMessageArena {
+
+public:
+
+    PBMessageArena() : arena(Options()) { }
+
+    PBMessageArena(PBMessageArena const &) = delete;
+    PBMessageArena & operator=(PBMessageArena const &) = delete;
+
+    template <typename T>
+    T & Create() {
+        return *google::protobuf::Arena::CreateMessage<T>(&arena);
+    }
+
+private:
+
+    alignas(alignof(std::max_align_t)) char block[BLOCK_SIZE];
+
+    google::protobuf::Arena arena;
+
+    google::protobuf::ArenaOptions Options() {
+        google::protobuf::ArenaOptions options;
+        options.initial_block = block;
+        options.initial_block_size = BLOCK_SIZE;
+        return options;
+    }
+
+};
+
 } } // Close namespaces
 
 
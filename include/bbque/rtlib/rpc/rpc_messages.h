@@ -31,6 +31,8 @@ namespace rtlib {
  *
  * The value of the message identifier is used to give priority to messages.
  * The higer the message id the higer the message priority.
+ * Adding a message renumbers the following ones: the RTLib revision must be
+ * increased, since the BarbequeRTRM pairs only with its own revision.
  */
 typedef enum rpc_msg_type
 {
@@ -50,6 +52,7 @@ typedef enum rpc_msg_type
 	RPC_EXC_REGISTER,
 	RPC_EXC_RTNOTIFY, // 10
 	RPC_EXC_UNREGISTER,
+	RPC_EXC_RTNOTIFY_BATCH,
 	RPC_EXC_RESP, ///< Response to an EXC request
 	RPC_EXC_MSGS_COUNT, ///< The number of EXC originated messages
 
@@ -211,6 +214,43 @@ typedef struct rpc_msg_EXC_RTNOTIFY
 	int cycle_count;
 } rpc_msg_EXC_RTNOTIFY_t;
 
+/**
+ * @brief The maximum number of runtime profiles in a single batch.
+ *
+ * This keeps a batch well below the size of an atomic FIFO write.
+ */
+#define RPC_EXC_RTNOTIFY_BATCH_MAX 32
+
+/**
+ * @brief The runtime profile of an execution context, within a batch.
+ */
+typedef struct rpc_msg_EXC_RTNOTIFY_sample
+{
+	/** The execution context the profile refers to */
+	uint8_t exc_id;
+	/** The asserted Goal-Gap */
+	int cps_goal_gap;
+	int cpu_usage;
+	int cycle_time_ms;
+	int cycle_count;
+} rpc_msg_EXC_RTNOTIFY_sample_t;
+
+/**
+ * @brief Command to notify the runtime profiles of a set of execution
+ * contexts.
+ *
+ * The exc_id of the header is not used.
+ */
+typedef struct rpc_msg_EXC_RTNOTIFY_BATCH
+{
+	/** The RPC fifo command header */
+	rpc_msg_header_t hdr;
+	/** The count of following profiles */
+	uint8_t count;
+	/** The set of notified profiles */
+	rpc_msg_EXC_RTNOTIFY_sample_t samples;
+} rpc_msg_EXC_RTNOTIFY_BATCH_t;
+
 /**
  * @brief Command to start an execution context.
  */
@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_RPC_SHM_CLIENT_H_
+#define BBQUE_RPC_SHM_CLIENT_H_
+
+#include "bbque/rtlib.h"
+#include "bbque/rtlib/bbque_rpc.h"
+#include "bbque/rtlib/rpc/rpc_messages.h"
+#include "bbque/rtlib/rpc/shm/rpc_shm_server.h"
+
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+
+namespace bbque {
+namespace rtlib {
+
+/**
+ * @class BbqueRPC_SHM_Client
+ *
+ * @brief Client side of the RPC shared memory channel
+ *
+ * Definition of the RPC protocol based on a memory segment shared with the
+ * Barbeque daemon, which holds a ring for each direction. Messages are
+ * copied into (and out of) the rings without system calls: a doorbell is
+ * rung only when the receiver is sleeping, i.e., an eventfd of the daemon
+ * or a futex on the application ring.
+ * The communication protocol must be aligend with the RTLib supported
+ * services.
+ *
+ * @see bbque/rtlib.h
+ * @see bbque/rtlib/rpc/rpc_messages.h
+ */
+class BbqueRPC_SHM_Client : public BbqueRPC
+{
+public:
+
+	BbqueRPC_SHM_Client();
+
+	~BbqueRPC_SHM_Client();
+
+protected:
+
+	RTLIB_ExitCode_t _Init(const char * name);
+
+	RTLIB_ExitCode_t _Register(pRegisteredEXC_t exc);
+
+	RTLIB_ExitCode_t _Unregister(pRegisteredEXC_t exc);
+
+	RTLIB_ExitCode_t _Enable(pRegisteredEXC_t exc);
+
+	RTLIB_ExitCode_t _Disable(pRegisteredEXC_t exc);
+
+	RTLIB_ExitCode_t _ScheduleRequest(pRegisteredEXC_t exc);
+
+	RTLIB_ExitCode_t _Set(pRegisteredEXC_t exc,
+			RTLIB_Constraint * constraints, uint8_t count);
+
+	RTLIB_ExitCode_t _Clear(pRegisteredEXC_t exc);
+
+	RTLIB_ExitCode_t _RTNotify(pRegisteredEXC_t exc,
+				int cps_ggap_perc,
+				int cpu_usage,
+				int cycle_time_ms,
+				int cycle_count);
+
+	RTLIB_ExitCode_t _RTNotifyBatch(
+			std::vector<rpc_msg_EXC_RTNOTIFY_sample_t> const & samples);
+
+	void _Exit();
+
+	inline uint32_t RpcMsgToken()
+	{
+		return channel_thread_pid;
+	}
+
+	/******************************************************************************
+	 * Runtime profile timing
+	 ******************************************************************************/
+
+	RTLIB_ExitCode_t _GetRuntimeProfileResp(
+						rpc_msg_token_t token,
+						pRegisteredEXC_t exc,
+						uint32_t exc_time,
+						uint32_t mem_time);
+
+	/******************************************************************************
+	 * Synchronization Protocol Messages
+	 ******************************************************************************/
+
+	RTLIB_ExitCode_t _SyncpPreChangeResp(
+					rpc_msg_token_t token,
+					pRegisteredEXC_t exc,
+					uint32_t syncLatency);
+
+	RTLIB_ExitCode_t _SyncpSyncChangeResp(
+					rpc_msg_token_t token,
+					pRegisteredEXC_t exc,
+					RTLIB_ExitCode_t sync);
+
+	RTLIB_ExitCode_t _SyncpPostChangeResp(
+					rpc_msg_token_t token,
+					pRegisteredEXC_t exc,
+					RTLIB_ExitCode_t result);
+
+private:
+
+	std::string bbque_sock_path = BBQUE_PATH_VAR "/" BBQUE_PUBLIC_SHM_SOCKET;
+
+	/** The memory segment shared with the daemon */
+	rpc_shm_segment_t * segment = nullptr;
+
+	size_t segment_size = 0;
+
+	/** The memfd of the shared segment (open until pairing) */
+	int shm_fd = -1;
+
+	/** The doorbell of the daemon */
+	int bbque_event_fd = -1;
+
+	/** The ring of the messages sent to the daemon */
+	RpcShmRing tx_ring;
+
+	/** The ring of the messages received from the daemon */
+	RpcShmRing rx_ring;
+
+	/** Serialize the threads sending messages to the daemon */
+	std::mutex tx_mtx;
+
+	std::atomic<bool> done;
+
+	bool running = false;
+
+	std::thread ChTrd;
+
+	std::mutex trdStatus_mtx;
+
+	std::condition_variable trdStatus_cv;
+
+	/**
+	 * @brief Serialize sending of command using the library
+	 *
+	 * The current implementation of the library allows to send a single
+	 * command at each time for single library instance. This is required do
+	 * properly handle responses from BarbequeRTRM.
+	 * This mutex should be used to protect the chResp response attribute,
+	 * which is always set to the last received response from BarbequeRTRM.
+	 *
+	 * @see chResp
+	 */
+	std::mutex chCommand_mtx;
+
+	/**
+	 * @brief Signal the reception of a response from BarbequeRTRM
+	 *
+	 * Each time a new message has been received from BarbequeRTRM by the channel
+	 * fetch thread, this variable is notified. Thus, commands could wait for
+	 * a response by suspending on it.
+	 */
+	std::condition_variable chResp_cv;
+
+	/**
+	 * @brief The last response received by BarbequeRTRM
+	 *
+	 * This attribute should be always protected by the chCommand_mtx
+	 */
+	rpc_msg_resp_t chResp;
+
+	RTLIB_ExitCode_t ChannelRelease();
+
+	RTLIB_ExitCode_t ChannelSetup();
+
+	RTLIB_ExitCode_t ChannelPair(const char * name);
+
+	/**
+	 * @brief Copy a message into the daemon ring, ringing its doorbell
+	 * if required
+	 */
+	RTLIB_ExitCode_t ChannelSend(void const * msg, size_t count);
+
+	/**
+	 * @brief Copy out the next message from the application ring
+	 *
+	 * Wait for the message, if the ring is empty.
+	 *
+	 * @return the bytes of the message, 0 if the channel has been closed
+	 */
+	ssize_t ChannelRecv(void * msg, size_t count);
+
+	/**
+	 * @brief Sleep on the application ring doorbell, if empty
+	 */
+	void ChannelWait();
+
+	void ChannelFetch();
+
+	void ChannelTrd(const char * name);
+
+	void RpcBbqResp();
+
+	/**
+	 * @brief Get from the ring a PreChange RPC message
+	 */
+	void RpcBbqSyncpPreChange();
+
+	/**
+	 * @brief Get from the ring a SyncChange RPC message
+	 */
+	void RpcBbqSyncpSyncChange();
+
+	/**
+	 * @brief Get from the ring a DoChange RPC message
+	 */
+	void RpcBbqSyncpDoChange();
+
+	/**
+	 * @brief Get from the ring a PostChange RPC message
+	 */
+	void RpcBbqSyncpPostChange();
+
+	/**
+	 * @brief Get from the ring a runtime profile request RPC message
+	 */
+	void RpcBbqGetRuntimeProfile();
+
+};
+
+} // namespace rtlib
+
+} // namespace bbque
+
+#endif // BBQUE_RPC_SHM_CLIENT_H_
@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_RPC_SHM_RING_H_
+#define BBQUE_RPC_SHM_RING_H_
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/** The alignment of the records in the ring */
+#define RPC_SHM_RECORD_ALIGN 8
+
+#define RPC_SHM_RECORD_SIZE(BYTES)\
+	(((sizeof(bbque::rtlib::rpc_shm_record_t) + (BYTES)) + \
+	 (RPC_SHM_RECORD_ALIGN - 1)) & ~(RPC_SHM_RECORD_ALIGN - 1))
+
+namespace bbque
+{
+namespace rtlib
+{
+
+/**
+ * @brief The header of a message stored into a ring
+ *
+ * A record with a null payload is a padding, which fills the bytes left
+ * at the end of the ring buffer when the next message does not fit.
+ */
+typedef struct rpc_shm_record {
+	/** The bytes of the record (header included and aligned) */
+	uint32_t rec_size;
+	/** The bytes of the RPC message following the header */
+	uint32_t pyl_size;
+} rpc_shm_record_t;
+
+/**
+ * @brief The shared state of a ring
+ *
+ * The ring is placed into a memory segment shared by the RTLib and the
+ * BarbequeRTRM, thus it does not contain any pointer: the data buffer
+ * immediately follows this structure. The head and tail indexes are free
+ * running counters, which are wrapped on the buffer size (a power of 2).
+ */
+typedef struct rpc_shm_ring {
+	/** The next byte to write (producer side) */
+	alignas(64) std::atomic<uint32_t> head;
+	/** The next byte to read (consumer side) */
+	alignas(64) std::atomic<uint32_t> tail;
+	/** Set by a consumer going to sleep on the doorbell */
+	std::atomic<uint32_t> waiting;
+	/** The bytes of the data buffer */
+	uint32_t size;
+} rpc_shm_ring_t;
+
+static_assert(sizeof(rpc_shm_ring_t) % RPC_SHM_RECORD_ALIGN == 0,
+		"rpc_shm_ring_t breaks the alignment of the ring records");
+
+/**
+ * @class RpcShmRing
+ * @brief A single producer, single consumer ring of variable size messages
+ *
+ * This is the process local view of a ring shared with the peer. The size
+ * of the ring is read only once, when the view is built, since the shared
+ * memory content could be corrupted by the (untrusted) peer at any time.
+ * For the same reason, the index owned by this side (the head of a
+ * producer, the tail of a consumer) is kept in the view, and only
+ * published into the shared state.
+ *
+ * Messages are exchanged without any system call. The consumer declares
+ * to be sleeping by setting the waiting flag: only in that case, the
+ * producer has to ring the consumer doorbell after a Push.
+ *
+ * Producers on the same side of the channel must be serialized by the
+ * caller.
+ */
+class RpcShmRing {
+
+public:
+
+	RpcShmRing() :
+		ring(nullptr), data(nullptr), size(0), head(0), tail(0), peek_size(0) {
+	}
+
+	/**
+	 * @brief Build the view of a ring
+	 *
+	 * @param shared The shared state of the ring
+	 * @param buffer_size The bytes of the data buffer (a power of 2)
+	 */
+	RpcShmRing(rpc_shm_ring_t * shared, uint32_t buffer_size) :
+		ring(shared),
+		data(reinterpret_cast<uint8_t *>(shared + 1)),
+		size(buffer_size),
+		head(shared->head.load(std::memory_order_relaxed)),
+		tail(shared->tail.load(std::memory_order_relaxed)),
+		peek_size(0) {
+	}
+
+	/**
+	 * @brief Initialize an empty ring (before sharing it)
+	 */
+	void Init() {
+		head = tail = 0;
+		ring->head.store(0, std::memory_order_relaxed);
+		ring->tail.store(0, std::memory_order_relaxed);
+		ring->waiting.store(0, std::memory_order_relaxed);
+		ring->size = size;
+	}
+
+	/**
+	 * @brief Check if there are no messages to read (consumer side)
+	 */
+	bool Empty() const {
+		return ring->head.load(std::memory_order_acquire) == tail;
+	}
+
+	/**
+	 * @brief Copy a message into the ring (producer side)
+	 *
+	 * @return false if there is not enough free space, or the ring state
+	 * is not valid
+	 */
+	bool Push(void const * msg, uint32_t count) {
+		uint32_t rec_size = RPC_SHM_RECORD_SIZE(count);
+		uint32_t h = head;
+		uint32_t t = ring->tail.load(std::memory_order_acquire);
+		uint32_t offset = h & (size - 1);
+		uint32_t contiguous = size - offset;
+
+		// A misaligned head would write the record header past the end
+		if (h & (RPC_SHM_RECORD_ALIGN - 1))
+			return false;
+
+		// The record should not wrap: pad the end of the buffer
+		uint32_t padding = (rec_size > contiguous) ? contiguous : 0;
+		if ((h - t) > size || (h - t) + padding + rec_size > size)
+			return false;
+
+		rpc_shm_record_t * rec;
+		if (padding) {
+			rec = reinterpret_cast<rpc_shm_record_t *>(data + offset);
+			rec->rec_size = padding;
+			rec->pyl_size = 0;
+			offset = 0;
+		}
+
+		rec = reinterpret_cast<rpc_shm_record_t *>(data + offset);
+		rec->rec_size = rec_size;
+		rec->pyl_size = count;
+		::memcpy(rec + 1, msg, count);
+
+		head = h + padding + rec_size;
+		ring->head.store(head, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Get the next message, without releasing it (consumer side)
+	 *
+	 * @return The bytes of the message, 0 if the ring is empty, -EBADMSG if
+	 * the ring content is not valid
+	 */
+	ssize_t Peek(void *& pyl) {
+		uint32_t h = ring->head.load(std::memory_order_acquire);
+		uint32_t t = tail;
+
+		if ((h - t) > size || (t & (RPC_SHM_RECORD_ALIGN - 1)))
+			return -EBADMSG;
+
+		while (h != t) {
+			uint32_t offset = t & (size - 1);
+			rpc_shm_record_t * rec =
+				reinterpret_cast<rpc_shm_record_t *>(data + offset);
+			uint32_t rec_size = rec->rec_size;
+			uint32_t pyl_size = rec->pyl_size;
+			if (rec_size < sizeof(rpc_shm_record_t) ||
+					(rec_size & (RPC_SHM_RECORD_ALIGN - 1)) ||
+					rec_size > (h - t) ||
+					rec_size > (size - offset) ||
+					pyl_size > (rec_size - sizeof(rpc_shm_record_t)))
+				return -EBADMSG;
+
+			// Skip the padding at the end of the buffer
+			if (pyl_size == 0) {
+				t += rec_size;
+				tail = t;
+				ring->tail.store(t, std::memory_order_release);
+				continue;
+			}
+
+			peek_size = rec_size;
+			pyl = rec + 1;
+			return pyl_size;
+		}
+
+		return 0;
+	}
+
+	/**
+	 * @brief Release the message returned by the last Peek (consumer side)
+	 */
+	void Pop() {
+		tail += peek_size;
+		ring->tail.store(tail, std::memory_order_release);
+		peek_size = 0;
+	}
+
+	/**
+	 * @brief Declare the consumer is going to sleep on the doorbell
+	 *
+	 * @return true if the ring is still empty, thus the consumer can sleep
+	 */
+	bool Arm() {
+		ring->waiting.store(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		return Empty();
+	}
+
+	/**
+	 * @brief Declare the consumer is awake
+	 */
+	void Disarm() {
+		ring->waiting.store(0, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Check if the consumer must be woken up (after a Push)
+	 *
+	 * @return true if the producer must ring the doorbell
+	 */
+	bool Doorbell() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (ring->waiting.load(std::memory_order_relaxed) == 0)
+			return false;
+		return ring->waiting.exchange(0, std::memory_order_relaxed) != 0;
+	}
+
+	/**
+	 * @brief Sleep on the waiting flag, used as a futex doorbell
+	 *
+	 * The futex is not private, since it is shared among processes.
+	 */
+	int FutexWait(uint32_t timeout_ms) {
+		struct timespec timeout = {
+			(time_t)(timeout_ms / 1000),
+			(long)(timeout_ms % 1000) * 1000000L
+		};
+		return ::syscall(SYS_futex,
+			reinterpret_cast<uint32_t *>(&ring->waiting),
+			FUTEX_WAIT, 1, &timeout, NULL, 0);
+	}
+
+	/**
+	 * @brief Wake up the consumer sleeping on the futex doorbell
+	 */
+	int FutexWake() {
+		return ::syscall(SYS_futex,
+			reinterpret_cast<uint32_t *>(&ring->waiting),
+			FUTEX_WAKE, 1, NULL, NULL, 0);
+	}
+
+private:
+
+	rpc_shm_ring_t * ring;
+
+	uint8_t * data;
+
+	uint32_t size;
+
+	/** The next byte to write, if this is the producer side */
+	uint32_t head;
+
+	/** The next byte to read, if this is the consumer side */
+	uint32_t tail;
+
+	/** The record size returned by the last Peek */
+	uint32_t peek_size;
+};
+
+} // namespace rtlib
+
+} // namespace bbque
+
+#endif // BBQUE_RPC_SHM_RING_H_
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_RPC_SHM_SERVER_H_
+#define BBQUE_RPC_SHM_SERVER_H_
+
+#include "bbque/rtlib.h"
+
+#include "bbque/config.h"
+#include "bbque/rtlib/rpc/rpc_messages.h"
+#include "bbque/rtlib/rpc/shm/rpc_shm_ring.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+/** The UNIX socket (into BBQUE_PATH_VAR) used to pair the applications */
+#define BBQUE_PUBLIC_SHM_SOCKET "rpc_shm"
+
+#define BBQUE_RPC_SHM_MAJOR_VERSION 1
+#define BBQUE_RPC_SHM_MINOR_VERSION 0
+
+/** Magic number of a valid application segment ("BBQS") */
+#define BBQUE_RPC_SHM_MAGIC 0x42425153
+
+/** The bytes of each ring buffer */
+#define BBQUE_RPC_SHM_RING_BYTES (BBQUE_RPC_SHM_RING_KB * 1024)
+
+/** The range of ring sizes accepted by the BarbequeRTRM */
+#define BBQUE_RPC_SHM_RING_MIN_BYTES (4 * 1024)
+#define BBQUE_RPC_SHM_RING_MAX_BYTES (1024 * 1024)
+
+/** The bytes of an application segment with the specified ring size */
+#define RPC_SHM_SEGMENT_SIZE(RING_BYTES)\
+	(sizeof(bbque::rtlib::rpc_shm_segment_t) + \
+	 2 * (sizeof(bbque::rtlib::rpc_shm_ring_t) + (RING_BYTES)))
+
+namespace bbque
+{
+namespace rtlib
+{
+
+/**
+ * @brief The header of the memory segment shared with an application
+ *
+ * The segment is created by the application, as a sealed memfd which
+ * cannot be shrunk, and it is mapped by the BarbequeRTRM at pairing time.
+ * The header is followed by two rings: the first one carries the messages
+ * sent by the application, the second one the messages sent by the
+ * BarbequeRTRM.
+ */
+typedef struct alignas(64) rpc_shm_segment {
+	/** Must be BBQUE_RPC_SHM_MAGIC */
+	uint32_t magic;
+	/** The channel protocol major version */
+	uint16_t mjr_version;
+	/** The channel protocol minor version */
+	uint16_t mnr_version;
+	/** The bytes of each ring buffer */
+	uint32_t ring_size;
+} rpc_shm_segment_t;
+
+/** The ring of the messages sent by the application */
+inline rpc_shm_ring_t * RpcShmRingToBbq(rpc_shm_segment_t * seg) {
+	return reinterpret_cast<rpc_shm_ring_t *>(seg + 1);
+}
+
+/** The ring of the messages sent by the BarbequeRTRM */
+inline rpc_shm_ring_t * RpcShmRingToApp(rpc_shm_segment_t * seg,
+		uint32_t ring_size) {
+	return reinterpret_cast<rpc_shm_ring_t *>(
+		reinterpret_cast<uint8_t *>(seg + 1) +
+		sizeof(rpc_shm_ring_t) + ring_size);
+}
+
+
+/******************************************************************************
+ * Channel Management
+ ******************************************************************************/
+
+/*
+ * The RPC_APP_PAIR command is the only one not sent through the rings: an
+ * application sends it on the BBQUE_PUBLIC_SHM_SOCKET, together with the
+ * descriptor of its memory segment. If the pairing succeed, the
+ * BarbequeRTRM sends back on the same connection the eventfd to use as a
+ * doorbell, and then the ACK response through the ring.
+ */
+
+/**
+ * @brief Send a message and a file descriptor on a UNIX socket
+ */
+inline ssize_t RpcShmSendFd(int sock_fd, void const * buf, size_t count,
+		int fd) {
+	char cbuf[CMSG_SPACE(sizeof(int))];
+	struct iovec iov = { const_cast<void *>(buf), count };
+	struct msghdr mhdr;
+	::memset(&mhdr, 0, sizeof(mhdr));
+	::memset(cbuf, 0, sizeof(cbuf));
+	mhdr.msg_iov = &iov;
+	mhdr.msg_iovlen = 1;
+	mhdr.msg_control = cbuf;
+	mhdr.msg_controllen = sizeof(cbuf);
+	struct cmsghdr * cmsg = CMSG_FIRSTHDR(&mhdr);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+	return ::sendmsg(sock_fd, &mhdr, MSG_NOSIGNAL);
+}
+
+/**
+ * @brief Receive a message and a file descriptor from a UNIX socket
+ *
+ * @param fd Set to the received descriptor, -1 if missing
+ */
+inline ssize_t RpcShmRecvFd(int sock_fd, void * buf, size_t count, int & fd) {
+	char cbuf[CMSG_SPACE(sizeof(int))];
+	struct iovec iov = { buf, count };
+	struct msghdr mhdr;
+	::memset(&mhdr, 0, sizeof(mhdr));
+	mhdr.msg_iov = &iov;
+	mhdr.msg_iovlen = 1;
+	mhdr.msg_control = cbuf;
+	mhdr.msg_controllen = sizeof(cbuf);
+
+	fd = -1;
+	ssize_t bytes = ::recvmsg(sock_fd, &mhdr, MSG_CMSG_CLOEXEC);
+	if (bytes < 0)
+		return bytes;
+
+	struct cmsghdr * cmsg = CMSG_FIRSTHDR(&mhdr);
+	if (cmsg && cmsg->cmsg_level == SOL_SOCKET &&
+			cmsg->cmsg_type == SCM_RIGHTS &&
+			cmsg->cmsg_len == CMSG_LEN(sizeof(int)))
+		::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+	return bytes;
+}
+
+} // namespace rtlib
+
+} // namespace bbque
+
+#endif // BBQUE_RPC_SHM_SERVER_H_
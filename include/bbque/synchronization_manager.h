@@ -172,6 +172,14 @@ private:
 	 */
 	ExitCode_t MapResources(SchedPtr_t papp);
 
+	/**
+	 * @brief Enforce the resource mappings collected since the beginning
+	 * of the platform synchronization
+	 *
+	 * @return The EXCs whose mapping failed, and still running
+	 */
+	std::vector<SchedPtr_t> CommitMappings();
+
 	/**
 	 * @brief Notify a Pre-Change to the specified EXCs
 	 */
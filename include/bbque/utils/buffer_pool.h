@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_UTILS_BUFFER_POOL_H_
+#define BBQUE_UTILS_BUFFER_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace bbque {
+
+namespace utils {
+
+/**
+ * @class BufferPool
+ * @brief A thread safe pool of message buffers, by size class
+ *
+ * The size classes are powers of two, starting from a minimum size. A
+ * released buffer is kept on the free list of its class (up to a maximum
+ * number of cached buffers per class) and then returned, without any heap
+ * allocation, by the next request of the same class. Requests bigger than
+ * the biggest class are served (and released) by the heap.
+ *
+ * The buffers returned are aligned as the ones returned by malloc.
+ */
+class BufferPool {
+
+public:
+
+	/**
+	 * @brief Build a pool
+	 *
+	 * @param min_size the bytes of the smallest size class
+	 * @param classes the number of size classes
+	 * @param cached_max the maximum number of free buffers kept by each
+	 * size class
+	 */
+	BufferPool(size_t min_size, uint8_t classes, size_t cached_max):
+		size_classes(classes),
+		cached_max(cached_max) {
+		for (uint8_t i = 0; i < classes; ++i) {
+			size_classes[i].size = min_size << i;
+			size_classes[i].free.reserve(cached_max);
+		}
+	}
+
+	BufferPool(BufferPool const &) = delete;
+	BufferPool & operator=(BufferPool const &) = delete;
+
+	~BufferPool() {
+		for (auto & sc : size_classes) {
+			for (buffer_header_t * hdr : sc.free)
+				::free(hdr);
+		}
+	}
+
+	/**
+	 * @brief Get a buffer of (at least) the specified bytes
+	 *
+	 * @param size the bytes required
+	 * @param hit set to true if the buffer has been recycled
+	 *
+	 * @return the buffer, nullptr if the heap allocation failed
+	 */
+	void * Get(size_t size, bool & hit) {
+		buffer_header_t * hdr = nullptr;
+		uint8_t sc_id = SizeClass(size);
+
+		hit = false;
+		if (sc_id < size_classes.size()) {
+			size_class_t & sc(size_classes[sc_id]);
+			size = sc.size;
+			std::unique_lock<std::mutex> sc_ul(sc.mtx);
+			if (!sc.free.empty()) {
+				hdr = sc.free.back();
+				sc.free.pop_back();
+				hit = true;
+			}
+		}
+
+		if (hit)
+			++hits;
+		else
+			++misses;
+
+		if (!hdr) {
+			hdr = (buffer_header_t *)::malloc(sizeof(buffer_header_t) + size);
+			if (!hdr)
+				return nullptr;
+			hdr->size_class = sc_id;
+		}
+
+		return hdr + 1;
+	}
+
+	void * Get(size_t size) {
+		bool hit;
+		return Get(size, hit);
+	}
+
+	/**
+	 * @brief Release a buffer returned by Get
+	 */
+	void Put(void * buffer) {
+		if (!buffer)
+			return;
+
+		buffer_header_t * hdr = ((buffer_header_t *)buffer) - 1;
+		if (hdr->size_class < size_classes.size()) {
+			size_class_t & sc(size_classes[hdr->size_class]);
+			std::unique_lock<std::mutex> sc_ul(sc.mtx);
+			if (sc.free.size() < cached_max) {
+				sc.free.push_back(hdr);
+				return;
+			}
+		}
+
+		::free(hdr);
+	}
+
+	/**
+	 * @brief The number of requests served by a recycled buffer
+	 */
+	uint64_t Hits() const {
+		return hits;
+	}
+
+	/**
+	 * @brief The number of requests served by the heap
+	 */
+	uint64_t Misses() const {
+		return misses;
+	}
+
+private:
+
+	/**
+	 * @brief The header preceding each buffer
+	 */
+	typedef struct alignas(alignof(std::max_align_t)) buffer_header {
+		/** The size class of the buffer, or the classes count if
+		 * allocated out of the pool */
+		uint8_t size_class;
+	} buffer_header_t;
+
+	typedef struct size_class {
+		/** The bytes of the class buffers */
+		size_t size = 0;
+		/** The free buffers of the class */
+		std::vector<buffer_header_t *> free;
+		std::mutex mtx;
+	} size_class_t;
+
+	std::vector<size_class_t> size_classes;
+
+	size_t cached_max;
+
+	std::atomic<uint64_t> hits{0};
+
+	std::atomic<uint64_t> misses{0};
+
+	/**
+	 * @brief The smallest size class fitting the specified bytes
+	 *
+	 * @return the class index, the classes count if none fits
+	 */
+	uint8_t SizeClass(size_t size) const {
+		uint8_t sc_id = 0;
+		while (sc_id < size_classes.size() &&
+				size_classes[sc_id].size < size)
+			++sc_id;
+		return sc_id;
+	}
+
+};
+
+} // namespace utils
+
+} // namespace bbque
+
+#endif // BBQUE_UTILS_BUFFER_POOL_H_
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_UTILS_FLAT_MAP_H_
+#define BBQUE_UTILS_FLAT_MAP_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace bbque {
+
+namespace utils {
+
+/**
+ * @class SmallFlatMap
+ * @brief A sorted associative container optimized for few elements
+ *
+ * The elements are kept sorted by key in a contiguous array. The first N
+ * elements are stored inline in the object itself, thus no memory is
+ * allocated until the container grows beyond N elements. Then the
+ * elements are moved into a (sorted) vector.
+ *
+ * The interface is the subset of std::map used for the bookkeeping of the
+ * resource holders: iteration in key order over std::pair elements, find,
+ * operator[], erase by key, size and clear. Differently from std::map,
+ * inserting or erasing an element invalidates the iterators.
+ *
+ * Both Key and T must be default constructible.
+ */
+template <class Key, class T, size_t N = 4>
+class SmallFlatMap {
+
+public:
+
+	using key_type       = Key;
+	using mapped_type    = T;
+	using value_type     = std::pair<Key, T>;
+	using size_type      = size_t;
+	using iterator       = value_type *;
+	using const_iterator = value_type const *;
+
+	SmallFlatMap():
+		nr_inline(0),
+		on_heap(false) {
+	}
+
+	size_type size() const {
+		return on_heap ? heap_items.size() : nr_inline;
+	}
+
+	bool empty() const {
+		return size() == 0;
+	}
+
+	iterator begin() {
+		return data();
+	}
+
+	iterator end() {
+		return data() + size();
+	}
+
+	const_iterator begin() const {
+		return data();
+	}
+
+	const_iterator end() const {
+		return data() + size();
+	}
+
+	iterator find(Key const & key) {
+		iterator it = lower_bound(key);
+		if ((it != end()) && (it->first == key))
+			return it;
+		return end();
+	}
+
+	const_iterator find(Key const & key) const {
+		const_iterator it = lower_bound(key);
+		if ((it != end()) && (it->first == key))
+			return it;
+		return end();
+	}
+
+	size_type count(Key const & key) const {
+		return (find(key) != end()) ? 1 : 0;
+	}
+
+	/**
+	 * @brief Access the value of a key, inserting it if missing
+	 */
+	T & operator[](Key const & key) {
+		iterator it = lower_bound(key);
+		if ((it != end()) && (it->first == key))
+			return it->second;
+		return insert_at(it - begin(), key)->second;
+	}
+
+	/**
+	 * @brief Erase the element of a key
+	 *
+	 * @return The number of elements erased (0 or 1)
+	 */
+	size_type erase(Key const & key) {
+		iterator it = find(key);
+		if (it == end())
+			return 0;
+		if (on_heap) {
+			heap_items.erase(heap_items.begin() + (it - begin()));
+			return 1;
+		}
+		std::move(it + 1, end(), it);
+		--nr_inline;
+		return 1;
+	}
+
+	void clear() {
+		nr_inline = 0;
+		on_heap = false;
+		heap_items.clear();
+	}
+
+private:
+
+	/** Inline storage of the first N elements */
+	std::array<value_type, N> inline_items;
+
+	/** Number of elements in the inline storage */
+	size_type nr_inline;
+
+	/** Storage of the elements beyond N */
+	std::vector<value_type> heap_items;
+
+	/** True if the elements are in heap_items */
+	bool on_heap;
+
+	value_type * data() {
+		return on_heap ? heap_items.data() : inline_items.data();
+	}
+
+	value_type const * data() const {
+		return on_heap ? heap_items.data() : inline_items.data();
+	}
+
+	iterator lower_bound(Key const & key) {
+		return std::lower_bound(begin(), end(), key,
+			[](value_type const & item, Key const & k) {
+				return item.first < k;
+			});
+	}
+
+	const_iterator lower_bound(Key const & key) const {
+		return std::lower_bound(begin(), end(), key,
+			[](value_type const & item, Key const & k) {
+				return item.first < k;
+			});
+	}
+
+	/**
+	 * @brief Insert a new element at a given position (keeping the order)
+	 */
+	iterator insert_at(size_type pos, Key const & key) {
+		if (on_heap) {
+			auto it = heap_items.insert(
+				heap_items.begin() + pos, value_type(key, T()));
+			return &(*it);
+		}
+
+		// Inline storage full: move to the heap
+		if (nr_inline == N) {
+			heap_items.reserve(2 * N);
+			heap_items.assign(
+				std::make_move_iterator(inline_items.begin()),
+				std::make_move_iterator(inline_items.end()));
+			on_heap = true;
+			nr_inline = 0;
+			return insert_at(pos, key);
+		}
+
+		std::move_backward(
+			inline_items.begin() + pos,
+			inline_items.begin() + nr_inline,
+			inline_items.begin() + nr_inline + 1);
+		inline_items[pos] = value_type(key, T());
+		++nr_inline;
+		return &inline_items[pos];
+	}
+
+};
+
+} // namespace utils
+
+} // namespace bbque
+
+#endif // BBQUE_UTILS_FLAT_MAP_H_
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_UTILS_FRAME_BUFFER_H_
+#define BBQUE_UTILS_FRAME_BUFFER_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include <unistd.h>
+
+namespace bbque {
+
+namespace utils {
+
+/**
+ * @class FrameBuffer
+ * @brief A reusable receive buffer for a stream of frames
+ *
+ * The buffer is filled with as many bytes as available from a non-blocking
+ * descriptor, by a single read. The frames are then parsed in place, and
+ * consumed, by the caller. The bytes of a partially received frame are kept
+ * (and moved to the buffer start) until the next fill.
+ *
+ * Not thread safe: a single reader is expected.
+ */
+class FrameBuffer {
+
+public:
+
+	FrameBuffer(size_t capacity):
+		buffer(new uint8_t[capacity]),
+		capacity(capacity) {
+	}
+
+	FrameBuffer(FrameBuffer const &) = delete;
+	FrameBuffer & operator=(FrameBuffer const &) = delete;
+
+	/**
+	 * @brief The first byte not consumed yet
+	 */
+	uint8_t * Data() const {
+		return buffer.get() + head;
+	}
+
+	/**
+	 * @brief The bytes not consumed yet
+	 */
+	size_t Size() const {
+		return tail - head;
+	}
+
+	/**
+	 * @brief Release the bytes of a parsed (or discarded) frame
+	 */
+	void Consume(size_t bytes) {
+		head += std::min(bytes, Size());
+		if (head == tail)
+			head = tail = 0;
+	}
+
+	/**
+	 * @brief Append the bytes available from a descriptor
+	 *
+	 * @return the bytes read, 0 at end of file, -EAGAIN if no bytes are
+	 * available, -ENOBUFS if the buffer is full, -errno on errors
+	 */
+	ssize_t Fill(int fd) {
+		// Make room by moving the partial frame at the buffer start
+		if (head) {
+			::memmove(buffer.get(), Data(), Size());
+			tail -= head;
+			head = 0;
+		}
+
+		if (tail == capacity)
+			return -ENOBUFS;
+
+		ssize_t bytes;
+		do {
+			bytes = ::read(fd, buffer.get() + tail, capacity - tail);
+		} while (bytes < 0 && errno == EINTR);
+		if (bytes < 0)
+			return (errno == EWOULDBLOCK) ? -EAGAIN : -errno;
+
+		tail += bytes;
+		return bytes;
+	}
+
+private:
+
+	std::unique_ptr<uint8_t[]> buffer;
+
+	size_t capacity;
+
+	/** The first byte not consumed */
+	size_t head = 0;
+
+	/** The first byte not filled */
+	size_t tail = 0;
+
+};
+
+} // namespace utils
+
+} // namespace bbque
+
+#endif // BBQUE_UTILS_FRAME_BUFFER_H_
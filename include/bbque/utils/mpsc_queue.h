@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_UTILS_MPSC_QUEUE_H_
+#define BBQUE_UTILS_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <utility>
+
+namespace bbque {
+
+namespace utils {
+
+/**
+ * @class MPSCQueue
+ * @brief An unbounded multiple producers, single consumer FIFO queue
+ *
+ * Any thread can push elements, without locking: a push is a single atomic
+ * exchange on the queue head. Only one thread at a time (the consumer) can
+ * pop them.
+ *
+ * A push is visible to the consumer only once completed, thus the queue
+ * can be seen empty for a short while by the consumer, even if the push of
+ * an element has already started.
+ *
+ * T must be default constructible.
+ */
+template <class T>
+class MPSCQueue {
+
+public:
+
+	MPSCQueue():
+		head(new Node()),
+		tail(head.load(std::memory_order_relaxed)) {
+	}
+
+	~MPSCQueue() {
+		T value;
+		while (Pop(value));
+		delete tail;
+	}
+
+	MPSCQueue(MPSCQueue const &) = delete;
+	MPSCQueue & operator=(MPSCQueue const &) = delete;
+
+	/**
+	 * @brief Add an element at the end of the queue (any thread)
+	 */
+	void Push(T value) {
+		Node * node = new Node(std::move(value));
+		Node * prev = head.exchange(node, std::memory_order_acq_rel);
+		prev->next.store(node, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Extract the first element of the queue (consumer only)
+	 *
+	 * @return false if the queue is empty, true otherwise
+	 */
+	bool Pop(T & value) {
+		Node * next = tail->next.load(std::memory_order_acquire);
+		if (next == nullptr)
+			return false;
+		value = std::move(next->value);
+		delete tail;
+		tail = next;
+		return true;
+	}
+
+	/**
+	 * @brief Check for elements to pop (consumer only)
+	 */
+	bool Empty() const {
+		return tail->next.load(std::memory_order_acquire) == nullptr;
+	}
+
+private:
+
+	struct Node {
+		Node() : next(nullptr) { }
+		explicit Node(T && value) : next(nullptr), value(std::move(value)) { }
+		std::atomic<Node *> next;
+		T value;
+	};
+
+	/** The last pushed node (producers side) */
+	std::atomic<Node *> head;
+
+	/** The last popped node (consumer side) */
+	Node * tail;
+};
+
+} // namespace utils
+
+} // namespace bbque
+
+#endif // BBQUE_UTILS_MPSC_QUEUE_H_
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_TRACER_H_
+#define BBQUE_TRACER_H_
+
+#include "bbque/config.h"
+
+#ifdef CONFIG_BBQUE_TRACING
+
+#include "bbque/command_manager.h"
+#include "bbque/utils/logging/logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+/** The maximum length of the label of a span (e.g., an EXC identifier) */
+#define BBQUE_TRACE_LABEL_LEN 24
+
+namespace bbque { namespace utils {
+
+class TraceRing;
+
+/**
+ * @class Tracer
+ * @brief Hierarchical timing of the daemon activities
+ *
+ * The activities are traced by scoped spans (see TraceSpan), which are
+ * recorded when completed. Each thread records its spans into its own ring
+ * buffer, without locking. When the buffer is full, the oldest spans are
+ * overwritten.
+ *
+ * The buffered spans of all the threads are exported on demand, by the
+ * command "bq.tr.dump [file]", in the Chrome trace event format (JSON), which
+ * can be loaded by Perfetto or chrome://tracing. Since nested spans of a
+ * thread are contained in time one into the other, the hierarchy is rebuilt
+ * by the viewer.
+ */
+class Tracer : public CommandHandler {
+
+public:
+
+	/**
+	 * @brief A completed span
+	 */
+	struct Event_t {
+		/** The span name: a string literal */
+		char const * name;
+		/** An optional label, e.g., the EXC identifier */
+		char label[BBQUE_TRACE_LABEL_LEN];
+		/** Begin time [ns] since the tracer start */
+		uint64_t begin_ns;
+		/** Duration [ns] */
+		uint64_t duration_ns;
+		/** The recording thread */
+		pid_t tid;
+	};
+
+	static Tracer & GetInstance();
+
+	virtual ~Tracer();
+
+	/**
+	 * @brief Nanoseconds elapsed since the tracer start
+	 */
+	inline uint64_t Now() const {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - epoch).count();
+	}
+
+	inline bool Enabled() const {
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Start or stop the recording of new spans
+	 */
+	void Enable(bool enable);
+
+	/**
+	 * @brief Record a completed span into the buffer of the calling thread
+	 */
+	void Record(char const * name, char const * label,
+			uint64_t begin_ns, uint64_t end_ns);
+
+	/**
+	 * @brief Write the buffered spans in Chrome trace event format
+	 *
+	 * @return 0 on success, a negative number otherwise
+	 */
+	int Dump(std::string const & file_path);
+
+	/**
+	 * @brief Handle the "bq.tr.*" commands
+	 */
+	int CommandsCb(int argc, char *argv[]);
+
+private:
+
+	std::unique_ptr<Logger> logger;
+
+	/** The time origin of the recorded spans */
+	std::chrono::steady_clock::time_point const epoch;
+
+	std::atomic<bool> enabled;
+
+	/** The buffers of all the threads which have been recording spans */
+	std::vector<std::shared_ptr<TraceRing>> rings;
+
+	/** The names of the recording threads */
+	std::map<pid_t, std::string> thread_names;
+
+	/** Protect the buffers list and the thread names */
+	std::mutex rings_mtx;
+
+	Tracer();
+
+	/**
+	 * @brief The buffer of the calling thread
+	 *
+	 * A buffer is assigned to a thread at its first recorded span. The
+	 * buffers of terminated threads are reused by the new ones, so that
+	 * their spans are still exported.
+	 */
+	TraceRing * GetThreadRing();
+
+	std::shared_ptr<TraceRing> AcquireRing(pid_t tid);
+};
+
+/**
+ * @class TraceSpan
+ * @brief A scoped span: it is recorded when it goes out of scope
+ */
+class TraceSpan {
+
+public:
+
+	TraceSpan(char const * name, char const * label = nullptr) :
+		tracer(Tracer::GetInstance()), name(name), begin_ns(0),
+		recording(tracer.Enabled()) {
+		if (!recording)
+			return;
+		label_buf[0] = '\0';
+		if (label != nullptr) {
+			strncpy(label_buf, label, BBQUE_TRACE_LABEL_LEN - 1);
+			label_buf[BBQUE_TRACE_LABEL_LEN - 1] = '\0';
+		}
+		begin_ns = tracer.Now();
+	}
+
+	~TraceSpan() {
+		if (!recording)
+			return;
+		tracer.Record(name, label_buf, begin_ns, tracer.Now());
+	}
+
+private:
+
+	Tracer & tracer;
+
+	char const * name;
+
+	char label_buf[BBQUE_TRACE_LABEL_LEN];
+
+	uint64_t begin_ns;
+
+	bool recording;
+};
+
+} // namespace utils
+
+} // namespace bbque
+
+#define BBQUE_TRACE_CONCAT_(A, B) A ## B
+#define BBQUE_TRACE_CONCAT(A, B) BBQUE_TRACE_CONCAT_(A, B)
+
+/** Trace the enclosing scope */
+#define BBQUE_TRACE_SPAN(NAME) \
+	bbque::utils::TraceSpan BBQUE_TRACE_CONCAT(trace_span_, __LINE__)(NAME)
+/** Trace the enclosing scope, labelled (e.g., by the EXC identifier) */
+#define BBQUE_TRACE_SPAN_LABEL(NAME, LABEL) \
+	bbque::utils::TraceSpan BBQUE_TRACE_CONCAT(trace_span_, __LINE__)(NAME, LABEL)
+
+#else
+
+#define BBQUE_TRACE_SPAN(NAME)
+#define BBQUE_TRACE_SPAN_LABEL(NAME, LABEL)
+
+#endif // CONFIG_BBQUE_TRACING
+
+#endif // BBQUE_TRACER_H_
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_UTILS_WORKER_POOL_H_
+#define BBQUE_UTILS_WORKER_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/prctl.h>
+
+#include "bbque/utils/mpsc_queue.h"
+
+namespace bbque {
+
+namespace utils {
+
+/**
+ * @class WorkerPool
+ * @brief A fixed set of threads serving jobs in order of submission
+ *
+ * Each job is submitted together with a key (e.g., the application PID),
+ * which selects the thread running it. Therefore, the jobs with the same
+ * key are run one at a time, in the same order they have been submitted.
+ * Jobs of different keys can be run concurrently, unless assigned to the
+ * same thread.
+ *
+ * Each thread has its own lock-free job queue: the submission does not
+ * require locking, unless the thread is sleeping and it must be woken up.
+ */
+class WorkerPool {
+
+public:
+
+	typedef std::function<void()> Job_t;
+
+	/**
+	 * @brief Spawn the threads of the pool
+	 *
+	 * @param name The prefix of the threads name
+	 * @param nr_workers The number of threads
+	 */
+	WorkerPool(std::string const & name, uint16_t nr_workers) {
+		if (nr_workers == 0)
+			nr_workers = 1;
+		for (uint16_t id = 0; id < nr_workers; ++id) {
+			workers.emplace_back(new PoolWorker());
+			char thd_name[16];
+			snprintf(thd_name, sizeof(thd_name), "%s%d", name.c_str(), id);
+			workers.back()->thd = std::thread(
+				&WorkerPool::Run, workers.back().get(), std::string(thd_name));
+		}
+	}
+
+	/**
+	 * @brief Stop the threads, once the submitted jobs are completed
+	 */
+	~WorkerPool() {
+		for (auto & pw : workers) {
+			std::unique_lock<std::mutex> ul(pw->mtx);
+			pw->done = true;
+			pw->cv.notify_one();
+		}
+		for (auto & pw : workers)
+			pw->thd.join();
+	}
+
+	WorkerPool(WorkerPool const &) = delete;
+	WorkerPool & operator=(WorkerPool const &) = delete;
+
+	/**
+	 * @brief Submit a job
+	 *
+	 * @param key The jobs with the same key are run in submission order
+	 * @param job The function to run
+	 */
+	void Submit(uint32_t key, Job_t job) {
+		PoolWorker * pw = workers[key % workers.size()].get();
+		pw->jobs.Push(std::move(job));
+		// Wake up the thread only if it is (going to) sleep
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (pw->sleeping.load(std::memory_order_relaxed)) {
+			std::unique_lock<std::mutex> ul(pw->mtx);
+			pw->cv.notify_one();
+		}
+	}
+
+	/**
+	 * @brief The number of threads in the pool
+	 */
+	size_t Size() const {
+		return workers.size();
+	}
+
+private:
+
+	struct PoolWorker {
+		MPSCQueue<Job_t> jobs;
+		std::atomic<bool> sleeping;
+		bool done;
+		std::mutex mtx;
+		std::condition_variable cv;
+		std::thread thd;
+
+		PoolWorker() : sleeping(false), done(false) { }
+	};
+
+	std::vector<std::unique_ptr<PoolWorker>> workers;
+
+	static void Run(PoolWorker * pw, std::string name) {
+		prctl(PR_SET_NAME, (long unsigned int) name.c_str(), 0, 0, 0);
+
+		Job_t job;
+		std::unique_lock<std::mutex> ul(pw->mtx, std::defer_lock);
+		while (true) {
+			while (pw->jobs.Pop(job)) {
+				job();
+				job = nullptr;
+			}
+
+			// Check again for jobs after having declared to sleep: a
+			// submitter either sees the flag set, or its job is seen here
+			ul.lock();
+			pw->sleeping.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (pw->jobs.Empty() && !pw->done)
+				pw->cv.wait(ul);
+			pw->sleeping.store(false, std::memory_order_relaxed);
+			bool done = pw->done;
+			ul.unlock();
+
+			if (done && pw->jobs.Empty())
+				break;
+		}
+	}
+};
+
+} // namespace utils
+
+} // namespace bbque
+
+#endif // BBQUE_UTILS_WORKER_POOL_H_
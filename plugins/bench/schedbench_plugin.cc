@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "schedbench_plugin.h"
+#include "schedbench_test.h"
+
+namespace bp = bbque::plugins;
+
+extern "C"
+int32_t PF_exitFunc() {
+	return 0;
+}
+
+extern "C"
+PF_ExitFunc PF_initPlugin(const PF_PlatformServices * params) {
+	int res = 0;
+
+	PF_RegisterParams rp;
+	rp.version.major = 1;
+	rp.version.minor = 0;
+	rp.programming_language = PF_LANG_CPP;
+
+	// Registering SchedBenchmarkTest Module
+	rp.CreateFunc = bp::SchedBenchmarkTest::Create;
+	rp.DestroyFunc = bp::SchedBenchmarkTest::Destroy;
+	res = params->RegisterObject((const char *)MODULE_NAMESPACE, &rp);
+	if (res < 0)
+		return NULL;
+
+	return PF_exitFunc;
+
+}
+PLUGIN_INIT(PF_initPlugin);
@@ -0,0 +1,453 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "schedbench_test.h"
+
+#include "bbque/application_manager.h"
+#include "bbque/binding_manager.h"
+#include "bbque/configuration_manager.h"
+#include "bbque/platform_manager.h"
+#include "bbque/scheduler_manager.h"
+#include "bbque/synchronization_manager.h"
+#include "bbque/system.h"
+#include "bbque/utils/timer.h"
+
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+# include "bbque/process_manager.h"
+#endif
+#ifdef CONFIG_BBQUE_SCHED_PROFILING
+# include "bbque/profile_manager.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+#include <malloc.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ba = bbque::app;
+namespace po = boost::program_options;
+
+namespace bbque { namespace plugins {
+
+SchedBenchmarkTest::SchedBenchmarkTest() :
+	nr_apps(SCHEDBENCH_DEFAULT_APPS),
+	nr_procs(SCHEDBENCH_DEFAULT_PROCS),
+	nr_recipes(SCHEDBENCH_DEFAULT_RECIPES),
+	nr_rounds(SCHEDBENCH_DEFAULT_ROUNDS),
+	nr_warmup(SCHEDBENCH_DEFAULT_WARMUP),
+	output("-"),
+	heap_retained(0),
+	nr_failed(0) {
+
+	logger = bu::Logger::GetLogger(MODULE_NAMESPACE);
+	assert(logger);
+}
+
+SchedBenchmarkTest::~SchedBenchmarkTest() {
+
+}
+
+// ===================[ Plugin interfaces ]====================================
+
+void * SchedBenchmarkTest::Create(PF_ObjectParams *) {
+	return new SchedBenchmarkTest();
+}
+
+int32_t SchedBenchmarkTest::Destroy(void * plugin) {
+	if (!plugin)
+		return -1;
+	delete (SchedBenchmarkTest *) plugin;
+	return 0;
+}
+
+// ===================[ Benchmark setup ]======================================
+
+void SchedBenchmarkTest::LoadConfiguration() {
+	ConfigurationManager & cm(ConfigurationManager::GetInstance());
+	po::options_description opts_desc("Scheduling Benchmark Options");
+	opts_desc.add_options()
+		(MODULE_CONFIG ".apps",
+		 po::value<uint32_t>(&nr_apps)->default_value(
+			SCHEDBENCH_DEFAULT_APPS),
+		 "Number of synthetic EXCs")
+		(MODULE_CONFIG ".procs",
+		 po::value<uint32_t>(&nr_procs)->default_value(
+			SCHEDBENCH_DEFAULT_PROCS),
+		 "Number of synthetic processes")
+		(MODULE_CONFIG ".recipes",
+		 po::value<uint32_t>(&nr_recipes)->default_value(
+			SCHEDBENCH_DEFAULT_RECIPES),
+		 "Number of generated recipes")
+		(MODULE_CONFIG ".rounds",
+		 po::value<uint32_t>(&nr_rounds)->default_value(
+			SCHEDBENCH_DEFAULT_ROUNDS),
+		 "Number of measured scheduling rounds")
+		(MODULE_CONFIG ".warmup",
+		 po::value<uint32_t>(&nr_warmup)->default_value(
+			SCHEDBENCH_DEFAULT_WARMUP),
+		 "Number of warm-up scheduling rounds")
+		(MODULE_CONFIG ".output",
+		 po::value<std::string>(&output)->default_value("-"),
+		 "JSON report file (- for the standard output)")
+		("SchedulerManager.policy",
+		 po::value<std::string>(&policy)->default_value(
+			BBQUE_SCHEDPOL_DEFAULT),
+		 "The scheduling policy")
+		;
+	po::variables_map opts_vm;
+	cm.ParseConfigurationFile(opts_desc, opts_vm);
+
+	if (nr_recipes == 0)
+		nr_recipes = 1;
+	if (nr_rounds == 0)
+		nr_rounds = 1;
+
+	logger->Info("Benchmark: policy=%s apps=%d procs=%d recipes=%d "
+		"rounds=%d (+%d warm-up)",
+		policy.c_str(), nr_apps, nr_procs, nr_recipes,
+		nr_rounds, nr_warmup);
+}
+
+bool SchedBenchmarkTest::Setup() {
+	PlatformManager & plm(PlatformManager::GetInstance());
+	BindingManager & bdm(BindingManager::GetInstance());
+
+	if (plm.LoadPlatformConfig() != PlatformManager::PLATFORM_OK) {
+		logger->Error("Setup: platform configuration loading FAILED");
+		return false;
+	}
+
+	if (plm.LoadPlatformData() != PlatformManager::PLATFORM_OK) {
+		logger->Error("Setup: platform data loading FAILED");
+		return false;
+	}
+
+	if (bdm.LoadBindingDomains() != BindingManager::OK) {
+		logger->Error("Setup: binding domains loading FAILED");
+		return false;
+	}
+
+	return true;
+}
+
+pid_t SchedBenchmarkTest::SpawnSleeper() {
+	pid_t pid = fork();
+	if (pid == 0) {
+		// Only async-signal-safe calls here: the daemon is multi-threaded
+		for (;;)
+			pause();
+	}
+
+	if (pid < 0) {
+		logger->Error("SpawnSleeper: fork FAILED");
+		return -1;
+	}
+
+	sleepers.push_back(pid);
+	return pid;
+}
+
+bool SchedBenchmarkTest::RegisterWorkload() {
+	ApplicationManager & am(ApplicationManager::GetInstance());
+	pid_t pid = -1;
+
+	// Each child process hosts as many EXCs as the UID encoding allows
+	for (uint32_t i = 0; i < nr_apps; ++i) {
+		uint8_t exc_id = i & BBQUE_UID_MASK;
+		if (exc_id == 0) {
+			pid = SpawnSleeper();
+			if (pid < 0)
+				return false;
+		}
+
+		std::string recipe(SCHEDBENCH_RECIPE_PREFIX +
+			std::to_string(i % nr_recipes));
+		ba::AppPtr_t papp = am.CreateEXC(
+			SCHEDBENCH_APP_NAME, pid, exc_id, recipe, RTLIB_LANG_CPP,
+			i % BBQUE_APP_PRIO_LEVELS, false, true);
+		if (!papp) {
+			logger->Error("RegisterWorkload: EXC %d creation FAILED "
+				"(recipe=%s)", i, recipe.c_str());
+			return false;
+		}
+
+		if (am.EnableEXC(papp) != ApplicationManager::AM_SUCCESS) {
+			logger->Error("RegisterWorkload: [%s] enabling FAILED",
+				papp->StrId());
+			return false;
+		}
+	}
+
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+	ProcessManager & prm(ProcessManager::GetInstance());
+	prm.Add(SCHEDBENCH_PROC_NAME);
+
+	for (uint32_t i = 0; i < nr_procs; ++i) {
+		pid = SpawnSleeper();
+		if (pid < 0)
+			return false;
+
+		prm.NotifyStart(SCHEDBENCH_PROC_NAME, pid);
+		ProcPtr_t proc(prm.GetProcess(pid));
+		if (!proc) {
+			logger->Error("RegisterWorkload: process %d registration "
+				"FAILED", pid);
+			return false;
+		}
+
+		// Alternate single-core and dual-core requests
+		auto sched_req = std::make_shared<ba::Process::ScheduleRequest>();
+		sched_req->cpu_cores = 1 + (i % 2);
+		proc->SetScheduleRequestInfo(sched_req);
+	}
+#else
+	if (nr_procs > 0)
+		logger->Warn("RegisterWorkload: process management not "
+			"available, %d processes ignored", nr_procs);
+	nr_procs = 0;
+#endif
+
+	logger->Info("RegisterWorkload: %d EXCs and %d processes registered",
+		nr_apps, nr_procs);
+	return true;
+}
+
+void SchedBenchmarkTest::ReleaseWorkload() {
+	ApplicationManager & am(ApplicationManager::GetInstance());
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+	ProcessManager & prm(ProcessManager::GetInstance());
+#endif
+
+	for (auto pid : sleepers) {
+		if (am.GetApplication(pid, 0))
+			am.DestroyEXC(pid);
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+		else
+			prm.NotifyExit(SCHEDBENCH_PROC_NAME, pid);
+#endif
+		kill(pid, SIGKILL);
+		waitpid(pid, nullptr, 0);
+	}
+	sleepers.clear();
+}
+
+// ===================[ Scheduling rounds ]====================================
+
+void SchedBenchmarkTest::RunRounds() {
+	SchedulerManager & sm(SchedulerManager::GetInstance());
+	SynchronizationManager & ym(SynchronizationManager::GetInstance());
+	System & sys(System::GetInstance());
+#ifdef CONFIG_BBQUE_SCHED_PROFILING
+	ProfileManager & om(ProfileManager::GetInstance());
+#endif
+	bu::Timer round_tmr;
+	bu::Timer phase_tmr;
+	int64_t heap_start = 0;
+
+	for (uint32_t r = 0; r < nr_warmup + nr_rounds; ++r) {
+		bool measured = (r >= nr_warmup);
+		if (r == nr_warmup)
+			heap_start = HeapInUse();
+		int64_t heap_before = HeapInUse();
+		round_tmr.start();
+
+		//--- Scheduling
+		phase_tmr.start();
+		SchedulerManager::ExitCode_t sched_result = sm.Schedule();
+		phase_tmr.stop();
+		if (sched_result != SchedulerManager::DONE) {
+			logger->Warn("RunRounds: round %d scheduling FAILED", r);
+			if (measured)
+				++nr_failed;
+			continue;
+		}
+		double t_schedule = phase_tmr.getElapsedTimeUs();
+
+		//--- Synchronization
+		double t_sync = 0;
+		if (sys.HasSchedulables(ba::Schedulable::SYNC)) {
+			phase_tmr.start();
+			ym.SyncSchedule();
+			phase_tmr.stop();
+			t_sync = phase_tmr.getElapsedTimeUs();
+		}
+
+#ifdef CONFIG_BBQUE_SCHED_PROFILING
+		//--- Profiling
+		phase_tmr.start();
+		om.ProfileSchedule();
+		phase_tmr.stop();
+		double t_profile = phase_tmr.getElapsedTimeUs();
+#endif
+		round_tmr.stop();
+
+		if (!measured)
+			continue;
+
+		round_us.push_back(round_tmr.getElapsedTimeUs());
+		schedule_us.push_back(t_schedule);
+		sync_us.push_back(t_sync);
+#ifdef CONFIG_BBQUE_SCHED_PROFILING
+		profile_us.push_back(t_profile);
+#endif
+		heap_delta.push_back(HeapInUse() - heap_before);
+	}
+
+	heap_retained = HeapInUse() - heap_start;
+	logger->Info("RunRounds: %d rounds completed, %d failed",
+		nr_rounds, nr_failed);
+}
+
+SchedBenchmarkTest::Stats_t
+SchedBenchmarkTest::GetStats(std::vector<double> samples) {
+	Stats_t stats = {0, 0, 0, 0, 0};
+	if (samples.empty())
+		return stats;
+
+	// Nearest-rank percentiles
+	std::sort(samples.begin(), samples.end());
+	auto Percentile = [&samples](double pct) {
+		size_t rank = std::ceil(pct / 100.0 * samples.size());
+		return samples[(rank > 0) ? rank - 1 : 0];
+	};
+
+	stats.min  = samples.front();
+	stats.p50  = Percentile(50);
+	stats.p99  = Percentile(99);
+	stats.max  = samples.back();
+	stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) /
+		samples.size();
+	return stats;
+}
+
+int64_t SchedBenchmarkTest::HeapInUse() {
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+	struct mallinfo2 mi = mallinfo2();
+#else
+	struct mallinfo mi = mallinfo();
+#endif
+	// Small blocks from the arenas plus the mmap-ed ones
+	return static_cast<int64_t>(mi.uordblks) + mi.hblkhd;
+}
+
+// ===================[ JSON report ]==========================================
+
+static void WriteStats(FILE * out, char const * name,
+		double min, double p50, double p99, double max, double mean,
+		bool last = false) {
+	fprintf(out, "\t\t\"%s\": {\"min\": %.3f, \"p50\": %.3f, \"p99\": %.3f, "
+		"\"max\": %.3f, \"mean\": %.3f}%s\n",
+		name, min, p50, p99, max, mean, last ? "" : ",");
+}
+
+void SchedBenchmarkTest::WriteReport() const {
+	PlatformManager & plm(PlatformManager::GetInstance());
+	size_t nr_cpus = 0, nr_pes = 0, nr_mems = 0, nr_storages = 0;
+
+	for (auto const & sys_entry : plm.GetPlatformDescription().GetSystemsAll()) {
+		auto const & sys = sys_entry.second;
+		if (!sys.IsLocal())
+			continue;
+		for (auto const & cpu : sys.GetCPUsAll()) {
+			++nr_cpus;
+			nr_pes += cpu.GetProcessingElementsAll().size();
+		}
+		nr_mems     += sys.GetMemoriesAll().size();
+		nr_storages += sys.GetStoragesAll().size();
+	}
+
+	FILE * out = stdout;
+	if (output != "-") {
+		out = fopen(output.c_str(), "w");
+		if (!out) {
+			logger->Error("WriteReport: cannot open <%s>", output.c_str());
+			return;
+		}
+	}
+
+	fprintf(out, "{\n");
+	fprintf(out, "\t\"benchmark\": \"%s\",\n", SCHEDBENCH_NAME);
+	fprintf(out, "\t\"policy\": \"%s\",\n", policy.c_str());
+	fprintf(out, "\t\"platform\": {\"cpus\": %zu, \"pes\": %zu, "
+		"\"memories\": %zu, \"storages\": %zu},\n",
+		nr_cpus, nr_pes, nr_mems, nr_storages);
+	fprintf(out, "\t\"workload\": {\"applications\": %u, \"processes\": %u, "
+		"\"recipes\": %u},\n",
+		nr_apps, nr_procs, nr_recipes);
+	fprintf(out, "\t\"rounds\": {\"warmup\": %u, \"measured\": %u, "
+		"\"failed\": %u},\n",
+		nr_warmup, nr_rounds, nr_failed);
+
+	std::vector<std::pair<char const *, std::vector<double> const *>> phases = {
+		{ "round",    &round_us },
+		{ "schedule", &schedule_us },
+		{ "sync",     &sync_us },
+#ifdef CONFIG_BBQUE_SCHED_PROFILING
+		{ "profile",  &profile_us },
+#endif
+	};
+	fprintf(out, "\t\"latency_us\": {\n");
+	for (size_t i = 0; i < phases.size(); ++i) {
+		Stats_t st(GetStats(*phases[i].second));
+		WriteStats(out, phases[i].first,
+			st.min, st.p50, st.p99, st.max, st.mean,
+			i == phases.size() - 1);
+	}
+	fprintf(out, "\t},\n");
+
+	Stats_t heap(GetStats(heap_delta));
+	fprintf(out, "\t\"heap_bytes\": {\n");
+	WriteStats(out, "round_delta",
+		heap.min, heap.p50, heap.p99, heap.max, heap.mean);
+	fprintf(out, "\t\t\"retained\": %ld\n", static_cast<long>(heap_retained));
+	fprintf(out, "\t}\n");
+	fprintf(out, "}\n");
+
+	if (out != stdout)
+		fclose(out);
+	else
+		fflush(out);
+}
+
+// ===================[ Start the test ]=======================================
+
+void SchedBenchmarkTest::Test() {
+#ifndef CONFIG_TARGET_EMULATED_HOST
+	logger->Error("Test: the benchmark requires the emulated host target");
+	return;
+#else
+	LoadConfiguration();
+
+	if (!Setup())
+		return;
+
+	if (RegisterWorkload())
+		RunRounds();
+
+	ReleaseWorkload();
+	WriteReport();
+#endif
+}
+
+} // namespace plugins
+
+} // namespace bbque
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_SCHEDBENCH_TEST_H_
+#define BBQUE_SCHEDBENCH_TEST_H_
+
+#include "bbque/config.h"
+#include "bbque/plugins/plugin.h"
+#include "bbque/plugins/test.h"
+#include "bbque/utils/logging/logger.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#define SCHEDBENCH_NAME "schedbench"
+#define MODULE_NAMESPACE TEST_NAMESPACE SCHEDBENCH_NAME
+#define MODULE_CONFIG "SchedBenchmark"
+
+/** The prefix of the names of the generated recipes */
+#define SCHEDBENCH_RECIPE_PREFIX "schedbench-"
+
+/** The name of the synthetic applications and processes */
+#define SCHEDBENCH_APP_NAME  "schedbench"
+#define SCHEDBENCH_PROC_NAME "schedbench-proc"
+
+#define SCHEDBENCH_DEFAULT_APPS     16
+#define SCHEDBENCH_DEFAULT_PROCS     0
+#define SCHEDBENCH_DEFAULT_RECIPES   1
+#define SCHEDBENCH_DEFAULT_ROUNDS  100
+#define SCHEDBENCH_DEFAULT_WARMUP    5
+
+// These are the parameters received by the PluginManager on create calls
+struct PF_ObjectParams;
+
+namespace bu = bbque::utils;
+
+namespace bbque { namespace plugins {
+
+/**
+ * @class SchedBenchmarkTest
+ * @brief Latency benchmark of the scheduling rounds
+ *
+ * This test boots the daemon core on the (emulated) platform described by
+ * the platform loader, registers a set of synthetic EXCs and processes,
+ * and then drives a number of scheduling rounds. Each round performs the
+ * same steps of ResourceManager::Optimize(), i.e. the scheduling policy
+ * run and the synchronization of the scheduled applications, which are
+ * timed separately.
+ *
+ * The synthetic EXCs are registered as containers, so that the
+ * synchronization protocol does not require any RTLib counterpart. Their
+ * recipes are expected to be found in the recipes folder, with names
+ * SCHEDBENCH_RECIPE_PREFIX<N>.
+ *
+ * The results are written in JSON format, to support regression tracking.
+ */
+class SchedBenchmarkTest: public TestIF {
+
+public:
+
+	/**
+	 * @brief Plugin creation method
+	 */
+	static void * Create(PF_ObjectParams *);
+
+	/**
+	 * @brief Plugin destruction method
+	 */
+	static int32_t Destroy(void *);
+
+	virtual ~SchedBenchmarkTest();
+
+	/**
+	 * @brief Run the benchmark
+	 */
+	void Test();
+
+private:
+
+	/**
+	 * @brief Statistics of a set of samples
+	 */
+	struct Stats_t {
+		double min;
+		double p50;
+		double p99;
+		double max;
+		double mean;
+	};
+
+	std::unique_ptr<bu::Logger> logger;
+
+	/** Number of synthetic EXCs to register */
+	uint32_t nr_apps;
+
+	/** Number of synthetic (not integrated) processes to register */
+	uint32_t nr_procs;
+
+	/** Number of generated recipes, assigned round-robin to the EXCs */
+	uint32_t nr_recipes;
+
+	/** Number of measured scheduling rounds */
+	uint32_t nr_rounds;
+
+	/** Number of initial scheduling rounds not accounted */
+	uint32_t nr_warmup;
+
+	/** Output file ("-" for the standard output) */
+	std::string output;
+
+	/** The scheduling policy loaded by the SchedulerManager */
+	std::string policy;
+
+	/** The child processes hosting the synthetic EXCs and processes */
+	std::vector<pid_t> sleepers;
+
+	/** Per-round samples [us] */
+	std::vector<double> round_us;
+	std::vector<double> schedule_us;
+	std::vector<double> sync_us;
+#ifdef CONFIG_BBQUE_SCHED_PROFILING
+	std::vector<double> profile_us;
+#endif
+
+	/** Per-round growth of the heap memory in use [bytes] */
+	std::vector<double> heap_delta;
+
+	/** Heap memory in use growth over all the measured rounds [bytes] */
+	int64_t heap_retained;
+
+	/** Number of failed scheduling rounds */
+	uint32_t nr_failed;
+
+	SchedBenchmarkTest();
+
+	/**
+	 * @brief Parse the benchmark options from the configuration file
+	 */
+	void LoadConfiguration();
+
+	/**
+	 * @brief Load the platform description and register the resources
+	 *
+	 * @return true on success, false otherwise
+	 */
+	bool Setup();
+
+	/**
+	 * @brief Register the synthetic EXCs and processes
+	 *
+	 * @return true on success, false otherwise
+	 */
+	bool RegisterWorkload();
+
+	/**
+	 * @brief Unregister the workload and terminate the child processes
+	 */
+	void ReleaseWorkload();
+
+	/**
+	 * @brief Fork a child process doing nothing until killed
+	 *
+	 * The life status of the processes owning the EXCs is checked at each
+	 * scheduling run, thus each EXC must refer to an existing process.
+	 *
+	 * @return the PID of the child, or -1 on error
+	 */
+	pid_t SpawnSleeper();
+
+	/**
+	 * @brief Drive the warm-up and the measured scheduling rounds
+	 */
+	void RunRounds();
+
+	/**
+	 * @brief Write the JSON report of the measured rounds
+	 */
+	void WriteReport() const;
+
+	static Stats_t GetStats(std::vector<double> samples);
+
+	static int64_t HeapInUse();
+};
+
+} // namespace plugins
+
+} // namespace bbque
+
+#endif // BBQUE_SCHEDBENCH_TEST_H_
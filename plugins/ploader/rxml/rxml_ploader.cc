@@ -743,6 +743,8 @@ RXMLPlatformLoader::ParseStorages(node_ptr root,
 		attr_ptr bw_unit_attr  = this->GetFirstAttribute(storage_tag, "bw_unit",  		true);
 		attr_ptr dev		   = this->GetFirstAttribute(storage_tag, "dev", 			true);
 		attr_ptr type_attr     = this->GetFirstAttribute(storage_tag, "type",     		false);
+		attr_ptr r_iops_attr   = this->GetFirstAttribute(storage_tag, "read_iops",		false);
+		attr_ptr w_iops_attr   = this->GetFirstAttribute(storage_tag, "write_iops",		false);
 
 		short        id;
 		int          quantity;
@@ -750,6 +752,8 @@ RXMLPlatformLoader::ParseStorages(node_ptr root,
 		uint64_t	 read_bandwidth;
 		uint64_t     write_bandwidth;
 		int_fast16_t bw_exp;
+		uint64_t     read_iops  = 0;
+		uint64_t     write_iops = 0;
 
 		// id=""
 		try {
@@ -830,6 +834,28 @@ RXMLPlatformLoader::ParseStorages(node_ptr root,
 			return PL_LOGIC_ERROR;
 		}
 
+		// read_iops="" (optional)
+		if (r_iops_attr != nullptr) {
+			try {
+				read_iops = std::stoull(r_iops_attr->value());
+			}
+			catch (const std::exception &e) {
+				logger->Error("ParseStorages: read IOPS for <storage> is not a valid integer.");
+				return PL_LOGIC_ERROR;
+			}
+		}
+
+		// write_iops="" (optional)
+		if (w_iops_attr != nullptr) {
+			try {
+				write_iops = std::stoull(w_iops_attr->value());
+			}
+			catch (const std::exception &e) {
+				logger->Error("ParseStorages: write IOPS for <storage> is not a valid integer.");
+				return PL_LOGIC_ERROR;
+			}
+		}
+
 		// bw_unit=""
 		switch (ConstHashString(bw_unit_attr->value())) {
 		case ConstHashString("B/s"):
@@ -891,19 +917,38 @@ RXMLPlatformLoader::ParseStorages(node_ptr root,
 		block_dev.SetId(id);
 
 		read_storage.SetPrefix(block_dev.GetPath());
-		read_storage.SetId(0);
+		read_storage.SetIOKind(pp::PlatformDescription::IO_READ_BANDWIDTH);
 		read_storage.SetQuantity(((int64_t)quantity) << exp);
 		read_storage.SetBandwidth((uint64_t)read_bandwidth << bw_exp);
 		read_storage.SetDev(std::string(dev->value()));
 		sys.AddStorage(std::make_shared<pp::PlatformDescription::Storage>(read_storage));
 
 		write_storage.SetPrefix(block_dev.GetPath());
-		write_storage.SetId(1);
+		write_storage.SetIOKind(pp::PlatformDescription::IO_WRITE_BANDWIDTH);
 		write_storage.SetQuantity(((int64_t)quantity) << exp);
 		write_storage.SetBandwidth((uint64_t)write_bandwidth << bw_exp);
 		write_storage.SetDev(std::string(dev->value()));
 		sys.AddStorage(std::make_shared<pp::PlatformDescription::Storage>(write_storage));
 
+		// IOPS resources, registered only if specified
+		if (read_iops > 0) {
+			pp::PlatformDescription::Storage r_iops_storage(read_storage);
+			r_iops_storage.SetIOKind(pp::PlatformDescription::IO_READ_IOPS);
+			r_iops_storage.SetIOPS(read_iops);
+			sys.AddStorage(std::make_shared<pp::PlatformDescription::Storage>(r_iops_storage));
+			logger->Debug("ParseStorages: <%s> read IOPS = %lu",
+				r_iops_storage.GetPath().c_str(), read_iops);
+		}
+
+		if (write_iops > 0) {
+			pp::PlatformDescription::Storage w_iops_storage(write_storage);
+			w_iops_storage.SetIOKind(pp::PlatformDescription::IO_WRITE_IOPS);
+			w_iops_storage.SetIOPS(write_iops);
+			sys.AddStorage(std::make_shared<pp::PlatformDescription::Storage>(w_iops_storage));
+			logger->Debug("ParseStorages: <%s> write IOPS = %lu",
+				w_iops_storage.GetPath().c_str(), write_iops);
+		}
+
 		block_dev.SetReadDevice(std::make_shared<pp::PlatformDescription::Storage>(read_storage));
 		block_dev.SetWriteDevice(std::make_shared<pp::PlatformDescription::Storage>(write_storage));
 
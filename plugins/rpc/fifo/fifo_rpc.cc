@@ -20,16 +20,28 @@
 #include "bbque/config.h"
 #include <boost/filesystem.hpp>
 
+#include <sys/epoll.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
-#include <poll.h>
-#ifdef ANDROID
-# include "bbque/android/ppoll.h"
-#endif
 #include <fcntl.h>
+#include <climits>
 #include <csignal>
 #include <stdexcept>
 
+/** The bytes of the receive buffer: as much as a (default) pipe capacity */
+#define FIFO_RPC_RX_BUFFER_SIZE (64 * 1024)
+
+/** The message buffers size classes: from 64 bytes up to PIPE_BUF */
+#define FIFO_RPC_POOL_MIN_SIZE     64
+#define FIFO_RPC_POOL_CLASSES       7
+/** The free buffers kept by each size class */
+#define FIFO_RPC_POOL_CACHED_MAX   64
+
+/** Metrics (class COUNTER) declaration */
+#define FIFO_COUNTER_METRIC(NAME, DESC)\
+ {MODULE_NAMESPACE "." NAME, DESC, bu::MetricsCollector::COUNTER, 0, NULL, 0}
+
 namespace bl = bbque::rtlib;
 namespace fs = boost::filesystem;
 namespace po = boost::program_options;
@@ -39,16 +51,32 @@ namespace bbque
 namespace plugins
 {
 
+/* Definition of metrics used by this module */
+bu::MetricsCollector::MetricsCollection_t
+FifoRPC::metrics[FIFO_RPC_METRICS_COUNT] = {
+	FIFO_COUNTER_METRIC("pool.hit",  "Messages received into a recycled buffer"),
+	FIFO_COUNTER_METRIC("pool.miss", "Messages received into a new buffer"),
+};
+
 FifoRPC::FifoRPC(std::string const & fifo_dir) :
 	initialized(false),
 	conf_fifo_dir(fifo_dir),
-	rpc_fifo_fd(0)
+	rpc_fifo_fd(0),
+	epoll_fd(-1),
+	rx_buffer(FIFO_RPC_RX_BUFFER_SIZE),
+	rx_discarded(0),
+	msg_pool(FIFO_RPC_POOL_MIN_SIZE, FIFO_RPC_POOL_CLASSES,
+	         FIFO_RPC_POOL_CACHED_MAX),
+	mc(bu::MetricsCollector::GetInstance())
 {
 
 	// Get a logger
 	logger = bu::Logger::GetLogger(MODULE_NAMESPACE);
 	assert(logger);
 
+	// Setup all the module metrics
+	mc.Register(metrics, FIFO_RPC_METRICS_COUNT);
+
 	// Ignore SIGPIPE, which will otherwise result into a BBQ termination.
 	// Indeed, in case of write errors the timeouts allows BBQ to react to
 	// the application not responding or disappearing.
@@ -66,6 +94,8 @@ FifoRPC::~FifoRPC()
 	logger->Debug("FIFO RPC: cleaning up FIFO [%s]...",
 	              fifo_path.string().c_str());
 
+	if (epoll_fd >= 0)
+		::close(epoll_fd);
 	::close(rpc_fifo_fd);
 	// Remove the server side pipe
 	::unlink(fifo_path.string().c_str());
@@ -78,6 +108,7 @@ int FifoRPC::Init()
 	int error;
 	fs::path fifo_path(conf_fifo_dir);
 	boost::system::error_code ec;
+	struct epoll_event event;
 
 	if (initialized)
 		return 0;
@@ -125,10 +156,11 @@ int FifoRPC::Init()
 		return -3;
 	}
 
-	// Opening the server side pipe (R/W to keep it opened)
+	// Opening the server side pipe (R/W to keep it opened). Reads never
+	// block: a partial message must not stall the other applications.
 	logger->Debug("FIFO RPC: opening R/W...");
 	rpc_fifo_fd = ::open(fifo_path.string().c_str(),
-	                     O_RDWR);
+	                     O_RDWR | O_NONBLOCK | O_CLOEXEC);
 	if (rpc_fifo_fd < 0) {
 		logger->Error("FAILED opening RPC FIFO [%s]",
 		              fifo_path.string().c_str());
@@ -148,6 +180,21 @@ int FifoRPC::Init()
 		return -5;
 	}
 
+	// Setup the event loop waiting for incoming messages
+	epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+	event.events = EPOLLIN;
+	event.data.fd = rpc_fifo_fd;
+	if (epoll_fd < 0 ||
+	    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, rpc_fifo_fd, &event)) {
+		logger->Error("FAILED setting up RPC FIFO polling "
+		              "(Error %d: %s)",
+		              errno, strerror(errno));
+		::close(rpc_fifo_fd);
+		rpc_fifo_fd = 0;
+		::unlink(fifo_path.string().c_str());
+		return -6;
+	}
+
 	// Marking channel as already initialized
 	initialized = true;
 
@@ -157,20 +204,16 @@ int FifoRPC::Init()
 
 int FifoRPC::Poll()
 {
-	struct pollfd fifo_poll;
+	struct epoll_event event;
 	sigset_t sigmask;
 	int ret = 0;
 
-	// Bind to the FIFO input stream
-	fifo_poll.fd = rpc_fifo_fd;
-	fifo_poll.events = POLLIN;
-
 	// Return on any signal
 	sigemptyset(&sigmask);
 
 	// Wait for data availability or signal
 	logger->Debug("FIFO RPC: waiting message...");
-	ret = ::ppoll(&fifo_poll, 1, NULL, &sigmask);
+	ret = ::epoll_pwait(epoll_fd, &event, 1, -1, &sigmask);
 	if (ret < 0) {
 		logger->Debug("FIFO RPC: interrupted...");
 		ret = -EINTR;
@@ -179,108 +222,114 @@ int FifoRPC::Poll()
 	return ret;
 }
 
-ssize_t FifoRPC::RecvMessage(rpc_msg_ptr_t & msg)
+bool FifoRPC::IsValidHeader(bl::rpc_fifo_header_t const & hdr) const
+{
+	size_t pyl_offset = (hdr.rpc_msg_type == bl::RPC_APP_PAIR) ?
+		FIFO_PYL_OFFSET(APP_PAIR) : FIFO_PYL_OFFSET(GENERIC);
+
+	// Messages bigger than PIPE_BUF could be interleaved with others
+	return (hdr.rpc_msg_type < bl::RPC_BBQ_MSGS_COUNT) &&
+		(hdr.rpc_msg_offset == pyl_offset) &&
+		(hdr.fifo_msg_size >= pyl_offset + sizeof(bl::rpc_msg_header_t)) &&
+		(hdr.fifo_msg_size <= PIPE_BUF);
+}
+
+ssize_t FifoRPC::FrameMessage(rpc_msg_ptr_t & msg)
 {
 	bl::rpc_fifo_header_t hdr;
 	void *fifo_buff_ptr;
-	ssize_t result;
-	ssize_t bytes;
+	bool pool_hit;
 
-	// Read next message FIFO header
-	bytes = ::read(rpc_fifo_fd, (void*)&hdr, FIFO_PKT_SIZE(header));
-	if (bytes <= 0) {
-		if (bytes == EINTR)
-			logger->Debug("FIFO RPC: exiting FIFO read...");
-		else
-			logger->Error("FIFO RPC: fifo read error");
-		return bytes;
-	}
+	while (rx_buffer.Size() >= FIFO_PKT_SIZE(header)) {
+		::memcpy(&hdr, rx_buffer.Data(), FIFO_PKT_SIZE(header));
 
-	// Allocate a new message buffer
-	fifo_buff_ptr = ::malloc(hdr.fifo_msg_size);
-	if (!fifo_buff_ptr) {
-		char c;
-		logger->Error("FIFO RPC: message buffer creation FAILED");
-		// Remove the remaining message from the FIFO
-		for ( ; bytes < hdr.fifo_msg_size; bytes++) {
-			result = ::read(rpc_fifo_fd, (void*)&c, sizeof(char));
-			if (BBQUE_LIKELY(result != -1))
-				continue;
-
-			// FIXME If a read fails at that point, the FIFO queue
-			// could be dirty with pending bytes of the current
-			// header message... a proper clean-up procedure
-			// should be activated, e.g. lookup for the next
-			// HEADER.
-			logger->Error("FIFO RPC: read FAILED (Error %d: %s)",
-			              errno, strerror(errno));
+		// Look for the next valid header, byte by byte
+		if (!IsValidHeader(hdr)) {
+			rx_buffer.Consume(1);
+			++rx_discarded;
+			continue;
 		}
-		return -errno;
-	}
 
-	// Save header into new buffer
-	::memcpy(fifo_buff_ptr, &hdr, FIFO_PKT_SIZE(header));
+		if (rx_discarded) {
+			logger->Error("FIFO RPC: discarded [%d] bytes not matching "
+			              "a message header", (int)rx_discarded);
+			rx_discarded = 0;
+		}
 
-	bool error = false;
+		// Wait for the rest of the message
+		if (rx_buffer.Size() < hdr.fifo_msg_size)
+			return 0;
+
+		// Get a message buffer, recycled whenever possible
+		fifo_buff_ptr = msg_pool.Get(hdr.fifo_msg_size, pool_hit);
+		mc.Count(metrics[pool_hit ?
+		         FIFO_RPC_POOL_HIT : FIFO_RPC_POOL_MISS].mh);
+		if (!fifo_buff_ptr) {
+			logger->Error("FIFO RPC: message buffer creation FAILED");
+			rx_buffer.Consume(hdr.fifo_msg_size);
+			return -ENOMEM;
+		}
+		::memcpy(fifo_buff_ptr, rx_buffer.Data(), hdr.fifo_msg_size);
+		rx_buffer.Consume(hdr.fifo_msg_size);
 
-	// Recover the payload start pointer
-	switch (hdr.rpc_msg_type) {
-	case bl::RPC_APP_PAIR:
+		// Recover the payload start pointer
+		msg = (rpc_msg_ptr_t)((uint8_t *)fifo_buff_ptr + hdr.rpc_msg_offset);
 
-		result = ::read(rpc_fifo_fd,
-		                &(((bl::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->rpc_fifo),
-		                hdr.fifo_msg_size - FIFO_PKT_SIZE(header));
-		if (BBQUE_UNLIKELY(result == -1)) {
-			error = true;
-			break;
-		}
+		// The message buffer is released according to the RPC message type
+		if (msg->typ != hdr.rpc_msg_type) {
+			logger->Error("FIFO RPC: RPC message type [%d] not matching "
+				"the FIFO one [%d]", msg->typ, hdr.rpc_msg_type);
 
-		msg = (rpc_msg_ptr_t) & (((bl::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->pyl);
-		logger->Debug("FIFO RPC: Rx FIFO_HDR [sze: %hd, off: %hd, typ: %hd] "
-		              "RPC_HDR [typ: %d, pid: %d, eid: %hd]",
-		              ((bl::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->hdr.fifo_msg_size,
-		              ((bl::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->hdr.rpc_msg_offset,
-		              ((bl::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->hdr.rpc_msg_type,
-		              ((bl::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->pyl.hdr.typ,
-		              ((bl::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->pyl.hdr.app_pid,
-		              ((bl::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->pyl.hdr.exc_id
-		             );
-		break;
-	default:
-		result = ::read(rpc_fifo_fd,
-		                &(((bl::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->pyl),
-		                hdr.fifo_msg_size - FIFO_PKT_SIZE(header));
-		if (BBQUE_UNLIKELY(result == -1)) {
-			error = true;
-			break;
-		}
+			msg_pool.Put(fifo_buff_ptr);
+			msg = NULL;
 
-		msg = &(((bl::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->pyl);
+			return -EBADMSG;
+		}
 		logger->Debug("FIFO RPC: Rx FIFO_HDR [sze: %hd, off: %hd, typ: %hd] "
 		              "RPC_HDR [typ: %d, pid: %d, eid: %hd]",
-		              ((bl::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->hdr.fifo_msg_size,
-		              ((bl::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->hdr.rpc_msg_offset,
-		              ((bl::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->hdr.rpc_msg_type,
-		              ((bl::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->pyl.typ,
-		              ((bl::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->pyl.app_pid,
-		              ((bl::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->pyl.exc_id
+		              hdr.fifo_msg_size,
+		              hdr.rpc_msg_offset,
+		              hdr.rpc_msg_type,
+		              msg->typ,
+		              msg->app_pid,
+		              msg->exc_id
 		             );
-	}
 
-	if (error) {
-		logger->Error("FIFO RPC: read RPC message FAILED (Error %d: %s)",
-		              errno, strerror(errno));
+		// Recovery the payload size to be returned
+		return hdr.fifo_msg_size - hdr.rpc_msg_offset;
+	}
 
-		free(fifo_buff_ptr);
-		msg = NULL;
+	return 0;
+}
 
-		return -errno;
-	}
+ssize_t FifoRPC::RecvMessage(rpc_msg_ptr_t & msg)
+{
+	ssize_t bytes;
 
-	// Recovery the payload size to be returned
-	bytes = hdr.fifo_msg_size - hdr.rpc_msg_offset;
+	msg = NULL;
+	while (true) {
+		// Return the messages already received, if any
+		bytes = FrameMessage(msg);
+		if (bytes != 0)
+			return bytes;
+
+		// Read all the messages available, without blocking
+		bytes = rx_buffer.Fill(rpc_fifo_fd);
+		if (bytes > 0)
+			continue;
+
+		if (bytes != -EAGAIN) {
+			logger->Error("FIFO RPC: fifo read error (Error %d: %s)",
+			              (int)-bytes, strerror(-bytes));
+			return (bytes != 0) ? bytes : -EIO;
+		}
 
-	return bytes;
+		// Wait for new messages
+		if (Poll() == -EINTR) {
+			logger->Debug("FIFO RPC: exiting FIFO read...");
+			return -EINTR;
+		}
+	}
 }
 
 RPCChannelIF::plugin_data_t FifoRPC::GetPluginData(
@@ -378,24 +427,23 @@ ssize_t FifoRPC::SendMessage(plugin_data_t & pd, rpc_msg_ptr_t msg,
                              size_t count)
 {
 	fifo_data_t * ppd = (fifo_data_t*)pd.get();
-	bl::rpc_fifo_GENERIC_t *fifo_msg;
+	bl::rpc_fifo_header_t hdr;
+	struct iovec iov[2];
 	ssize_t error;
 
 	assert(rpc_fifo_fd);
 	assert(ppd && ppd->app_fifo_fd);
 
-	// FIXME copying the RPC message into the FIFO one is not efficient at all,
-	// but this it the less intrusive patch to use a single write on the PIPE.
-	// A better solution, e.g. pre-allocating a channel message, should be
-	// provided by a future patch
-
-	// Build a new message of the required type
-	// NOTE all BBQ generated command have the sam FIFO layout
-	fifo_msg = (bl::rpc_fifo_GENERIC_t*)::malloc(
-	                   offsetof(bl::rpc_fifo_GENERIC_t, pyl) + count);
-
-	// Copy the RPC message into the FIFO msg
-	::memcpy(&(fifo_msg->pyl), msg, count);
+	// NOTE all BBQ generated command have the sam FIFO layout, thus the
+	// FIFO header and the RPC message are gathered by a single write on the
+	// PIPE, without copying them into a FIFO message
+	hdr.fifo_msg_size = offsetof(bl::rpc_fifo_GENERIC_t, pyl) + count;
+	hdr.rpc_msg_offset = offsetof(bl::rpc_fifo_GENERIC_t, pyl);
+	hdr.rpc_msg_type = msg->typ;
+	iov[0].iov_base = &hdr;
+	iov[0].iov_len = hdr.rpc_msg_offset;
+	iov[1].iov_base = msg;
+	iov[1].iov_len = count;
 
 	logger->Debug("FIFO RPC: TX [type: %d, size: %d] "
 	              "using app channel [%d:%s]...",
@@ -404,17 +452,14 @@ ssize_t FifoRPC::SendMessage(plugin_data_t & pd, rpc_msg_ptr_t msg,
 	              ppd->app_fifo_filename);
 
 	// Send the RPC FIFO message
-	fifo_msg->hdr.fifo_msg_size = offsetof(bl::rpc_fifo_GENERIC_t, pyl) + count;
-	fifo_msg->hdr.rpc_msg_offset = offsetof(bl::rpc_fifo_GENERIC_t, pyl);
-	fifo_msg->hdr.rpc_msg_type = msg->typ;
-	error = ::write(ppd->app_fifo_fd, fifo_msg, fifo_msg->hdr.fifo_msg_size);
+	error = ::writev(ppd->app_fifo_fd, iov, 2);
 	if (error == -1) {
 		logger->Error("FIFO RPC: send message (header) FAILED (Error %d: %s)",
 		              errno, strerror(errno));
 		return -errno;
 	}
 
-	return fifo_msg->hdr.fifo_msg_size;
+	return hdr.fifo_msg_size;
 }
 
 void FifoRPC::FreeMessage(rpc_msg_ptr_t & msg)
@@ -432,7 +477,7 @@ void FifoRPC::FreeMessage(rpc_msg_ptr_t & msg)
 	}
 
 	// Releaseing the FIFO message buffer
-	::free(fifo_msg);
+	msg_pool.Put(fifo_msg);
 }
 
 //----- static plugin interface
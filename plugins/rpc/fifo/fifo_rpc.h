@@ -22,7 +22,10 @@
 
 #include "bbque/plugins/rpc_channel.h"
 #include "bbque/plugins/plugin.h"
+#include "bbque/utils/buffer_pool.h"
+#include "bbque/utils/frame_buffer.h"
 #include "bbque/utils/logging/logger.h"
+#include "bbque/utils/metrics_collector.h"
 
 #include <cstdint>
 
@@ -85,7 +88,17 @@ public:
 
 private:
 
+	/** The set of metrics collected by this plugin */
+	enum {
+		FIFO_RPC_POOL_HIT = 0,
+		FIFO_RPC_POOL_MISS,
 
+		FIFO_RPC_METRICS_COUNT
+	};
+
+	/** The collection of metrics used by this plugin */
+	static bu::MetricsCollector::MetricsCollection_t
+		metrics[FIFO_RPC_METRICS_COUNT];
 
 	/**
 	 * @brief System logger instance
@@ -107,6 +120,31 @@ private:
 	 */
 	int rpc_fifo_fd;
 
+	/**
+	 * @brief The epoll instance waiting for incoming messages
+	 */
+	int epoll_fd;
+
+	/**
+	 * @brief The messages read from the RPC server FIFO, not framed yet
+	 */
+	bu::FrameBuffer rx_buffer;
+
+	/**
+	 * @brief The bytes discarded while looking for a valid message header
+	 */
+	size_t rx_discarded;
+
+	/**
+	 * @brief The buffers of the received messages
+	 */
+	bu::BufferPool msg_pool;
+
+	/**
+	 * @brief The metrics collector
+	 */
+	bu::MetricsCollector & mc;
+
 	/**
 	 * @brief   The plugins constructor
 	 * Plugins objects could be build only by using the "create" method.
@@ -118,6 +156,19 @@ private:
 
 	int Init();
 
+	/**
+	 * @brief Check a message header read from the RPC server FIFO
+	 */
+	bool IsValidHeader(rtlib::rpc_fifo_header_t const & hdr) const;
+
+	/**
+	 * @brief Extract the next complete message from the receive buffer
+	 *
+	 * @return the RPC message bytes, 0 if no complete message is
+	 * available, -errno on errors
+	 */
+	ssize_t FrameMessage(rpc_msg_ptr_t & msg);
+
 };
 
 } // namespace plugins
@@ -21,16 +21,27 @@
 #include "bbque/config.h"
 #include <boost/filesystem.hpp>
 
+#include <sys/epoll.h>
 #include <sys/stat.h>
 #include <unistd.h>
-#include <poll.h>
-#ifdef ANDROID
-#include "bbque/android/ppoll.h"
-#endif
 #include <fcntl.h>
+#include <climits>
 #include <csignal>
 #include <stdexcept>
 
+/** The bytes of the receive buffer: as much as a (default) pipe capacity */
+#define FIFO_RPC_RX_BUFFER_SIZE (64 * 1024)
+
+/** The message buffers size classes: from 64 bytes up to PIPE_BUF */
+#define FIFO_RPC_POOL_MIN_SIZE     64
+#define FIFO_RPC_POOL_CLASSES       7
+/** The free buffers kept by each size class */
+#define FIFO_RPC_POOL_CACHED_MAX   64
+
+/** Metrics (class COUNTER) declaration */
+#define FIFO_COUNTER_METRIC(NAME, DESC)\
+ {MODULE_NAMESPACE "." NAME, DESC, bu::MetricsCollector::COUNTER, 0, NULL, 0}
+
 namespace bl = bbque::rtlib;
 namespace fs = boost::filesystem;
 namespace po = boost::program_options;
@@ -38,16 +49,32 @@ namespace po = boost::program_options;
 namespace bbque {
 namespace plugins {
 
+/* Definition of metrics used by this module */
+bu::MetricsCollector::MetricsCollection_t
+PBFifoRPC::metrics[FIFO_RPC_METRICS_COUNT] = {
+	FIFO_COUNTER_METRIC("pool.hit",  "Messages received into a recycled buffer"),
+	FIFO_COUNTER_METRIC("pool.miss", "Messages received into a new buffer"),
+};
+
 PBFifoRPC::PBFifoRPC(std::string const & fifo_dir) :
     initialized(false),
     conf_fifo_dir(fifo_dir),
-    rpc_fifo_fd(0)
+    rpc_fifo_fd(0),
+    epoll_fd(-1),
+    rx_buffer(FIFO_RPC_RX_BUFFER_SIZE),
+    rx_discarded(0),
+    msg_pool(FIFO_RPC_POOL_MIN_SIZE, FIFO_RPC_POOL_CLASSES,
+	     FIFO_RPC_POOL_CACHED_MAX),
+    mc(bu::MetricsCollector::GetInstance())
 {
 
 	// Get a logger
 	logger = bu::Logger::GetLogger(MODULE_NAMESPACE);
 	assert(logger);
 
+	// Setup all the module metrics
+	mc.Register(metrics, FIFO_RPC_METRICS_COUNT);
+
 	// Ignore SIGPIPE, which will otherwise result into a BBQ termination.
 	// Indeed, in case of write errors the timeouts allows BBQ to react to
 	// the application not responding or disappearing.
@@ -65,6 +92,8 @@ PBFifoRPC::~PBFifoRPC()
 	logger->Debug("FIFO RPC: cleaning up FIFO [%s]...",
 		fifo_path.string().c_str());
 
+	if (epoll_fd >= 0)
+		::close(epoll_fd);
 	::close(rpc_fifo_fd);
 	// Remove the server side pipe
 	::unlink(fifo_path.string().c_str());
@@ -77,6 +106,7 @@ int PBFifoRPC::Init()
 	int error;
 	fs::path fifo_path(conf_fifo_dir);
 	boost::system::error_code ec;
+	struct epoll_event event;
 
 	if (initialized)
 		return 0;
@@ -124,10 +154,11 @@ int PBFifoRPC::Init()
 		return -3;
 	}
 
-	// Opening the server side pipe (R/W to keep it opened)
+	// Opening the server side pipe (R/W to keep it opened). Reads never
+	// block: a partial message must not stall the other applications.
 	logger->Debug("FIFO RPC: opening R/W...");
 	rpc_fifo_fd = ::open(fifo_path.string().c_str(),
-			O_RDWR);
+			O_RDWR | O_NONBLOCK | O_CLOEXEC);
 	if (rpc_fifo_fd < 0) {
 		logger->Error("FAILED opening RPC FIFO [%s]",
 			fifo_path.string().c_str());
@@ -147,6 +178,21 @@ int PBFifoRPC::Init()
 		return -5;
 	}
 
+	// Setup the event loop waiting for incoming messages
+	epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+	event.events = EPOLLIN;
+	event.data.fd = rpc_fifo_fd;
+	if (epoll_fd < 0 ||
+		::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, rpc_fifo_fd, &event)) {
+		logger->Error("FAILED setting up RPC FIFO polling "
+			"(Error %d: %s)",
+			errno, strerror(errno));
+		::close(rpc_fifo_fd);
+		rpc_fifo_fd = 0;
+		::unlink(fifo_path.string().c_str());
+		return -6;
+	}
+
 	// Marking channel as already initialized
 	initialized = true;
 
@@ -156,20 +202,16 @@ int PBFifoRPC::Init()
 
 int PBFifoRPC::Poll()
 {
-	struct pollfd fifo_poll;
+	struct epoll_event event;
 	sigset_t sigmask;
 	int ret = 0;
 
-	// Bind to the FIFO input stream
-	fifo_poll.fd = rpc_fifo_fd;
-	fifo_poll.events = POLLIN;
-
 	// Return on any signal
 	sigemptyset(&sigmask);
 
 	// Wait for data availability or signal
 	logger->Debug("FIFO RPC: waiting message...");
-	ret = ::ppoll(&fifo_poll, 1, NULL, &sigmask);
+	ret = ::epoll_pwait(epoll_fd, &event, 1, -1, &sigmask);
 	if (ret < 0) {
 		logger->Debug("FIFO RPC: interrupted...");
 		ret = -EINTR;
@@ -178,140 +220,182 @@ int PBFifoRPC::Poll()
 	return ret;
 }
 
-ssize_t PBFifoRPC::RecvMessage(rpc_msg_ptr_t & msg)
+bool PBFifoRPC::IsValidHeader(bl::rpc_fifo_header_t const & hdr) const
+{
+	size_t pkt_size = (hdr.rpc_msg_type == bl::RPC_APP_PAIR) ?
+		FIFO_PKT_SIZE(APP_PAIR) : FIFO_PKT_SIZE(GENERIC);
+	size_t pyl_offset = (hdr.rpc_msg_type == bl::RPC_APP_PAIR) ?
+		FIFO_PYL_OFFSET(APP_PAIR) : FIFO_PYL_OFFSET(GENERIC);
+
+	// The payload is decoded in place, thus the whole message is required.
+	// Messages bigger than PIPE_BUF could be interleaved with others.
+	return (hdr.rpc_msg_type < bl::RPC_BBQ_MSGS_COUNT) &&
+		(hdr.rpc_msg_offset == pyl_offset) &&
+		(hdr.fifo_msg_size >= pkt_size) &&
+		(hdr.fifo_msg_size <= PIPE_BUF) &&
+		(hdr.pyl_size >= 0) &&
+		(hdr.pyl_size <= hdr.fifo_msg_size - hdr.rpc_msg_offset);
+}
+
+ssize_t PBFifoRPC::FrameMessage(void *& fifo_buff_ptr)
 {
 	bl::rpc_fifo_header_t hdr;
-	void *fifo_buff_ptr;
-	ssize_t result;
-	ssize_t bytes;
+	bool pool_hit;
 
-	// Read next message FIFO header
-	bytes = ::read(rpc_fifo_fd, (void*)&hdr, FIFO_PKT_SIZE(header));
-	if (bytes <= 0) {
-		if (bytes == EINTR)
-			logger->Debug("FIFO RPC: exiting FIFO read...");
-		else
-			logger->Error("FIFO RPC: fifo read error");
-		return bytes;
+	while (rx_buffer.Size() >= FIFO_PKT_SIZE(header)) {
+		::memcpy(&hdr, rx_buffer.Data(), FIFO_PKT_SIZE(header));
+
+		// Look for the next valid header, byte by byte
+		if (!IsValidHeader(hdr)) {
+			rx_buffer.Consume(1);
+			++rx_discarded;
+			continue;
+		}
+
+		if (rx_discarded) {
+			logger->Error("FIFO RPC: discarded [%d] bytes not matching "
+				"a message header", (int)rx_discarded);
+			rx_discarded = 0;
+		}
+
+		// Wait for the rest of the message
+		if (rx_buffer.Size() < hdr.fifo_msg_size)
+			return 0;
+
+		// Get a message buffer, recycled whenever possible
+		fifo_buff_ptr = msg_pool.Get(hdr.fifo_msg_size, pool_hit);
+		mc.Count(metrics[pool_hit ?
+			FIFO_RPC_POOL_HIT : FIFO_RPC_POOL_MISS].mh);
+		if (!fifo_buff_ptr) {
+			logger->Error("FIFO RPC: message buffer creation FAILED");
+			rx_buffer.Consume(hdr.fifo_msg_size);
+			return -ENOMEM;
+		}
+		::memcpy(fifo_buff_ptr, rx_buffer.Data(), hdr.fifo_msg_size);
+		rx_buffer.Consume(hdr.fifo_msg_size);
+
+		return hdr.fifo_msg_size;
 	}
 
-	// Allocate a new message buffer
-	fifo_buff_ptr = ::malloc(hdr.fifo_msg_size);
-	if (!fifo_buff_ptr) {
-		char c;
-		logger->Error("FIFO RPC: message buffer creation FAILED");
-		// Remove the remaining message from the FIFO
-		for ( ; bytes < hdr.fifo_msg_size; bytes++) {
-			result = ::read(rpc_fifo_fd, (void*)&c, sizeof(char));
-			if (BBQUE_LIKELY(result != -1))
-				continue;
-
-			// FIXME If a read fails at that point, the FIFO queue
-			// could be dirty with pending bytes of the current
-			// header message... a proper clean-up procedure
-			// should be activated, e.g. lookup for the next
-			// HEADER.
-			logger->Error("FIFO RPC: read FAILED (Error %d: %s)",
-				errno, strerror(errno));
+	return 0;
+}
+
+ssize_t PBFifoRPC::ReadMessage(void *& fifo_buff_ptr)
+{
+	ssize_t bytes;
+
+	while (true) {
+		// Return the messages already received, if any
+		bytes = FrameMessage(fifo_buff_ptr);
+		if (bytes != 0)
+			return bytes;
+
+		// Read all the messages available, without blocking
+		bytes = rx_buffer.Fill(rpc_fifo_fd);
+		if (bytes > 0)
+			continue;
+
+		if (bytes != -EAGAIN) {
+			logger->Error("FIFO RPC: fifo read error (Error %d: %s)",
+				(int)-bytes, strerror(-bytes));
+			return (bytes != 0) ? bytes : -EIO;
+		}
+
+		// Wait for new messages
+		if (Poll() == -EINTR) {
+			logger->Debug("FIFO RPC: exiting FIFO read...");
+			return -EINTR;
 		}
-		return -errno;
 	}
+}
 
-	// Save header into new buffer
-	::memcpy(fifo_buff_ptr, &hdr, FIFO_PKT_SIZE(header));
+ssize_t PBFifoRPC::RecvMessage(rpc_msg_ptr_t & msg)
+{
+	bl::rpc_fifo_header_t hdr;
+	void *fifo_buff_ptr;
+	ssize_t bytes;
 
-	bool error = false;
+	// Read next message
+	msg = NULL;
+	bytes = ReadMessage(fifo_buff_ptr);
+	if (bytes <= 0)
+		return bytes;
+	::memcpy(&hdr, fifo_buff_ptr, FIFO_PKT_SIZE(header));
 
-	PB_rpc_msg pb_msg;
+	// The decoded message is allocated on a stack arena
+	bl::PBMessageArena<> pb_arena;
+	PB_rpc_msg & pb_msg(pb_arena.Create<PB_rpc_msg>());
 	void *pyl_buffer;
 	if (hdr.rpc_msg_type == bl::RPC_APP_PAIR) {
-		// Read the fifo name string AND THE PAYLOAD
-		result = ::read(rpc_fifo_fd,
-				&(((bl::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->rpc_fifo),
-				hdr.fifo_msg_size - FIFO_PKT_SIZE(header));
-		if (BBQUE_UNLIKELY(result == -1)) {
-			error = true;
-		}
-		else {
-			// Save the payload in the msg reference parameter
-			pyl_buffer = &(((bl::rpc_fifo_APP_PAIR_t *)fifo_buff_ptr)->pyl);
-			pb_msg.ParseFromArray(pyl_buffer, hdr.pyl_size);
-			bl::rpc_msg_APP_PAIR_t *struct_msg = (bl::rpc_msg_APP_PAIR_t *)pyl_buffer;
-			::memset(struct_msg, 0, hdr.pyl_size);
-			bl::PBMessageFactory::struct_set_header((bl::rpc_msg_header_t *)struct_msg, pb_msg.hdr());
-			struct_msg->mjr_version = pb_msg.mjr_version();
-			struct_msg->mnr_version = pb_msg.mnr_version();
-			strncpy(struct_msg->app_name, pb_msg.app_name().c_str(), RTLIB_APP_NAME_LENGTH);
-		}
+		// Save the payload in the msg reference parameter
+		pyl_buffer = &(((bl::rpc_fifo_APP_PAIR_t *)fifo_buff_ptr)->pyl);
+		pb_msg.ParseFromArray(pyl_buffer, hdr.pyl_size);
+		bl::rpc_msg_APP_PAIR_t *struct_msg = (bl::rpc_msg_APP_PAIR_t *)pyl_buffer;
+		::memset(struct_msg, 0, hdr.pyl_size);
+		bl::PBMessageFactory::struct_set_header((bl::rpc_msg_header_t *)struct_msg, pb_msg.hdr());
+		struct_msg->mjr_version = pb_msg.mjr_version();
+		struct_msg->mnr_version = pb_msg.mnr_version();
+		strncpy(struct_msg->app_name, pb_msg.app_name().c_str(), RTLIB_APP_NAME_LENGTH);
 	}
 	else {
-		// Read the payload
-		result = ::read(rpc_fifo_fd,
-				&(((bl::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->pyl),
-				hdr.fifo_msg_size - FIFO_PKT_SIZE(header));
-		if (BBQUE_UNLIKELY(result == -1)) {
-			error = true;
+		// Save the payload in the msg reference parameter
+		pyl_buffer = &(((bl::rpc_fifo_GENERIC_t *)fifo_buff_ptr)->pyl);
+		pb_msg.ParseFromArray(pyl_buffer, hdr.pyl_size);
+		::memset(pyl_buffer, 0, hdr.pyl_size);
+		bl::PBMessageFactory::struct_set_header((bl::rpc_msg_header_t *)pyl_buffer, pb_msg.hdr());
+		if (pb_msg.hdr().typ() == bl::RPC_APP_EXIT ||
+		pb_msg.hdr().typ() == bl::RPC_EXC_CLEAR ||
+		pb_msg.hdr().typ() == bl::RPC_EXC_START ||
+		pb_msg.hdr().typ() == bl::RPC_EXC_STOP ||
+		pb_msg.hdr().typ() == bl::RPC_EXC_SCHEDULE) {
+			// DO NOTHING
 		}
-		else {
-			// Save the payload in the msg reference parameter
-			pyl_buffer = &(((bl::rpc_fifo_GENERIC_t *)fifo_buff_ptr)->pyl);
-			pb_msg.ParseFromArray(pyl_buffer, hdr.pyl_size);
-			::memset(pyl_buffer, 0, hdr.pyl_size);
-			bl::PBMessageFactory::struct_set_header((bl::rpc_msg_header_t *)pyl_buffer, pb_msg.hdr());
-			if (pb_msg.hdr().typ() == bl::RPC_APP_EXIT ||
-			pb_msg.hdr().typ() == bl::RPC_EXC_CLEAR ||
-			pb_msg.hdr().typ() == bl::RPC_EXC_START ||
-			pb_msg.hdr().typ() == bl::RPC_EXC_STOP ||
-			pb_msg.hdr().typ() == bl::RPC_EXC_SCHEDULE) {
-				// DO NOTHING
-			}
-			else if (pb_msg.hdr().typ() == bl::RPC_EXC_REGISTER) {
-				bl::rpc_msg_EXC_REGISTER_t *struct_msg = (bl::rpc_msg_EXC_REGISTER_t *)pyl_buffer;
-				strncpy(struct_msg->exc_name, pb_msg.exc_name().c_str(), RTLIB_EXC_NAME_LENGTH);
-				strncpy(struct_msg->recipe, pb_msg.recipe().c_str(), RTLIB_RECIPE_NAME_LENGTH);
-				struct_msg->lang = (RTLIB_ProgrammingLanguage_t)pb_msg.lang();
-			}
-			else if (pb_msg.hdr().typ() == bl::RPC_EXC_UNREGISTER) {
-				bl::rpc_msg_EXC_UNREGISTER_t *struct_msg = (bl::rpc_msg_EXC_UNREGISTER_t *)pyl_buffer;
-				strncpy(struct_msg->exc_name, pb_msg.exc_name().c_str(), RTLIB_EXC_NAME_LENGTH);
-			}
-			else if (pb_msg.hdr().typ() == bl::RPC_EXC_SET) {
-				bl::rpc_msg_EXC_SET_t *struct_msg = (bl::rpc_msg_EXC_SET_t *)pyl_buffer;
-				struct_msg->count = pb_msg.constraints_size();
-				RTLIB_Constraint_t *constraints = &(struct_msg->constraints);
-				for (uint8_t i = 0; i < struct_msg->count; i++) {
-					constraints[i].awm = pb_msg.constraints(i).awm();
-					constraints[i].operation = (RTLIB_ConstraintOperation_t)pb_msg.constraints(i).operation();
-					constraints[i].type = (RTLIB_ConstraintType_t)pb_msg.constraints(i).type();
-				}
+		else if (pb_msg.hdr().typ() == bl::RPC_EXC_REGISTER) {
+			bl::rpc_msg_EXC_REGISTER_t *struct_msg = (bl::rpc_msg_EXC_REGISTER_t *)pyl_buffer;
+			strncpy(struct_msg->exc_name, pb_msg.exc_name().c_str(), RTLIB_EXC_NAME_LENGTH);
+			strncpy(struct_msg->recipe, pb_msg.recipe().c_str(), RTLIB_RECIPE_NAME_LENGTH);
+			struct_msg->lang = (RTLIB_ProgrammingLanguage_t)pb_msg.lang();
+		}
+		else if (pb_msg.hdr().typ() == bl::RPC_EXC_UNREGISTER) {
+			bl::rpc_msg_EXC_UNREGISTER_t *struct_msg = (bl::rpc_msg_EXC_UNREGISTER_t *)pyl_buffer;
+			strncpy(struct_msg->exc_name, pb_msg.exc_name().c_str(), RTLIB_EXC_NAME_LENGTH);
+		}
+		else if (pb_msg.hdr().typ() == bl::RPC_EXC_SET) {
+			bl::rpc_msg_EXC_SET_t *struct_msg = (bl::rpc_msg_EXC_SET_t *)pyl_buffer;
+			struct_msg->count = pb_msg.constraints_size();
+			RTLIB_Constraint_t *constraints = &(struct_msg->constraints);
+			for (uint8_t i = 0; i < struct_msg->count; i++) {
+				constraints[i].awm = pb_msg.constraints(i).awm();
+				constraints[i].operation = (RTLIB_ConstraintOperation_t)pb_msg.constraints(i).operation();
+				constraints[i].type = (RTLIB_ConstraintType_t)pb_msg.constraints(i).type();
 			}
-			else if (pb_msg.hdr().typ() == bl::RPC_EXC_RTNOTIFY) {
-				bl::rpc_msg_EXC_RTNOTIFY_t *struct_msg = (bl::rpc_msg_EXC_RTNOTIFY_t *)pyl_buffer;
-				struct_msg->cps_goal_gap = pb_msg.cps_goal_gap();
-				struct_msg->cpu_usage = pb_msg.cpu_usage();
-				struct_msg->cycle_time_ms = pb_msg.cycle_time_ms();
-				struct_msg->cycle_count = pb_msg.cycle_count();
+		}
+		else if (pb_msg.hdr().typ() == bl::RPC_EXC_RTNOTIFY) {
+			bl::rpc_msg_EXC_RTNOTIFY_t *struct_msg = (bl::rpc_msg_EXC_RTNOTIFY_t *)pyl_buffer;
+			struct_msg->cps_goal_gap = pb_msg.cps_goal_gap();
+			struct_msg->cpu_usage = pb_msg.cpu_usage();
+			struct_msg->cycle_time_ms = pb_msg.cycle_time_ms();
+			struct_msg->cycle_count = pb_msg.cycle_count();
+		}
+		else if (pb_msg.hdr().typ() == bl::RPC_BBQ_RESP) {
+			if (pb_msg.hdr().resp_type() == UNDEF) {
+				bl::rpc_msg_resp_t *struct_msg = (bl::rpc_msg_resp_t *)pyl_buffer;
+				struct_msg->result = pb_msg.result();
 			}
-			else if (pb_msg.hdr().typ() == bl::RPC_BBQ_RESP) {
-				if (pb_msg.hdr().resp_type() == UNDEF) {
-					bl::rpc_msg_resp_t *struct_msg = (bl::rpc_msg_resp_t *)pyl_buffer;
-					struct_msg->result = pb_msg.result();
-				}
-				else if (pb_msg.hdr().resp_type() == PB_BBQ_SYNCP_PRECHANGE_RESP) {
-					bl::rpc_msg_BBQ_SYNCP_PRECHANGE_RESP_t *struct_msg = (bl::rpc_msg_BBQ_SYNCP_PRECHANGE_RESP_t *)pyl_buffer;
-					struct_msg->syncLatency = pb_msg.sync_latency();
-					struct_msg->result = pb_msg.result();
-				}
-				else if (pb_msg.hdr().resp_type() == PB_BBQ_GET_PROFILE_RESP) {
-					bl::rpc_msg_BBQ_GET_PROFILE_RESP_t *struct_msg = (bl::rpc_msg_BBQ_GET_PROFILE_RESP_t *)pyl_buffer;
-					struct_msg->exec_time = pb_msg.exec_time();
-					struct_msg->mem_time = pb_msg.mem_time();
-				}
+			else if (pb_msg.hdr().resp_type() == PB_BBQ_SYNCP_PRECHANGE_RESP) {
+				bl::rpc_msg_BBQ_SYNCP_PRECHANGE_RESP_t *struct_msg = (bl::rpc_msg_BBQ_SYNCP_PRECHANGE_RESP_t *)pyl_buffer;
+				struct_msg->syncLatency = pb_msg.sync_latency();
+				struct_msg->result = pb_msg.result();
 			}
-			else {
-				logger->Error("Unrecognized msg type %d", msg->typ);
+			else if (pb_msg.hdr().resp_type() == PB_BBQ_GET_PROFILE_RESP) {
+				bl::rpc_msg_BBQ_GET_PROFILE_RESP_t *struct_msg = (bl::rpc_msg_BBQ_GET_PROFILE_RESP_t *)pyl_buffer;
+				struct_msg->exec_time = pb_msg.exec_time();
+				struct_msg->mem_time = pb_msg.mem_time();
 			}
 		}
+		else {
+			logger->Error("Unrecognized msg type %d", pb_msg.hdr().typ());
+		}
 	}
 	msg = (rpc_msg_ptr_t)pyl_buffer;
 	logger->Debug("FIFO RPC: Rx FIFO_HDR [sze: %hd, off: %hd, typ: %hd] "
@@ -323,14 +407,15 @@ ssize_t PBFifoRPC::RecvMessage(rpc_msg_ptr_t & msg)
 		pb_msg.hdr().app_pid(),
 		pb_msg.hdr().exc_id());
 
-	if (error) {
-		logger->Error("FIFO RPC: read RPC message FAILED (Error %d: %s)",
-			errno, strerror(errno));
+	// The message buffer is released according to the RPC message type
+	if (msg->typ != hdr.rpc_msg_type) {
+		logger->Error("FIFO RPC: RPC message type [%d] not matching "
+			"the FIFO one [%d]", msg->typ, hdr.rpc_msg_type);
 
-		free(fifo_buff_ptr);
+		msg_pool.Put(fifo_buff_ptr);
 		msg = NULL;
 
-		return -errno;
+		return -EBADMSG;
 	}
 
 	// Recovery the payload size to be returned
@@ -434,25 +519,23 @@ ssize_t PBFifoRPC::SendMessage(plugin_data_t & pd, rpc_msg_ptr_t msg,
 			       size_t count)
 {
 	fifo_data_t * ppd = (fifo_data_t*)pd.get();
-	bl::rpc_fifo_GENERIC_t *fifo_msg;
+	bl::rpc_fifo_GENERIC_t fifo_buff;
+	bl::rpc_fifo_GENERIC_t *fifo_msg = &fifo_buff;
 	ssize_t error;
 
 	assert(rpc_fifo_fd);
 	assert(ppd && ppd->app_fifo_fd);
 
-	// FIXME copying the RPC message into the FIFO one is not efficient at all,
-	// but this it the less intrusive patch to use a single write on the PIPE.
-	// A better solution, e.g. pre-allocating a channel message, should be
-	// provided by a future patch
-
-	// Build a new message of the required type
+	// Build the message into a local buffer, to use a single write on the
+	// PIPE.
 	// NOTE all BBQ generated command have the sam FIFO layout
-	fifo_msg = (bl::rpc_fifo_GENERIC_t*)::malloc(sizeof(bl::rpc_fifo_GENERIC_t));
 
 	static uint16_t nr_sys = 0;
 	if (nr_sys > 0) {
 		// msg contains a rpc_msg_BBQ_SYNCP_PRECHANGE_SYSTEM
-		PB_rpc_msg_BBQ_SYNCP_PRECHANGE_SYSTEM pb_sys;
+		bl::PBMessageArena<> pb_arena;
+		PB_rpc_msg_BBQ_SYNCP_PRECHANGE_SYSTEM & pb_sys(
+			pb_arena.Create<PB_rpc_msg_BBQ_SYNCP_PRECHANGE_SYSTEM>());
 		bl::rpc_msg_BBQ_SYNCP_PRECHANGE_SYSTEM_t *sys = (bl::rpc_msg_BBQ_SYNCP_PRECHANGE_SYSTEM_t *)msg;
 		pb_sys.set_sys_id(sys->sys_id);
 		pb_sys.set_nr_cpus(sys->nr_cpus);
@@ -469,7 +552,8 @@ ssize_t PBFifoRPC::SendMessage(plugin_data_t & pd, rpc_msg_ptr_t msg,
 		nr_sys--;
 	}
 	else {
-		PB_rpc_msg pb_msg;
+		bl::PBMessageArena<> pb_arena;
+		PB_rpc_msg & pb_msg(pb_arena.Create<PB_rpc_msg>());
 		bl::PBMessageFactory::pb_set_header(pb_msg, msg->typ, msg->token, msg->app_pid, msg->exc_id);
 		if (msg->typ == bl::RPC_BBQ_SYNCP_PRECHANGE) {
 			bl::rpc_msg_BBQ_SYNCP_PRECHANGE_t *themsg = (bl::rpc_msg_BBQ_SYNCP_PRECHANGE_t *)msg;
@@ -545,7 +629,7 @@ void PBFifoRPC::FreeMessage(rpc_msg_ptr_t & msg)
 	}
 
 	// Releaseing the FIFO message buffer
-	::free(fifo_msg);
+	msg_pool.Put(fifo_msg);
 }
 
 //----- static plugin interface
@@ -0,0 +1,675 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "shm_rpc.h"
+
+#include "bbque/config.h"
+#include "bbque/utils/utility.h"
+#include <boost/filesystem.hpp>
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+/** The message buffers size classes: from 64 up to 512 bytes */
+#define SHM_RPC_POOL_MIN_SIZE     64
+#define SHM_RPC_POOL_CLASSES       4
+/** The free buffers kept by each size class */
+#define SHM_RPC_POOL_CACHED_MAX   64
+
+/** Metrics (class COUNTER) declaration */
+#define SHM_COUNTER_METRIC(NAME, DESC)\
+ {MODULE_NAMESPACE "." NAME, DESC, bu::MetricsCollector::COUNTER, 0, NULL, 0}
+
+namespace bl = bbque::rtlib;
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+
+namespace bbque
+{
+namespace plugins
+{
+
+/* Definition of metrics used by this module */
+bu::MetricsCollector::MetricsCollection_t
+ShmRPC::metrics[SHM_RPC_METRICS_COUNT] = {
+	SHM_COUNTER_METRIC("pool.hit",  "Messages received into a recycled buffer"),
+	SHM_COUNTER_METRIC("pool.miss", "Messages received into a new buffer"),
+};
+
+/**
+ * @brief Check if a thread belongs to the given process
+ *
+ * The RTLib identifies the application by the TID of the thread which
+ * initialized it, which is not the PID when that is not the main thread.
+ */
+static bool IsThreadOf(pid_t tid, pid_t pid)
+{
+	boost::system::error_code ec;
+	fs::path task_path("/proc/" + std::to_string(pid) +
+	                   "/task/" + std::to_string(tid));
+	return fs::exists(task_path, ec);
+}
+
+ShmRPC::shm_data::~shm_data()
+{
+	if (segment)
+		::munmap(segment, segment_size);
+}
+
+ShmRPC::ShmRPC(std::string const & shm_dir) :
+	initialized(false),
+	conf_shm_dir(shm_dir),
+	rpc_sock_fd(-1),
+	rpc_event_fd(-1),
+	next_channel(0),
+	msg_pool(SHM_RPC_POOL_MIN_SIZE, SHM_RPC_POOL_CLASSES,
+	         SHM_RPC_POOL_CACHED_MAX),
+	mc(bu::MetricsCollector::GetInstance())
+{
+
+	// Get a logger
+	logger = bu::Logger::GetLogger(MODULE_NAMESPACE);
+	assert(logger);
+
+	// Setup all the module metrics
+	mc.Register(metrics, SHM_RPC_METRICS_COUNT);
+
+	// Ignore SIGPIPE, which will otherwise result into a BBQ termination.
+	// Indeed, in case of write errors the timeouts allows BBQ to react to
+	// the application not responding or disappearing.
+	signal(SIGPIPE, SIG_IGN);
+
+	logger->Debug("Built SHM rpc object @%p", (void*)this);
+
+}
+
+ShmRPC::~ShmRPC()
+{
+	fs::path sock_path(conf_shm_dir);
+	sock_path /= "/" BBQUE_PUBLIC_SHM_SOCKET;
+
+	logger->Debug("SHM RPC: cleaning up socket [%s]...",
+	              sock_path.string().c_str());
+
+	for (int conn_fd : pending_conns)
+		::close(conn_fd);
+	for (auto & entry : pairings) {
+		::close(entry.second.conn_fd);
+		::close(entry.second.shm_fd);
+	}
+
+	::close(rpc_event_fd);
+	::close(rpc_sock_fd);
+	// Remove the server side socket
+	::unlink(sock_path.string().c_str());
+}
+
+//----- RPCChannelIF module interface
+
+int ShmRPC::Init()
+{
+	fs::path sock_path(conf_shm_dir);
+	boost::system::error_code ec;
+	struct sockaddr_un addr;
+
+	if (initialized)
+		return 0;
+
+	logger->Debug("SHM RPC: channel initialization...");
+
+	sock_path /= "/" BBQUE_PUBLIC_SHM_SOCKET;
+	if (sock_path.string().length() >= sizeof(addr.sun_path)) {
+		logger->Error("SHM RPC: socket path [%s] too long",
+		              sock_path.string().c_str());
+		return -1;
+	}
+
+	// Make dir (if not already present)
+	logger->Debug("SHM RPC: create dir [%s]...",
+	              sock_path.parent_path().c_str());
+	fs::create_directories(sock_path.parent_path(), ec);
+
+	// If the socket already exists: destroy it and rebuild a new one
+	::unlink(sock_path.string().c_str());
+
+	// Create the pairing socket
+	logger->Debug("SHM RPC: create socket [%s]...",
+	              sock_path.string().c_str());
+	rpc_sock_fd = ::socket(AF_UNIX,
+	                       SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (rpc_sock_fd < 0) {
+		logger->Error("SHM RPC: socket creation FAILED (Error %d: %s)",
+		              errno, strerror(errno));
+		return -2;
+	}
+
+	::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	::strncpy(addr.sun_path, sock_path.string().c_str(),
+	          sizeof(addr.sun_path) - 1);
+	if (::bind(rpc_sock_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+	    ::listen(rpc_sock_fd, SOMAXCONN)) {
+		logger->Error("SHM RPC: socket [%s] binding FAILED (Error %d: %s)",
+		              sock_path.string().c_str(), errno, strerror(errno));
+		::close(rpc_sock_fd);
+		rpc_sock_fd = -1;
+		return -3;
+	}
+
+	// Ensuring the socket is R/W to everyone
+	if (::chmod(sock_path.string().c_str(),
+	            S_IRUSR | S_IWUSR | S_IWGRP | S_IWOTH)) {
+		logger->Error("FAILED setting permissions on RPC socket [%s] "
+		              "(Error %d: %s)",
+		              sock_path.string().c_str(),
+		              errno, strerror(errno));
+		::close(rpc_sock_fd);
+		rpc_sock_fd = -1;
+		::unlink(sock_path.string().c_str());
+		return -4;
+	}
+
+	// The doorbell rung by the applications
+	rpc_event_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (rpc_event_fd < 0) {
+		logger->Error("SHM RPC: doorbell creation FAILED (Error %d: %s)",
+		              errno, strerror(errno));
+		::close(rpc_sock_fd);
+		rpc_sock_fd = -1;
+		::unlink(sock_path.string().c_str());
+		return -5;
+	}
+
+	// Marking channel as already initialized
+	initialized = true;
+
+	logger->Info("SHM RPC: channel initialization DONE");
+	return 0;
+}
+
+bool ShmRPC::ArmChannels(bool arm)
+{
+	std::unique_lock<std::mutex> channels_ul(channels_mtx);
+	bool empty = true;
+
+	for (auto & pch : channels) {
+		if (pch->broken)
+			continue;
+		if (!arm) {
+			pch->rx_ring.Disarm();
+			continue;
+		}
+		if (!pch->rx_ring.Arm())
+			empty = false;
+	}
+
+	return empty;
+}
+
+int ShmRPC::Poll()
+{
+	std::vector<struct pollfd> fds;
+	sigset_t sigmask;
+	int ret = 0;
+
+	// Return on any signal
+	sigemptyset(&sigmask);
+
+	while (true) {
+		if (!pairing_msgs.empty())
+			return 1;
+
+		// Ask for the doorbell to be rung by the next message, unless
+		// there are already some messages to read
+		if (!ArmChannels(true)) {
+			ArmChannels(false);
+			return 1;
+		}
+
+		// Wait for the doorbell, new connections and pairing requests
+		fds.resize(2 + pending_conns.size());
+		fds[0].fd = rpc_sock_fd;
+		fds[1].fd = rpc_event_fd;
+		for (size_t i = 0; i < pending_conns.size(); ++i)
+			fds[2 + i].fd = pending_conns[i];
+		for (auto & pfd : fds) {
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+		}
+
+		logger->Debug("SHM RPC: waiting message...");
+		ret = ::ppoll(fds.data(), fds.size(), NULL, &sigmask);
+		ArmChannels(false);
+		if (ret < 0) {
+			logger->Debug("SHM RPC: interrupted...");
+			return -EINTR;
+		}
+
+		// Reset the doorbell
+		if (fds[1].revents & POLLIN) {
+			uint64_t count;
+			if (::read(rpc_event_fd, &count, sizeof(count)) < 0)
+				logger->Debug("SHM RPC: doorbell read FAILED");
+		}
+
+		for (size_t i = 2; i < fds.size(); ++i) {
+			if (fds[i].revents)
+				RecvPairing(fds[i].fd);
+		}
+
+		if (fds[0].revents & POLLIN)
+			AcceptConnection();
+	}
+}
+
+void ShmRPC::AcceptConnection()
+{
+	int conn_fd = ::accept4(rpc_sock_fd, NULL, NULL,
+	                        SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (conn_fd < 0) {
+		logger->Error("SHM RPC: accept connection FAILED (Error %d: %s)",
+		              errno, strerror(errno));
+		return;
+	}
+
+	logger->Debug("SHM RPC: new connection [%d]", conn_fd);
+	pending_conns.push_back(conn_fd);
+}
+
+void ShmRPC::RecvPairing(int conn_fd)
+{
+	std::unique_lock<std::mutex> pairings_ul(pairings_mtx, std::defer_lock);
+	bl::rpc_msg_APP_PAIR_t pair;
+	rpc_msg_ptr_t msg;
+	ssize_t bytes;
+	int shm_fd;
+
+	// A connection carries only the pairing request
+	pending_conns.erase(
+		std::find(pending_conns.begin(), pending_conns.end(), conn_fd));
+
+	bytes = bl::RpcShmRecvFd(conn_fd, &pair, sizeof(pair), shm_fd);
+	if (bytes != sizeof(pair) || shm_fd < 0 ||
+	    pair.hdr.typ != bl::RPC_APP_PAIR) {
+		logger->Error("SHM RPC: [%d] pairing request not valid "
+		              "(bytes: %d, fd: %d)",
+		              conn_fd, (int)bytes, shm_fd);
+		if (shm_fd >= 0)
+			::close(shm_fd);
+		::close(conn_fd);
+		return;
+	}
+
+	// The pairing is keyed by the application PID, which is written by the
+	// (untrusted) application: check it against the peer process reported
+	// by the kernel. The RTLib may be initialized by a thread other than the
+	// main one, hence any thread of the peer process is accepted.
+	struct ucred peer_cred = {};
+	socklen_t cred_len = sizeof(peer_cred);
+	if (::getsockopt(conn_fd, SOL_SOCKET, SO_PEERCRED,
+			&peer_cred, &cred_len) != 0 ||
+	    !IsThreadOf(pair.hdr.app_pid, peer_cred.pid)) {
+		logger->Error("SHM RPC: [%d] pairing request not valid "
+		              "(pid: %d, peer pid: %d)",
+		              conn_fd, pair.hdr.app_pid, (int)peer_cred.pid);
+		::close(shm_fd);
+		::close(conn_fd);
+		return;
+	}
+
+	msg = GetBuffer(sizeof(pair));
+	if (!msg) {
+		logger->Error("SHM RPC: message buffer creation FAILED");
+		::close(shm_fd);
+		::close(conn_fd);
+		return;
+	}
+	::memcpy(msg, &pair, sizeof(pair));
+
+	// Keep track of the connection, to complete the pairing
+	pairings_ul.lock();
+	auto it = pairings.find(pair.hdr.app_pid);
+	if (it != pairings.end()) {
+		::close(it->second.conn_fd);
+		::close(it->second.shm_fd);
+	}
+	pairings[pair.hdr.app_pid] = { conn_fd, shm_fd };
+	pairings_ul.unlock();
+
+	logger->Debug("SHM RPC: Rx RPC_HDR [typ: %d, pid: %d, eid: %hd]",
+	              msg->typ, msg->app_pid, msg->exc_id);
+	pairing_msgs.push_back(msg);
+}
+
+ShmRPC::rpc_msg_ptr_t ShmRPC::GetBuffer(size_t count)
+{
+	bool pool_hit;
+	void * buf = msg_pool.Get(count, pool_hit);
+
+	mc.Count(metrics[pool_hit ? SHM_RPC_POOL_HIT : SHM_RPC_POOL_MISS].mh);
+	return (rpc_msg_ptr_t)buf;
+}
+
+ssize_t ShmRPC::FetchMessage(rpc_msg_ptr_t & msg)
+{
+	std::unique_lock<std::mutex> channels_ul(channels_mtx);
+	size_t nr_channels = channels.size();
+	void * pyl;
+
+	// Pairing requests first
+	if (!pairing_msgs.empty()) {
+		msg = pairing_msgs.front();
+		pairing_msgs.pop_front();
+		return sizeof(bl::rpc_msg_APP_PAIR_t);
+	}
+
+	// Round-robin among the applications, to prevent starvation
+	for (size_t i = 0; i < nr_channels; ++i) {
+		size_t idx = (next_channel + i) % nr_channels;
+		pshm_data_t & pch(channels[idx]);
+		if (pch->broken)
+			continue;
+
+		ssize_t bytes = pch->rx_ring.Peek(pyl);
+		if (bytes == 0)
+			continue;
+		if (bytes < (ssize_t)sizeof(rpc_msg_header_t)) {
+			logger->Error("SHM RPC: [%5d] ring content not valid, "
+			              "channel disabled", pch->app_pid);
+			pch->broken = true;
+			continue;
+		}
+
+		msg = GetBuffer(bytes);
+		if (!msg) {
+			logger->Error("SHM RPC: message buffer creation FAILED");
+			return -ENOMEM;
+		}
+		::memcpy(msg, pyl, bytes);
+		pch->rx_ring.Pop();
+
+		// The sender is known: do not trust the header
+		msg->app_pid = pch->app_pid;
+		next_channel = idx + 1;
+
+		logger->Debug("SHM RPC: Rx RPC_HDR [typ: %d, pid: %d, eid: %hd]",
+		              msg->typ, msg->app_pid, msg->exc_id);
+		return bytes;
+	}
+
+	return 0;
+}
+
+ssize_t ShmRPC::RecvMessage(rpc_msg_ptr_t & msg)
+{
+	ssize_t bytes;
+	int ret;
+
+	while (true) {
+		bytes = FetchMessage(msg);
+		if (bytes != 0)
+			return bytes;
+
+		// Block until a new message is available
+		ret = Poll();
+		if (ret < 0)
+			return ret;
+	}
+}
+
+ShmRPC::pshm_data_t ShmRPC::MapSegment(pid_t app_pid, int shm_fd)
+{
+	pshm_data_t pd;
+	struct stat shm_stat;
+	void * addr;
+
+	// The segment must not shrink, once mapped
+	int seals = ::fcntl(shm_fd, F_GET_SEALS);
+	if (seals < 0 || !(seals & F_SEAL_SHRINK)) {
+		logger->Error("SHM RPC: [%5d] segment not sealed", app_pid);
+		return pd;
+	}
+
+	if (::fstat(shm_fd, &shm_stat) ||
+	    shm_stat.st_size < (off_t)RPC_SHM_SEGMENT_SIZE(
+	                                BBQUE_RPC_SHM_RING_MIN_BYTES) ||
+	    shm_stat.st_size > (off_t)RPC_SHM_SEGMENT_SIZE(
+	                                BBQUE_RPC_SHM_RING_MAX_BYTES)) {
+		logger->Error("SHM RPC: [%5d] segment size not valid", app_pid);
+		return pd;
+	}
+
+	addr = ::mmap(NULL, shm_stat.st_size, PROT_READ | PROT_WRITE,
+	              MAP_SHARED, shm_fd, 0);
+	if (addr == MAP_FAILED) {
+		logger->Error("SHM RPC: [%5d] segment mapping FAILED "
+		              "(Error %d: %s)", app_pid, errno, strerror(errno));
+		return pd;
+	}
+
+	pd = std::make_shared<shm_data_t>();
+	pd->app_pid = app_pid;
+	pd->segment = (bl::rpc_shm_segment_t *)addr;
+	pd->segment_size = shm_stat.st_size;
+
+	// Check the segment layout (read once)
+	uint32_t ring_size = pd->segment->ring_size;
+	if (pd->segment->magic != BBQUE_RPC_SHM_MAGIC ||
+	    pd->segment->mjr_version != BBQUE_RPC_SHM_MAJOR_VERSION ||
+	    ring_size < BBQUE_RPC_SHM_RING_MIN_BYTES ||
+	    ring_size > BBQUE_RPC_SHM_RING_MAX_BYTES ||
+	    (ring_size & (ring_size - 1)) ||
+	    RPC_SHM_SEGMENT_SIZE(ring_size) > pd->segment_size) {
+		logger->Error("SHM RPC: [%5d] segment layout not valid", app_pid);
+		return pshm_data_t();
+	}
+
+	pd->rx_ring = bl::RpcShmRing(
+		bl::RpcShmRingToBbq(pd->segment), ring_size);
+	pd->tx_ring = bl::RpcShmRing(
+		bl::RpcShmRingToApp(pd->segment, ring_size), ring_size);
+
+	return pd;
+}
+
+int ShmRPC::SendDoorbell(int conn_fd)
+{
+	uint8_t result = RTLIB_OK;
+
+	// The connection is non blocking, but the message is small enough to
+	// always fit into the empty socket buffer
+	if (bl::RpcShmSendFd(conn_fd, &result, sizeof(result),
+	                     rpc_event_fd) != sizeof(result)) {
+		logger->Error("SHM RPC: doorbell sending FAILED (Error %d: %s)",
+		              errno, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+RPCChannelIF::plugin_data_t ShmRPC::GetPluginData(
+        rpc_msg_ptr_t & msg)
+{
+	std::unique_lock<std::mutex> pairings_ul(pairings_mtx);
+	pshm_data_t pd;
+	pairing_t pairing;
+
+	// We should have the pairing socket already on place
+	assert(initialized);
+
+	// We should also have a valid RPC message
+	assert(msg->typ == bl::RPC_APP_PAIR);
+
+	logger->Debug("SHM RPC: plugin data initialization...");
+
+	// Recover the pairing connection
+	auto it = pairings.find(msg->app_pid);
+	if (it == pairings.end()) {
+		logger->Error("SHM RPC: [%5d] pairing connection NOT FOUND",
+		              msg->app_pid);
+		return plugin_data_t();
+	}
+	pairing = it->second;
+	pairings.erase(it);
+	pairings_ul.unlock();
+
+	// Map the application segment and send back the doorbell
+	pd = MapSegment(msg->app_pid, pairing.shm_fd);
+	::close(pairing.shm_fd);
+	if (!pd || SendDoorbell(pairing.conn_fd)) {
+		logger->Error("Error trying to get plugin data RPC SHM [%5d]",
+		              msg->app_pid);
+		::close(pairing.conn_fd);
+		return plugin_data_t();
+	}
+	::close(pairing.conn_fd);
+
+	// The first message should ring the doorbell, since the receiver
+	// could be already sleeping
+	pd->rx_ring.Arm();
+
+	std::unique_lock<std::mutex> channels_ul(channels_mtx);
+	channels.push_back(pd);
+	channels_ul.unlock();
+
+	logger->Info("SHM RPC: [%5d] channel initialization DONE "
+	             "(segment: %lu bytes)",
+	             pd->app_pid, pd->segment_size);
+
+	return plugin_data_t(pd);
+}
+
+void ShmRPC::ReleasePluginData(plugin_data_t & pd)
+{
+	shm_data_t * ppd = (shm_data_t*)pd.get();
+
+	assert(initialized == true);
+	assert(ppd);
+
+	// Stop polling the application ring: the segment is unmapped once the
+	// last reference to the plugin data is released
+	std::unique_lock<std::mutex> channels_ul(channels_mtx);
+	for (auto it = channels.begin(); it != channels.end(); ++it) {
+		if (it->get() != ppd)
+			continue;
+		channels.erase(it);
+		break;
+	}
+	channels_ul.unlock();
+
+	logger->Info("SHM RPC: [%5d] channel release DONE", ppd->app_pid);
+}
+
+ssize_t ShmRPC::SendMessage(plugin_data_t & pd, rpc_msg_ptr_t msg,
+                            size_t count)
+{
+	shm_data_t * ppd = (shm_data_t*)pd.get();
+	auto deadline = std::chrono::steady_clock::now() +
+	                std::chrono::milliseconds(BBQUE_RPC_TIMEOUT);
+
+	assert(ppd && ppd->segment);
+	std::unique_lock<std::mutex> tx_ul(ppd->tx_mtx);
+
+	logger->Debug("SHM RPC: TX [type: %d, size: %d] "
+	              "using app channel [%d]...",
+	              msg->typ, (int)count, ppd->app_pid);
+
+	// Wait for the application to make room, if the ring is full
+	while (!ppd->tx_ring.Push(msg, count)) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			logger->Error("SHM RPC: [%5d] send message FAILED "
+			              "(Error: ring full)", ppd->app_pid);
+			return -EAGAIN;
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+
+	// Wake up the application, only if sleeping
+	if (ppd->tx_ring.Doorbell())
+		ppd->tx_ring.FutexWake();
+
+	return count;
+}
+
+void ShmRPC::FreeMessage(rpc_msg_ptr_t & msg)
+{
+	msg_pool.Put(msg);
+}
+
+//----- static plugin interface
+
+void * ShmRPC::Create(PF_ObjectParams *params)
+{
+	static std::string conf_shm_dir;
+
+	// Declare the supported options
+	po::options_description shm_rpc_opts_desc("SHM RPC Options");
+	shm_rpc_opts_desc.add_options()
+	(MODULE_NAMESPACE".dir", po::value<std::string>
+	 (&conf_shm_dir)->default_value(BBQUE_PATH_VAR),
+	 "path of the pairing socket dir")
+	;
+	static po::variables_map shm_rpc_opts_value;
+
+	// Get configuration params
+	PF_Service_ConfDataIn data_in;
+	data_in.opts_desc = &shm_rpc_opts_desc;
+	PF_Service_ConfDataOut data_out;
+	data_out.opts_value = &shm_rpc_opts_value;
+	PF_ServiceData sd;
+	sd.id = MODULE_NAMESPACE;
+	sd.request = &data_in;
+	sd.response = &data_out;
+
+	int32_t response = params->
+	                   platform_services->InvokeService(PF_SERVICE_CONF_DATA, sd);
+	if (response != PF_SERVICE_DONE)
+		return NULL;
+
+	if (daemonized)
+		syslog(LOG_INFO, "Using RPC SHM socket dir [%s]",
+		       conf_shm_dir.c_str());
+	else
+		fprintf(stderr, FI("SHM RPC: using dir [%s]\n"),
+		        conf_shm_dir.c_str());
+
+	return new ShmRPC(conf_shm_dir);
+
+}
+
+int32_t ShmRPC::Destroy(void *plugin)
+{
+	if (!plugin)
+		return -1;
+	delete (ShmRPC *)plugin;
+	return 0;
+}
+
+} // namesapce plugins
+
+} // namespace bque
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_PLUGINS_SHM_RPC_H_
+#define BBQUE_PLUGINS_SHM_RPC_H_
+
+#include "bbque/rtlib/rpc/shm/rpc_shm_server.h"
+
+#include "bbque/plugins/rpc_channel.h"
+#include "bbque/plugins/plugin.h"
+#include "bbque/utils/buffer_pool.h"
+#include "bbque/utils/logging/logger.h"
+#include "bbque/utils/metrics_collector.h"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define MODULE_NAMESPACE RPC_CHANNEL_NAMESPACE ".shm"
+
+// These are the parameters received by the PluginManager on create calls
+struct PF_ObjectParams;
+
+namespace bu = bbque::utils;
+
+namespace bbque { namespace plugins {
+
+/**
+ * @class ShmRPC
+ * @brief A shared memory based implementation of the RPCChannelIF interface.
+ * @details
+ * Each application creates a memory segment holding two single producer,
+ * single consumer rings, one for each direction, and then it asks to be
+ * paired by connecting to a UNIX socket. Once paired, the messages are
+ * exchanged through the rings without any system call. A doorbell is rung
+ * only when the consumer is sleeping: an eventfd, passed to the applications
+ * at pairing time, wakes up the BarbequeRTRM, while a futex on the ring
+ * wakes up the application.
+ */
+class ShmRPC : public RPCChannelIF {
+
+typedef struct shm_data : ChannelData {
+	/** The application PID */
+	pid_t app_pid;
+	/** The application segment */
+	rtlib::rpc_shm_segment_t * segment;
+	/** The bytes of the application segment */
+	size_t segment_size;
+	/** The ring of the messages sent by the application */
+	rtlib::RpcShmRing rx_ring;
+	/** The ring of the messages sent to the application */
+	rtlib::RpcShmRing tx_ring;
+	/** Serialize the threads sending messages to the application */
+	std::mutex tx_mtx;
+	/** Set once the segment content has been found not valid */
+	bool broken;
+
+	shm_data() :
+		app_pid(0), segment(nullptr), segment_size(0), broken(false) {
+	}
+
+	~shm_data();
+} shm_data_t;
+
+typedef std::shared_ptr<shm_data_t> pshm_data_t;
+
+/** A pairing request waiting for the channel setup */
+typedef struct pairing {
+	/** The connection the request has been received from */
+	int conn_fd;
+	/** The application segment memfd */
+	int shm_fd;
+} pairing_t;
+
+public:
+
+//----- static plugin interface
+
+	/**
+	 *
+	 */
+	static void * Create(PF_ObjectParams *);
+
+	/**
+	 *
+	 */
+	static int32_t Destroy(void *);
+
+	virtual ~ShmRPC();
+
+//----- RPCChannelIF module interface
+
+	virtual int Poll();
+
+	virtual ssize_t RecvMessage(rpc_msg_ptr_t & msg);
+
+	virtual plugin_data_t GetPluginData(rpc_msg_ptr_t & msg);
+
+	virtual void ReleasePluginData(plugin_data_t & pd);
+
+	virtual ssize_t SendMessage(plugin_data_t & pd, rpc_msg_ptr_t msg,
+								size_t count);
+
+	virtual void FreeMessage(rpc_msg_ptr_t & msg);
+
+private:
+
+	/** The set of metrics collected by this plugin */
+	enum {
+		SHM_RPC_POOL_HIT = 0,
+		SHM_RPC_POOL_MISS,
+
+		SHM_RPC_METRICS_COUNT
+	};
+
+	/** The collection of metrics used by this plugin */
+	static bu::MetricsCollector::MetricsCollection_t
+		metrics[SHM_RPC_METRICS_COUNT];
+
+	/**
+	 * @brief System logger instance
+	 */
+	std::unique_ptr<bu::Logger> logger;
+
+	/**
+	 * @brief Thrue if the channel has been correctly initalized
+	 */
+	bool initialized;
+
+	/**
+	 * @brief The path of the directory for the pairing socket
+	 */
+	std::string conf_shm_dir;
+
+	/**
+	 * @brief The pairing socket descriptor
+	 */
+	int rpc_sock_fd;
+
+	/**
+	 * @brief The doorbell rung by the applications
+	 */
+	int rpc_event_fd;
+
+	/**
+	 * @brief The connections not yet sending a pairing request
+	 */
+	std::vector<int> pending_conns;
+
+	/**
+	 * @brief The pairing requests to return by RecvMessage
+	 */
+	std::deque<rpc_msg_ptr_t> pairing_msgs;
+
+	/**
+	 * @brief The pairing requests, by application PID
+	 */
+	std::map<pid_t, pairing_t> pairings;
+
+	std::mutex pairings_mtx;
+
+	/**
+	 * @brief The paired applications channels
+	 */
+	std::vector<pshm_data_t> channels;
+
+	std::mutex channels_mtx;
+
+	/**
+	 * @brief The next channel to check for messages (round-robin)
+	 */
+	size_t next_channel;
+
+	/**
+	 * @brief The buffers of the received messages
+	 */
+	bu::BufferPool msg_pool;
+
+	/**
+	 * @brief The metrics collector
+	 */
+	bu::MetricsCollector & mc;
+
+	/**
+	 * @brief   The plugins constructor
+	 * Plugins objects could be build only by using the "create" method.
+	 * Usually the PluginManager acts as object
+	 * @param
+	 * @return
+	 */
+	ShmRPC(std::string const & shm_dir);
+
+	int Init();
+
+	/**
+	 * @brief Get a buffer for a received message
+	 */
+	rpc_msg_ptr_t GetBuffer(size_t count);
+
+	/**
+	 * @brief Check for a message to return, without blocking
+	 *
+	 * @return the message bytes, 0 if there is no message
+	 */
+	ssize_t FetchMessage(rpc_msg_ptr_t & msg);
+
+	/**
+	 * @brief Set (or clear) the waiting flag of all the channels
+	 *
+	 * @return true if all the channels are empty
+	 */
+	bool ArmChannels(bool arm);
+
+	/**
+	 * @brief Accept a new connection on the pairing socket
+	 */
+	void AcceptConnection();
+
+	/**
+	 * @brief Read the pairing request from a connection
+	 */
+	void RecvPairing(int conn_fd);
+
+	/**
+	 * @brief Map and validate an application segment
+	 */
+	pshm_data_t MapSegment(pid_t app_pid, int shm_fd);
+
+	/**
+	 * @brief Send the doorbell eventfd to a paired application
+	 */
+	int SendDoorbell(int conn_fd);
+
+};
+
+} // namespace plugins
+
+} // namespace bbque
+
+#endif // BBQUE_PLUGINS_SHM_RPC_H_
@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ioshare_schedpol.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <functional>
+
+#include "bbque/modules_factory.h"
+#include "bbque/platform_manager.h"
+#include "bbque/utils/logging/logger.h"
+
+#include "bbque/app/working_mode.h"
+#include "bbque/res/binder.h"
+#include "bbque/res/resource_path.h"
+
+// Defaults of the configurable parameters
+#define IOSHARE_MAX_UTILIZATION_PCT  90
+#define IOSHARE_HEADROOM_PCT         20
+#define IOSHARE_MIN_SHARE_PCT        10
+
+namespace bu = bbque::utils;
+namespace po = boost::program_options;
+
+using namespace std::placeholders;
+
+namespace bbque {
+namespace plugins {
+
+// :::::::::::::::::::::: Static plugin interface ::::::::::::::::::::::::::::
+
+void * IOShareSchedPol::Create(PF_ObjectParams *)
+{
+	return new IOShareSchedPol();
+}
+
+int32_t IOShareSchedPol::Destroy(void * plugin)
+{
+	if (!plugin)
+		return -1;
+	delete (IOShareSchedPol *) plugin;
+	return 0;
+}
+
+// ::::::::::::::::::::: Scheduler policy module interface :::::::::::::::::::
+
+char const * IOShareSchedPol::Name()
+{
+	return SCHEDULER_POLICY_NAME;
+}
+
+IOShareSchedPol::IOShareSchedPol() :
+    cm(ConfigurationManager::GetInstance()),
+    ra(ResourceAccounter::GetInstance())
+{
+	logger = bu::Logger::GetLogger(MODULE_NAMESPACE);
+	assert(logger);
+	if (logger)
+		logger->Info("ioshare: Built a new dynamic object[%p]", this);
+	else
+		fprintf(stderr,
+			FI("ioshare: Built new dynamic object [%p]\n"), (void *) this);
+
+	po::options_description opts_desc("IOShareSchedPol Parameters Options");
+	opts_desc.add_options()
+		(MODULE_CONFIG ".max_utilization_pct",
+		po::value<uint32_t>(
+		&this->max_utilization_pct)->default_value(IOSHARE_MAX_UTILIZATION_PCT),
+		"Maximum fraction [%] of the device capacity to book");
+	opts_desc.add_options()
+		(MODULE_CONFIG ".headroom_pct",
+		po::value<uint32_t>(
+		&this->headroom_pct)->default_value(IOSHARE_HEADROOM_PCT),
+		"Margin [%] added to the measured I/O usage");
+	opts_desc.add_options()
+		(MODULE_CONFIG ".min_share_pct",
+		po::value<uint32_t>(
+		&this->min_share_pct)->default_value(IOSHARE_MIN_SHARE_PCT),
+		"Minimum fraction [%] of the priority-proportional share");
+	po::variables_map opts_vm;
+	cm.ParseConfigurationFile(opts_desc, opts_vm);
+
+	max_utilization_pct = std::min(std::max(max_utilization_pct, 1u), 100u);
+	min_share_pct = std::min(min_share_pct, 100u);
+	logger->Info("Running with max_utilization=%d%%, headroom=%d%%, min_share=%d%%",
+		max_utilization_pct, headroom_pct, min_share_pct);
+}
+
+IOShareSchedPol::~IOShareSchedPol()
+{
+	tenants.clear();
+}
+
+SchedulerPolicyIF::ExitCode_t IOShareSchedPol::_Init()
+{
+	if (this->cpu_pe_list.empty()) {
+		this->cpu_pe_list = sys->GetResources("sys.cpu.pe");
+		logger->Info("Init: %d CPU core(s) available", cpu_pe_list.size());
+	}
+
+	if (this->io_devices.empty())
+		InitIODevices();
+
+	// Slots for the priority-proportional assignments, considering
+	// both applications and processes
+	this->nr_slots = GetSlotsForAllSchedulables();
+	logger->Debug("Init: number of assignable slots = %d", nr_slots);
+
+	return SCHED_OK;
+}
+
+void IOShareSchedPol::InitIODevices()
+{
+	PlatformManager & plm(PlatformManager::GetInstance());
+	auto const & local_sys(plm.GetPlatformDescription().GetLocalSystem());
+
+	for (auto const & storage : local_sys.GetStoragesAll()) {
+		IODevice_t io_dev;
+		io_dev.path_str = storage->GetPath();
+		io_dev.path = ra.GetPath(io_dev.path_str);
+		io_dev.dev  = storage->GetDev();
+		io_dev.kind = storage->GetIOKind();
+		if (io_dev.path == nullptr) {
+			logger->Warn("Init: <%s> not registered", io_dev.path_str.c_str());
+			continue;
+		}
+		logger->Info("Init: <%s> device=%s capacity=%lu",
+			io_dev.path_str.c_str(), io_dev.dev.c_str(),
+			sys->ResourceTotal(io_dev.path));
+		io_devices.push_back(io_dev);
+	}
+	logger->Info("Init: %d block I/O resource(s) available", io_devices.size());
+}
+
+SchedulerPolicyIF::ExitCode_t IOShareSchedPol::Schedule(
+							System & system,
+							RViewToken_t & status_view)
+{
+	// Class providing query functions for applications and resources
+	sys = &system;
+	SchedulerPolicyIF::ExitCode_t result = Init();
+	if (result != SCHED_OK)
+		return result;
+
+	// Collect the schedulable entities
+	auto add_app = std::bind(
+		static_cast<ExitCode_t (IOShareSchedPol::*)(ba::AppCPtr_t)>
+		(&IOShareSchedPol::AddTenant), this, _1);
+	ForEachApplicationToScheduleDo(add_app);
+
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+	auto add_proc = std::bind(
+		static_cast<ExitCode_t (IOShareSchedPol::*)(ProcPtr_t)>
+		(&IOShareSchedPol::AddTenant), this, _1);
+	ForEachProcessToScheduleDo(add_proc);
+#endif // CONFIG_BBQUE_LINUX_PROC_MANAGER
+
+	logger->Debug("Schedule: %d tenant(s) to schedule", tenants.size());
+
+	// Share each block I/O resource among the tenants
+	for (size_t io_idx = 0; io_idx < io_devices.size(); ++io_idx)
+		ShareIODevice(io_idx);
+
+	// Resource binding and then scheduling
+	for (auto & tenant : tenants)
+		AssignWorkingMode(tenant);
+	tenants.clear();
+
+	// Return the new resource status view according to the new resource
+	// allocation performed
+	status_view = sched_status_view;
+	return SCHED_DONE;
+}
+
+SchedulerPolicyIF::ExitCode_t IOShareSchedPol::AddTenant(ba::AppCPtr_t papp)
+{
+	if (papp->Blocking()) {
+		logger->Info("AddTenant: [%s] is being blocked", papp->StrId());
+		return SCHED_SKIP_APP;
+	}
+
+	Tenant_t tenant;
+	tenant.papp   = papp;
+	tenant.psched = papp;
+	tenant.weight = sys->ApplicationLowestPriority() - papp->Priority() + 1;
+	tenant.io_amounts.resize(io_devices.size(), 0);
+	tenants.push_back(tenant);
+	return SCHED_OK;
+}
+
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+
+SchedulerPolicyIF::ExitCode_t IOShareSchedPol::AddTenant(ProcPtr_t proc)
+{
+	Tenant_t tenant;
+	tenant.proc   = proc;
+	tenant.psched = proc;
+	tenant.weight = sys->ApplicationLowestPriority() - proc->Priority() + 1;
+	tenant.io_amounts.resize(io_devices.size(), 0);
+	tenants.push_back(tenant);
+	return SCHED_OK;
+}
+
+#endif // CONFIG_BBQUE_LINUX_PROC_MANAGER
+
+uint64_t IOShareSchedPol::GetDemand(
+				    Tenant_t const & tenant,
+				    IODevice_t const & io_dev,
+				    uint64_t capacity) const
+{
+	// Priority-proportional share, scaled on the bookable capacity
+	uint64_t fair_share = GetPrioProportionalResourceQuota(
+		io_dev.path, tenant.psched->Priority());
+	fair_share = std::min(fair_share * max_utilization_pct / 100, capacity);
+
+	auto usage = tenant.psched->GetIOUsage(io_dev.dev);
+	if (usage.samples == 0)
+		return fair_share;
+
+	// Bandwidth resources are accounted in B/s, as the measured usage
+	double measured = 0;
+	switch (io_dev.kind) {
+	case pp::PlatformDescription::IO_READ_BANDWIDTH:
+		measured = usage.read_bps;
+		break;
+	case pp::PlatformDescription::IO_WRITE_BANDWIDTH:
+		measured = usage.write_bps;
+		break;
+	case pp::PlatformDescription::IO_READ_IOPS:
+		measured = usage.read_iops;
+		break;
+	case pp::PlatformDescription::IO_WRITE_IOPS:
+		measured = usage.write_iops;
+		break;
+	default:
+		return fair_share;
+	}
+
+	uint64_t demand = measured * (100 + headroom_pct) / 100;
+	uint64_t min_share = std::max<uint64_t>(fair_share * min_share_pct / 100, 1);
+	return std::min(std::max(demand, min_share), capacity);
+}
+
+void IOShareSchedPol::ShareIODevice(size_t io_idx)
+{
+	IODevice_t const & io_dev(io_devices[io_idx]);
+	if (tenants.empty())
+		return;
+
+	// Bookable capacity: a fraction of the total, to never saturate the
+	// device, and not more than what is still available
+	uint64_t total = sys->ResourceTotal(io_dev.path);
+	uint64_t capacity = total * max_utilization_pct / 100;
+	capacity = std::min(capacity,
+		sys->ResourceAvailable(io_dev.path, sched_status_view));
+	logger->Debug("ShareIODevice: <%s> total=%lu capacity=%lu",
+		io_dev.path_str.c_str(), total, capacity);
+	if (capacity == 0) {
+		logger->Warn("ShareIODevice: <%s> no capacity left",
+			io_dev.path_str.c_str());
+		return;
+	}
+
+	std::vector<uint64_t> demands(tenants.size());
+	std::vector<size_t> active;
+	for (size_t i = 0; i < tenants.size(); ++i) {
+		demands[i] = GetDemand(tenants[i], io_dev, capacity);
+		active.push_back(i);
+	}
+
+	// Weighted max-min fairness: tenants demanding less than their
+	// weighted share are fully satisfied, and the residual capacity is
+	// shared again among the others, until no one is left below its share
+	uint64_t remaining = capacity;
+	bool satisfied_some = true;
+	while (!active.empty() && satisfied_some) {
+		uint64_t weights = 0;
+		for (auto i : active)
+			weights += tenants[i].weight;
+
+		satisfied_some = false;
+		uint64_t granted = 0;
+		std::vector<size_t> still_active;
+		for (auto i : active) {
+			uint64_t share = remaining * tenants[i].weight / weights;
+			if (demands[i] <= share) {
+				tenants[i].io_amounts[io_idx] = demands[i];
+				granted += demands[i];
+				satisfied_some = true;
+			}
+			else
+				still_active.push_back(i);
+		}
+		remaining -= granted;
+		active = std::move(still_active);
+	}
+
+	// Tenants demanding more than the fair share get the residual capacity
+	// in proportion to their weight. If everyone has been satisfied, the
+	// slack is spread over all the tenants, to preserve work conservation.
+	auto & receivers(active);
+	if (receivers.empty()) {
+		for (size_t i = 0; i < tenants.size(); ++i)
+			receivers.push_back(i);
+	}
+
+	uint64_t weights = 0;
+	for (auto i : receivers)
+		weights += tenants[i].weight;
+	for (auto i : receivers)
+		tenants[i].io_amounts[io_idx] += remaining * tenants[i].weight / weights;
+
+	// A null amount would leave the tenant unthrottled: raise it to the
+	// minimum, taken from the biggest assignment if the capacity is over
+	uint64_t assigned = 0;
+	for (auto const & tenant : tenants)
+		assigned += tenant.io_amounts[io_idx];
+
+	auto by_amount = [io_idx](Tenant_t const & a, Tenant_t const & b) {
+		return a.io_amounts[io_idx] < b.io_amounts[io_idx];
+	};
+	for (auto & tenant : tenants) {
+		if (tenant.io_amounts[io_idx] > 0)
+			continue;
+		if (assigned >= capacity) {
+			auto max_it = std::max_element(tenants.begin(), tenants.end(), by_amount);
+			if (max_it->io_amounts[io_idx] <= 1) {
+				logger->Warn("ShareIODevice: [%s] <%s> no capacity left",
+					tenant.psched->StrId(), io_dev.path_str.c_str());
+				continue;
+			}
+			--max_it->io_amounts[io_idx];
+			--assigned;
+		}
+		tenant.io_amounts[io_idx] = 1;
+		++assigned;
+	}
+
+	for (size_t i = 0; i < tenants.size(); ++i) {
+		logger->Info("ShareIODevice: [%s] prio=%d <%s> demand=%lu assigned=%lu",
+			tenants[i].psched->StrId(),
+			tenants[i].psched->Priority(),
+			io_dev.path_str.c_str(),
+			demands[i],
+			tenants[i].io_amounts[io_idx]);
+	}
+}
+
+SchedulerPolicyIF::ExitCode_t IOShareSchedPol::AssignWorkingMode(Tenant_t & tenant)
+{
+	ba::AwmPtr_t pawm;
+	if (tenant.papp)
+		pawm = std::make_shared<ba::WorkingMode>(
+			tenant.papp->WorkingModes().size(), "IOShare", 1, tenant.papp);
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+	else
+		pawm = std::make_shared<ba::WorkingMode>(0, "IOShare", 1, tenant.proc);
+#endif
+	if (!pawm)
+		return SCHED_ERROR;
+
+	// CPU quota
+	std::string cpu_pe_path_str("sys.cpu.pe");
+	uint64_t cpu_pe_quota = GetPrioProportionalResourceQuota(
+		cpu_pe_path_str, tenant.psched->Priority());
+	if (cpu_pe_quota == 0) {
+		logger->Warn("AssignWorkingMode: [%s] will have no CPU quota",
+			tenant.psched->StrId());
+		return SCHED_R_UNAVAILABLE;
+	}
+	pawm->AddResourceRequest(cpu_pe_path_str, cpu_pe_quota,
+				br::ResourceAssignment::Policy::BALANCED);
+	logger->Debug("AssignWorkingMode: [%s] <%s> = %lu",
+		tenant.psched->StrId(), cpu_pe_path_str.c_str(), cpu_pe_quota);
+
+	// Block I/O bandwidth and IOPS
+	for (size_t io_idx = 0; io_idx < io_devices.size(); ++io_idx) {
+		if (tenant.io_amounts[io_idx] == 0)
+			continue;
+		pawm->AddResourceRequest(io_devices[io_idx].path_str,
+					tenant.io_amounts[io_idx],
+					br::ResourceAssignment::Policy::BALANCED);
+		logger->Debug("AssignWorkingMode: [%s] <%s> = %lu",
+			tenant.psched->StrId(), io_devices[io_idx].path_str.c_str(),
+			tenant.io_amounts[io_idx]);
+	}
+
+	// Resource binding: CPU quota balanced over all the cores, I/O
+	// requests already referencing the system resources
+	br::ResourceBitset pe_mask;
+	for (auto const & pe : cpu_pe_list)
+		pe_mask.Set(pe->ID());
+	int32_t ref_num = pawm->BindResource(ra.GetPath(cpu_pe_path_str), pe_mask);
+	for (auto const & io_dev : io_devices) {
+		auto io_type = io_dev.path->Type();
+		auto io_id = io_dev.path->GetID(io_type);
+		if (pawm->GetRequestedAmount(io_dev.path) == 0)
+			continue;
+		ref_num = pawm->BindResource(io_type, io_id, io_id, ref_num);
+	}
+	if (ref_num < 0) {
+		logger->Error("AssignWorkingMode: [%s] resource binding failed",
+			tenant.psched->StrId());
+		return SCHED_ERROR;
+	}
+
+	// Schedule request
+	if (tenant.papp) {
+		ApplicationManager & am(ApplicationManager::GetInstance());
+		auto am_ret = am.ScheduleRequest(tenant.papp, pawm, sched_status_view, ref_num);
+		if (am_ret != ApplicationManager::AM_SUCCESS) {
+			logger->Error("AssignWorkingMode: [%s] schedule request failed",
+				tenant.papp->StrId());
+			return SCHED_SKIP_APP;
+		}
+	}
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+	else {
+		ProcessManager & prm(ProcessManager::GetInstance());
+		auto prm_ret = prm.ScheduleRequest(tenant.proc, pawm, sched_status_view, ref_num);
+		if (prm_ret != ProcessManager::SUCCESS) {
+			logger->Error("AssignWorkingMode: [%s] schedule request failed",
+				tenant.proc->StrId());
+			return SCHED_SKIP_APP;
+		}
+	}
+#endif // CONFIG_BBQUE_LINUX_PROC_MANAGER
+
+	logger->Info("AssignWorkingMode: [%s] successfully scheduled",
+		tenant.psched->StrId());
+	return SCHED_OK;
+}
+
+} // namespace plugins
+
+} // namespace bbque
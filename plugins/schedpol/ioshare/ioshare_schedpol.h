@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_IOSHARE_SCHEDPOL_H_
+#define BBQUE_IOSHARE_SCHEDPOL_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bbque/config.h"
+#include "bbque/configuration_manager.h"
+#include "bbque/plugins/plugin.h"
+#include "bbque/plugins/scheduler_policy.h"
+#include "bbque/pp/platform_description.h"
+#include "bbque/process_manager.h"
+#include "bbque/scheduler_manager.h"
+
+#define SCHEDULER_POLICY_NAME "ioshare"
+
+#define MODULE_NAMESPACE SCHEDULER_POLICY_NAMESPACE "." SCHEDULER_POLICY_NAME
+#define MODULE_CONFIG SCHEDULER_POLICY_CONFIG "." SCHEDULER_POLICY_NAME
+
+using bbque::res::RViewToken_t;
+using bbque::utils::MetricsCollector;
+using bbque::utils::Timer;
+
+// These are the parameters received by the PluginManager on create calls
+struct PF_ObjectParams;
+
+namespace bbque {
+namespace plugins {
+
+class LoggerIF;
+
+/**
+ * @class IOShareSchedPol
+ *
+ * Work-conserving sharing of the block I/O devices. The capacity of each
+ * device (read/write bandwidth and IOPS) is split among the schedulable
+ * entities according to a weighted max-min fairness criterion, where the
+ * weights are given by the priority and the demands by the measured I/O
+ * usage. This way, the share left unused by a tenant is redistributed to
+ * the ones needing more, while the total amount booked never exceeds a
+ * configurable fraction of the device capacity.
+ */
+class IOShareSchedPol : public SchedulerPolicyIF
+{
+public:
+
+	// :::::::::::::::::::::: Static plugin interface :::::::::::::::::::::::::
+
+	/**
+	 * @brief Create the ioshare plugin
+	 */
+	static void * Create(PF_ObjectParams *);
+
+	/**
+	 * @brief Destroy the ioshare plugin
+	 */
+	static int32_t Destroy(void *);
+
+
+	// :::::::::::::::::: Scheduler policy module interface :::::::::::::::::::
+
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~IOShareSchedPol();
+
+	/**
+	 * @brief Return the name of the policy plugin
+	 */
+	char const * Name();
+
+	/**
+	 * @brief The member function called by the SchedulerManager to perform a
+	 * new scheduling / resource allocation
+	 */
+	ExitCode_t Schedule(System & system, RViewToken_t & status_view);
+
+private:
+
+	/**
+	 * @struct IODevice_t
+	 * @brief A block I/O resource (bandwidth or IOPS of a device)
+	 */
+	struct IODevice_t
+	{
+		/** The resource path string ("sysN.blkM.ioK" or "sysN.blkM.iopsK") */
+		std::string path_str;
+		/** The resource path object */
+		br::ResourcePathPtr_t path;
+		/** The block device identifier ("major:minor") */
+		std::string dev;
+		/** Read/write bandwidth or IOPS */
+		pp::PlatformDescription::IOKind_t kind;
+	};
+
+	/**
+	 * @struct Tenant_t
+	 * @brief A schedulable entity sharing the block I/O devices
+	 */
+	struct Tenant_t
+	{
+		/** The application (null in case of process) */
+		ba::AppCPtr_t papp;
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+		/** The process (null in case of application) */
+		ProcPtr_t proc;
+#endif
+		/** The schedulable entity */
+		ba::SchedPtr_t psched;
+		/** Weight of the tenant, according to its priority */
+		uint32_t weight;
+		/** Amount assigned, for each entry of io_devices */
+		std::vector<uint64_t> io_amounts;
+	};
+
+	/** Configuration manager instance */
+	ConfigurationManager & cm;
+
+	/** Resource accounter instance */
+	ResourceAccounter & ra;
+
+	/** System logger instance */
+	std::unique_ptr<bu::Logger> logger;
+
+	/** CPU processing elements */
+	br::ResourcePtrList_t cpu_pe_list;
+
+	/** Block I/O resources of the local system */
+	std::vector<IODevice_t> io_devices;
+
+	/** Schedulable entities of the current scheduling round */
+	std::vector<Tenant_t> tenants;
+
+	/** Maximum fraction [%] of a device capacity to book */
+	uint32_t max_utilization_pct;
+
+	/** Margin [%] to add to the measured usage, to let a tenant grow */
+	uint32_t headroom_pct;
+
+	/** Minimum fraction [%] of the fair share granted to a tenant */
+	uint32_t min_share_pct;
+
+	/**
+	 * @brief Constructor
+	 *
+	 * Plugins objects could be build only by using the "create" method.
+	 * Usually the PluginManager acts as object
+	 */
+	IOShareSchedPol();
+
+	/**
+	 * @brief Optional initialization member function
+	 */
+	ExitCode_t _Init();
+
+	/**
+	 * @brief Collect the block I/O resources from the platform description
+	 */
+	void InitIODevices();
+
+	/**
+	 * @brief Add a schedulable entity to the tenants of the scheduling round
+	 */
+	ExitCode_t AddTenant(ba::AppCPtr_t papp);
+
+#ifdef CONFIG_BBQUE_LINUX_PROC_MANAGER
+
+	ExitCode_t AddTenant(ProcPtr_t proc);
+
+#endif // CONFIG_BBQUE_LINUX_PROC_MANAGER
+
+	/**
+	 * @brief The amount of a block I/O resource a tenant needs
+	 *
+	 * This is the measured usage, plus some headroom, bounded from below
+	 * by a fraction of the priority-proportional share. If no usage has
+	 * been measured yet, the priority-proportional share is returned.
+	 */
+	uint64_t GetDemand(Tenant_t const & tenant, IODevice_t const & io_dev,
+			uint64_t capacity) const;
+
+	/**
+	 * @brief Split the capacity of a block I/O resource among the tenants
+	 *
+	 * @param io_idx Index of the resource in io_devices
+	 */
+	void ShareIODevice(size_t io_idx);
+
+	/**
+	 * @brief Build the working mode of a tenant and send the schedule
+	 * request
+	 */
+	ExitCode_t AssignWorkingMode(Tenant_t & tenant);
+
+};
+
+} // namespace plugins
+
+} // namespace bbque
+
+#endif // BBQUE_IOSHARE_SCHEDPOL_H_
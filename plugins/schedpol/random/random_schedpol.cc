@@ -143,6 +143,49 @@ void RandomSchedPol::ScheduleApp(ba::AppCPtr_t papp)
 	}
 }
 
+SchedulerPolicyIF::ExitCode_t
+RandomSchedPol::SchedulePartition(SchedPartition_t & part,
+                                  std::vector<ba::AppCPtr_t> const & apps,
+                                  BBQUE_RID_TYPE cpu_id)
+{
+	std::default_random_engine generator;
+
+	for (auto & papp : apps) {
+		ba::AwmPtrList_t const & awms(papp->WorkingModes());
+		std::uniform_int_distribution<int> awm_dist(0, awms.size() - 1);
+
+		for (int nr_attempts = 0; nr_attempts < NR_ATTEMPTS_MAX; ++nr_attempts) {
+			// Select a random AWM for this EXC
+			ba::AwmPtr_t selected_awm;
+			int8_t selected_awm_id = awm_dist(generator);
+			for (auto & pawm : awms) {
+				if (pawm->Id() == selected_awm_id)
+					selected_awm = pawm;
+			}
+			assert(selected_awm != nullptr);
+
+			// Binding to the CPU of the partition
+			int32_t b_refn = selected_awm->BindResource(
+			                 br::ResourceType::CPU, R_ID_ANY, cpu_id);
+			if (b_refn < 0)
+				continue;
+
+			SchedDecision_t decision;
+			decision.papp = papp;
+			decision.pawm = selected_awm;
+			decision.bind_refn = b_refn;
+			if (ScheduleInPartition(part, decision) == SCHED_OK) {
+				logger->Debug("SchedulePartition: EXC [%s] AWM=<%d> "
+				              "on binding domain <%d>",
+				              papp->StrId(), selected_awm_id, cpu_id);
+				break;
+			}
+		}
+	}
+
+	return SCHED_OK;
+}
+
 SchedulerPolicyIF::ExitCode_t
 RandomSchedPol::_Init()
 {
@@ -167,20 +210,62 @@ RandomSchedPol::Schedule(bbque::System & sv, br::RViewToken_t &rav)
 	if (result != SCHED_OK)
 		return result;
 
-	logger->Info("Random scheduling RUNNING applications...");
+	// A partition for each CPU binding domain
+	BindingMap_t & bindings(bdm.GetBindingDomains());
+	auto cpu_it = bindings.find(br::ResourceType::CPU);
+	if (cpu_it == bindings.end() || cpu_it->second->resources.empty()) {
+		logger->Warn("Schedule: CPU bindings not available (?)");
+		return SCHED_ERROR;
+	}
+
+	std::vector<SchedPartition_t> partitions;
+	std::vector<BBQUE_RID_TYPE> part_cpu_ids;
+	for (auto const & cpu : cpu_it->second->resources) {
+		partitions.emplace_back();
+		partitions.back().name = "cpu" + std::to_string(cpu->ID());
+		part_cpu_ids.push_back(cpu->ID());
+	}
+
+	// Spread the applications over random partitions
+	std::vector<std::vector<ba::AppCPtr_t>> part_apps(partitions.size());
+	std::default_random_engine generator;
+	std::uniform_int_distribution<int> part_dist(0, partitions.size() - 1);
+
 	papp = sv.GetFirstRunning(app_it);
 	while (papp) {
-		ScheduleApp(papp);
+		part_apps[part_dist(generator)].push_back(papp);
 		papp = sv.GetNextRunning(app_it);
 	}
 
-	logger->Info("Random scheduling READY applications...");
 	papp = sv.GetFirstReady(app_it);
 	while (papp) {
-		ScheduleApp(papp);
+		part_apps[part_dist(generator)].push_back(papp);
 		papp = sv.GetNextReady(app_it);
 	}
 
+	logger->Info("Random scheduling applications on %d partitions...",
+	             partitions.size());
+	auto nr_conflicts = ForEachPartitionParallelDo(partitions,
+		[&](SchedPartition_t & part) {
+			size_t i = &part - partitions.data();
+			return SchedulePartition(part, part_apps[i], part_cpu_ids[i]);
+		});
+
+	// Conflicting decisions, and partitions not scheduled, fall back to
+	// the serial scheduling
+	logger->Debug("Schedule: %d conflicting decisions", nr_conflicts);
+	for (size_t i = 0; i < partitions.size(); ++i) {
+		if (partitions[i].result != SCHED_OK) {
+			logger->Warn("Schedule: partition <%s> not scheduled",
+			             partitions[i].name.c_str());
+			for (auto & part_app : part_apps[i])
+				ScheduleApp(part_app);
+			continue;
+		}
+		for (auto & decision : partitions[i].conflicts)
+			ScheduleApp(decision.papp);
+	}
+
 	// Pass back to the SchedulerManager a reference to the scheduled view
 	rav = sched_status_view;
 	return SCHED_DONE;
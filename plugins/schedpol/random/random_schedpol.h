@@ -27,6 +27,7 @@
 
 #include <cstdint>
 #include <random>
+#include <vector>
 
 #define SCHEDULER_POLICY_NAME "random"
 #define MODULE_NAMESPACE SCHEDULER_POLICY_NAMESPACE "." SCHEDULER_POLICY_NAME
@@ -118,6 +119,19 @@ private:
 	 * @brief Randonly select an AWM for the application
 	 */
 	void ScheduleApp(ba::AppCPtr_t papp);
+
+	/**
+	 * @brief Randomly select an AWM for each application of a partition,
+	 * binding it to the CPU of the partition
+	 *
+	 * @param part The partition
+	 * @param apps The applications assigned to the partition
+	 * @param cpu_id The ID of the CPU (binding domain) of the partition
+	 */
+	SchedulerPolicyIF::ExitCode_t SchedulePartition(
+			SchedPartition_t & part,
+			std::vector<ba::AppCPtr_t> const & apps,
+			BBQUE_RID_TYPE cpu_id);
 };
 
 } // namespace plugins
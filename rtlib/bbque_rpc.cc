@@ -24,6 +24,8 @@
 #include "bbque/rtlib/rpc/fifo/rpc_fifo_client.h"
 #elif defined(CONFIG_BBQUE_RPC_PB_FIFO)
 #include "bbque/rtlib/rpc/pb_fifo/rpc_pb_fifo_client.h"
+#elif defined(CONFIG_BBQUE_RPC_SHM)
+#include "bbque/rtlib/rpc/shm/rpc_shm_client.h"
 #else
 #error "RPC CHANNEL NOT SPECIFIED"
 #endif
@@ -104,6 +106,9 @@ BbqueRPC * BbqueRPC::GetInstance()
 #elif defined(CONFIG_BBQUE_RPC_PB_FIFO)
 	logger->Debug("Using PROTOBUF FIFO RPC channel");
 	instance = new BbqueRPC_PB_FIFO_Client();
+#elif defined(CONFIG_BBQUE_RPC_SHM)
+	logger->Debug("Using SHM RPC channel");
+	instance = new BbqueRPC_SHM_Client();
 #else
 #error "RPC CHANNEL NOT SPECIFIED"
 #endif
@@ -111,7 +116,11 @@ BbqueRPC * BbqueRPC::GetInstance()
 	return instance;
 }
 
-BbqueRPC::~ BbqueRPC(void) { }
+BbqueRPC::~ BbqueRPC(void)
+{
+	logger->Debug("Message buffers: [%" PRIu64 "] recycled, [%" PRIu64 "] allocated",
+		msg_pool.Hits(), msg_pool.Misses());
+}
 
 RTLIB_ExitCode_t BbqueRPC::ParseOptions()
 {
@@ -383,6 +392,10 @@ RTLIB_ExitCode_t BbqueRPC::InitApplication(const char * name, pid_t r_pid)
 		return exitCode;
 	}
 
+	// Runtime profiles batches are forwarded by a dedicated thread
+	if (rtlib_configuration.runtime_profiling.rt_profile_batch_window_ms)
+		rtp_flusher = std::thread(&BbqueRPC::RuntimeProfilesFlusher, this);
+
 	rtlib_is_initialized = true;
 	logger->Debug("Initialize: DONE");
 	return RTLIB_OK;
@@ -527,6 +540,9 @@ void BbqueRPC::Unregister(const RTLIB_EXCHandler_t exc_handler)
 
 	assert(isRegistered(exc) == true);
 	logger->Debug("Unregister: unregistering [%s]...", exc->name.c_str());
+
+	// Forward the profiles still pending, this EXC one included
+	FlushRuntimeProfiles(true);
 	result = _Unregister(exc);
 	if (result != RTLIB_OK) {
 		logger->Error("Unregister: EXC [%p:%s] FAILED (Error %d: %s)",
@@ -550,6 +566,9 @@ void BbqueRPC::UnregisterAll()
 		return;
 	}
 
+	// Forward the runtime profiles still pending
+	StopRuntimeProfilesFlusher();
+
 	// Unregistering all the registered EXCs
 	for (auto & registered_exc : exc_map) {
 		auto exc = registered_exc.second;
@@ -622,6 +641,9 @@ RTLIB_ExitCode_t BbqueRPC::Disable(const RTLIB_EXCHandler_t exc_handler)
 	}
 
 	assert(isEnabled(exc) == true);
+
+	// Forward the profiles still pending, this EXC one included
+	FlushRuntimeProfiles(true);
 	result = _Disable(exc);
 	logger->Debug("Disable: [%s] disable message sent", exc->name.c_str());
 
@@ -2322,6 +2344,7 @@ RTLIB_ExitCode_t BbqueRPC::ForwardRuntimeProfile(const RTLIB_EXCHandler_t exc_ha
 		return RTLIB_EXC_NOT_REGISTERED;
 	}
 
+
 	// Forward is inhibited for some ms when the application is assigned a
 	// new set of resources
 	int ms_from_last_allocation = exc->cycletime_stats_user.GetSum();
@@ -2366,6 +2389,19 @@ RTLIB_ExitCode_t BbqueRPC::ForwardRuntimeProfile(const RTLIB_EXCHandler_t exc_ha
 		std::round(cpu_usage),
 		cycle_time_avg_ms);
 
+	// Batching: the profile is forwarded later, together with the ones of
+	// the other EXCs. As in _RTNotify, nothing is sent in sync mode.
+	if (rtlib_configuration.runtime_profiling.rt_profile_batch_window_ms) {
+		if (! isSyncMode(exc))
+			QueueRuntimeProfile({
+				exc->id,
+				(int) std::round(cps_goal_gap),
+				(int) std::round(cpu_usage * 1e3),
+				(int) std::round(cycle_time_avg_ms),
+				(int) exc->cycles_count});
+		return RTLIB_OK;
+	}
+
 	// Send the runtime profile to the resource manager
 	RTLIB_ExitCode_t result =
 		_RTNotify(exc,
@@ -2385,6 +2421,113 @@ RTLIB_ExitCode_t BbqueRPC::ForwardRuntimeProfile(const RTLIB_EXCHandler_t exc_ha
 	return RTLIB_OK;
 }
 
+void BbqueRPC::QueueRuntimeProfile(rpc_msg_EXC_RTNOTIFY_sample_t const & sample)
+{
+	std::unique_lock<std::mutex> rtp_batch_ul(rtp_batch_mtx);
+
+	// The batch window starts with the oldest pending profile
+	if (rtp_batch.empty()) {
+		rtp_batch_timer.start();
+		rtp_batch_cv.notify_one();
+	}
+
+	rtp_batch[sample.exc_id] = sample;
+	logger->Debug("QueueRuntimeProfile: EXC [%d] queued, [%d] pending",
+		sample.exc_id, (int) rtp_batch.size());
+}
+
+RTLIB_ExitCode_t BbqueRPC::FlushRuntimeProfiles(bool force)
+{
+	std::vector<rpc_msg_EXC_RTNOTIFY_sample_t> samples;
+	std::unique_lock<std::mutex> rtp_batch_ul(rtp_batch_mtx);
+
+	if (rtp_batch.empty())
+		return RTLIB_OK;
+	if (!force && rtp_batch_timer.getElapsedTimeMs() <
+	    rtlib_configuration.runtime_profiling.rt_profile_batch_window_ms)
+		return RTLIB_OK;
+
+	samples.reserve(rtp_batch.size());
+	for (auto const & entry : rtp_batch)
+		samples.push_back(entry.second);
+	rtp_batch.clear();
+	rtp_batch_timer.stop();
+	rtp_batch_ul.unlock();
+
+	logger->Debug("FlushRuntimeProfiles: forwarding [%d] profiles...",
+		(int) samples.size());
+	RTLIB_ExitCode_t result = _RTNotifyBatch(samples);
+	if (result != RTLIB_OK) {
+		logger->Error("FlushRuntimeProfiles: FAILED to send (Error %d: %s)",
+			result, RTLIB_ErrorStr(result));
+		return RTLIB_EXC_ENABLE_FAILED;
+	}
+
+	return RTLIB_OK;
+}
+
+void BbqueRPC::RuntimeProfilesFlusher()
+{
+	uint16_t window_ms =
+		rtlib_configuration.runtime_profiling.rt_profile_batch_window_ms;
+	std::unique_lock<std::mutex> rtp_batch_ul(rtp_batch_mtx);
+
+	logger->Debug("RuntimeProfilesFlusher: started [window: %d ms]", window_ms);
+	while (!rtp_flusher_done) {
+		// Wait for the first pending profile, and then for its window end
+		if (rtp_batch.empty()) {
+			rtp_batch_cv.wait(rtp_batch_ul);
+			continue;
+		}
+		double elapsed_ms = rtp_batch_timer.getElapsedTimeMs();
+		if (elapsed_ms < window_ms) {
+			rtp_batch_cv.wait_for(rtp_batch_ul,
+				std::chrono::milliseconds(window_ms - (int) elapsed_ms));
+			continue;
+		}
+
+		rtp_batch_ul.unlock();
+		FlushRuntimeProfiles();
+		rtp_batch_ul.lock();
+	}
+	logger->Debug("RuntimeProfilesFlusher: terminated");
+}
+
+void BbqueRPC::StopRuntimeProfilesFlusher()
+{
+	if (rtp_flusher.joinable()) {
+		std::unique_lock<std::mutex> rtp_batch_ul(rtp_batch_mtx);
+		rtp_flusher_done = true;
+		rtp_batch_cv.notify_one();
+		rtp_batch_ul.unlock();
+		rtp_flusher.join();
+	}
+
+	FlushRuntimeProfiles(true);
+}
+
+RTLIB_ExitCode_t BbqueRPC::_RTNotifyBatch(
+		std::vector<rpc_msg_EXC_RTNOTIFY_sample_t> const & samples)
+{
+	RTLIB_ExitCode_t result = RTLIB_OK;
+
+	for (auto const & sample : samples) {
+		pRegisteredEXC_t exc = getRegistered(sample.exc_id);
+		if (! exc)
+			continue;
+
+		RTLIB_ExitCode_t sample_result = _RTNotify(exc,
+			sample.cps_goal_gap,
+			sample.cpu_usage,
+			sample.cycle_time_ms,
+			sample.cycle_count);
+		if (sample_result != RTLIB_OK)
+			result = sample_result;
+	}
+
+	return result;
+}
+
 RTLIB_ExitCode_t BbqueRPC::SetExplicitGoalGap(
 					      const RTLIB_EXCHandler_t exc_handler,
 					      int ggap)
@@ -28,6 +28,8 @@
 #include <errno.h>
 #include <fcntl.h>
 
+#include <algorithm>
+
 namespace bu = bbque::utils;
 
 // Setup logging
@@ -68,6 +70,7 @@ BbqueRPC_FIFO_Client::~BbqueRPC_FIFO_Client()
 {
 	logger = bu::ConsoleLogger::GetInstance(BBQUE_LOG_MODULE);
 	logger->Debug("BbqueRPC_FIFO_Client dtor");
+	StopRuntimeProfilesFlusher();
 	ChannelRelease();
 }
 
@@ -259,8 +262,8 @@ RTLIB_ExitCode_t BbqueRPC_FIFO_Client::ChannelPair(const char * name)
 				application_pid,
 				0
 			},
-			BBQUE_RPC_FIFO_MAJOR_VERSION,
-			BBQUE_RPC_FIFO_MINOR_VERSION,
+			RTLIB_VERSION_MAJOR,
+			RTLIB_VERSION_MINOR,
 			"\0"
 		}
 	};
@@ -523,7 +526,9 @@ RTLIB_ExitCode_t BbqueRPC_FIFO_Client::_Set(pRegisteredEXC_t prec,
 	// Allocate the buffer to hold all the contraints
 	msg_size = FIFO_PKT_SIZE(EXC_SET) +
 		((count - 1) * sizeof (RTLIB_Constraint_t));
-	prf_EXC_SET = (rpc_fifo_EXC_SET_t *)::malloc(msg_size);
+	prf_EXC_SET = (rpc_fifo_EXC_SET_t *)msg_pool.Get(msg_size);
+	if (! prf_EXC_SET)
+		return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
 
 	// Init FIFO header
 	prf_EXC_SET->hdr.fifo_msg_size = msg_size;
@@ -554,7 +559,7 @@ RTLIB_ExitCode_t BbqueRPC_FIFO_Client::_Set(pRegisteredEXC_t prec,
 	RPC_FIFO_SEND_SIZE(EXC_SET, msg_size);
 
 	// Clean-up the FIFO message
-	::free(prf_EXC_SET);
+	msg_pool.Put(prf_EXC_SET);
 	logger->Debug("_Set: Waiting BBQUE response...");
 	WAIT_RPC_RESP;
 	return (RTLIB_ExitCode_t) chResp.result;
@@ -628,6 +633,60 @@ RTLIB_ExitCode_t BbqueRPC_FIFO_Client::_RTNotify(pRegisteredEXC_t prec,
 	//return (RTLIB_ExitCode_t)chResp.result;
 }
 
+RTLIB_ExitCode_t BbqueRPC_FIFO_Client::_RTNotifyBatch(
+		std::vector<rpc_msg_EXC_RTNOTIFY_sample_t> const & samples)
+{
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_fifo_EXC_RTNOTIFY_BATCH_t * prf_EXC_RTNOTIFY_BATCH;
+	size_t msg_size;
+	size_t first = 0;
+
+	// Here the message is taken from the pool to make room for a variable
+	// number of profiles
+	msg_size = FIFO_PKT_SIZE(EXC_RTNOTIFY_BATCH) +
+		((RPC_EXC_RTNOTIFY_BATCH_MAX - 1) *
+		 sizeof(rpc_msg_EXC_RTNOTIFY_sample_t));
+	prf_EXC_RTNOTIFY_BATCH = (rpc_fifo_EXC_RTNOTIFY_BATCH_t *)msg_pool.Get(msg_size);
+	if (! prf_EXC_RTNOTIFY_BATCH)
+		return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+
+	while (first < samples.size()) {
+		uint8_t count = std::min<size_t>(
+			samples.size() - first, RPC_EXC_RTNOTIFY_BATCH_MAX);
+		msg_size = FIFO_PKT_SIZE(EXC_RTNOTIFY_BATCH) +
+			((count - 1) * sizeof(rpc_msg_EXC_RTNOTIFY_sample_t));
+
+		// Init FIFO header
+		prf_EXC_RTNOTIFY_BATCH->hdr.fifo_msg_size = msg_size;
+		prf_EXC_RTNOTIFY_BATCH->hdr.rpc_msg_offset =
+			FIFO_PYL_OFFSET(EXC_RTNOTIFY_BATCH);
+		prf_EXC_RTNOTIFY_BATCH->hdr.rpc_msg_type = RPC_EXC_RTNOTIFY_BATCH;
+
+		// Init RPC header and payload
+		prf_EXC_RTNOTIFY_BATCH->pyl.hdr.typ = RPC_EXC_RTNOTIFY_BATCH;
+		prf_EXC_RTNOTIFY_BATCH->pyl.hdr.token = RpcMsgToken();
+		prf_EXC_RTNOTIFY_BATCH->pyl.hdr.app_pid = application_pid;
+		prf_EXC_RTNOTIFY_BATCH->pyl.hdr.exc_id = 0;
+		prf_EXC_RTNOTIFY_BATCH->pyl.count = count;
+		::memcpy(&(prf_EXC_RTNOTIFY_BATCH->pyl.samples), &samples[first],
+			count * sizeof(rpc_msg_EXC_RTNOTIFY_sample_t));
+
+		logger->Debug("_RTNotifyBatch: Set [%d] runtime profiles...", count);
+		if (::write(server_fifo_fd, prf_EXC_RTNOTIFY_BATCH, msg_size) <= 0) {
+			logger->Error("write to BBQUE fifo FAILED [%s]",
+				bbque_fifo_path.c_str());
+			msg_pool.Put(prf_EXC_RTNOTIFY_BATCH);
+			return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+		}
+
+		first += count;
+	}
+
+	// Clean-up the FIFO message
+	msg_pool.Put(prf_EXC_RTNOTIFY_BATCH);
+	return RTLIB_OK;
+}
+
 RTLIB_ExitCode_t BbqueRPC_FIFO_Client::_ScheduleRequest(pRegisteredEXC_t prec)
 {
 	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
@@ -658,6 +717,7 @@ RTLIB_ExitCode_t BbqueRPC_FIFO_Client::_ScheduleRequest(pRegisteredEXC_t prec)
 
 void BbqueRPC_FIFO_Client::_Exit()
 {
+	StopRuntimeProfilesFlusher();
 	ChannelRelease();
 }
 
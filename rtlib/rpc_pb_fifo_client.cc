@@ -69,12 +69,14 @@ BbqueRPC_PB_FIFO_Client::~ BbqueRPC_PB_FIFO_Client()
 {
 	logger = bu::ConsoleLogger::GetInstance(BBQUE_LOG_MODULE);
 	logger->Debug("BbqueRPC_PB_FIFO_Client dtor");
+	StopRuntimeProfilesFlusher();
 	ChannelRelease();
 }
 
 RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::ChannelRelease()
 {
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_APP_EXIT, RpcMsgToken(), application_pid, 0);
 	rpc_fifo_APP_EXIT_t rf_APP_EXIT = {
 		{
@@ -247,10 +249,11 @@ void BbqueRPC_PB_FIFO_Client::ChannelTrd(const char * name)
 RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::ChannelPair(const char * name)
 {
 	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_APP_PAIR, RpcMsgToken(), application_pid, 0);
-	msg.set_mjr_version(BBQUE_RPC_FIFO_MAJOR_VERSION);
-	msg.set_mnr_version(BBQUE_RPC_FIFO_MINOR_VERSION);
+	msg.set_mjr_version(RTLIB_VERSION_MAJOR);
+	msg.set_mnr_version(RTLIB_VERSION_MINOR);
 	msg.set_app_name(name);
 	rpc_fifo_APP_PAIR_t rf_APP_PAIR = {
 		{
@@ -364,7 +367,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_Init(
 RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_Register(pRegisteredEXC_t prec)
 {
 	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_EXC_REGISTER, RpcMsgToken(), application_pid, prec->id);
 	msg.set_exc_name(prec->name);
 	msg.set_recipe(prec->parameters.recipe);
@@ -395,7 +399,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_Register(pRegisteredEXC_t prec)
 RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_Unregister(pRegisteredEXC_t prec)
 {
 	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_EXC_UNREGISTER, RpcMsgToken(), application_pid, prec->id);
 	msg.set_exc_name(prec->name);
 	rpc_fifo_EXC_UNREGISTER_t rf_EXC_UNREGISTER = {
@@ -423,7 +428,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_Unregister(pRegisteredEXC_t prec)
 RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_Enable(pRegisteredEXC_t prec)
 {
 	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_EXC_START, RpcMsgToken(), application_pid, prec->id);
 	rpc_fifo_EXC_START_t rf_EXC_START = {
 		{
@@ -449,7 +455,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_Enable(pRegisteredEXC_t prec)
 RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_Disable(pRegisteredEXC_t prec)
 {
 	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_EXC_STOP, RpcMsgToken(), application_pid, prec->id);
 	rpc_fifo_EXC_STOP_t rf_EXC_STOP = {
 		{
@@ -476,7 +483,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_Set(pRegisteredEXC_t prec,
 					       RTLIB_Constraint_t * constraints, uint8_t count)
 {
 	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_EXC_SET, RpcMsgToken(), application_pid, prec->id);
 	// At least 1 constraint it is expected
 	assert(count);
@@ -516,7 +524,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_Set(pRegisteredEXC_t prec,
 RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_Clear(pRegisteredEXC_t prec)
 {
 	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_EXC_CLEAR, RpcMsgToken(), application_pid, prec->id);
 	rpc_fifo_EXC_CLEAR_t rf_EXC_CLEAR = {
 		{
@@ -546,7 +555,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_RTNotify(pRegisteredEXC_t prec,
 						    int cycle_count)
 {
 	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_EXC_RTNOTIFY, RpcMsgToken(), application_pid, prec->id);
 	msg.set_cps_goal_gap(cps_goal_gap);
 	msg.set_cpu_usage(cpu_usage);
@@ -580,7 +590,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_RTNotify(pRegisteredEXC_t prec,
 RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_ScheduleRequest(pRegisteredEXC_t prec)
 {
 	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_EXC_SCHEDULE, RpcMsgToken(), application_pid, prec->id);
 	rpc_fifo_EXC_SCHEDULE_t rf_EXC_SCHEDULE = {
 		{
@@ -605,6 +616,7 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_ScheduleRequest(pRegisteredEXC_t prec
 
 void BbqueRPC_PB_FIFO_Client::_Exit()
 {
+	StopRuntimeProfilesFlusher();
 	ChannelRelease();
 }
 
@@ -615,7 +627,8 @@ void BbqueRPC_PB_FIFO_Client::_Exit()
 RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_SyncpPreChangeResp(
 							      rpc_msg_token_t token, pRegisteredEXC_t prec, uint32_t syncLatency)
 {
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_BBQ_RESP, token, application_pid, prec->id);
 	msg.mutable_hdr()->set_resp_type(PB_BBQ_SYNCP_PRECHANGE_RESP);
 	msg.set_sync_latency(syncLatency);
@@ -643,7 +656,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_SyncpPreChangeResp(
 
 void BbqueRPC_PB_FIFO_Client::RpcBbqSyncpPreChange(unsigned int pyl_size)
 {
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	size_t bytes;
 	// Read response RPC header
 	uint8_t buffer[RPC_PKT_SIZE] = {0};
@@ -673,7 +687,7 @@ void BbqueRPC_PB_FIFO_Client::RpcBbqSyncpPreChange(unsigned int pyl_size)
 		}
 
 		// Read the message
-		void *pyl_buffer = ::malloc(RPC_PKT_SIZE);
+		uint8_t pyl_buffer[RPC_PKT_SIZE];
 		bytes = ::read(client_fifo_fd, pyl_buffer, RPC_PKT_SIZE);
 
 		if (bytes <= 0) {
@@ -682,7 +696,9 @@ void BbqueRPC_PB_FIFO_Client::RpcBbqSyncpPreChange(unsigned int pyl_size)
 			chResp.set_result(RTLIB_BBQUE_CHANNEL_READ_FAILED);
 		}
 
-		PB_rpc_msg_BBQ_SYNCP_PRECHANGE_SYSTEM sys;
+		PBMessageArena<> sys_arena;
+		PB_rpc_msg_BBQ_SYNCP_PRECHANGE_SYSTEM & sys(
+			sys_arena.Create<PB_rpc_msg_BBQ_SYNCP_PRECHANGE_SYSTEM>());
 		sys.ParseFromArray(pyl_buffer, hdr.pyl_size);
 		rpc_msg_BBQ_SYNCP_PRECHANGE_SYSTEM_t struct_sys = {
 			(int16_t)sys.sys_id(),
@@ -725,7 +741,8 @@ void BbqueRPC_PB_FIFO_Client::RpcBbqSyncpPreChange(unsigned int pyl_size)
 RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_SyncpSyncChangeResp(
 							       rpc_msg_token_t token, pRegisteredEXC_t prec, RTLIB_ExitCode_t sync)
 {
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_BBQ_RESP, token, application_pid, prec->id);
 	msg.set_result(sync);
 	rpc_fifo_BBQ_SYNCP_SYNCCHANGE_RESP_t rf_BBQ_SYNCP_SYNCCHANGE_RESP = {
@@ -751,7 +768,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_SyncpSyncChangeResp(
 
 void BbqueRPC_PB_FIFO_Client::RpcBbqSyncpSyncChange(unsigned int pyl_size)
 {
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	size_t bytes;
 	// Read response RPC header
 	uint8_t buffer[RPC_PKT_SIZE] = {0};
@@ -782,7 +800,8 @@ void BbqueRPC_PB_FIFO_Client::RpcBbqSyncpSyncChange(unsigned int pyl_size)
 
 void BbqueRPC_PB_FIFO_Client::RpcBbqSyncpDoChange(unsigned int pyl_size)
 {
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	size_t bytes;
 	// Read response RPC header
 	uint8_t buffer[RPC_PKT_SIZE] = {0};
@@ -815,7 +834,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_SyncpPostChangeResp(
 							       rpc_msg_token_t token, pRegisteredEXC_t prec,
 							       RTLIB_ExitCode_t result)
 {
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_BBQ_RESP, token, application_pid, prec->id);
 	msg.set_result(result);
 	rpc_fifo_BBQ_SYNCP_POSTCHANGE_RESP_t rf_BBQ_SYNCP_POSTCHANGE_RESP = {
@@ -841,7 +861,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_SyncpPostChangeResp(
 
 void BbqueRPC_PB_FIFO_Client::RpcBbqSyncpPostChange(unsigned int pyl_size)
 {
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	size_t bytes;
 	// Read response RPC header
 	uint8_t buffer[RPC_PKT_SIZE] = {0};
@@ -872,7 +893,8 @@ void BbqueRPC_PB_FIFO_Client::RpcBbqSyncpPostChange(unsigned int pyl_size)
 
 void BbqueRPC_PB_FIFO_Client::RpcBbqGetRuntimeProfile(unsigned int pyl_size)
 {
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	size_t bytes;
 	// Read RPC request
 	uint8_t buffer[RPC_PKT_SIZE] = {0};
@@ -905,7 +927,8 @@ RTLIB_ExitCode_t BbqueRPC_PB_FIFO_Client::_GetRuntimeProfileResp(
 								 uint32_t mem_time)
 {
 	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
-	PB_rpc_msg msg;
+	PBMessageArena<> msg_arena;
+	PB_rpc_msg & msg(msg_arena.Create<PB_rpc_msg>());
 	PBMessageFactory::pb_set_header(msg, RPC_BBQ_RESP, token, application_pid, prec->id);
 	msg.mutable_hdr()->set_resp_type(PB_BBQ_GET_PROFILE_RESP);
 	msg.set_exec_time(exc_time);
@@ -0,0 +1,948 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bbque/rtlib/rpc/shm/rpc_shm_client.h"
+
+#include "bbque/rtlib/rpc/rpc_messages.h"
+#include "bbque/utils/utility.h"
+#include "bbque/utils/logging/console_logger.h"
+#include "bbque/config.h"
+
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace bu = bbque::utils;
+
+// Setup logging
+#undef  BBQUE_LOG_MODULE
+#define BBQUE_LOG_MODULE "rpc.shm"
+
+#define RPC_SHM_SEND_SIZE(RPC_MSG, SIZE)\
+	logger->Debug("Tx [" #RPC_MSG "] Request "\
+	              "RPC_HDR [typ: %d, pid: %d, eid: %" PRIu8 "], Bytes: %" PRIu32 "...\n",\
+	              rm_ ## RPC_MSG.hdr.typ,\
+	              rm_ ## RPC_MSG.hdr.app_pid,\
+	              rm_ ## RPC_MSG.hdr.exc_id,\
+	              (uint32_t)SIZE\
+		     );\
+	if (ChannelSend((void*)&rm_ ## RPC_MSG, SIZE) != RTLIB_OK) {\
+		return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;\
+	}
+
+#define RPC_SHM_SEND(RPC_MSG)\
+	RPC_SHM_SEND_SIZE(RPC_MSG, RPC_PKT_SIZE(RPC_MSG))
+
+namespace bbque {
+namespace rtlib {
+
+BbqueRPC_SHM_Client::BbqueRPC_SHM_Client() :
+    BbqueRPC(),
+    done(false)
+{
+	logger->Debug("Building SHM RPC channel");
+}
+
+BbqueRPC_SHM_Client::~BbqueRPC_SHM_Client()
+{
+	logger = bu::ConsoleLogger::GetInstance(BBQUE_LOG_MODULE);
+	logger->Debug("BbqueRPC_SHM_Client dtor");
+	StopRuntimeProfilesFlusher();
+	ChannelRelease();
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::ChannelRelease()
+{
+	rpc_msg_APP_EXIT_t rm_APP_EXIT = {
+		{
+			RPC_APP_EXIT,
+			RpcMsgToken(),
+			application_pid,
+			0
+		}
+	};
+
+	// Already released (or never set up)
+	if (!segment)
+		return RTLIB_OK;
+
+	logger->Debug("Releasing SHM RPC channel");
+	// Sending RPC Request
+	if (bbque_event_fd >= 0 &&
+	    ChannelSend(&rm_APP_EXIT, RPC_PKT_SIZE(APP_EXIT)) != RTLIB_OK)
+		logger->Error("Notify daemon FAILED");
+
+	// Stopping the fetch thread
+	done = true;
+	if (rx_ring.Doorbell())
+		rx_ring.FutexWake();
+	if (ChTrd.joinable())
+		ChTrd.join();
+
+	// The daemon unmaps the segment once processed the APP_EXIT
+	::munmap(segment, segment_size);
+	segment = nullptr;
+	if (shm_fd >= 0)
+		::close(shm_fd);
+	shm_fd = -1;
+	if (bbque_event_fd >= 0)
+		::close(bbque_event_fd);
+	bbque_event_fd = -1;
+
+	return RTLIB_OK;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::ChannelSend(void const * msg,
+						  size_t count)
+{
+	std::unique_lock<std::mutex> tx_ul(tx_mtx);
+	auto deadline = std::chrono::steady_clock::now() +
+		std::chrono::milliseconds(BBQUE_RPC_TIMEOUT);
+
+	// A message must fit into the ring, even if wrapped around
+	if (RPC_SHM_RECORD_SIZE(count) > BBQUE_RPC_SHM_RING_BYTES / 2) {
+		logger->Error("ChannelSend: message too big [%d bytes]", (int)count);
+		return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+	}
+
+	// Wait for the daemon to make room, if the ring is full
+	while (!tx_ring.Push(msg, count)) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			logger->Error("ChannelSend: daemon ring full");
+			return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+
+	// Wake up the daemon, only if sleeping
+	if (tx_ring.Doorbell()) {
+		uint64_t count = 1;
+		if (::write(bbque_event_fd, &count, sizeof(count)) < 0) {
+			logger->Error("ChannelSend: daemon doorbell FAILED (Error %d: %s)",
+				errno, strerror(errno));
+			return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+		}
+	}
+
+	return RTLIB_OK;
+}
+
+void BbqueRPC_SHM_Client::ChannelWait()
+{
+	// Check again for messages (and termination) after having declared
+	// to sleep: either the daemon sees the flag set, or we see its message
+	if (!rx_ring.Arm() || done) {
+		rx_ring.Disarm();
+		return;
+	}
+
+	rx_ring.FutexWait(BBQUE_RPC_TIMEOUT);
+	rx_ring.Disarm();
+}
+
+ssize_t BbqueRPC_SHM_Client::ChannelRecv(void * msg, size_t count)
+{
+	ssize_t bytes;
+	void * pyl;
+
+	while ((bytes = rx_ring.Peek(pyl)) == 0) {
+		if (done)
+			return 0;
+		ChannelWait();
+	}
+
+	if (bytes < 0) {
+		logger->Error("ChannelRecv: daemon ring corrupted");
+		done = true;
+		return bytes;
+	}
+
+	// Copy out the message and release the ring room
+	::memset(msg, 0, count);
+	::memcpy(msg, pyl, std::min<size_t>(bytes, count));
+	rx_ring.Pop();
+
+	return bytes;
+}
+
+void BbqueRPC_SHM_Client::RpcBbqResp()
+{
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	// Read response RPC message
+	if (ChannelRecv((void *) &chResp, RPC_PKT_SIZE(resp)) <= 0) {
+		logger->Error("FAILED read from daemon ring");
+		chResp.result = RTLIB_BBQUE_CHANNEL_READ_FAILED;
+	}
+
+	// Notify about reception of a new response
+	logger->Debug("Notify response [%d]", chResp.result);
+	chResp_cv.notify_one();
+}
+
+void BbqueRPC_SHM_Client::ChannelFetch()
+{
+	rpc_msg_header_t * hdr;
+	ssize_t bytes;
+	void * pyl;
+
+	// Wait for a message
+	bytes = rx_ring.Peek(pyl);
+	if (bytes == 0) {
+		ChannelWait();
+		return;
+	}
+
+	if (bytes < (ssize_t) RPC_PKT_SIZE(header)) {
+		logger->Error("FAILED read from daemon ring (Error: corrupted)");
+		// Exit the read thread if we are unable to read from the Barbeque
+		// FIXME an error should be notified to the application
+		done = true;
+		return;
+	}
+
+	hdr = (rpc_msg_header_t *) pyl;
+	logger->Debug("Rx RPC_HDR [typ: %d, pid: %d, eid: %hd], Bytes: %d",
+		hdr->typ, hdr->app_pid, hdr->exc_id, (int)bytes);
+
+	// Dispatching the received message
+	switch (hdr->typ) {
+		//--- Application Originated Messages
+	case RPC_APP_RESP:
+		logger->Debug("APP_RESP");
+		RpcBbqResp();
+		break;
+
+		//--- Execution Context Originated Messages
+	case RPC_EXC_RESP:
+		logger->Debug("EXC_RESP");
+		RpcBbqResp();
+		break;
+
+		//--- Barbeque Originated Messages
+	case RPC_BBQ_STOP_EXECUTION:
+		logger->Debug("BBQ_STOP_EXECUTION");
+		rx_ring.Pop();
+		break;
+
+	case RPC_BBQ_GET_PROFILE:
+		logger->Debug("BBQ_GET_PROFILE");
+		RpcBbqGetRuntimeProfile();
+		break;
+
+	case RPC_BBQ_SYNCP_PRECHANGE:
+		logger->Debug("BBQ_SYNCP_PRECHANGE");
+		RpcBbqSyncpPreChange();
+		break;
+
+	case RPC_BBQ_SYNCP_SYNCCHANGE:
+		logger->Debug("BBQ_SYNCP_SYNCCHANGE");
+		RpcBbqSyncpSyncChange();
+		break;
+
+	case RPC_BBQ_SYNCP_DOCHANGE:
+		logger->Debug("BBQ_SYNCP_DOCHANGE");
+		RpcBbqSyncpDoChange();
+		break;
+
+	case RPC_BBQ_SYNCP_POSTCHANGE:
+		logger->Debug("BBQ_SYNCP_POSTCHANGE");
+		RpcBbqSyncpPostChange();
+		break;
+
+	default:
+		logger->Error("Unknown BBQ response/command [%d]", hdr->typ);
+		rx_ring.Pop();
+		break;
+	}
+}
+
+void BbqueRPC_SHM_Client::ChannelTrd(const char * name)
+{
+	std::unique_lock<std::mutex> trdStatus_ul(trdStatus_mtx);
+
+	// Set the thread name
+	if (BBQUE_UNLIKELY(prctl(PR_SET_NAME, (long unsigned int) "bq.shm", 0, 0, 0)))
+		logger->Error("Set name FAILED! (Error: %s)\n", strerror(errno));
+
+	// Setup the RTLib UID
+	SetChannelThreadID(gettid(), name);
+	logger->Debug("ChannelTrd [PID: %d] CREATED", channel_thread_pid);
+	// Notifying the thread has beed started
+	trdStatus_cv.notify_one();
+
+	// Waiting for channel setup to be completed
+	if (! running)
+		trdStatus_cv.wait(trdStatus_ul);
+
+	logger->Debug("ChannelTrd [PID: %d] START", channel_thread_pid);
+	while (! done)
+		ChannelFetch();
+	logger->Debug("ChannelTrd [PID: %d] END", channel_thread_pid);
+}
+
+#define WAIT_RPC_RESP \
+	chResp.result = RTLIB_BBQUE_CHANNEL_TIMEOUT; \
+	chResp_cv.wait_for(chCommand_ul, \
+			   std::chrono::milliseconds(BBQUE_RPC_TIMEOUT)); \
+	if (chResp.result == RTLIB_BBQUE_CHANNEL_TIMEOUT) {\
+		logger->Warn("RTLIB response TIMEOUT"); \
+	}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::ChannelPair(const char * name)
+{
+	UNUSED(name);
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_APP_PAIR_t rm_APP_PAIR = {
+		{
+			RPC_APP_PAIR,
+			RpcMsgToken(),
+			application_pid,
+			0
+		},
+		RTLIB_VERSION_MAJOR,
+		RTLIB_VERSION_MINOR,
+		"\0"
+	};
+	struct sockaddr_un addr;
+	struct timeval timeout = {
+		BBQUE_RPC_TIMEOUT / 1000,
+		(BBQUE_RPC_TIMEOUT % 1000) * 1000
+	};
+	uint8_t result;
+	ssize_t bytes;
+	int sock_fd;
+
+	::strncpy(rm_APP_PAIR.app_name, application_name, RTLIB_APP_NAME_LENGTH);
+	logger->Debug("ChannelPair: pairing SHM channel [app_name: %s]",
+		rm_APP_PAIR.app_name);
+
+	// Connecting to the daemon pairing socket
+	sock_fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (sock_fd < 0) {
+		logger->Error("ChannelPair: socket creation failed (error %d: %s)",
+			errno, strerror(errno));
+		return RTLIB_BBQUE_CHANNEL_SETUP_FAILED;
+	}
+	::setsockopt(sock_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	::strncpy(addr.sun_path, bbque_sock_path.c_str(), sizeof(addr.sun_path) - 1);
+	if (::connect(sock_fd, (struct sockaddr *) &addr, sizeof(addr))) {
+		logger->Error("ChannelPair: connecting daemon socket [%s] failed "
+			"(error %d: %s)",
+			bbque_sock_path.c_str(), errno, strerror(errno));
+		::close(sock_fd);
+		return RTLIB_BBQUE_CHANNEL_SETUP_FAILED;
+	}
+
+	// Sending RPC Request, together with the shared segment
+	logger->Debug("Tx [APP_PAIR] Request RPC_HDR [typ: %d, pid: %d]...",
+		rm_APP_PAIR.hdr.typ, rm_APP_PAIR.hdr.app_pid);
+	bytes = RpcShmSendFd(sock_fd, &rm_APP_PAIR, RPC_PKT_SIZE(APP_PAIR), shm_fd);
+	if (bytes != RPC_PKT_SIZE(APP_PAIR)) {
+		logger->Error("ChannelPair: write to daemon socket FAILED "
+			"(error %d: %s)", errno, strerror(errno));
+		::close(sock_fd);
+		return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+	}
+
+	// The segment has been mapped by the daemon, which sends back its
+	// doorbell. The response then follows through the ring.
+	logger->Debug("ChannelPair: waiting for daemon doorbell...");
+	bytes = RpcShmRecvFd(sock_fd, &result, sizeof(result), bbque_event_fd);
+	::close(sock_fd);
+	if (bytes != sizeof(result) || bbque_event_fd < 0) {
+		logger->Error("ChannelPair: daemon doorbell not received "
+			"(error %d: %s)", errno, strerror(errno));
+		return RTLIB_BBQUE_CHANNEL_SETUP_FAILED;
+	}
+	::close(shm_fd);
+	shm_fd = -1;
+
+	logger->Debug("ChannelPair: waiting for daemon response...");
+	WAIT_RPC_RESP;
+	logger->Debug("ChannelPair: daemon response: %d", chResp.result);
+	return (RTLIB_ExitCode_t) chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::ChannelSetup()
+{
+	uint32_t ring_size = BBQUE_RPC_SHM_RING_BYTES;
+	void * addr;
+
+	logger->Debug("ChannelSetup: initialization...");
+	static_assert((BBQUE_RPC_SHM_RING_BYTES & (BBQUE_RPC_SHM_RING_BYTES - 1)) == 0,
+		"The RPC shared memory ring size must be a power of 2");
+
+	// Creating the shared segment
+	segment_size = RPC_SHM_SEGMENT_SIZE(ring_size);
+	logger->Debug("ChannelSetup: creating shared segment [%d bytes]...",
+		(int)segment_size);
+	shm_fd = ::memfd_create("bbque_rpc", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (shm_fd < 0) {
+		logger->Error("ChannelSetup: creating shared segment failed "
+			"(error %d: %s)", errno, strerror(errno));
+		return RTLIB_BBQUE_CHANNEL_SETUP_FAILED;
+	}
+
+	// The daemon requires the segment not to shrink once mapped
+	if (::ftruncate(shm_fd, segment_size) ||
+	    ::fcntl(shm_fd, F_ADD_SEALS,
+		    F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)) {
+		logger->Error("ChannelSetup: sizing shared segment failed "
+			"(error %d: %s)", errno, strerror(errno));
+		::close(shm_fd);
+		shm_fd = -1;
+		return RTLIB_BBQUE_CHANNEL_SETUP_FAILED;
+	}
+
+	addr = ::mmap(NULL, segment_size, PROT_READ | PROT_WRITE,
+		MAP_SHARED, shm_fd, 0);
+	if (addr == MAP_FAILED) {
+		logger->Error("ChannelSetup: mapping shared segment failed "
+			"(error %d: %s)", errno, strerror(errno));
+		::close(shm_fd);
+		shm_fd = -1;
+		return RTLIB_BBQUE_CHANNEL_SETUP_FAILED;
+	}
+	segment = (rpc_shm_segment_t *) addr;
+
+	// Setting up the rings
+	segment->magic = BBQUE_RPC_SHM_MAGIC;
+	segment->mjr_version = BBQUE_RPC_SHM_MAJOR_VERSION;
+	segment->mnr_version = BBQUE_RPC_SHM_MINOR_VERSION;
+	segment->ring_size = ring_size;
+	tx_ring = RpcShmRing(RpcShmRingToBbq(segment), ring_size);
+	tx_ring.Init();
+	rx_ring = RpcShmRing(RpcShmRingToApp(segment, ring_size), ring_size);
+	rx_ring.Init();
+	logger->Debug("ChannelSetup: shared segment ready");
+
+	return RTLIB_OK;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Init(const char * name)
+{
+	std::unique_lock<std::mutex> trdStatus_ul(trdStatus_mtx);
+
+	// Setting up the communication channel
+	RTLIB_ExitCode_t result = ChannelSetup();
+	if (result != RTLIB_OK)
+		return result;
+
+	// Starting the communication thread
+	logger->Debug("_Init: spawning channel thread...");
+	done = false;
+	running = false;
+	ChTrd = std::thread(&BbqueRPC_SHM_Client::ChannelTrd, this, name);
+	trdStatus_cv.wait(trdStatus_ul);
+
+	// Start the reception thread
+	logger->Debug("_Init: starting channel thread...");
+	running = true;
+	trdStatus_cv.notify_one();
+	trdStatus_ul.unlock();
+
+	// Pairing channel with server
+	result = ChannelPair(application_name);
+	if (result != RTLIB_OK) {
+		ChannelRelease();
+		return result;
+	}
+
+	return RTLIB_OK;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Register(pRegisteredEXC_t prec)
+{
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_REGISTER_t rm_EXC_REGISTER = {
+		{
+			RPC_EXC_REGISTER,
+			RpcMsgToken(),
+			application_pid,
+			prec->id
+		},
+		"\0",
+		"\0",
+		RTLIB_LANG_UNDEF
+	};
+	// EXC and Recipe name: we need a null-termination character to
+	// properly separate two char[] fields
+	memset(rm_EXC_REGISTER.exc_name, '\0', RTLIB_EXC_NAME_LENGTH);
+	strncpy(rm_EXC_REGISTER.exc_name, prec->name.c_str(),
+		RTLIB_EXC_NAME_LENGTH - 1);
+	memset(rm_EXC_REGISTER.recipe, '\0', RTLIB_EXC_NAME_LENGTH);
+	strncpy(rm_EXC_REGISTER.recipe, prec->parameters.recipe,
+		RTLIB_EXC_NAME_LENGTH - 1);
+	rm_EXC_REGISTER.lang = prec->parameters.language;
+	logger->Debug("_Register: EXC [%d:%d:%s:%d]...",
+		rm_EXC_REGISTER.hdr.app_pid,
+		rm_EXC_REGISTER.hdr.exc_id,
+		rm_EXC_REGISTER.exc_name,
+		rm_EXC_REGISTER.lang);
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_REGISTER);
+	logger->Debug("_Register: waiting for daemon response...");
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t) chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Unregister(pRegisteredEXC_t prec)
+{
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_UNREGISTER_t rm_EXC_UNREGISTER = {
+		{
+			RPC_EXC_UNREGISTER,
+			RpcMsgToken(),
+			application_pid,
+			prec->id
+		},
+		"\0"
+	};
+	::strncpy(rm_EXC_UNREGISTER.exc_name, prec->name.c_str(),
+		RTLIB_EXC_NAME_LENGTH);
+	logger->Debug("_Unregister: EXC [%d:%d:%s]...",
+		rm_EXC_UNREGISTER.hdr.app_pid,
+		rm_EXC_UNREGISTER.hdr.exc_id,
+		rm_EXC_UNREGISTER.exc_name);
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_UNREGISTER);
+	logger->Debug("_Unregister: waiting for daemon response....");
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t) chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Enable(pRegisteredEXC_t prec)
+{
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_START_t rm_EXC_START = {
+		{
+			RPC_EXC_START,
+			RpcMsgToken(),
+			application_pid,
+			prec->id
+		},
+	};
+	logger->Debug("_Enable: EXC [%d:%d]...",
+		rm_EXC_START.hdr.app_pid,
+		rm_EXC_START.hdr.exc_id);
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_START);
+	logger->Debug("_Enable: waiting for daemon response...");
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t) chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Disable(pRegisteredEXC_t prec)
+{
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_STOP_t rm_EXC_STOP = {
+		{
+			RPC_EXC_STOP,
+			RpcMsgToken(),
+			application_pid,
+			prec->id
+		},
+	};
+	logger->Debug("_Disable: EXC [%d:%d]...",
+		rm_EXC_STOP.hdr.app_pid,
+		rm_EXC_STOP.hdr.exc_id);
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_STOP);
+	logger->Debug("_Disable: waiting for daemon response...");
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t) chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Set(pRegisteredEXC_t prec,
+					   RTLIB_Constraint_t * constraints,
+					   uint8_t count)
+{
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+
+	// Here the message is dynamically allocate to make room for a variable
+	// number of constraints...
+	rpc_msg_EXC_SET_t * prm_EXC_SET;
+	size_t msg_size;
+
+	// At least 1 constraint it is expected
+	assert(count);
+
+	// Allocate the buffer to hold all the contraints
+	msg_size = RPC_PKT_SIZE(EXC_SET) +
+		((count - 1) * sizeof (RTLIB_Constraint_t));
+	prm_EXC_SET = (rpc_msg_EXC_SET_t *)msg_pool.Get(msg_size);
+	if (!prm_EXC_SET)
+		return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+
+	// Init RPC header
+	prm_EXC_SET->hdr.typ = RPC_EXC_SET;
+	prm_EXC_SET->hdr.token = RpcMsgToken();
+	prm_EXC_SET->hdr.app_pid = application_pid;
+	prm_EXC_SET->hdr.exc_id = prec->id;
+	logger->Debug("_Set: Copying [%d] constraints using buffer @%p "
+		"of [%" PRIu64 "] Bytes...",
+		count, (void *) & (prm_EXC_SET->constraints),
+		(count) * sizeof (RTLIB_Constraint_t));
+
+	// Init RPC payload
+	prm_EXC_SET->count = count;
+	::memcpy(&(prm_EXC_SET->constraints), constraints,
+		(count) * sizeof (RTLIB_Constraint_t));
+
+	// Sending RPC Request
+	rpc_msg_EXC_SET_t & rm_EXC_SET = (*prm_EXC_SET);
+	logger->Debug("_Set: Set [%d] constraints on EXC [%d:%d]...",
+		count,
+		rm_EXC_SET.hdr.app_pid,
+		rm_EXC_SET.hdr.exc_id);
+	RTLIB_ExitCode_t result = ChannelSend(prm_EXC_SET, msg_size);
+
+	// Clean-up the message
+	msg_pool.Put(prm_EXC_SET);
+	if (result != RTLIB_OK)
+		return result;
+
+	logger->Debug("_Set: Waiting BBQUE response...");
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t) chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Clear(pRegisteredEXC_t prec)
+{
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_CLEAR_t rm_EXC_CLEAR = {
+		{
+			RPC_EXC_CLEAR,
+			RpcMsgToken(),
+			application_pid,
+			prec->id
+		},
+	};
+	logger->Debug("_Clear: Remove constraints for EXC [%d:%d]...",
+		rm_EXC_CLEAR.hdr.app_pid,
+		rm_EXC_CLEAR.hdr.exc_id);
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_CLEAR);
+	logger->Debug("_Clear: Waiting BBQUE response...");
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t) chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_RTNotify(pRegisteredEXC_t prec,
+						int cps_ggap_perc,
+						int cpu_usage,
+						int cycle_time_ms,
+						int cycles_count)
+{
+	rpc_msg_EXC_RTNOTIFY_t rm_EXC_RTNOTIFY = {
+		{
+			RPC_EXC_RTNOTIFY,
+			RpcMsgToken(),
+			application_pid,
+			prec->id
+		},
+		cps_ggap_perc,
+		cpu_usage,
+		cycle_time_ms,
+		cycles_count
+	};
+	logger->Debug("_RTNotify: Set Goal-Gap for EXC [%d:%d]...",
+		rm_EXC_RTNOTIFY.hdr.app_pid,
+		rm_EXC_RTNOTIFY.hdr.exc_id);
+
+	// Sending RPC Request: no response is expected, thus there is no need
+	// to serialize with the other commands
+	if (! isSyncMode(prec)) {
+		RPC_SHM_SEND(EXC_RTNOTIFY);
+	}
+
+	return RTLIB_OK;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_RTNotifyBatch(
+		std::vector<rpc_msg_EXC_RTNOTIFY_sample_t> const & samples)
+{
+	rpc_msg_EXC_RTNOTIFY_BATCH_t * prm_EXC_RTNOTIFY_BATCH;
+	RTLIB_ExitCode_t result = RTLIB_OK;
+	size_t msg_size;
+	size_t first = 0;
+
+	// Here the message is taken from the pool to make room for a variable
+	// number of profiles
+	msg_size = RPC_PKT_SIZE(EXC_RTNOTIFY_BATCH) +
+		((RPC_EXC_RTNOTIFY_BATCH_MAX - 1) *
+		 sizeof(rpc_msg_EXC_RTNOTIFY_sample_t));
+	prm_EXC_RTNOTIFY_BATCH = (rpc_msg_EXC_RTNOTIFY_BATCH_t *)msg_pool.Get(msg_size);
+	if (! prm_EXC_RTNOTIFY_BATCH)
+		return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+
+	while (first < samples.size() && result == RTLIB_OK) {
+		uint8_t count = std::min<size_t>(
+			samples.size() - first, RPC_EXC_RTNOTIFY_BATCH_MAX);
+		msg_size = RPC_PKT_SIZE(EXC_RTNOTIFY_BATCH) +
+			((count - 1) * sizeof(rpc_msg_EXC_RTNOTIFY_sample_t));
+
+		// Init RPC header and payload
+		prm_EXC_RTNOTIFY_BATCH->hdr.typ = RPC_EXC_RTNOTIFY_BATCH;
+		prm_EXC_RTNOTIFY_BATCH->hdr.token = RpcMsgToken();
+		prm_EXC_RTNOTIFY_BATCH->hdr.app_pid = application_pid;
+		prm_EXC_RTNOTIFY_BATCH->hdr.exc_id = 0;
+		prm_EXC_RTNOTIFY_BATCH->count = count;
+		::memcpy(&(prm_EXC_RTNOTIFY_BATCH->samples), &samples[first],
+			count * sizeof(rpc_msg_EXC_RTNOTIFY_sample_t));
+
+		logger->Debug("_RTNotifyBatch: Set [%d] runtime profiles...", count);
+		result = ChannelSend(prm_EXC_RTNOTIFY_BATCH, msg_size);
+		first += count;
+	}
+
+	// Clean-up the message
+	msg_pool.Put(prm_EXC_RTNOTIFY_BATCH);
+	return result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_ScheduleRequest(pRegisteredEXC_t prec)
+{
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_SCHEDULE_t rm_EXC_SCHEDULE = {
+		{
+			RPC_EXC_SCHEDULE,
+			RpcMsgToken(),
+			application_pid,
+			prec->id
+		},
+	};
+	logger->Debug("_ScheduleRequest: Schedule request for EXC [%d:%d]...",
+		rm_EXC_SCHEDULE.hdr.app_pid,
+		rm_EXC_SCHEDULE.hdr.exc_id);
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_SCHEDULE);
+	logger->Debug("_ScheduleRequest: Waiting BBQUE response...");
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t) chResp.result;
+}
+
+void BbqueRPC_SHM_Client::_Exit()
+{
+	StopRuntimeProfilesFlusher();
+	ChannelRelease();
+}
+
+/******************************************************************************
+ * Synchronization Protocol Messages - PreChange
+ ******************************************************************************/
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_SyncpPreChangeResp(rpc_msg_token_t token,
+							  pRegisteredEXC_t prec,
+							  uint32_t syncLatency)
+{
+	rpc_msg_BBQ_SYNCP_PRECHANGE_RESP_t rm_BBQ_SYNCP_PRECHANGE_RESP = {
+		{
+			RPC_BBQ_RESP,
+			token,
+			application_pid,
+			prec->id
+		},
+		syncLatency,
+		RTLIB_OK
+	};
+	logger->Debug("_SyncpPreChangeResp: EXC [%d:%d] latency [%d]...",
+		rm_BBQ_SYNCP_PRECHANGE_RESP.hdr.app_pid,
+		rm_BBQ_SYNCP_PRECHANGE_RESP.hdr.exc_id,
+		rm_BBQ_SYNCP_PRECHANGE_RESP.syncLatency);
+	// Sending RPC Request
+	RPC_SHM_SEND(BBQ_SYNCP_PRECHANGE_RESP);
+	return RTLIB_OK;
+}
+
+void BbqueRPC_SHM_Client::RpcBbqSyncpPreChange()
+{
+	rpc_msg_BBQ_SYNCP_PRECHANGE_t msg;
+	// Read the RPC message
+	if (ChannelRecv((void *) &msg, RPC_PKT_SIZE(BBQ_SYNCP_PRECHANGE)) <= 0) {
+		logger->Error("RpcBbqSyncpPreChange: FAILED read from daemon ring");
+		return;
+	}
+
+	std::vector<rpc_msg_BBQ_SYNCP_PRECHANGE_SYSTEM_t> messages;
+
+	// The assigned systems follow, one message each
+	for (uint_fast16_t i = 0; i < msg.nr_sys; i ++) {
+		rpc_msg_BBQ_SYNCP_PRECHANGE_SYSTEM_t msg_sys;
+		if (ChannelRecv((void *) &msg_sys,
+				RPC_PKT_SIZE(BBQ_SYNCP_PRECHANGE_SYSTEM)) <= 0) {
+			logger->Error("RpcBbqSyncpPreChange: FAILED read from daemon ring");
+			return;
+		}
+
+		messages.push_back(msg_sys);
+	}
+
+	// Notify the Pre-Change
+	SyncP_PreChangeNotify(msg, messages);
+}
+
+/******************************************************************************
+ * Synchronization Protocol Messages - SyncChange
+ ******************************************************************************/
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_SyncpSyncChangeResp(rpc_msg_token_t token,
+							   pRegisteredEXC_t prec,
+							   RTLIB_ExitCode_t sync)
+{
+	rpc_msg_BBQ_SYNCP_SYNCCHANGE_RESP_t rm_BBQ_SYNCP_SYNCCHANGE_RESP = {
+		{
+			RPC_BBQ_RESP,
+			token,
+			application_pid,
+			prec->id
+		},
+		(uint8_t) sync
+	};
+	// Check that the ExitCode can be represented by the response message
+	assert(sync < 256);
+	logger->Debug("_SyncpSyncChangeResp: response EXC [%d:%d]...",
+		rm_BBQ_SYNCP_SYNCCHANGE_RESP.hdr.app_pid,
+		rm_BBQ_SYNCP_SYNCCHANGE_RESP.hdr.exc_id);
+	// Sending RPC Request
+	RPC_SHM_SEND(BBQ_SYNCP_SYNCCHANGE_RESP);
+	return RTLIB_OK;
+}
+
+void BbqueRPC_SHM_Client::RpcBbqSyncpSyncChange()
+{
+	rpc_msg_BBQ_SYNCP_SYNCCHANGE_t msg;
+	// Read the RPC message
+	if (ChannelRecv((void *) &msg, RPC_PKT_SIZE(BBQ_SYNCP_SYNCCHANGE)) <= 0) {
+		logger->Error("RpcBbqSyncpSyncChange: FAILED read from daemon ring");
+		return;
+	}
+
+	// Notify the Sync-Change
+	SyncP_SyncChangeNotify(msg);
+}
+
+/******************************************************************************
+ * Synchronization Protocol Messages - DoChange
+ ******************************************************************************/
+
+void BbqueRPC_SHM_Client::RpcBbqSyncpDoChange()
+{
+	rpc_msg_BBQ_SYNCP_DOCHANGE_t msg;
+	// Read the RPC message
+	if (ChannelRecv((void *) &msg, RPC_PKT_SIZE(BBQ_SYNCP_DOCHANGE)) <= 0) {
+		logger->Error("RpcBbqSyncpDoChange: FAILED read from daemon ring");
+		return;
+	}
+
+	// Notify the Do-Change
+	SyncP_DoChangeNotify(msg);
+}
+
+/******************************************************************************
+ * Synchronization Protocol Messages - PostChange
+ ******************************************************************************/
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_SyncpPostChangeResp(rpc_msg_token_t token,
+							   pRegisteredEXC_t prec,
+							   RTLIB_ExitCode_t result)
+{
+	rpc_msg_BBQ_SYNCP_POSTCHANGE_RESP_t rm_BBQ_SYNCP_POSTCHANGE_RESP = {
+		{
+			RPC_BBQ_RESP,
+			token,
+			application_pid,
+			prec->id
+		},
+		(uint8_t) result
+	};
+	// Check that the ExitCode can be represented by the response message
+	assert(result < 256);
+	logger->Debug("_SyncpPostChangeResp: response EXC [%d:%d]...",
+		rm_BBQ_SYNCP_POSTCHANGE_RESP.hdr.app_pid,
+		rm_BBQ_SYNCP_POSTCHANGE_RESP.hdr.exc_id);
+	// Sending RPC Request
+	RPC_SHM_SEND(BBQ_SYNCP_POSTCHANGE_RESP);
+	return RTLIB_OK;
+}
+
+void BbqueRPC_SHM_Client::RpcBbqSyncpPostChange()
+{
+	rpc_msg_BBQ_SYNCP_POSTCHANGE_t msg;
+	// Read the RPC message
+	if (ChannelRecv((void *) &msg, RPC_PKT_SIZE(BBQ_SYNCP_POSTCHANGE)) <= 0) {
+		logger->Error("RpcBbqSyncpPostChange: FAILED read from daemon ring");
+		return;
+	}
+
+	// Notify the Post-Change
+	SyncP_PostChangeNotify(msg);
+}
+
+/*******************************************************************************
+ * Runtime profiling
+ ******************************************************************************/
+
+void BbqueRPC_SHM_Client::RpcBbqGetRuntimeProfile()
+{
+	rpc_msg_BBQ_GET_PROFILE_t msg;
+	// Read RPC request
+	if (ChannelRecv((void *) &msg, RPC_PKT_SIZE(BBQ_GET_PROFILE)) <= 0) {
+		logger->Error("RpcBbqGetRuntimeProfile: FAILED read from daemon ring");
+		return;
+	}
+
+	// Get runtime profile
+	GetRuntimeProfile(msg);
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_GetRuntimeProfileResp(rpc_msg_token_t token,
+							     pRegisteredEXC_t prec,
+							     uint32_t exc_time,
+							     uint32_t mem_time)
+{
+	rpc_msg_BBQ_GET_PROFILE_RESP_t rm_BBQ_GET_PROFILE_RESP = {
+		{
+			RPC_BBQ_RESP,
+			token,
+			application_pid,
+			prec->id
+		},
+		exc_time,
+		mem_time
+	};
+	// Sending RPC response
+	logger->Debug("_GetRuntimeProfileResp: Setting runtime profile info for EXC [%d:%d]...",
+		rm_BBQ_GET_PROFILE_RESP.hdr.app_pid,
+		rm_BBQ_GET_PROFILE_RESP.hdr.exc_id);
+	RPC_SHM_SEND(BBQ_GET_PROFILE_RESP);
+	return RTLIB_OK;
+}
+
+} // namespace rtlib
+
+} // namespace bbque
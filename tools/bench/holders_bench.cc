@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Micro-benchmark of the bookkeeping of the resource holders.
+ *
+ * The same sequence of operations performed by Resource::Acquire(),
+ * Resource::UsedBy() and Resource::Release() on the holders of a resource
+ * state is run on a std::map and on the SmallFlatMap used by
+ * br::AppUsageQtyMap_t, for an increasing number of applications.
+ * The applications are booked and released in a shuffled order.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "bbque/utils/flat_map.h"
+
+#define BBQUE_BENCH_HOLDERS_INLINE    4
+#define BBQUE_BENCH_MIN_OPERATIONS    (1 << 21)
+
+using AppUid_t = uint32_t;
+
+using StdMap_t  = std::map<AppUid_t, uint64_t>;
+using FlatMap_t = bbque::utils::SmallFlatMap<
+	AppUid_t, uint64_t, BBQUE_BENCH_HOLDERS_INLINE>;
+
+using bench_clock = std::chrono::steady_clock;
+
+struct Result_t {
+	double acquire_ops;
+	double lookup_ops;
+	double release_ops;
+	uint64_t checksum;
+};
+
+static double OpsPerSecond(uint64_t ops, bench_clock::duration elapsed) {
+	double secs = std::chrono::duration<double>(elapsed).count();
+	return (secs > 0) ? (ops / secs) : 0;
+}
+
+template <class Map>
+static Result_t Run(std::vector<AppUid_t> const & acquire_order,
+		std::vector<AppUid_t> const & release_order,
+		uint32_t rounds) {
+	Result_t result = {0, 0, 0, 0};
+	bench_clock::duration t_acquire(0), t_lookup(0), t_release(0);
+	uint64_t nr_apps = acquire_order.size();
+
+	for (uint32_t r = 0; r < rounds; ++r) {
+		Map apps;
+
+		auto start = bench_clock::now();
+		for (auto uid : acquire_order)
+			apps[uid] = uid + r;
+		t_acquire += bench_clock::now() - start;
+
+		start = bench_clock::now();
+		for (auto uid : release_order) {
+			auto it = apps.find(uid);
+			if (it != apps.end())
+				result.checksum += it->second;
+		}
+		t_lookup += bench_clock::now() - start;
+
+		start = bench_clock::now();
+		for (auto uid : release_order)
+			result.checksum += apps.erase(uid);
+		t_release += bench_clock::now() - start;
+	}
+
+	result.acquire_ops = OpsPerSecond(nr_apps * rounds, t_acquire);
+	result.lookup_ops  = OpsPerSecond(nr_apps * rounds, t_lookup);
+	result.release_ops = OpsPerSecond(nr_apps * rounds, t_release);
+	return result;
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t seed = (argc > 1) ? atoi(argv[1]) : 1;
+	std::mt19937 rand_gen(seed);
+
+	printf("# Resource holders bookkeeping [Mops/s], seed=%u\n", seed);
+	printf("# %6s | %-26s | %-26s | %-26s\n", "",
+		"acquire", "used_by", "release");
+	printf("# %6s | %12s %12s | %12s %12s | %12s %12s\n", "apps",
+		"std::map", "flat", "std::map", "flat", "std::map", "flat");
+
+	std::vector<uint32_t> nr_apps_set = {
+		1, 2, 4, 10, 100, 1000, 10000 };
+	for (auto nr_apps : nr_apps_set) {
+		std::vector<AppUid_t> acquire_order(nr_apps);
+		std::iota(acquire_order.begin(), acquire_order.end(), 1000);
+		std::shuffle(acquire_order.begin(), acquire_order.end(), rand_gen);
+		std::vector<AppUid_t> release_order(acquire_order);
+		std::shuffle(release_order.begin(), release_order.end(), rand_gen);
+
+		uint32_t rounds = BBQUE_BENCH_MIN_OPERATIONS / nr_apps;
+		if (rounds < 10)
+			rounds = 10;
+
+		Result_t std_res  = Run<StdMap_t>(acquire_order, release_order, rounds);
+		Result_t flat_res = Run<FlatMap_t>(acquire_order, release_order, rounds);
+		if (std_res.checksum != flat_res.checksum) {
+			fprintf(stderr, "Checksum mismatch with %u applications\n",
+				nr_apps);
+			return EXIT_FAILURE;
+		}
+
+		printf("  %6u | %12.2f %12.2f | %12.2f %12.2f | %12.2f %12.2f\n",
+			nr_apps,
+			std_res.acquire_ops / 1e6, flat_res.acquire_ops / 1e6,
+			std_res.lookup_ops / 1e6,  flat_res.lookup_ops / 1e6,
+			std_res.release_ops / 1e6, flat_res.release_ops / 1e6);
+	}
+
+	return EXIT_SUCCESS;
+}
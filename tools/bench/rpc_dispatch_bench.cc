@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2020  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Stress benchmark of the dispatching of the RTLib requests.
+ *
+ * A single dispatcher thread (as ApplicationProxy::Task) receives a burst of
+ * requests from a set of applications and dispatches each of them:
+ * - "thread": to a new detached thread, as done before by
+ *   ApplicationProxy::ProcessRequest;
+ * - "pool": to the WorkerPool, keyed by application PID.
+ * Each request performs a short critical section on a shared registry,
+ * emulating the update of the ApplicationManager data structures.
+ *
+ * Reported are the throughput, the dispatching latency (from the reception
+ * to the start of the request processing), and the number of requests of
+ * the same application served out of order.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bbque/utils/worker_pool.h"
+
+#define BBQUE_BENCH_DEFAULT_REQUESTS  100000
+#define BBQUE_BENCH_DEFAULT_WORKERS        4
+#define BBQUE_BENCH_REQUEST_WORK         200
+
+using bench_clock = std::chrono::steady_clock;
+
+struct Request_t {
+	uint32_t app_pid;
+	uint32_t seq;
+	bench_clock::time_point recv_time;
+};
+
+/**
+ * The state shared by the request handlers
+ */
+class Registry {
+
+public:
+
+	explicit Registry(uint32_t nr_requests) :
+		latency_us(nr_requests), out_of_order(0), pending(nr_requests) {
+	}
+
+	void Serve(Request_t const & rqs, uint32_t idx) {
+		latency_us[idx] = std::chrono::duration<double, std::micro>(
+			bench_clock::now() - rqs.recv_time).count();
+
+		std::unique_lock<std::mutex> ul(mtx);
+		uint32_t & last_seq(last[rqs.app_pid]);
+		if (rqs.seq < last_seq)
+			++out_of_order;
+		last_seq = rqs.seq;
+		// Some processing
+		volatile uint32_t acc = 0;
+		for (uint32_t i = 0; i < BBQUE_BENCH_REQUEST_WORK; ++i)
+			acc += i * rqs.seq;
+		ul.unlock();
+
+		if (--pending == 0) {
+			std::unique_lock<std::mutex> done_ul(done_mtx);
+			done_cv.notify_one();
+		}
+	}
+
+	void WaitAll() {
+		std::unique_lock<std::mutex> done_ul(done_mtx);
+		while (pending.load() != 0)
+			done_cv.wait_for(done_ul, std::chrono::milliseconds(10));
+	}
+
+	std::vector<double> latency_us;
+
+	uint32_t out_of_order;
+
+private:
+
+	std::map<uint32_t, uint32_t> last;
+
+	std::mutex mtx;
+
+	std::atomic<uint32_t> pending;
+
+	std::mutex done_mtx;
+
+	std::condition_variable done_cv;
+};
+
+struct Result_t {
+	double rqs_per_sec;
+	double p50_us;
+	double p99_us;
+	double max_us;
+	uint32_t out_of_order;
+};
+
+static Result_t Summary(Registry & reg, bench_clock::duration elapsed) {
+	Result_t result;
+	std::vector<double> & samples(reg.latency_us);
+	std::sort(samples.begin(), samples.end());
+	result.rqs_per_sec = samples.size() /
+		std::chrono::duration<double>(elapsed).count();
+	result.p50_us = samples[samples.size() / 2];
+	result.p99_us = samples[(samples.size() * 99) / 100];
+	result.max_us = samples.back();
+	result.out_of_order = reg.out_of_order;
+	return result;
+}
+
+static Result_t RunThreads(uint32_t nr_requests, uint32_t nr_apps) {
+	Registry reg(nr_requests);
+	auto start = bench_clock::now();
+	for (uint32_t i = 0; i < nr_requests; ++i) {
+		Request_t rqs = { 1000 + i % nr_apps, i / nr_apps, bench_clock::now() };
+		std::thread exe([&reg, rqs, i]() { reg.Serve(rqs, i); });
+		exe.detach();
+	}
+	reg.WaitAll();
+	return Summary(reg, bench_clock::now() - start);
+}
+
+static Result_t RunPool(uint32_t nr_requests, uint32_t nr_apps,
+		uint16_t nr_workers) {
+	Registry reg(nr_requests);
+	bbque::utils::WorkerPool pool("bench", nr_workers);
+	auto start = bench_clock::now();
+	for (uint32_t i = 0; i < nr_requests; ++i) {
+		Request_t rqs = { 1000 + i % nr_apps, i / nr_apps, bench_clock::now() };
+		pool.Submit(rqs.app_pid, [&reg, rqs, i]() { reg.Serve(rqs, i); });
+	}
+	reg.WaitAll();
+	return Summary(reg, bench_clock::now() - start);
+}
+
+static void Print(char const * model, uint32_t nr_apps, Result_t const & res) {
+	printf("  %6u | %-8s | %12.0f | %10.1f %10.1f %10.1f | %8u\n",
+		nr_apps, model, res.rqs_per_sec,
+		res.p50_us, res.p99_us, res.max_us, res.out_of_order);
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t nr_requests = (argc > 1) ?
+		atoi(argv[1]) : BBQUE_BENCH_DEFAULT_REQUESTS;
+	uint16_t nr_workers = (argc > 2) ?
+		atoi(argv[2]) : BBQUE_BENCH_DEFAULT_WORKERS;
+	if (nr_requests == 0) {
+		fprintf(stderr, "Usage: %s [requests] [workers]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	printf("# RPC requests dispatching, %u requests, %u pool workers\n",
+		nr_requests, nr_workers);
+	printf("# %6s | %-8s | %12s | %32s | %8s\n", "", "", "",
+		"dispatching latency [us]", "");
+	printf("# %6s | %-8s | %12s | %10s %10s %10s | %8s\n", "apps", "model",
+		"requests/s", "p50", "p99", "max", "reorder");
+
+	std::vector<uint32_t> nr_apps_set = { 1, 10, 100, 1000 };
+	for (auto nr_apps : nr_apps_set) {
+		Print("thread", nr_apps, RunThreads(nr_requests, nr_apps));
+		Print("pool", nr_apps, RunPool(nr_requests, nr_apps, nr_workers));
+	}
+
+	return EXIT_SUCCESS;
+}